@@ -28,6 +28,7 @@
 #include "SimTKcommon/Simmatrix.h"
 #include "SimTKcommon/internal/State.h"
 #include "SimTKcommon/internal/Measure.h"
+#include "SimTKcommon/internal/Profiling.h"
 
 #include <cassert>
 
@@ -290,6 +291,11 @@ inline const String& getName()    const;
 Simbody does not interpret this in any way. **/
 inline const String& getVersion() const;
 
+/** Return the accumulated time spent realizing Stage \a g of this
+%Subsystem while profiling was enabled. @see Profiler, 
+System::getTimingCounters() **/
+inline const TimingCounter& getRealizeTimingCounter(Stage g) const;
+
 /** Return \c true if this %Subsystem is contained in a System. **/
 inline bool isInSystem() const;
 /** Return \c true if this %Subsystem is contained in the same System as 
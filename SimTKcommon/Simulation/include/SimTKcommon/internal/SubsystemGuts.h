@@ -27,6 +27,7 @@
 #include "SimTKcommon/basics.h"
 #include "SimTKcommon/Simmatrix.h"
 #include "SimTKcommon/internal/State.h"
+#include "SimTKcommon/internal/Profiling.h"
 
 #include <cassert>
 
@@ -319,6 +320,19 @@ SubsystemIndex getMySubsystemIndex() const {
 }
 
 
+/** Return the accumulated time spent realizing Stage \a g of this
+%Subsystem, including its Measures. This is updated only while profiling is
+enabled; see Profiler. **/
+const TimingCounter& getRealizeTimingCounter(Stage g) const
+{   return m_realizeTimingCounters[g]; }
+
+/** Append to \a counters all the timing counters of this %Subsystem that
+have been called at least once: the realize counters, followed by any that
+the concrete %Subsystem keeps for its own parts. **/
+void appendTimingCounters(Array_<TimingCounter>& counters) const;
+/** Set all the timing counters of this %Subsystem back to zero. **/
+void resetTimingCounters() const;
+
 /** Returns \c true if this subsystem's realizeTopology() method has been
 called since the last topological change or call to 
 invalidateSubsystemTopologyCache(). **/
@@ -437,6 +451,11 @@ virtual void handleEventsImpl
 virtual void reportEventsImpl
     (const State&, Event::Cause, const Array_<EventId>& eventIds) const {}
 
+// Subsystems that time parts of their computation with their own 
+// TimingCounters should report and reset them here.
+virtual void appendTimingCountersImpl(Array_<TimingCounter>& counters) const {}
+virtual void resetTimingCountersImpl() const {}
+
 
 public:
 /** Return a const reference to the Subsystem handle object that is the unique 
@@ -466,6 +485,8 @@ private:
 // Suppressed.
 Guts& operator=(const Guts&);
 
+void nameTimingCounters();
+
 //------------------------------------------------------------------------------
                                     private:
 
@@ -484,6 +505,9 @@ Array_<AbstractMeasure::Implementation*>
 
     // TOPOLOGY CACHE INFORMATION
 mutable bool    m_subsystemTopologyRealized;
+
+    // STATISTICS
+mutable TimingCounter m_realizeTimingCounters[Stage::NValid];
 };
 
 
@@ -497,6 +521,8 @@ inline SubsystemIndex Subsystem::getMySubsystemIndex() const
 
 inline const String& Subsystem::getName()    const {return getSubsystemGuts().getName();}
 inline const String& Subsystem::getVersion() const {return getSubsystemGuts().getVersion();}
+inline const TimingCounter& Subsystem::getRealizeTimingCounter(Stage g) const
+{   return getSubsystemGuts().getRealizeTimingCounter(g); }
 
 inline bool Subsystem::subsystemTopologyHasBeenRealized() const {
     return getSubsystemGuts().subsystemTopologyHasBeenRealized();
@@ -767,6 +767,18 @@ int getNumHandleEventCalls() const;
 /** This is the total number of calls to reportEvents() regardless
 of the outcome. **/
 int getNumReportEventCalls() const;
+
+    // Timing
+
+/** Return the timing counters of all the Subsystems of this System that have
+been called at least once: each %Subsystem's realization of each Stage, and
+any counters the %Subsystem keeps for its own parts, such as the one per Force
+kept by GeneralForceSubsystem. Timing is collected only while profiling is 
+enabled; see Profiler. **/
+void getTimingCounters(Array_<TimingCounter>& counters) const;
+/** Set the timing counters of all the Subsystems back to zero. This is also
+done by resetAllCountersToZero(). **/
+void resetTimingCounters();
 /**@}**/
 
 
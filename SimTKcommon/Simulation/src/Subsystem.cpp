@@ -93,6 +93,7 @@ Subsystem::Guts::Guts(const String& name, const String& version)
     m_mySystem(0), m_mySubsystemIndex(InvalidSubsystemIndex), m_myHandle(0),
     m_subsystemTopologyRealized(false)
 { 
+    nameTimingCounters();
 }
 
 // Copy constructor isn't very useful. Note that it doesn't copy Measures.
@@ -102,6 +103,28 @@ Subsystem::Guts::Guts(const Subsystem::Guts& src)
     m_mySystem(0), m_mySubsystemIndex(InvalidSubsystemIndex), m_myHandle(0),
     m_subsystemTopologyRealized(false)
 {
+    nameTimingCounters();
+}
+
+// Timing counters are named "<subsystem name>::realize<Stage>".
+void Subsystem::Guts::nameTimingCounters() {
+    for (int g = Stage::LowestValid; g <= Stage::HighestValid; ++g)
+        m_realizeTimingCounters[g].setName(m_subsystemName + "::realize" 
+                                           + Stage(g).getName());
+}
+
+void Subsystem::Guts::
+appendTimingCounters(Array_<TimingCounter>& counters) const {
+    for (int g = Stage::LowestValid; g <= Stage::HighestValid; ++g)
+        if (m_realizeTimingCounters[g].getNumCalls() > 0)
+            counters.push_back(m_realizeTimingCounters[g]);
+    appendTimingCountersImpl(counters);
+}
+
+void Subsystem::Guts::resetTimingCounters() const {
+    for (int g = Stage::LowestValid; g <= Stage::HighestValid; ++g)
+        m_realizeTimingCounters[g].reset();
+    resetTimingCountersImpl();
 }
 
 // Destructor must unreference and possibly delete measures.
@@ -206,6 +229,7 @@ Subsystem::Guts* Subsystem::Guts::clone() const {
 void Subsystem::Guts::realizeSubsystemTopology(State& s) const {
     SimTK_STAGECHECK_EQ_ALWAYS(getStage(s), Stage::Empty, 
         "Subsystem::Guts::realizeSubsystemTopology()");
+    Profiler::Scope scope(m_realizeTimingCounters[Stage::Topology], "realize");
     realizeSubsystemTopologyImpl(s);
 
     // Realize this Subsystem's Measures.
@@ -226,6 +250,8 @@ void Subsystem::Guts::realizeSubsystemModel(State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage::Topology, 
         "Subsystem::Guts::realizeSubsystemModel()");
     if (getStage(s) < Stage::Model) {
+        Profiler::Scope scope(m_realizeTimingCounters[Stage::Model],
+                              "realize");
         realizeSubsystemModelImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -243,6 +269,8 @@ void Subsystem::Guts::realizeSubsystemInstance(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Instance).prev(), 
         "Subsystem::Guts::realizeSubsystemInstance()");
     if (getStage(s) < Stage::Instance) {
+        Profiler::Scope scope(m_realizeTimingCounters[Stage::Instance],
+                              "realize");
         realizeSubsystemInstanceImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -260,6 +288,7 @@ void Subsystem::Guts::realizeSubsystemTime(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Time).prev(), 
         "Subsystem::Guts::realizeTime()");
     if (getStage(s) < Stage::Time) {
+        Profiler::Scope scope(m_realizeTimingCounters[Stage::Time], "realize");
         realizeSubsystemTimeImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -277,6 +306,8 @@ void Subsystem::Guts::realizeSubsystemPosition(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Position).prev(), 
         "Subsystem::Guts::realizeSubsystemPosition()");
     if (getStage(s) < Stage::Position) {
+        Profiler::Scope scope(m_realizeTimingCounters[Stage::Position],
+                              "realize");
         realizeSubsystemPositionImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -294,6 +325,8 @@ void Subsystem::Guts::realizeSubsystemVelocity(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Velocity).prev(), 
         "Subsystem::Guts::realizeSubsystemVelocity()");
     if (getStage(s) < Stage::Velocity) {
+        Profiler::Scope scope(m_realizeTimingCounters[Stage::Velocity],
+                              "realize");
         realizeSubsystemVelocityImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -311,6 +344,8 @@ void Subsystem::Guts::realizeSubsystemDynamics(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Dynamics).prev(), 
         "Subsystem::Guts::realizeSubsystemDynamics()");
     if (getStage(s) < Stage::Dynamics) {
+        Profiler::Scope scope(m_realizeTimingCounters[Stage::Dynamics],
+                              "realize");
         realizeSubsystemDynamicsImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -328,6 +363,8 @@ void Subsystem::Guts::realizeSubsystemAcceleration(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Acceleration).prev(), 
         "Subsystem::Guts::realizeSubsystemAcceleration()");
     if (getStage(s) < Stage::Acceleration) {
+        Profiler::Scope scope(m_realizeTimingCounters[Stage::Acceleration],
+                              "realize");
         realizeSubsystemAccelerationImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -345,6 +382,8 @@ void Subsystem::Guts::realizeSubsystemReport(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Report).prev(), 
         "Subsystem::Guts::realizeSubsystemReport()");
     if (getStage(s) < Stage::Report) {
+        Profiler::Scope scope(m_realizeTimingCounters[Stage::Report],
+                              "realize");
         realizeSubsystemReportImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -112,10 +112,23 @@ System& System::setUseUniformBackground(bool useUniformBackground)
 bool System::getUseUniformBackground() const
 {   return getSystemGuts().getRep().getUseUniformBackground(); }
 
-void System::resetAllCountersToZero() {updSystemGuts().updRep().resetAllCounters();}
+void System::resetAllCountersToZero() {
+    updSystemGuts().updRep().resetAllCounters();
+    resetTimingCounters();
+}
 int System::getNumRealizationsOfThisStage(Stage g) const {return getSystemGuts().getRep().nRealizationsOfStage[g];}
 int System::getNumRealizeCalls() const {return getSystemGuts().getRep().nRealizeCalls;}
 
+void System::getTimingCounters(Array_<TimingCounter>& counters) const {
+    counters.clear();
+    for (SubsystemIndex sx(0); sx < getNumSubsystems(); ++sx)
+        getSubsystem(sx).getSubsystemGuts().appendTimingCounters(counters);
+}
+void System::resetTimingCounters() {
+    for (SubsystemIndex sx(0); sx < getNumSubsystems(); ++sx)
+        getSubsystem(sx).getSubsystemGuts().resetTimingCounters();
+}
+
 int System::getNumPrescribeQCalls() const {return getSystemGuts().getRep().nPrescribeQCalls;}
 int System::getNumPrescribeUCalls() const {return getSystemGuts().getRep().nPrescribeUCalls;}
 
@@ -55,6 +55,7 @@
 #include "SimTKcommon/internal/ParallelWorkQueue.h"
 #include "SimTKcommon/internal/Pathname.h"
 #include "SimTKcommon/internal/Plugin.h"
+#include "SimTKcommon/internal/Profiling.h"
 #include "SimTKcommon/internal/Timing.h"
 #include "SimTKcommon/internal/Xml.h"
 #include "SimTKcommon/Testing.h"
@@ -62,12 +62,10 @@ class Parallel2DExecutorImpl;
  * separated by a happens-before edge.)  This allows the task to modify data that is indexed by i and j
  * without needing to worry about concurrent modifications.
  * 
- * The threads are created in the Parallel2DExecutor's constructor and remain active until it is deleted.
- * This means that creating a Parallel2DExecutor is a somewhat expensive operation, but it may then be
- * used repeatedly for executing various calculations.  By default, the number of threads is chosen
- * to be equal to the number of available processor cores.  You can optionally specify a different number
- * of threads to create.  For example, using more threads than processors can sometimes lead to better
- * processor utilitization.
+ * The calculations are executed by a ParallelExecutor, and so run on the pool of worker threads shared by
+ * all ParallelExecutor, Parallel2DExecutor and ParallelWorkQueue objects in the process.  By default, the
+ * number of threads used is chosen to be equal to the number of available processor cores.  You can
+ * optionally specify a different maximum number of threads.
  */
 
 class SimTK_SimTKCOMMON_EXPORT Parallel2DExecutor : public PIMPLHandle<Parallel2DExecutor, Parallel2DExecutorImpl> {
@@ -78,7 +76,7 @@ public:
      * Construct a Parallel2DExecutor.
      * 
      * @param gridSize   the size of the range over which i and j should vary
-     * @param numThreads the number of threads to create.  By default, this is set equal to the number
+     * @param numThreads the maximum number of threads to use.  By default, this is set equal to the number
      * of processors.
      */
     explicit Parallel2DExecutor(int gridSize, int numThreads = ParallelExecutor::getNumProcessors());
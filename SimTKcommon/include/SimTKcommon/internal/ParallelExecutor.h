@@ -25,6 +25,8 @@
  * -------------------------------------------------------------------------- */
 
 #include "PrivateImplementation.h"
+#include "Array.h"
+#include <algorithm>
 #include <thread>
 #include <iostream>
  
@@ -56,16 +58,24 @@ class ParallelExecutorImpl;
  * any assumptions about what order they will occur in or which ones will
  * happen at the same time.
  * 
- * The threads are created in the ParallelExecutor's constructor and remain
- * active until it is deleted. This means that creating a ParallelExecutor is a
- * somewhat expensive operation, but it may then be used repeatedly for
- * executing various calculations.  By default, the number of threads is chosen
- * to be equal to the number of available processor cores.  You can optionally
- * specify a different number of threads to create.  For example, using more
- * threads than processors can sometimes lead to better processor
- * utilitization.  Alternatively, if the Task will only be executed four times,
- * you might specify min(4, ParallelExecutor::getNumProcessors()) to avoid
- * creating extra threads that will never have any work to do.
+ * The threads do not belong to any particular ParallelExecutor. All
+ * ParallelExecutor, Parallel2DExecutor and ParallelWorkQueue objects in the
+ * process share a single pool of worker threads, created when they are first
+ * needed, so creating a ParallelExecutor is cheap. By default the pool has
+ * one thread per available processor core; use setNumSharedThreads() to
+ * change that and setSharedThreadAffinity() to pin the threads to particular
+ * processors. The number of threads given to a ParallelExecutor is the
+ * maximum number of pool threads it will use at once. For example, if the
+ * Task will only be executed four times, you might specify 4.
+ *
+ * The pool runs one Task at a time. If execute() is called from inside a
+ * running Task (for example a parallel force evaluation inside a parallel
+ * optimizer), or while another thread's Task occupies the pool, the Task is
+ * executed serially on the calling thread instead, since the processors are
+ * already busy. Otherwise the calling thread works on the Task alongside the
+ * pool threads, so a Task still gets done if they are all busy with
+ * ParallelWorkQueue tasks. A ParallelExecutor keeps no state from one call to
+ * the next, so several threads may call execute() on the same one at once.
  *
  * You may find it useful to use "thread local" variables with your parallel
  * tasks. A thread local variable may have a different value on each thread
@@ -76,7 +86,7 @@ class ParallelExecutorImpl;
  * a variable `thread_local T` means that a separate workspace object of type
  * `T` will automatically be created for each thread. That object will have
  * "thread scope" meaning it will be destructed only on thread termination.
- * 
+ *
  * One way to use thread local variables is to declare a static thread local
  * member variable in your ParallelExecutor::Task:
  * @code{.cpp}
@@ -92,11 +102,40 @@ class ParallelExecutorImpl;
  * // Initialize the static variable out-of-line.
  * thread_local double workspace = 0;
  * @endcode
+ *
+ * By default the indices are dealt out to the threads in a fixed round-robin
+ * order (StaticScheduling), which is cheapest when every invocation costs
+ * about the same. When the cost of the invocations varies a lot (for example
+ * a few expensive contact forces mixed with many cheap springs) you should
+ * select WorkStealingScheduling instead. Each thread then starts with a
+ * contiguous block of indices which it consumes in chunks that shrink as the
+ * block is used up, and a thread that runs out of work steals half of the
+ * remaining block of another thread. That keeps all the threads busy until
+ * the whole batch is done.
+ *
+ * When every invocation adds its contribution into a common result, such as
+ * a force vector, use parallelReduce() instead of execute(). It gives each
+ * contiguous block of indices its own partial result and then combines the
+ * partial results pairwise in a tree, so no thread has to wait for a lock
+ * and no serial pass over all the partial results is needed.
  */
 
 class SimTK_SimTKCOMMON_EXPORT ParallelExecutor : public PIMPLHandle<ParallelExecutor, ParallelExecutorImpl> {
 public:
     class Task;
+    /**
+     * The policy used to distribute the indices of a Task among the threads.
+     */
+    enum Scheduling {
+        /// Thread i executes indices i, i+n, i+2n, ... where n is the number
+        /// of threads. This has the lowest overhead for uniform workloads.
+        StaticScheduling,
+        /// Each thread owns a contiguous range of indices which it consumes
+        /// in adaptively sized chunks; idle threads steal half of the
+        /// remaining range of a busy thread. Use this for heterogeneous
+        /// workloads.
+        WorkStealingScheduling
+    };
     /**
      * Construct a ParallelExecutor. By default, constructs a ParallelExecutor
      * with the number of threads equal to the number of total processors on the
@@ -110,14 +149,30 @@ public:
      * is allowed to launch
      */
     explicit ParallelExecutor(int maxThreads);
+    /**
+     * Construct a ParallelExecutor that uses a particular scheduling policy.
+     *
+     * @param maxThreads the maximum number of threads that the ParallelExecutor
+     * is allowed to launch
+     * @param scheduling the policy used to distribute task indices among the
+     * threads
+     */
+    ParallelExecutor(int maxThreads, Scheduling scheduling);
     /**
      * Clone the ParallelExecutor.
      *
-     * @return Returns a ParallelExecutor with the same number of maxThreads
+     * @return Returns a ParallelExecutor with the same number of maxThreads,
+     * scheduling policy and spin time
      */
     ParallelExecutor* clone() const;
     /**
      * Execute a parallel task.
+     *
+     * If the Task throws an exception from any of its methods, the worker
+     * threads stop executing it as soon as they are done with the index they
+     * are working on, so some of the indices may never be executed. Every
+     * thread still calls finish(). Once all the threads are done, the first
+     * exception that was thrown is rethrown here, on the calling thread.
      * 
      * @param task    the Task to execute
      * @param times   the number of times the Task should be executed
@@ -130,8 +185,8 @@ public:
      */
     static int getNumProcessors();
     /**
-     * Determine whether the thread invoking this method is a worker thread
-     * created by ParallelExecutor.
+     * Determine whether the thread invoking this method is one of the shared
+     * pool's worker threads, or is working on a Task it passed to execute().
      */
     static bool isWorkerThread();
     /**
@@ -139,6 +194,160 @@ public:
      * currently allowed to use.
      */
     int getMaxThreads() const;
+    /**
+     * Set the number of threads in the pool shared by all ParallelExecutor,
+     * Parallel2DExecutor and ParallelWorkQueue objects. This waits for any
+     * running or queued work to complete. It may not be called from a worker
+     * thread.
+     */
+    static void setNumSharedThreads(int numThreads);
+    /**
+     * Get the number of threads in the shared pool. The default is
+     * getNumProcessors().
+     */
+    static int getNumSharedThreads();
+    /**
+     * Pin the shared pool threads to processors: thread i is restricted to
+     * processor processors[i % processors.size()], where processors are
+     * numbered as by the operating system. Pass an empty array to leave
+     * threads created from now on unpinned. This is supported on Linux and
+     * Windows; elsewhere it does nothing.
+     *
+     * @return false if pinning is not supported or the operating system
+     * refused the request
+     */
+    static bool setSharedThreadAffinity(const Array_<int>& processors);
+    /**
+     * Get the processors to which the shared pool threads are pinned, as
+     * last set with setSharedThreadAffinity().
+     */
+    static Array_<int> getSharedThreadAffinity();
+    /**
+     * Set how long the threads busy-wait before blocking. After finishing a
+     * Task, each worker thread spins for up to this long waiting for the
+     * next one before it goes to sleep on a condition variable, and
+     * execute() spins for up to this long waiting for the workers to finish.
+     * Spinning avoids the operating system wake-up latency, which otherwise
+     * dominates for Tasks that take only tens of microseconds, at the cost of
+     * keeping the processors busy while there is nothing to do. The default
+     * is zero, meaning threads block immediately.
+     *
+     * @param spinTime   the spin time in nanoseconds; must not be negative
+     */
+    void setSpinTimeInNs(long long spinTime);
+    /**
+     * Get how long the threads busy-wait before blocking, in nanoseconds.
+     */
+    long long getSpinTimeInNs() const;
+    /**
+     * Set the policy used to distribute task indices among the threads for
+     * subsequent calls to execute(). This may not be called while a Task is
+     * being executed.
+     */
+    void setScheduling(Scheduling scheduling);
+    /**
+     * Get the policy currently used to distribute task indices among the
+     * threads.
+     */
+    Scheduling getScheduling() const;
+    /**
+     * The number of blocks into which parallelReduce() divides the indices
+     * when asked for a deterministic result.
+     */
+    static const int NumDeterministicReductionBlocks = 16;
+    /**
+     * The number of chunks per thread that calcNumChunks() and
+     * calcTargetChunkCost() aim for when a sequence of items is divided up
+     * for execute(), so that work stealing has something to balance.
+     */
+    static const int ChunksPerThread = 4;
+    /**
+     * Get how many chunks of about equal size to divide \a numItems items of
+     * similar cost into for \a numThreads threads: ChunksPerThread per
+     * thread, but none with fewer than \a minItemsPerChunk items. A result
+     * less than 2 means the items aren't worth splitting up.
+     */
+    static int calcNumChunks(int numItems, int numThreads, 
+                             int minItemsPerChunk);
+    /**
+     * Get the cost each chunk should reach when items whose costs add up to
+     * \a totalCost are divided up for \a numThreads threads with
+     * appendChunksByCost(): enough for ChunksPerThread chunks per thread, but
+     * never less than \a minChunkCost.
+     */
+    static Real calcTargetChunkCost(Real totalCost, int numThreads, 
+                                    Real minChunkCost);
+    /**
+     * Divide the items from chunkStarts.back() up to \a end into contiguous
+     * chunks, each ending at the first item that brings its cost to
+     * \a targetCost, and append the start of each chunk after the first
+     * followed by \a end to \a chunkStarts. Chunk c then holds the items
+     * chunkStarts[c] to chunkStarts[c+1]-1, and only the last chunk may cost
+     * less than \a targetCost. If \a chunkStarts had a single element there
+     * is always at least one chunk, even with no items.
+     *
+     * @param end          one past the last item to divide up
+     * @param costOf       a callable with signature `Real (int)` giving the
+     *                     estimated cost of an item
+     * @param targetCost   the cost at which a chunk is closed
+     * @param chunkStarts  holds the first item as its last element on entry
+     */
+    template <class CostOf>
+    static void appendChunksByCost(int end, const CostOf& costOf, 
+                                   Real targetCost, Array_<int>& chunkStarts);
+    /**
+     * Perform a parallel reduction. The indices 0 to times-1 are divided
+     * into contiguous blocks. Each block gets a partial result that starts
+     * out as a copy of \a identity, and `body(index, partial)` is called for
+     * each index of the block in increasing order. The blocks are executed
+     * in parallel, after which the partial results are combined pairwise,
+     * also in parallel: `combine(partials[i], partials[i+s])` is called for
+     * s = 1, 2, 4, ... and every i that is a multiple of 2s. On return
+     * partials[0] holds the result for all the indices.
+     *
+     * \a body may be called simultaneously on different threads, so it must
+     * only write to the partial result it is given. \a combine is called
+     * simultaneously for different pairs of partial results.
+     *
+     * The order in which contributions are added together depends only on
+     * the number of blocks, and not on which thread executes what, so
+     * repeating a reduction gives bitwise identical results. By default
+     * there are a couple of blocks for each of getMaxThreads() threads (just
+     * one block when getMaxThreads() is 1, so that the serial case has no
+     * overhead), which means the result can change in the last bits if the
+     * number of threads is changed. Set \a deterministic to use
+     * NumDeterministicReductionBlocks blocks instead, so that the result
+     * is also independent of the number of threads, at the cost of
+     * initializing and combining more partial results.
+     *
+     * Exceptions thrown by \a body or \a combine are propagated as for
+     * execute().
+     *
+     * @param times      the number of indices
+     * @param identity   the value each partial result is reset to before
+     *                   its block is executed
+     * @param body       a callable with signature `void (int, T&)`
+     * @param combine    a callable with signature `void (T&, const T&)`
+     * @param partials   storage for the partial results; it is resized as
+     *                   needed and may be reused across calls to avoid
+     *                   allocating memory each time
+     * @param deterministic  whether to make the result independent of the
+     *                   number of threads
+     */
+    template <class T, class Body, class Combine>
+    void parallelReduce(int times, const T& identity, const Body& body,
+                        const Combine& combine, Array_<T>& partials,
+                        bool deterministic = false);
+    /**
+     * Perform a parallel reduction as above and return the result. This
+     * allocates the partial results on every call.
+     */
+    template <class T, class Body, class Combine>
+    T parallelReduce(int times, const T& identity, const Body& body,
+                     const Combine& combine, bool deterministic = false);
+private:
+    template <class T, class Body> class ReduceTask;
+    template <class T, class Combine> class CombineTask;
 };
 
 /**
@@ -169,6 +378,92 @@ public:
     }
 };
 
+// Executes the blocks of a parallelReduce(); index i is block i.
+template <class T, class Body>
+class ParallelExecutor::ReduceTask : public ParallelExecutor::Task {
+public:
+    ReduceTask(int times, int numBlocks, const T& identity, const Body& body,
+               Array_<T>& partials)
+    :   times(times), numBlocks(numBlocks), identity(identity), body(body),
+        partials(partials) {
+    }
+    void execute(int block) override {
+        T& partial = partials[block];
+        partial = identity;
+        const int begin = (int)((long long)times*block/numBlocks);
+        const int end = (int)((long long)times*(block+1)/numBlocks);
+        for (int i = begin; i < end; ++i)
+            body(i, partial);
+    }
+private:
+    const int times, numBlocks;
+    const T& identity;
+    const Body& body;
+    Array_<T>& partials;
+};
+
+// Executes one level of the combining tree of a parallelReduce(); index i
+// combines partial result 2*i*stride with partial result (2*i+1)*stride.
+template <class T, class Combine>
+class ParallelExecutor::CombineTask : public ParallelExecutor::Task {
+public:
+    CombineTask(int stride, const Combine& combine, Array_<T>& partials)
+    :   stride(stride), combine(combine), partials(partials) {
+    }
+    void execute(int pair) override {
+        const int first = 2*stride*pair;
+        combine(partials[first], partials[first+stride]);
+    }
+private:
+    const int stride;
+    const Combine& combine;
+    Array_<T>& partials;
+};
+
+template <class T, class Body, class Combine>
+void ParallelExecutor::parallelReduce(int times, const T& identity,
+                                      const Body& body, const Combine& combine,
+                                      Array_<T>& partials, bool deterministic) {
+    SimTK_APIARGCHECK1_ALWAYS(times >= 0, "ParallelExecutor", "parallelReduce",
+        "The number of indices must not be negative, but was %d.", times);
+    const int maxThreads = getMaxThreads();
+    const int maxBlocks = deterministic ? NumDeterministicReductionBlocks
+                        : maxThreads == 1 ? 1 : 2*maxThreads;
+    const int numBlocks = std::max(1, std::min(times, maxBlocks));
+    partials.resize(numBlocks, identity);
+    ReduceTask<T, Body> reduceTask(times, numBlocks, identity, body, partials);
+    execute(reduceTask, numBlocks);
+    for (int stride = 1; stride < numBlocks; stride *= 2) {
+        CombineTask<T, Combine> combineTask(stride, combine, partials);
+        execute(combineTask, (numBlocks+stride-1)/(2*stride));
+    }
+}
+
+template <class CostOf>
+void ParallelExecutor::appendChunksByCost(int end, const CostOf& costOf,
+                                          Real targetCost,
+                                          Array_<int>& chunkStarts) {
+    Real chunkCost = 0;
+    for (int i = chunkStarts.back(); i < end; ++i) {
+        chunkCost += costOf(i);
+        if (chunkCost >= targetCost) {
+            chunkStarts.push_back(i+1);
+            chunkCost = 0;
+        }
+    }
+    if (chunkStarts.size() == 1 || chunkStarts.back() != end)
+        chunkStarts.push_back(end);
+}
+
+template <class T, class Body, class Combine>
+T ParallelExecutor::parallelReduce(int times, const T& identity,
+                                   const Body& body, const Combine& combine,
+                                   bool deterministic) {
+    Array_<T> partials;
+    parallelReduce(times, identity, body, combine, partials, deterministic);
+    return partials[0];
+}
+
 } // namespace SimTK
 
 #endif // SimTK_SimTKCOMMON_PARALLEL_EXECUTOR_H_
@@ -53,14 +53,10 @@ class ParallelWorkQueueImpl;
  * done in parallel on multiple threads, so you cannot make any assumptions about what order they will occur in
  * or which ones will happen at the same time.
  *
- * The threads are created in the ParallelWorkQueue's constructor and remain active until it is deleted.
- * This means that creating a ParallelWorkQueue is a somewhat expensive operation, but it may then be
- * used repeatedly for executing various calculations.  By default, the number of threads is chosen
- * to be equal to the number of available processor cores.  You can optionally specify a different number
- * of threads to create.  For example, using more threads than processors can sometimes lead to better
- * processor utilitization.  Alternatively, if only four Tasks will be executed, you might specify
- * min(4, ParallelExecutor::getNumProcessors()) to avoid creating extra threads that will never
- * have any work to do.
+ * The Tasks are executed by the pool of worker threads shared by all ParallelExecutor, Parallel2DExecutor
+ * and ParallelWorkQueue objects in the process (see ParallelExecutor::setNumSharedThreads()), so creating a
+ * ParallelWorkQueue is cheap.  The number of threads given to the constructor is the maximum number of Tasks
+ * from this queue that will execute at the same time.
  */
 
 class SimTK_SimTKCOMMON_EXPORT ParallelWorkQueue : public PIMPLHandle<ParallelWorkQueue, ParallelWorkQueueImpl> {
@@ -70,7 +66,7 @@ public:
      * Construct a ParallelWorkQueue.
      *
      * @param queueSize  the maximum number of Tasks that can be in the queue waiting to start executing at any time
-     * @param numThreads the number of threads to create.  By default, this is set equal to the number of processors.
+     * @param numThreads the maximum number of Tasks to execute at once.  By default, this is set equal to the number of processors.
      */
     explicit ParallelWorkQueue(int queueSize, int numThreads = ParallelExecutor::getNumProcessors());
     /**
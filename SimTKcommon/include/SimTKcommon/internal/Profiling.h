@@ -0,0 +1,173 @@
+#ifndef SimTK_SimTKCOMMON_PROFILING_H_
+#define SimTK_SimTKCOMMON_PROFILING_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+Declares TimingCounter and Profiler, which together provide opt-in timing of
+the pieces of a simulation: each Subsystem's realization of each Stage, each
+Force in a GeneralForceSubsystem, and each Integrator step. **/
+
+#include "SimTKcommon/internal/common.h"
+#include "SimTKcommon/internal/Timing.h"
+
+#include <atomic>
+#include <iosfwd>
+#include <string>
+
+namespace SimTK {
+
+/** Accumulates the number of times some piece of code was executed, and the
+elapsed (real) and CPU time it took. Counters are normally updated by a
+Profiler::Scope and may be updated from several threads at once. Copying a
+counter copies a snapshot of its current values. **/
+class SimTK_SimTKCOMMON_EXPORT TimingCounter {
+public:
+    TimingCounter() : numCalls(0), realTimeInNs(0), cpuTimeInNs(0) {}
+    explicit TimingCounter(const std::string& name)
+    :   name(name), numCalls(0), realTimeInNs(0), cpuTimeInNs(0) {}
+    TimingCounter(const TimingCounter& src)
+    :   name(src.name), numCalls(src.getNumCalls()),
+        realTimeInNs(src.getRealTimeInNs()),
+        cpuTimeInNs(src.getCpuTimeInNs()) {}
+    TimingCounter& operator=(const TimingCounter& src) {
+        name = src.name;
+        numCalls = src.getNumCalls();
+        realTimeInNs = src.getRealTimeInNs();
+        cpuTimeInNs = src.getCpuTimeInNs();
+        return *this;
+    }
+
+    /** The name identifies the counter in reports and in trace files. **/
+    const std::string& getName() const {return name;}
+    void setName(const std::string& newName) {name = newName;}
+
+    long long getNumCalls() const
+    {   return numCalls.load(std::memory_order_relaxed); }
+    /** Total elapsed time, in nanoseconds. **/
+    long long getRealTimeInNs() const
+    {   return realTimeInNs.load(std::memory_order_relaxed); }
+    /** Total CPU time used by the timed threads, in nanoseconds. This has the
+    (typically coarse) resolution of threadCpuTime(). **/
+    long long getCpuTimeInNs() const
+    {   return cpuTimeInNs.load(std::memory_order_relaxed); }
+    /** Total elapsed time, in seconds. **/
+    double getRealTime() const {return nsToSec(getRealTimeInNs());}
+    /** Total CPU time, in seconds. **/
+    double getCpuTime() const {return nsToSec(getCpuTimeInNs());}
+
+    /** Record one more call that took the given amounts of time. **/
+    void add(long long realNs, long long cpuNs) {
+        numCalls.fetch_add(1, std::memory_order_relaxed);
+        realTimeInNs.fetch_add(realNs, std::memory_order_relaxed);
+        cpuTimeInNs.fetch_add(cpuNs, std::memory_order_relaxed);
+    }
+    /** Set the call count and times back to zero. The name is kept. **/
+    void reset() {
+        numCalls = 0;
+        realTimeInNs = 0;
+        cpuTimeInNs = 0;
+    }
+private:
+    std::string             name;
+    std::atomic<long long>  numCalls;
+    std::atomic<long long>  realTimeInNs;
+    std::atomic<long long>  cpuTimeInNs;
+};
+
+/** Global switches and output for the timing instrumentation built into
+Simbody. Profiling is off by default; while it is off every instrumented
+region costs a single test of a flag. Once it is turned on with
+setEnabled(true), each Subsystem times its realization of each Stage (see
+System::getTimingCounters()), GeneralForceSubsystem times each Force, and
+each Integrator times its steps.
+
+If tracing is also turned on, every timed region is additionally recorded as
+an event with its start time and thread, and the events can be written in the
+Chrome trace-event JSON format with writeChromeTrace(). The file can then be
+viewed in chrome://tracing or in Perfetto. Events accumulate until
+clearTrace() is called, so only trace a limited number of steps.
+
+You can instrument your own code the same way:
+@code
+    static TimingCounter counter("MyController::computeControls");
+    Profiler::Scope scope(counter, "user");
+@endcode **/
+class SimTK_SimTKCOMMON_EXPORT Profiler {
+public:
+    /** Determine whether timing is currently being collected. **/
+    static bool isEnabled() {return enabled.load(std::memory_order_relaxed);}
+    /** Turn timing collection on or off for all threads. **/
+    static void setEnabled(bool enable);
+
+    /** Determine whether timed regions are also being recorded as trace
+    events. Events are recorded only while profiling is enabled. **/
+    static bool isTracing() {return tracing.load(std::memory_order_relaxed);}
+    /** Turn recording of trace events on or off. Turning it on starts a new
+    trace; event times are measured from this moment. **/
+    static void setTracing(bool trace);
+    /** Discard all recorded trace events. **/
+    static void clearTrace();
+    /** Get the number of trace events recorded so far. **/
+    static int getNumTraceEvents();
+    /** Write the recorded trace events to a stream as a Chrome trace-event
+    JSON object. Times are in microseconds. **/
+    static void writeChromeTrace(std::ostream& out);
+
+    /** Times the region of code from its construction to its destruction
+    and adds the result to a TimingCounter. If profiling is disabled when the
+    %Scope is created it does nothing. The \a category is used only to group
+    trace events; it must be a string literal or otherwise outlive the trace.
+    **/
+    class SimTK_SimTKCOMMON_EXPORT Scope {
+    public:
+        Scope(TimingCounter& counter, const char* category)
+        :   counter(isEnabled() ? &counter : nullptr), category(category) {
+            if (this->counter)
+                start();
+        }
+        ~Scope() {
+            if (counter)
+                stop();
+        }
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        void start() {
+            startCpuTimeInNs = secToNs(threadCpuTime());
+            startRealTimeInNs = realTimeInNs();
+        }
+        void stop();
+
+        TimingCounter*  counter;
+        const char*     category;
+        long long       startRealTimeInNs, startCpuTimeInNs;
+    };
+private:
+    static std::atomic<bool> enabled, tracing;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_PROFILING_H_
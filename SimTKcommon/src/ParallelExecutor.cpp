@@ -33,136 +33,204 @@ using namespace std;
 
 namespace SimTK {
 
-static void threadBody(ThreadInfo& info);
-
-ParallelExecutorImpl::ParallelExecutorImpl() : finished(false) {
+ParallelExecutorImpl::ParallelExecutorImpl() :
+    scheduling(ParallelExecutor::StaticScheduling), spinTimeInNs(0) {
 
     //By default, we use the total number of processors available of the
     //computer (including hyperthreads)
     numMaxThreads = ParallelExecutor::getNumProcessors();
     if(numMaxThreads <= 0)
       numMaxThreads = 1;
+
+    // Make sure the pool outlives any executor with static storage duration.
+    ThreadPool::getInstance();
 }
-ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) : finished(false) {
+ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) :
+    scheduling(ParallelExecutor::StaticScheduling), spinTimeInNs(0) {
 
     // Set the maximum number of threads that we can use
     SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ParallelExecutorImpl",
                  "ParallelExecutorImpl", "Number of threads must be positive.");
     numMaxThreads = numThreads;
+    ThreadPool::getInstance();
+}
+ParallelExecutorImpl::ParallelExecutorImpl(int numThreads,
+    ParallelExecutor::Scheduling scheduling) :
+    scheduling(scheduling), spinTimeInNs(0) {
+
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ParallelExecutorImpl",
+                 "ParallelExecutorImpl", "Number of threads must be positive.");
+    numMaxThreads = numThreads;
+    ThreadPool::getInstance();
 }
 ParallelExecutorImpl::~ParallelExecutorImpl() {
-    
-    // Notify the threads that they should exit.
-    
-    std::unique_lock<std::mutex> lock(runMutex);
-    finished = true;
-    for (int i = 0; i < (int) threads.size(); ++i)
-        threadInfo[i].running = true;
-    runCondition.notify_all();
-    lock.unlock();
-    
-    // Wait until all the threads have finished.
-    
-    for (int i = 0; i < (int) threads.size(); ++i)
-        threads[i].join();
 }
 ParallelExecutorImpl* ParallelExecutorImpl::clone() const {
-    return new ParallelExecutorImpl(numMaxThreads);
-}
-void ParallelExecutorImpl::execute(ParallelExecutor::Task& task, int times) {
-  if (min(times, numMaxThreads) == 1) {
-      //(1) NON-PARALLEL CASE:
-      // Nothing is actually going to get done in parallel, so we might as well
-      // just execute the task directly and save the threading overhead.
-      task.initialize();
-      for (int i = 0; i < times; ++i)
-          task.execute(i);
-      task.finish();
-      return;
+    ParallelExecutorImpl* copy =
+        new ParallelExecutorImpl(numMaxThreads, scheduling);
+    copy->setSpinTimeInNs(getSpinTimeInNs());
+    return copy;
+}
+void ParallelExecutorImpl::execute(ParallelExecutor::Task& task, 
+                                   int times) const {
+    if (min(times, numMaxThreads) == 1) {
+        //(1) NON-PARALLEL CASE:
+        // Nothing is actually going to get done in parallel, so we might as
+        // well just execute the task directly and save the threading overhead.
+        executeSerially(task, times);
+        return;
+    }
+
+    ParallelExecutorJob job(task, times, scheduling);
+    if (!ThreadPool::getInstance().tryRun(job, numMaxThreads, spinTimeInNs)) {
+        //(2) NESTED CASE:
+        // We are already running on a pool thread (or the pool is busy with
+        // a Task submitted by another thread), so the processors are taken.
+        // Creating more threads would only oversubscribe them.
+        executeSerially(task, times);
+        return;
+    }
+    //(3) PARALLEL CASE: tryRun() executed the Task on the pool threads.
+    // If any of the invocations failed, pass the exception on to our caller.
+    job.rethrowIfFailed();
+}
+void ParallelExecutorImpl::executeSerially(ParallelExecutor::Task& task,
+                                           int times) {
+    // As in the parallel case, finish() is called even if execute() throws.
+    std::exception_ptr exception;
+    try {
+        task.initialize();
+        for (int i = 0; i < times; ++i)
+            task.execute(i);
     }
-    
-    //(2) PARALLEL CASE:
-    // We launch the maximum number of threads and save them for later use
-    if(threads.size() < (size_t)numMaxThreads)
-    {
-      // We do not support numMaxThreads changing for a given instance of
-      // ParallelExecutor.
-      assert(threads.size() == 0);
-      threadInfo.reserve(numMaxThreads);
-      threads.resize(numMaxThreads);
-      for (int i = 0; i < numMaxThreads; ++i) {
-          threadInfo.emplace_back(i, this);
-          threads[i] = std::thread(threadBody, std::ref(threadInfo[i]));
-      }
+    catch (...) {
+        exception = std::current_exception();
     }
-   
-    // Initialize fields to execute the new task.
-    std::unique_lock<std::mutex> lock(runMutex);
-    currentTask = &task;
-    currentTaskCount = times;
-    waitingThreadCount = 0;
-    for (int i = 0; i < (int)threadInfo.size(); ++i) {
-        threadInfo[i].running = true;
+    try {
+        task.finish();
     }
+    catch (...) {
+        if (!exception)
+            exception = std::current_exception();
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
 
-    // Wake up the worker threads and wait until they finish.
-    runCondition.notify_all();
-    waitCondition.wait(lock,
-        [&] { return waitingThreadCount == (int)threads.size(); });
-    lock.unlock();
-}
-void ParallelExecutorImpl::incrementWaitingThreads() {
-    std::lock_guard<std::mutex> lock(runMutex);
-    getCurrentTask().finish();
-    waitingThreadCount++;
-    if (waitingThreadCount == (int)threads.size()) {
-        waitCondition.notify_one();
+ParallelExecutorJob::ParallelExecutorJob(ParallelExecutor::Task& task,
+    int count, ParallelExecutor::Scheduling scheduling) :
+    task(task), count(count), scheduling(scheduling), numSlots(0),
+    workRanges(nullptr), cancelled(false) {
+}
+void ParallelExecutorJob::prepare(int slots) {
+    numSlots = slots;
+    if (scheduling == ParallelExecutor::WorkStealingScheduling) {
+        // A thread waits in tryRun() until its Job is done, so the ranges
+        // can be reused by that thread's next Job without reallocating.
+        static thread_local std::unique_ptr<WorkRange[]> ranges;
+        static thread_local int numRanges = 0;
+        if (numRanges < numSlots) {
+            ranges.reset(new WorkRange[numSlots]);
+            numRanges = numSlots;
+        }
+        workRanges = ranges.get();
+        // Give each thread a contiguous block of indices to start with.
+        for (int i = 0; i < numSlots; ++i) {
+            workRanges[i].begin = (int)((long long)count*i/numSlots);
+            workRanges[i].end = (int)((long long)count*(i+1)/numSlots);
+        }
     }
 }
+void ParallelExecutorJob::cancel(std::exception_ptr exception) {
+    std::lock_guard<std::mutex> lock(finishMutex);
+    if (!firstException)
+        firstException = exception;
+    cancelled.store(true, std::memory_order_relaxed);
+}
+void ParallelExecutorJob::rethrowIfFailed() {
+    if (firstException)
+        std::rethrow_exception(firstException);
+}
 
-thread_local bool ParallelExecutorImpl::isWorker(false);
+bool ParallelExecutorJob::takeChunk(int thread, int& first, int& last) {
+    WorkRange& range = workRanges[thread];
+    std::lock_guard<std::mutex> lock(range.lock);
+    const int remaining = range.end - range.begin;
+    if (remaining <= 0)
+        return false;
+
+    // Take big chunks while there is a lot left to do to keep the locking
+    // overhead low, but shrink them near the end so that the tail of the
+    // range can still be stolen by idle threads.
+    const int chunk = 1 + remaining/(2*numSlots);
+    first = range.begin;
+    last = first + chunk;
+    range.begin = last;
+    return true;
+}
+bool ParallelExecutorJob::stealWork(int thread) {
+    for (int i = 1; i < numSlots; ++i) {
+        WorkRange& victim = workRanges[(thread+i)%numSlots];
+        int first, last;
+        {
+            std::lock_guard<std::mutex> lock(victim.lock);
+            const int remaining = victim.end - victim.begin;
+            if (remaining <= 0)
+                continue;
+            last = victim.end;
+            victim.end -= (remaining+1)/2;
+            first = victim.end;
+        }
+        // Our own range is empty, but other thieves may be looking at it.
+        WorkRange& mine = workRanges[thread];
+        std::lock_guard<std::mutex> lock(mine.lock);
+        mine.begin = first;
+        mine.end = last;
+        return true;
+    }
+    return false;
+}
 
 /**
- * This function contains the code executed by the worker threads.
+ * This function contains the code executed by each of the pool threads
+ * working on the Task. If any of them fails, the others stop at the next
+ * index and the exception is rethrown to the caller of execute().
  */
 
-void threadBody(ThreadInfo& info) {
-    ParallelExecutorImpl::isWorker = true;
-    ParallelExecutorImpl& executor = *info.executor;
-    int threadCount = executor.getThreadCount();
-    while (!executor.isFinished()) {
-        
-        // Wait for a Task to come in.
-        
-        std::unique_lock<std::mutex> lock(executor.getMutex());
-        executor.getCondition().wait(lock, [&] { return info.running; });
-        lock.unlock();
-        if (!executor.isFinished()) {
-            
-            // Execute the task for all the indices belonging to this thread.
-            
-            int count = executor.getCurrentTaskCount();
-            ParallelExecutor::Task& task = executor.getCurrentTask();
-            task.initialize();
-            int index = info.index;
-                        
-            try {
-                while (index < count) {
-                    task.execute(index);
-                    index += threadCount;
+void ParallelExecutorJob::run(int slot) {
+    try {
+        task.initialize();
+        if (scheduling == ParallelExecutor::WorkStealingScheduling) {
+            int first, last;
+            while (!isCancelled()) {
+                if (!takeChunk(slot, first, last)) {
+                    if (!stealWork(slot))
+                        break; // every index has been claimed
+                    continue;
                 }
+                for (int index = first; index < last && !isCancelled();
+                     ++index)
+                    task.execute(index);
             }
-            catch (const std::exception& ex) {
-                std::cerr <<"The parallel task threw an unhandled exception:"<< std::endl;
-                std::cerr <<ex.what()<< std::endl;
-            }
-            catch (...) {
-                std::cerr <<"The parallel task threw an error."<< std::endl;
-            }
-            info.running = false;
-            executor.incrementWaitingThreads();
+        }
+        else {
+            for (int index = slot; index < count && !isCancelled();
+                 index += numSlots)
+                task.execute(index);
         }
     }
+    catch (...) {
+        cancel(std::current_exception());
+    }
+
+    std::lock_guard<std::mutex> lock(finishMutex);
+    try {
+        task.finish();
+    }
+    catch (...) {
+        if (!firstException)
+            firstException = std::current_exception();
+    }
 }
 
 ParallelExecutor::ParallelExecutor() : HandleBase(new ParallelExecutorImpl()) {
@@ -171,12 +239,19 @@ ParallelExecutor::ParallelExecutor() : HandleBase(new ParallelExecutorImpl()) {
 ParallelExecutor::ParallelExecutor(int numThreads) : HandleBase(new ParallelExecutorImpl(numThreads)) {
 }
 
+ParallelExecutor::ParallelExecutor(int numThreads, Scheduling scheduling)
+:   HandleBase(new ParallelExecutorImpl(numThreads, scheduling)) {
+}
+
 ParallelExecutor* ParallelExecutor::clone() const{
-    return new ParallelExecutor(getMaxThreads());
+    ParallelExecutor* copy =
+        new ParallelExecutor(getMaxThreads(), getScheduling());
+    copy->setSpinTimeInNs(getSpinTimeInNs());
+    return copy;
 }
 
 void ParallelExecutor::execute(Task& task, int times) {
-    updImpl().execute(task, times);
+    getImpl().execute(task, times);
 }
 
 #ifdef __APPLE__
@@ -230,10 +305,44 @@ int ParallelExecutor::getNumProcessors() {
 }
 
 bool ParallelExecutor::isWorkerThread() {
-    return ParallelExecutorImpl::isWorker;
+    return ThreadPool::isPoolThread();
+}
+void ParallelExecutor::setNumSharedThreads(int numThreads) {
+    ThreadPool::getInstance().setNumThreads(numThreads);
+}
+int ParallelExecutor::getNumSharedThreads() {
+    return ThreadPool::getInstance().getNumThreads();
+}
+int ParallelExecutor::calcNumChunks(int numItems, int numThreads,
+                                    int minItemsPerChunk) {
+    return std::min(numItems/minItemsPerChunk, ChunksPerThread*numThreads);
+}
+Real ParallelExecutor::calcTargetChunkCost(Real totalCost, int numThreads,
+                                           Real minChunkCost) {
+    return std::max(minChunkCost, totalCost/(ChunksPerThread*numThreads));
+}
+bool ParallelExecutor::setSharedThreadAffinity(const Array_<int>& processors) {
+    return ThreadPool::getInstance().setAffinity(processors);
+}
+Array_<int> ParallelExecutor::getSharedThreadAffinity() {
+    return ThreadPool::getInstance().getAffinity();
 }
 int ParallelExecutor::getMaxThreads() const{
     return getImpl().getMaxThreads();
 }
+void ParallelExecutor::setSpinTimeInNs(long long spinTime) {
+    SimTK_APIARGCHECK_ALWAYS(spinTime >= 0, "ParallelExecutor",
+                 "setSpinTimeInNs", "The spin time must not be negative.");
+    updImpl().setSpinTimeInNs(spinTime);
+}
+long long ParallelExecutor::getSpinTimeInNs() const {
+    return getImpl().getSpinTimeInNs();
+}
+void ParallelExecutor::setScheduling(Scheduling scheduling) {
+    updImpl().setScheduling(scheduling);
+}
+ParallelExecutor::Scheduling ParallelExecutor::getScheduling() const {
+    return getImpl().getScheduling();
+}
 
 } // namespace SimTK
@@ -26,73 +26,123 @@
 
 #include "SimTKcommon/internal/ParallelExecutor.h"
 #include "SimTKcommon/internal/Array.h"
+#include "ThreadPool.h"
 
+#include <atomic>
+#include <exception>
 #include <iostream>
-#include <thread>
+#include <memory>
 #include <mutex>
-#include <condition_variable>
 
 namespace SimTK {
 
-class ParallelExecutorImpl;
+/**
+ * The range of task indices [begin, end) that has not yet been claimed from a
+ * worker thread's queue under WorkStealingScheduling. The owning thread takes
+ * chunks from the front; other threads steal from the back.
+ */
+
+class WorkRange {
+public:
+    WorkRange() : begin(0), end(0) {
+    }
+    std::mutex lock;
+    int begin, end;
+};
 
 /**
- * This class stores per-thread information used while executing a task.
+ * One call to ParallelExecutor::execute() that runs on the shared ThreadPool,
+ * with every slot playing the role of one thread. It lives on the stack of the
+ * calling thread, so an executor can be used by several threads at once: a
+ * call that finds the pool busy runs its Task inline and never touches the
+ * state of the Job that is running.
  */
 
-class ThreadInfo {
+class ParallelExecutorJob : public ThreadPool::Job {
 public:
-    ThreadInfo(int index, ParallelExecutorImpl* executor) : index(index), executor(executor), running(false) {
+    ParallelExecutorJob(ParallelExecutor::Task& task, int count,
+                        ParallelExecutor::Scheduling scheduling);
+    /**
+     * Claim the next chunk of indices [first, last) from the queue belonging
+     * to the given thread. Returns false if that queue is empty.
+     */
+    bool takeChunk(int thread, int& first, int& last);
+    /**
+     * Move half of the remaining indices of some other thread's queue into the
+     * queue belonging to the given thread. Returns false if there was nothing
+     * left to steal, meaning that every index has been claimed.
+     */
+    bool stealWork(int thread);
+    /**
+     * Record an exception thrown by the Task and tell the worker threads to
+     * stop executing it. Only the first exception is kept; it is rethrown by
+     * rethrowIfFailed() once all the workers are done.
+     */
+    void cancel(std::exception_ptr exception);
+    bool isCancelled() const {
+        return cancelled.load(std::memory_order_relaxed);
     }
-    const int index;
-    ParallelExecutorImpl* const executor;
-    bool running;
+    /**
+     * Rethrow the first exception thrown by the Task, if there was one.
+     */
+    void rethrowIfFailed();
+
+    // ThreadPool::Job interface.
+    void prepare(int numSlots) override;
+    void run(int slot) override;
+private:
+    ParallelExecutor::Task& task;
+    const int count;
+    const ParallelExecutor::Scheduling scheduling;
+    // The number of pool threads working on the Task.
+    int numSlots;
+    // Owned by the calling thread, which waits for the Job to finish before
+    // it can submit another one; see prepare().
+    WorkRange* workRanges;
+    // Serializes the calls to Task::finish(), and guards firstException.
+    std::mutex finishMutex;
+    // Set when a worker fails so the others skip their remaining indices.
+    std::atomic<bool> cancelled;
+    // The first exception thrown by the Task.
+    std::exception_ptr firstException;
 };
 
 /**
- * This is the internal implementation class for ParallelExecutor.
+ * This is the internal implementation class for ParallelExecutor. It holds
+ * only the settings; the threads belong to the shared ThreadPool and the
+ * state of each call to execute() is kept in a ParallelExecutorJob.
  */
 
 class ParallelExecutorImpl : public PIMPLImplementation<ParallelExecutor, ParallelExecutorImpl> {
 public:
     ParallelExecutorImpl();
     ParallelExecutorImpl(int numThreads);
+    ParallelExecutorImpl(int numThreads, ParallelExecutor::Scheduling scheduling);
     ~ParallelExecutorImpl();
     ParallelExecutorImpl* clone() const;
-    void execute(ParallelExecutor::Task& task, int times);
-    int getThreadCount() {
-        return threads.size();
-    }
-    ParallelExecutor::Task& getCurrentTask() {
-        return *currentTask;
+    void execute(ParallelExecutor::Task& task, int times) const;
+    int getMaxThreads() const{
+      return numMaxThreads;
     }
-    int getCurrentTaskCount() {
-        return currentTaskCount;
+    ParallelExecutor::Scheduling getScheduling() const {
+        return scheduling;
     }
-    bool isFinished() {
-        return finished;
+    void setScheduling(ParallelExecutor::Scheduling newScheduling) {
+        scheduling = newScheduling;
     }
-    std::mutex& getMutex() {
-        return runMutex;
+    long long getSpinTimeInNs() const {
+        return spinTimeInNs;
     }
-    std::condition_variable& getCondition() {
-        return runCondition;
+    void setSpinTimeInNs(long long spinTime) {
+        spinTimeInNs = spinTime;
     }
-    int getMaxThreads() const{
-      return numMaxThreads;
-    }
-    void incrementWaitingThreads();
-    static thread_local bool isWorker;
 private:
-    bool finished;
-    std::mutex runMutex;
-    std::condition_variable runCondition, waitCondition;
-    Array_<std::thread> threads;
-    Array_<ThreadInfo> threadInfo;
-    ParallelExecutor::Task* currentTask;
-    int currentTaskCount;
-    int waitingThreadCount;
+    // Execute a Task on the calling thread.
+    static void executeSerially(ParallelExecutor::Task& task, int times);
+
     int numMaxThreads;
+    ParallelExecutor::Scheduling scheduling;
+    long long spinTimeInNs;
 };
 
 } // namespace SimTK
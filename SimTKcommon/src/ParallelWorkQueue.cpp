@@ -22,67 +22,31 @@
  * -------------------------------------------------------------------------- */
 
 #include "ParallelWorkQueueImpl.h"
+#include "ThreadPool.h"
 #include "SimTKcommon/internal/ParallelExecutor.h"
 #include <utility>
 #include <mutex>
 #include <condition_variable>
 
-using std::queue;
-
 namespace SimTK {
 
-static void threadBody(ParallelWorkQueueImpl& owner) {
-    queue<ParallelWorkQueue::Task*>& taskQueue = owner.updTaskQueue();
-    std::mutex& queueMutex = owner.getQueueMutex();
-    std::condition_variable& waitForTaskCondition = owner.getWaitCondition();
-    std::condition_variable& queueFullCondition = owner.getQueueFullCondition();
-    bool decrementTaskCount = false;
-    while (!owner.isFinished() || !taskQueue.empty()) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        if (decrementTaskCount) {
-            owner.markTaskCompleted();
-            decrementTaskCount = false;
-        }
-        waitForTaskCondition.wait(lock,
-                [&] { return !taskQueue.empty() || owner.isFinished(); });
-        ParallelWorkQueue::Task* task = NULL;
-        if (!taskQueue.empty()) {
-            task = taskQueue.front();
-            taskQueue.pop();
-        }
-        queueFullCondition.notify_one();
-        lock.unlock();
-        if (task != NULL) {
-            task->execute();
-            delete task;
-            decrementTaskCount = true;
-        }
-    }
-    if (decrementTaskCount) {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        owner.markTaskCompleted();
-    }
-}
-
-ParallelWorkQueueImpl::ParallelWorkQueueImpl(int queueSize, int numThreads) : queueSize(queueSize), pendingTasks(0), finished(false) {
-    threads.resize(numThreads);
-    for (int i = 0; i < numThreads; ++i)
-        threads[i] = std::thread(threadBody, std::ref(*this));
+ParallelWorkQueueImpl::ParallelWorkQueueImpl(int queueSize, int numThreads) : queueSize(queueSize), maxActiveThreads(numThreads),
+        pendingTasks(0), activeThreads(0), pool(ThreadPool::getInstance()) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ParallelWorkQueueImpl",
+                 "ParallelWorkQueueImpl", "Number of threads must be positive.");
 }
 
 ParallelWorkQueueImpl::~ParallelWorkQueueImpl() {
-    // Wait for the theads to finish.
+    // Wait for the queued Tasks to finish, and for the pool threads to stop
+    // referring to this object.
 
     std::unique_lock<std::mutex> lock(queueMutex);
-    finished = true;
-    waitForTaskCondition.notify_all();
-    lock.unlock();
-    for (int i = 0; i < (int) threads.size(); ++i)
-        threads[i].join();
+    queueFullCondition.wait(lock,
+            [this] { return pendingTasks == 0 && activeThreads == 0; });
 }
 
 ParallelWorkQueueImpl* ParallelWorkQueueImpl::clone() const {
-    return new ParallelWorkQueueImpl(queueSize, threads.size());
+    return new ParallelWorkQueueImpl(queueSize, maxActiveThreads);
 }
 
 void ParallelWorkQueueImpl::addTask(ParallelWorkQueue::Task* task) {
@@ -91,8 +55,11 @@ void ParallelWorkQueueImpl::addTask(ParallelWorkQueue::Task* task) {
             [this] { return (int)taskQueue.size() < queueSize; });
     taskQueue.push(task);
     ++pendingTasks;
-    waitForTaskCondition.notify_one();
-    lock.unlock();
+    if (activeThreads < maxActiveThreads) {
+        ++activeThreads;
+        lock.unlock();
+        pool.enqueue([this] { drain(); });
+    }
 }
 
 void ParallelWorkQueueImpl::flush() {
@@ -101,29 +68,20 @@ void ParallelWorkQueueImpl::flush() {
     lock.unlock();
 }
 
-queue<ParallelWorkQueue::Task*>& ParallelWorkQueueImpl::updTaskQueue() {
-    return taskQueue;
-}
-
-bool ParallelWorkQueueImpl::isFinished() const {
-    return finished;
-}
-
-std::mutex& ParallelWorkQueueImpl::getQueueMutex() {
-    return queueMutex;
-}
-
-std::condition_variable& ParallelWorkQueueImpl::getWaitCondition() {
-    return waitForTaskCondition;
-}
-
-std::condition_variable& ParallelWorkQueueImpl::getQueueFullCondition() {
-    return queueFullCondition;
-}
-
-void ParallelWorkQueueImpl::markTaskCompleted() {
-    --pendingTasks;
-    queueFullCondition.notify_one();
+void ParallelWorkQueueImpl::drain() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (!taskQueue.empty()) {
+        ParallelWorkQueue::Task* task = taskQueue.front();
+        taskQueue.pop();
+        queueFullCondition.notify_all();
+        lock.unlock();
+        task->execute();
+        delete task;
+        lock.lock();
+        --pendingTasks;
+    }
+    --activeThreads;
+    queueFullCondition.notify_all();
 }
 
 ParallelWorkQueue::ParallelWorkQueue(int queueSize, int numThreads) : HandleBase(new ParallelWorkQueueImpl(queueSize, numThreads)) {
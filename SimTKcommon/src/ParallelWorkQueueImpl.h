@@ -32,34 +32,34 @@
 
 namespace SimTK {
 
-class ParallelExecutor;
+class ThreadPool;
 
 /**
- * This is the internal implementation class for ParallelWorkQueue.
+ * This is the internal implementation class for ParallelWorkQueue. The Tasks
+ * are executed on the shared ThreadPool: whenever a Task is added and fewer
+ * than the allowed number of pool threads are working on this queue, a
+ * function that drains the queue is handed to the pool.
  */
 
 class ParallelWorkQueueImpl : public PIMPLImplementation<ParallelWorkQueue, ParallelWorkQueueImpl> {
 public:
-    class ExecutorTask;
     ParallelWorkQueueImpl(int queueSize, int numThreads);
     ~ParallelWorkQueueImpl();
     ParallelWorkQueueImpl* clone() const;
     void addTask(ParallelWorkQueue::Task* task);
     void flush();
-    std::queue<ParallelWorkQueue::Task*>& updTaskQueue();
-    bool isFinished() const;
-    std::mutex& getQueueMutex();
-    std::condition_variable& getWaitCondition();
-    std::condition_variable& getQueueFullCondition();
-    void markTaskCompleted();
 private:
+    // Executes Tasks from the queue on a pool thread until it is empty.
+    void drain();
+
     const int queueSize;
+    const int maxActiveThreads;
     int pendingTasks;
-    bool finished;
+    int activeThreads;
     std::queue<ParallelWorkQueue::Task*> taskQueue;
     std::mutex queueMutex;
-    std::condition_variable waitForTaskCondition, queueFullCondition;
-    SimTK::Array_<std::thread> threads;
+    std::condition_variable queueFullCondition;
+    ThreadPool& pool;
 };
 
 } // namespace SimTK
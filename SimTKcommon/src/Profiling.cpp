@@ -0,0 +1,146 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon/internal/Profiling.h"
+
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace SimTK {
+
+std::atomic<bool> Profiler::enabled(false);
+std::atomic<bool> Profiler::tracing(false);
+
+namespace {
+
+// One timed region, as recorded while tracing.
+struct TraceEvent {
+    std::string name;
+    const char* category;
+    long long   startInNs, durationInNs;
+    int         threadId;
+};
+
+// The recorded events. Access is serialized by the mutex; tracing is meant
+// for looking at a few steps in detail, not for production runs.
+struct Trace {
+    std::mutex              mutex;
+    std::vector<TraceEvent> events;
+    long long               startInNs = 0;
+};
+
+Trace& getTrace() {
+    static Trace trace;
+    return trace;
+}
+
+// Small consecutive thread ids are easier to read in trace viewers than
+// native ones.
+int getTraceThreadId() {
+    static std::atomic<int> nextId(1);
+    thread_local int id = nextId.fetch_add(1);
+    return id;
+}
+
+void writeJsonString(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; ++s) {
+        const unsigned char c = *s;
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        }
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+}
+
+void Profiler::setEnabled(bool enable) {
+    enabled = enable;
+}
+
+void Profiler::setTracing(bool trace) {
+    if (trace && !tracing.load()) {
+        Trace& t = getTrace();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        t.startInNs = realTimeInNs();
+    }
+    tracing = trace;
+}
+
+void Profiler::clearTrace() {
+    Trace& t = getTrace();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.events.clear();
+}
+
+int Profiler::getNumTraceEvents() {
+    Trace& t = getTrace();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return (int)t.events.size();
+}
+
+void Profiler::writeChromeTrace(std::ostream& out) {
+    Trace& t = getTrace();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    char times[64];
+    out << "{\"traceEvents\":[";
+    for (int i = 0; i < (int)t.events.size(); ++i) {
+        const TraceEvent& e = t.events[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(out, e.name.c_str());
+        out << ",\"cat\":";
+        writeJsonString(out, e.category);
+        std::snprintf(times, sizeof(times), "%.3f,\"dur\":%.3f",
+                      1e-3*(e.startInNs - t.startInNs), 1e-3*e.durationInNs);
+        out << ",\"ph\":\"X\",\"ts\":" << times
+            << ",\"pid\":1,\"tid\":" << e.threadId << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Profiler::Scope::stop() {
+    const long long duration = realTimeInNs() - startRealTimeInNs;
+    counter->add(duration, secToNs(threadCpuTime()) - startCpuTimeInNs);
+    if (isTracing()) {
+        TraceEvent event;
+        event.name = counter->getName();
+        event.category = category;
+        event.startInNs = startRealTimeInNs;
+        event.durationInNs = duration;
+        event.threadId = getTraceThreadId();
+        Trace& t = getTrace();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        t.events.push_back(std::move(event));
+    }
+}
+
+} // namespace SimTK
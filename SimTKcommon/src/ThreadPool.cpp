@@ -0,0 +1,287 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2008-26 Stanford University and the Authors.        *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "ThreadPool.h"
+#include "SimTKcommon/internal/ExceptionMacros.h"
+#include "SimTKcommon/internal/ParallelExecutor.h"
+#include "SimTKcommon/internal/Timing.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+   #include <windows.h>
+#elif __linux__
+   #include <pthread.h>
+   #include <sched.h>
+#endif
+
+namespace SimTK {
+
+thread_local bool ThreadPool::isWorker(false);
+
+ThreadPool& ThreadPool::getInstance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool() : started(false), stopping(false), jobState(0),
+    currentJob(nullptr), currentSlotCount(0), parkedThreadCount(0), callerIsParked(false), remainingSlotCount(0),
+    workerSpinTimeInNs(0), queuedCount(0) {
+
+    //By default, we use the total number of processors available of the
+    //computer (including hyperthreads)
+    numThreads = std::max(1, ParallelExecutor::getNumProcessors());
+}
+
+ThreadPool::~ThreadPool() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    stopThreads();
+}
+
+void ThreadPool::setNumThreads(int newNumThreads) {
+    SimTK_APIARGCHECK_ALWAYS(newNumThreads > 0, "ThreadPool", "setNumThreads",
+                             "Number of threads must be positive.");
+    SimTK_APIARGCHECK_ALWAYS(!isPoolThread(), "ThreadPool", "setNumThreads",
+                     "The number of threads can't be changed from a worker.");
+    std::lock_guard<std::mutex> jobLock(jobMutex);
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (newNumThreads == numThreads.load())
+        return;
+    stopThreads();
+    numThreads = newNumThreads; // the new threads are started on demand
+}
+
+bool ThreadPool::setAffinity(const Array_<int>& processors) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    affinity = processors;
+#if defined(_WIN32) || defined(__linux__)
+    bool success = true;
+    if (started.load() && !affinity.empty())
+        for (int i = 0; i < (int)threads.size(); ++i)
+            success = applyAffinity(i) && success;
+    return success;
+#else
+    return processors.empty();
+#endif
+}
+
+Array_<int> ThreadPool::getAffinity() const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return affinity;
+}
+
+bool ThreadPool::applyAffinity(int index) {
+    const int processor = affinity[index % affinity.size()];
+#if defined(_WIN32)
+    if (processor < 0 || processor >= 8*(int)sizeof(DWORD_PTR))
+        return false;
+    return SetThreadAffinityMask((HANDLE)threads[index].native_handle(),
+                                 (DWORD_PTR)1 << processor) != 0;
+#elif defined(__linux__)
+    if (processor < 0 || processor >= CPU_SETSIZE)
+        return false;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(processor, &cpus);
+    return pthread_setaffinity_np(threads[index].native_handle(),
+                                  sizeof(cpu_set_t), &cpus) == 0;
+#else
+    return false;
+#endif
+}
+
+void ThreadPool::ensureThreadsStarted() {
+    if (started.load())
+        return;
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (started.load())
+        return;
+    const int count = numThreads.load();
+    // A Job that is already running can be finished without the new threads.
+    const unsigned epoch = getEpoch(jobState.load());
+    threads.resize(count);
+    for (int i = 0; i < count; ++i) {
+        threads[i] = std::thread(&ThreadPool::threadBody, this, epoch);
+        if (!affinity.empty())
+            applyAffinity(i);
+    }
+    started.store(true);
+}
+
+// Caller must hold stateMutex, and jobMutex unless the pool is being
+// destroyed.
+void ThreadPool::stopThreads() {
+    if (!started.load())
+        return;
+    stopping.store(true);
+    {
+        std::lock_guard<std::mutex> lock(runMutex);
+        runCondition.notify_all();
+    }
+    for (int i = 0; i < (int)threads.size(); ++i)
+        threads[i].join();
+    threads.clear();
+    stopping.store(false);
+    started.store(false);
+}
+
+bool ThreadPool::tryRun(Job& job, int maxSlots, long long spinTimeInNs) {
+    if (isPoolThread())
+        return false;
+    std::unique_lock<std::mutex> jobLock(jobMutex, std::try_to_lock);
+    if (!jobLock.owns_lock())
+        return false;
+    ensureThreadsStarted();
+    const int numSlots = std::max(1, std::min(maxSlots, numThreads.load()));
+    job.prepare(numSlots);
+
+    // Post the Job for any worker to claim slots of. Spinning workers will
+    // pick it up immediately; we only need the mutex if some of them have
+    // given up and gone to sleep.
+    workerSpinTimeInNs.store(spinTimeInNs, std::memory_order_relaxed);
+    currentJob.store(&job);
+    currentSlotCount.store(numSlots);
+    remainingSlotCount.store(numSlots);
+    const unsigned epoch = getEpoch(jobState.load()) + 1;
+    jobState.store((unsigned long long)epoch << 32);
+    if (parkedThreadCount.load() > 0) {
+        std::lock_guard<std::mutex> lock(runMutex);
+        runCondition.notify_all();
+    }
+
+    // Workers may all be busy with queued functions, so run slots here too.
+    // Nested calls made from them must run inline, as they would on a worker.
+    isWorker = true;
+    runSlots(epoch);
+    isWorker = false;
+
+    // Wait until the workers finish, spinning first if allowed to.
+    if (spinTimeInNs > 0) {
+        const long long start = realTimeInNs();
+        for (int spins = 1; remainingSlotCount.load() != 0; ++spins)
+            if (spins % SpinsPerClockCheck == 0) {
+                if (realTimeInNs() - start > spinTimeInNs)
+                    break;
+                std::this_thread::yield(); // in case we're oversubscribed
+            }
+    }
+    if (remainingSlotCount.load() != 0) {
+        std::unique_lock<std::mutex> lock(runMutex);
+        callerIsParked.store(true);
+        waitCondition.wait(lock,
+            [&] { return remainingSlotCount.load() == 0; });
+        callerIsParked.store(false);
+    }
+    return true;
+}
+
+void ThreadPool::enqueue(std::function<void()> work) {
+    ensureThreadsStarted();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(work));
+        queuedCount.fetch_add(1);
+    }
+    if (parkedThreadCount.load() > 0) {
+        std::lock_guard<std::mutex> lock(runMutex);
+        runCondition.notify_one();
+    }
+}
+
+void ThreadPool::runSlots(unsigned epoch) {
+    unsigned long long state = jobState.load();
+    while (getEpoch(state) == epoch) {
+        // These belong to this epoch's Job unless it is already done, in
+        // which case there is no slot left and the exchange below fails.
+        Job* job = currentJob.load();
+        const int numSlots = currentSlotCount.load();
+        const int slot = (int)(state & 0xffffffffu);
+        if (slot >= numSlots)
+            return;
+        if (!jobState.compare_exchange_weak(state, state+1))
+            continue; // someone else claimed it; state has been reloaded
+        job->run(slot);
+        if (remainingSlotCount.fetch_sub(1) == 1 && callerIsParked.load()) {
+            std::lock_guard<std::mutex> lock(runMutex);
+            waitCondition.notify_one();
+        }
+        state = jobState.load();
+    }
+}
+
+void ThreadPool::waitForWork(unsigned lastEpoch) {
+    const long long spinTime =
+        workerSpinTimeInNs.load(std::memory_order_relaxed);
+    if (spinTime > 0) {
+        const long long start = realTimeInNs();
+        for (int spins = 1; !hasWork(lastEpoch); ++spins)
+            if (spins % SpinsPerClockCheck == 0) {
+                if (realTimeInNs() - start > spinTime)
+                    break;
+                std::this_thread::yield();
+            }
+    }
+    if (!hasWork(lastEpoch)) {
+        // Park. The count is incremented before the predicate is checked
+        // again (under the lock) so that whoever posts work cannot miss us.
+        std::unique_lock<std::mutex> lock(runMutex);
+        parkedThreadCount.fetch_add(1);
+        runCondition.wait(lock, [&] { return hasWork(lastEpoch); });
+        parkedThreadCount.fetch_sub(1);
+    }
+}
+
+/**
+ * This function contains the code executed by the worker threads.
+ */
+
+void ThreadPool::threadBody(unsigned lastEpoch) {
+    isWorker = true;
+    while (true) {
+        waitForWork(lastEpoch);
+
+        // A Job takes precedence over queued functions.
+        const unsigned epoch = getEpoch(jobState.load());
+        if (epoch != lastEpoch) {
+            lastEpoch = epoch;
+            runSlots(epoch);
+            continue;
+        }
+
+        std::function<void()> work;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (queue.empty()) {
+                if (stopping.load())
+                    break; // all the queued work is done
+                continue;
+            }
+            work = std::move(queue.front());
+            queue.pop_front();
+            queuedCount.fetch_sub(1);
+        }
+        work();
+    }
+}
+
+} // namespace SimTK
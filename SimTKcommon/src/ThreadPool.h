@@ -0,0 +1,178 @@
+#ifndef SimTK_SimTKCOMMON_THREAD_POOL_H_
+#define SimTK_SimTKCOMMON_THREAD_POOL_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2008-26 Stanford University and the Authors.        *
+ * Authors: Peter Eastman                                                     *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon/internal/common.h"
+#include "SimTKcommon/internal/Array.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace SimTK {
+
+/**
+ * The process-wide pool of worker threads on which ParallelExecutor,
+ * Parallel2DExecutor and ParallelWorkQueue all run, so that using several of
+ * them at once, or one inside another, does not oversubscribe the processors.
+ *
+ * The pool runs two kinds of work. A Job is split into a number of slots,
+ * which are claimed one at a time by whichever workers are free and by the
+ * thread that submitted it; that thread then waits until all of them are
+ * done. This is what ParallelExecutor uses. Since the submitting thread runs
+ * any slots the workers don't get to, a Job never waits for a worker that is
+ * busy with a queued function. Only one Job runs at a time, and a Job cannot
+ * be submitted from a pool thread; tryRun() returns false in those cases and
+ * the caller is expected to do the work inline. Queued functions, used by
+ * ParallelWorkQueue, are run one at a time by whichever worker is idle.
+ *
+ * The threads are created the first time they are needed.
+ */
+
+class ThreadPool {
+public:
+    /**
+     * A unit of work executed simultaneously by several worker threads.
+     */
+    class Job {
+    public:
+        virtual ~Job() {
+        }
+        /**
+         * Called once, on the submitting thread, before the workers start.
+         */
+        virtual void prepare(int numSlots) {
+        }
+        /**
+         * Called once for each slot in [0, numSlots), on a worker thread or
+         * on the submitting thread. One thread may run several slots in
+         * turn, so a slot must not wait for another one. This must not throw.
+         */
+        virtual void run(int slot) = 0;
+    };
+
+    /**
+     * Get the pool. It is created on first use and lives until the end of the
+     * program.
+     */
+    static ThreadPool& getInstance();
+    ~ThreadPool();
+
+    int getNumThreads() const {
+        return numThreads.load();
+    }
+    /**
+     * Change the number of worker threads. This waits for queued work to
+     * complete and joins the existing threads. It must not be called from a
+     * pool thread.
+     */
+    void setNumThreads(int numThreads);
+    /**
+     * Pin worker thread i to processor processors[i % processors.size()]. An
+     * empty list removes the pinning of new threads. Returns false if thread
+     * affinity is not supported on this platform or the operating system
+     * refused the request.
+     */
+    bool setAffinity(const Array_<int>& processors);
+    Array_<int> getAffinity() const;
+
+    /**
+     * Execute a Job in up to \a maxSlots slots and wait for it to complete.
+     * This thread runs slots too, counting as a pool thread while it does.
+     * After running out of slots each worker busy-waits for new work for up
+     * to \a spinTimeInNs before blocking, and so does this thread while
+     * waiting for the workers. Returns false, without calling the Job, if
+     * this is a pool thread or another Job is already running.
+     */
+    bool tryRun(Job& job, int maxSlots, long long spinTimeInNs);
+    /**
+     * Queue a function to be called on some idle worker thread. The function
+     * must not throw.
+     */
+    void enqueue(std::function<void()> work);
+
+    /**
+     * Determine whether the calling thread belongs to the pool, or is running
+     * slots of a Job it submitted.
+     */
+    static bool isPoolThread() {
+        return isWorker;
+    }
+private:
+    // How many iterations of a spin loop to run between clock reads.
+    static const int SpinsPerClockCheck = 64;
+
+    ThreadPool();
+    void ensureThreadsStarted();
+    void stopThreads();
+    void threadBody(unsigned lastEpoch);
+    void waitForWork(unsigned lastEpoch);
+    bool hasWork(unsigned lastEpoch) const {
+        return getEpoch(jobState.load()) != lastEpoch
+               || queuedCount.load() > 0 || stopping.load();
+    }
+    // Claim and run slots of the Job posted with the given epoch until none
+    // are left.
+    void runSlots(unsigned epoch);
+    bool applyAffinity(int index);
+
+    static unsigned getEpoch(unsigned long long state) {
+        return (unsigned)(state >> 32);
+    }
+
+    static thread_local bool isWorker;
+
+    std::atomic<int> numThreads;
+    Array_<int> affinity;
+    // Held while a Job is running, and while the threads are being stopped.
+    std::mutex jobMutex;
+    // Guards creation and destruction of the threads, and the affinity.
+    mutable std::mutex stateMutex;
+    std::atomic<bool> started, stopping;
+    Array_<std::thread> threads;
+    // The epoch of the most recent Job in the high 32 bits, and the next slot
+    // of it to be claimed in the low 32 bits. Keeping them together means a
+    // worker can't claim a slot of a Job that has been replaced by another.
+    std::atomic<unsigned long long> jobState;
+    std::atomic<Job*> currentJob;
+    std::atomic<int> currentSlotCount;
+    // Workers park on runCondition; the submitting thread on waitCondition.
+    std::mutex runMutex;
+    std::condition_variable runCondition, waitCondition;
+    std::atomic<int> parkedThreadCount;
+    std::atomic<bool> callerIsParked;
+    std::atomic<int> remainingSlotCount;
+    std::atomic<long long> workerSpinTimeInNs;
+    std::mutex queueMutex;
+    std::deque<std::function<void()> > queue;
+    std::atomic<int> queuedCount;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_THREAD_POOL_H_
@@ -23,7 +23,13 @@
 
 #include "SimTKcommon.h"
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
 
 #define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
 
@@ -93,6 +99,421 @@ void testSingleThreadedExecution() {
         ASSERT(flags[j] == (j < numFlags-10 ? 1 : 0));
 }
 
+// Each index takes a time proportional to its value squared, so a static
+// distribution would leave most of the threads idle.
+class UnbalancedTask : public ParallelExecutor::Task {
+public:
+    UnbalancedTask(Array_<int>& flags, Array_<double>& results)
+    :   flags(flags), results(results) {}
+    void execute(int index) override {
+        flags[index]++;
+        double sum = 0;
+        for (int i = 0; i < index*index; ++i)
+            sum += std::sqrt((double)i);
+        results[index] = sum;
+    }
+private:
+    Array_<int>& flags;
+    Array_<double>& results;
+};
+
+void testWorkStealingExecution() {
+    ParallelExecutor executor(4, ParallelExecutor::WorkStealingScheduling);
+    SimTK_TEST(executor.getScheduling() 
+               == ParallelExecutor::WorkStealingScheduling);
+    for (int numIndices : {1, 2, 3, 7, 100, 300}) {
+        Array_<int> flags(numIndices, 0);
+        Array_<double> results(numIndices, -1.);
+        UnbalancedTask task(flags, results);
+        executor.execute(task, numIndices);
+        for (int j = 0; j < numIndices; ++j) {
+            ASSERT(flags[j] == 1);
+            ASSERT(results[j] >= 0);
+        }
+    }
+
+    // The counting task must also work after switching the policy.
+    const int numFlags = 100;
+    Array_<int> flags(numFlags);
+    isParallel = true;
+    ParallelExecutor staticExecutor(3);
+    SimTK_TEST(staticExecutor.getScheduling() 
+               == ParallelExecutor::StaticScheduling);
+    staticExecutor.setScheduling(ParallelExecutor::WorkStealingScheduling);
+    std::unique_ptr<ParallelExecutor> copy(staticExecutor.clone());
+    SimTK_TEST(copy->getScheduling() 
+               == ParallelExecutor::WorkStealingScheduling);
+    for (int i = 0; i < 20; ++i) {
+        int count = 0;
+        SetFlagTask task(flags, count);
+        for (int j = 0; j < numFlags; ++j)
+            flags[j] = 0;
+        staticExecutor.execute(task, numFlags-10);
+        ASSERT(count == numFlags-10);
+        for (int j = 0; j < numFlags; ++j)
+            ASSERT(flags[j] == (j < numFlags-10 ? 1 : 0));
+    }
+}
+
+// Run many tiny tasks back to back with and without spinning, so that both
+// the spin and the park paths of the dispatch and of the barrier are taken.
+void testSpinningExecution() {
+    const int numFlags = 16;
+    Array_<int> flags(numFlags);
+    isParallel = true;
+    for (long long spinTime : {0LL, 1000LL, 100000LL}) {
+        ParallelExecutor executor(4);
+        executor.setSpinTimeInNs(spinTime);
+        SimTK_TEST(executor.getSpinTimeInNs() == spinTime);
+        std::unique_ptr<ParallelExecutor> copy(executor.clone());
+        SimTK_TEST(copy->getSpinTimeInNs() == spinTime);
+        for (int i = 0; i < 200; ++i) {
+            int count = 0;
+            SetFlagTask task(flags, count);
+            for (int j = 0; j < numFlags; ++j)
+                flags[j] = 0;
+            executor.execute(task, numFlags);
+            ASSERT(count == numFlags);
+            for (int j = 0; j < numFlags; ++j)
+                ASSERT(flags[j] == 1);
+            if (i % 50 == 0) // give the workers time to park
+                sleepInSec(0.005);
+        }
+    }
+    SimTK_TEST_MUST_THROW(ParallelExecutor(2).setSpinTimeInNs(-1));
+}
+
+class ThrowingTask : public ParallelExecutor::Task {
+public:
+    ThrowingTask(int badIndex, std::atomic<int>& numExecuted,
+                 std::atomic<int>& numFinished)
+    :   badIndex(badIndex), numExecuted(numExecuted),
+        numFinished(numFinished) {}
+    void execute(int index) override {
+        if (index == badIndex)
+            throw std::runtime_error("bad index");
+        ++numExecuted;
+    }
+    void finish() override {
+        ++numFinished;
+    }
+private:
+    int badIndex;
+    std::atomic<int>& numExecuted;
+    std::atomic<int>& numFinished;
+};
+
+void testExceptionPropagation() {
+    const int numIndices = 1000;
+    for (int numThreads : {1, 4}) {
+        for (ParallelExecutor::Scheduling scheduling :
+                {ParallelExecutor::StaticScheduling,
+                 ParallelExecutor::WorkStealingScheduling}) {
+            ParallelExecutor executor(numThreads, scheduling);
+            for (int badIndex : {0, 17, numIndices-1}) {
+                std::atomic<int> numExecuted(0), numFinished(0);
+                ThrowingTask task(badIndex, numExecuted, numFinished);
+                bool caught = false;
+                try {
+                    executor.execute(task, numIndices);
+                } catch (const std::runtime_error& e) {
+                    caught = true;
+                    SimTK_TEST(std::string(e.what()) == "bad index");
+                }
+                SimTK_TEST(caught);
+                SimTK_TEST(numExecuted < numIndices);
+                // Each of the pool threads used calls finish().
+                SimTK_TEST(numFinished == std::min(numThreads,
+                           ParallelExecutor::getNumSharedThreads()));
+            }
+
+            // The executor must still be usable afterwards.
+            std::atomic<int> numExecuted(0), numFinished(0);
+            ThrowingTask task(-1, numExecuted, numFinished);
+            executor.execute(task, numIndices);
+            SimTK_TEST(numExecuted == numIndices);
+        }
+    }
+}
+
+// Runs an inner parallel Task from each index of an outer one.
+class NestedTask : public ParallelExecutor::Task {
+public:
+    NestedTask(ParallelExecutor& inner, Array_<int>& flags, int innerCount)
+    :   inner(inner), flags(flags), innerCount(innerCount) {}
+    void execute(int index) override {
+        int count = 0;
+        Array_<int> innerFlags(innerCount, 0);
+        isParallel = ParallelExecutor::isWorkerThread();
+        SetFlagTask task(innerFlags, count);
+        inner.execute(task, innerCount);
+        ASSERT(count == innerCount);
+        flags[index] = count;
+    }
+private:
+    ParallelExecutor& inner;
+    Array_<int>& flags;
+    int innerCount;
+};
+
+void testSharedThreadPool() {
+    const int defaultThreads = ParallelExecutor::getNumSharedThreads();
+    SimTK_TEST(defaultThreads 
+               == std::max(1, ParallelExecutor::getNumProcessors()));
+
+    // A Task started from inside another one runs inline on the calling
+    // thread rather than waiting for the pool.
+    ParallelExecutor outer(4), inner(4);
+    Array_<int> flags(50, 0);
+    NestedTask nested(inner, flags, 20);
+    outer.execute(nested, 50);
+    for (int i = 0; i < 50; ++i)
+        ASSERT(flags[i] == 20);
+
+    // Resizing the pool while executors exist.
+    ParallelExecutor::setNumSharedThreads(3);
+    SimTK_TEST(ParallelExecutor::getNumSharedThreads() == 3);
+    isParallel = true;
+    int count = 0;
+    Array_<int> moreFlags(100, 0);
+    SetFlagTask task(moreFlags, count);
+    outer.execute(task, 100);
+    SimTK_TEST(count == 100);
+    SimTK_TEST_MUST_THROW(ParallelExecutor::setNumSharedThreads(0));
+
+    // Pinning every thread to the first processor should be allowed wherever
+    // affinity is supported at all.
+    Array_<int> processors(1, 0);
+    const bool pinned = ParallelExecutor::setSharedThreadAffinity(processors);
+    if (pinned)
+        SimTK_TEST(ParallelExecutor::getSharedThreadAffinity() == processors);
+    count = 0;
+    outer.execute(task, 100);
+    SimTK_TEST(count == 100);
+    ParallelExecutor::setSharedThreadAffinity(Array_<int>());
+    ParallelExecutor::setNumSharedThreads(defaultThreads);
+}
+
+// Occupies a pool thread until released, or for ten seconds at most.
+class BusyWorkTask : public ParallelWorkQueue::Task {
+public:
+    BusyWorkTask(std::atomic<int>& numStarted, std::atomic<int>& numFinished,
+                 std::atomic<bool>& release)
+    :   numStarted(numStarted), numFinished(numFinished), release(release) {
+    }
+    void execute() override {
+        ++numStarted;
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!release && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++numFinished;
+    }
+private:
+    std::atomic<int>& numStarted;
+    std::atomic<int>& numFinished;
+    std::atomic<bool>& release;
+};
+
+// A Task must not wait for pool threads that are busy with queued work; the
+// calling thread runs it instead.
+void testExecuteWhileQueueIsBusy() {
+    const int defaultThreads = ParallelExecutor::getNumSharedThreads();
+    ParallelExecutor::setNumSharedThreads(2);
+    std::atomic<int> numStarted(0), numFinished(0);
+    std::atomic<bool> release(false);
+    int count = 0;
+    int numFinishedBeforeExecuteReturned;
+    {
+        ParallelWorkQueue queue(10, 2);
+        for (int i = 0; i < 2; ++i)
+            queue.addTask(new BusyWorkTask(numStarted, numFinished, release));
+        while (numStarted < 2)
+            std::this_thread::yield();
+
+        isParallel = true;
+        Array_<int> flags(100, 0);
+        SetFlagTask task(flags, count);
+        ParallelExecutor executor(2);
+        executor.execute(task, 100);
+        numFinishedBeforeExecuteReturned = numFinished;
+        release = true;
+        for (int i = 0; i < 100; ++i)
+            ASSERT(flags[i] == 1);
+    }
+    SimTK_TEST(count == 100);
+    SimTK_TEST(numFinishedBeforeExecuteReturned == 0);
+    ParallelExecutor::setNumSharedThreads(defaultThreads);
+}
+
+// Several threads sharing one executor. Each call either gets the pool or
+// runs inline, and each caller sees only its own Task's work and exceptions.
+void testConcurrentCallers() {
+    const int numCallers = 4, numIndices = 1000, numRepeats = 50;
+    for (ParallelExecutor::Scheduling scheduling :
+            {ParallelExecutor::StaticScheduling,
+             ParallelExecutor::WorkStealingScheduling}) {
+        ParallelExecutor executor(4, scheduling);
+        std::atomic<int> numFailures(0);
+        Array_<std::thread> callers;
+        for (int c = 0; c < numCallers; ++c)
+            callers.push_back(std::thread([&, c] {
+                for (int r = 0; r < numRepeats; ++r) {
+                    // Caller 0 fails on every other call.
+                    const int badIndex = (c == 0 && r % 2) ? 17 : -1;
+                    std::atomic<int> numExecuted(0), numFinished(0);
+                    ThrowingTask task(badIndex, numExecuted, numFinished);
+                    bool caught = false;
+                    try {
+                        executor.execute(task, numIndices);
+                    } catch (const std::runtime_error&) {
+                        caught = true;
+                    }
+                    if (caught != (badIndex >= 0)
+                        || (!caught && numExecuted != numIndices)
+                        || numFinished < 1)
+                        ++numFailures;
+                }
+            }));
+        for (std::thread& caller : callers)
+            caller.join();
+        SimTK_TEST(numFailures == 0);
+    }
+}
+
+// Adds the harmonic series term for each index.
+class AddTerm {
+public:
+    void operator()(int index, double& sum) const {
+        sum += 1.0/(index+1);
+    }
+};
+
+class AddDoubles {
+public:
+    void operator()(double& sum, const double& other) const {
+        sum += other;
+    }
+};
+
+// Applies a force to one of a few bodies for each index.
+class AddBodyForce {
+public:
+    void operator()(int index, Vector_<SpatialVec>& forces) const {
+        forces[index % forces.size()] +=
+            SpatialVec(Vec3(index, 1, 0), Vec3(0, 0, 1.0/(index+1)));
+    }
+};
+
+class AddForces {
+public:
+    void operator()(Vector_<SpatialVec>& forces,
+                    const Vector_<SpatialVec>& other) const {
+        forces += other;
+    }
+};
+
+class ThrowAtIndex {
+public:
+    explicit ThrowAtIndex(int badIndex) : badIndex(badIndex) {}
+    void operator()(int index, double& sum) const {
+        if (index == badIndex)
+            throw std::runtime_error("bad index");
+        sum += index;
+    }
+private:
+    int badIndex;
+};
+
+void testParallelReduce() {
+    const int numIndices = 10000;
+    double serialSum = 0;
+    for (int i = 0; i < numIndices; ++i)
+        serialSum += 1.0/(i+1);
+
+    // A deterministic reduction gives bitwise the same answer no matter how
+    // many threads are used or how they are scheduled.
+    ParallelExecutor reference(1);
+    const double deterministicSum = reference.parallelReduce(numIndices, 0.,
+        AddTerm(), AddDoubles(), true);
+    SimTK_TEST_EQ(deterministicSum, serialSum);
+    for (int numThreads : {1, 2, 3, 8}) {
+        for (ParallelExecutor::Scheduling scheduling :
+                {ParallelExecutor::StaticScheduling,
+                 ParallelExecutor::WorkStealingScheduling}) {
+            ParallelExecutor executor(numThreads, scheduling);
+            SimTK_TEST(executor.parallelReduce(numIndices, 0., AddTerm(),
+                       AddDoubles(), true) == deterministicSum);
+
+            // Otherwise the result may depend on the number of threads, but
+            // repeating the reduction still gives the same answer.
+            const double sum = executor.parallelReduce(numIndices, 0.,
+                AddTerm(), AddDoubles());
+            SimTK_TEST_EQ(sum, serialSum);
+            for (int i = 0; i < 10; ++i)
+                SimTK_TEST(executor.parallelReduce(numIndices, 0.,
+                           AddTerm(), AddDoubles()) == sum);
+        }
+    }
+    SimTK_TEST(reference.parallelReduce(numIndices, 0., AddTerm(),
+               AddDoubles()) == serialSum);
+
+    // Reduce force vectors, reusing the partial results.
+    const int numBodies = 7;
+    Vector_<SpatialVec> zero(numBodies, SpatialVec(Vec3(0), Vec3(0)));
+    for (int count : {0, 1, 5, 1000}) {
+        Vector_<SpatialVec> expected(zero);
+        AddBodyForce addForce;
+        for (int i = 0; i < count; ++i)
+            addForce(i, expected);
+        ParallelExecutor executor(4, ParallelExecutor::WorkStealingScheduling);
+        Array_<Vector_<SpatialVec> > partials;
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            executor.parallelReduce(count, zero, addForce, AddForces(),
+                                    partials);
+            SimTK_TEST(partials.size() >= 1);
+            SimTK_TEST_EQ(partials[0], expected);
+        }
+    }
+
+    // Exceptions are propagated.
+    ParallelExecutor executor(4);
+    SimTK_TEST_MUST_THROW_EXC(executor.parallelReduce(1000, 0.,
+        ThrowAtIndex(500), AddDoubles()), std::runtime_error);
+    SimTK_TEST(executor.parallelReduce(1000, 0., ThrowAtIndex(-1),
+               AddDoubles()) == 999*1000/2);
+    SimTK_TEST_MUST_THROW(executor.parallelReduce(-1, 0., AddTerm(),
+                          AddDoubles()));
+}
+
+// Items are divided into contiguous chunks that each close at the first item
+// reaching the target cost.
+void testChunking() {
+    SimTK_TEST(ParallelExecutor::calcNumChunks(100, 2, 8) == 8);
+    SimTK_TEST(ParallelExecutor::calcNumChunks(100, 4, 8) == 12);
+    SimTK_TEST(ParallelExecutor::calcNumChunks(7, 4, 8) == 0);
+    SimTK_TEST(ParallelExecutor::calcTargetChunkCost(1000, 2, 50) == 125);
+    SimTK_TEST(ParallelExecutor::calcTargetChunkCost(100, 2, 50) == 50);
+
+    const Real costs[] = {1, 1, 5, 1, 1, 1, 3, 1};
+    auto costOf = [&](int i) {return costs[i];};
+    Array_<int> starts(1, 0);
+    ParallelExecutor::appendChunksByCost(8, costOf, 3, starts);
+    SimTK_TEST(starts == Array_<int>({0, 3, 6, 7, 8}));
+
+    // Items before the last start are left alone.
+    starts = Array_<int>({0, 2});
+    ParallelExecutor::appendChunksByCost(4, costOf, 3, starts);
+    SimTK_TEST(starts == Array_<int>({0, 2, 3, 4}));
+    ParallelExecutor::appendChunksByCost(4, costOf, 3, starts);
+    SimTK_TEST(starts == Array_<int>({0, 2, 3, 4}));
+
+    // There is always at least one chunk.
+    starts = Array_<int>(1, 0);
+    ParallelExecutor::appendChunksByCost(0, costOf, 3, starts);
+    SimTK_TEST(starts == Array_<int>({0, 0}));
+}
+
 void testResizeThreads() {
     for(int x = 1; x < 100; ++x)
     {
@@ -104,6 +525,14 @@ int main() {
     SimTK_START_TEST("TestParallelExecutor");
         SimTK_SUBTEST(testParallelExecution);
         SimTK_SUBTEST(testSingleThreadedExecution);
+        SimTK_SUBTEST(testWorkStealingExecution);
+        SimTK_SUBTEST(testSpinningExecution);
+        SimTK_SUBTEST(testExceptionPropagation);
+        SimTK_SUBTEST(testSharedThreadPool);
+        SimTK_SUBTEST(testExecuteWhileQueueIsBusy);
+        SimTK_SUBTEST(testConcurrentCallers);
+        SimTK_SUBTEST(testParallelReduce);
+        SimTK_SUBTEST(testChunking);
         SimTK_SUBTEST(testResizeThreads);
     SimTK_END_TEST();
     return 0;
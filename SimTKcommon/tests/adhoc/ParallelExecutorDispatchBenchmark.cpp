@@ -0,0 +1,110 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program measures how long a ParallelExecutor takes to run a Task as a
+function of the total amount of work in the Task, for serial execution and
+for parallel execution with blocking and with spinning worker threads. Use it
+to decide, on a particular machine, below which task size it is faster to run
+serially. Usage:
+
+    ParallelExecutorDispatchBenchmark [numThreads [spinTimeInUs]]
+*/
+
+#include "SimTKcommon.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+// Spins for a given number of iterations of a cheap floating point loop.
+// The result is stored so that the loop can't be optimized away.
+class BusyTask : public ParallelExecutor::Task {
+public:
+    BusyTask(int itersPerIndex, int numIndices)
+    :   itersPerIndex(itersPerIndex), results(numIndices, 0.) {}
+    void execute(int index) override {
+        double x = index;
+        for (int i = 0; i < itersPerIndex; ++i)
+            x = x*0.999999 + 1e-6;
+        results[index] = x;
+    }
+private:
+    int             itersPerIndex;
+    Array_<double>  results;
+};
+
+// Returns the average wall clock time of one execute() call in microseconds.
+static double timeExecute(ParallelExecutor& executor, BusyTask& task,
+                          int numIndices, int repeats) {
+    executor.execute(task, numIndices); // warm up; creates the threads
+    const long long start = realTimeInNs();
+    for (int i = 0; i < repeats; ++i)
+        executor.execute(task, numIndices);
+    return 1e-3*(realTimeInNs() - start)/repeats;
+}
+
+int main(int argc, char** argv) {
+    const int numThreads = argc > 1 ? std::atoi(argv[1])
+                                    : ParallelExecutor::getNumProcessors();
+    const double spinTimeInUs = argc > 2 ? std::atof(argv[2]) : 50.;
+    const int numIndices = 4*std::max(numThreads, 1);
+
+    // Calibrate the number of loop iterations per microsecond.
+    const int calibrationIters = 10000000;
+    BusyTask calibration(calibrationIters, 1);
+    const long long start = realTimeInNs();
+    calibration.execute(0);
+    const double itersPerUs =
+        calibrationIters/(1e-3*(realTimeInNs() - start));
+
+    std::printf("# threads=%d indices=%d spin=%gus (%.0f iters/us)\n",
+                numThreads, numIndices, spinTimeInUs, itersPerUs);
+    std::printf("%10s %12s %12s %12s %8s\n",
+                "work(us)", "serial(us)", "blocking(us)", "spinning(us)",
+                "best");
+
+    ParallelExecutor serial(1);
+    ParallelExecutor blocking(numThreads);
+    ParallelExecutor spinning(numThreads);
+    spinning.setSpinTimeInNs(secToNs(1e-6*spinTimeInUs));
+
+    const double workInUs[] = {0, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+    for (double work : workInUs) {
+        const int itersPerIndex = (int)(work*itersPerUs/numIndices);
+        BusyTask task(itersPerIndex, numIndices);
+        const int repeats = std::max(20, (int)(20000/(work+5)));
+        const double tSerial = timeExecute(serial, task, numIndices, repeats);
+        const double tBlocking =
+            timeExecute(blocking, task, numIndices, repeats);
+        const double tSpinning =
+            timeExecute(spinning, task, numIndices, repeats);
+        const char* best = "serial";
+        if (tBlocking < tSerial && tBlocking < tSpinning) best = "blocking";
+        else if (tSpinning < tSerial) best = "spinning";
+        std::printf("%10g %12.2f %12.2f %12.2f %8s\n",
+                    work, tSerial, tBlocking, tSpinning, best);
+    }
+    return 0;
+}
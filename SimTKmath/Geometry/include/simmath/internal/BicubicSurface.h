@@ -251,6 +251,30 @@ public:
     version. **/
     Real calcValue(const Vec2& XY) const;
 
+    /** Calculate the value of the surface at each of a set of XY coordinates.
+    The results are the same as calling calcValue() for each point in turn,
+    but the points are evaluated patch by patch rather than in the given
+    order so that the patch information in the hint is reused as much as
+    possible. This is useful when many bodies query the same surface, such
+    as wheels or feet on a terrain.
+    @param[in]      XY 
+        The (X,Y) points at which F(X,Y) is to be evaluated.
+    @param[out]     values
+        The interpolated values, in the same order as \a XY. This must
+        already be the same size as \a XY.
+    @param[in,out]  hint 
+        Information saved from an earlier invocation of calcValue(), 
+        calcUnitNormal(), or calcDerivative() that is used to reduce 
+        execution time. On return it holds the last patch visited. **/
+    void calcValues(const ArrayViewConst_<Vec2>& XY, ArrayView_<Real> values,
+                    PatchHint& hint) const;
+
+    /** This is a convenient version of calcValues() that does not provide
+    for a PatchHint. Since the points are sorted by patch, only the first
+    point on each patch is slow. **/
+    void calcValues(const ArrayViewConst_<Vec2>& XY, 
+                    ArrayView_<Real> values) const;
+
     /** Calculate the outward unit normal to the surface at a particular XY 
     coordinate.     
     @param[in]      XY 
@@ -366,8 +390,9 @@ public:
     int getNumAccessesNearbyPatch() const;
     /** Reset all statistics to zero. Note that statistics are mutable so you
     do not have to have write access to the surface. Any user of this surface
-    can reset statistics and we make no attempt to handle simultaneous access
-    by multiple threads in any careful manner. **/
+    can reset statistics. The counters are safe to update from several
+    threads at once, but a reset while other threads are accessing the
+    surface leaves the counts in no particular relation to each other. **/
     void resetStatistics() const;
     /**@}**/
 
@@ -64,6 +64,7 @@ class BrokenContactImpl;
 class CircularPointContactImpl;
 class EllipticalPointContactImpl;
 class BrickHalfSpaceContactImpl;
+class ManifoldContactImpl;
 class TriangleMeshContactImpl;
 
 class PointContactImpl; // deprecated
@@ -469,6 +470,71 @@ private:
 
 
 
+//==============================================================================
+//                              MANIFOLD CONTACT
+//==============================================================================
+/** This subclass of Contact represents a contact between two surfaces that
+touch over an area rather than at a point, such as the faces of two bricks,
+by a contact manifold: a set of contact points that share a single common
+normal z, each with its own penetration depth d. As for the point contacts,
+each point is given by an origin located such that the undeformed surface1
+point is at O+(d/2)z and the surface2 point is at O-(d/2)z. There is at least
+one point; an edge-edge contact has just one. **/
+class SimTK_SIMMATH_EXPORT ManifoldContact : public Contact {
+public:
+    /** Create a ManifoldContact object.
+    @param surf1        the index of the first surface involved in the contact
+    @param surf2        the index of the second surface involved in the contact
+    @param X_S1S2       the surface-to-surface relative transform
+    @param normal_S1    the common normal, pointing from surface1 to surface2,
+                        expressed in S1
+    @param origins_S1   the origin of each contact point, in S1
+    @param depths       the penetration depth (>0) or separation (<0) at each
+                        contact point; must be the same size as origins_S1
+    **/
+    ManifoldContact(ContactSurfaceIndex     surf1,
+                    ContactSurfaceIndex     surf2,
+                    const Transform&        X_S1S2,
+                    const UnitVec3&         normal_S1,
+                    const Array_<Vec3>&     origins_S1,
+                    const Array_<Real>&     depths);
+
+    /** Get the common normal, pointing outward from surface1 towards
+    surface2. This is a unit vector expressed in S1. **/
+    const UnitVec3& getNormal() const;
+    /** Get the number of contact points. **/
+    int getNumPoints() const;
+    /** Get the origin of contact point \a i, measured and expressed in S1. **/
+    const Vec3& getOrigin(int i) const;
+    /** Get the penetration depth (>0) or separation distance (<0) at contact
+    point \a i. **/
+    Real getDepth(int i) const;
+
+    /** Determine whether a Contact object is a ManifoldContact. **/
+    static bool isInstance(const Contact& contact);
+    /** Recast a manifold contact given as a generic Contact object to a
+    const reference to a concrete ManifoldContact object. **/
+    static const ManifoldContact& getAs(const Contact& contact)
+    {   assert(isInstance(contact));
+        return static_cast<const ManifoldContact&>(contact); }
+    /** Recast a manifold contact given as a generic Contact object to a
+    writable reference to a concrete ManifoldContact object. **/
+    static ManifoldContact& updAs(Contact& contact)
+    {   assert(isInstance(contact));
+        return static_cast<ManifoldContact&>(contact); }
+
+    /** Obtain the unique small-integer id for the ManifoldContact class. **/
+    static ContactTypeId classTypeId();
+
+private:
+    const ManifoldContactImpl& getImpl() const
+    {   assert(isInstance(*this));
+        return reinterpret_cast<const ManifoldContactImpl&>
+                    (Contact::getImpl()); }
+};
+
+
+
 //==============================================================================
 //                           TRIANGLE MESH CONTACT
 //==============================================================================
@@ -502,6 +568,12 @@ public:
     inside surface1. If surface2 is not a TriangleMesh, this will return an 
     empty set. **/
     const std::set<int>& getSurface2Faces() const;
+    /** Get the same faces as getSurface1Faces(), but as a sorted array that
+    can be indexed directly and walked without chasing pointers. **/
+    const Array_<int>& getSurface1FaceIndices() const;
+    /** Get the same faces as getSurface2Faces(), but as a sorted array that
+    can be indexed directly and walked without chasing pointers. **/
+    const Array_<int>& getSurface2FaceIndices() const;
 
     /** Determine whether a Contact object is a TriangleMeshContact. **/
     static bool isInstance(const Contact& contact);
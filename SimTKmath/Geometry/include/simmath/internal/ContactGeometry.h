@@ -147,6 +147,23 @@ may return any of them.
 specified point. **/
 Vec3 findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const;
 
+/** Find the nearest point on the surface of this object to each of a batch
+of points. The results are the same as calling findNearestPoint() for each 
+point in turn, but the cost of dispatching each query is paid once for the 
+whole batch, and some geometry types can use each query to speed up the next
+when neighboring points are presented together, such as the spring locations 
+of one contact patch. The outputs are views of storage owned by the caller, 
+each of which must have at least as many elements as \a positions. Different
+threads may query disjoint parts of a batch concurrently.
+@param[in]  positions       The points in question.
+@param[out] nearestPoints   The nearest point on the surface to each point.
+@param[out] inside          Whether each point is inside this object.
+@param[out] normals         The surface normal at each returned point. **/
+void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                       ArrayView_<Vec3>             nearestPoints, 
+                       ArrayView_<bool>             inside,
+                       ArrayView_<UnitVec3>         normals) const;
+
 /** Given a query point Q, find the nearest point P on the surface of this 
 object, looking only down the local gradient. Thus we cannot guarantee that P
 is the globally nearest point; if you need that use the findNearestPoint()
@@ -1278,6 +1295,46 @@ the specified point, this may return any of them.
 specified point. **/
 Vec3 findNearestPointToFace(const Vec3& position, int face, Vec2& uv) const;
 
+/** Build a signed distance field for this mesh, to make 
+findNearestPoint(position, inside, normal) and findNearestPoints() much faster
+for points near the surface. This is worthwhile for a rigid mesh that is 
+queried many times, as by ElasticFoundationForce. The field samples the 
+exact nearest point, signed distance and surface normal on a grid of cubic 
+cells, keeping only the cells within \a bandWidth of the surface. A 
+query point in one of those cells is answered by trilinear interpolation in 
+constant time, without visiting the Oriented Bounding Box Tree; all other 
+points, and the findNearestPoint() signature that returns a face, still use 
+the exact search. 
+
+While it is built, each cell's interpolated nearest point is compared with 
+the exact one at 15 test points spread through the cell, and a cell for 
+which those differ by more than half of \a maxError, or disagree about 
+whether the point is inside, is left out so that points in it get the exact
+answer. Cells straddling sharp edges and the medial axis are typically the 
+ones dropped. The margin makes errors larger than \a maxError rare, but 
+since only test points are checked it is not a strict guarantee. The normals
+returned for points in the field are interpolated, so they vary smoothly 
+rather than jumping between faces.
+
+The field is kept with this mesh, and shared by copies of it, so build it 
+before using the mesh to create a ContactSurface. Building it costs one exact
+query per grid point and 15 per cell, spread over the available threads;
+memory grows with the surface area divided by the square of \a cellSize.
+@param cellSize    The edge length of the grid cells, in the mesh's length 
+                   units. Smaller cells are more accurate but use more memory.
+@param bandWidth   Points up to this distance from the surface, inside or 
+                   outside, are answered from the field.
+@param maxError    The largest acceptable difference between the 
+                   interpolated and exact nearest points at a cell's test
+                   points. **/
+void createDistanceField(Real cellSize, Real bandWidth, Real maxError);
+/** Return true if createDistanceField() has been called for this mesh 
+(or the one it was copied from) and clearDistanceField() has not. **/
+bool hasDistanceField() const;
+/** Discard this mesh's distance field, if any, so that all nearest point 
+queries use the exact search again. **/
+void clearDistanceField();
+
 
 /** Determine whether this mesh intersects a ray, and if so, find the 
 intersection point.
@@ -1305,6 +1362,25 @@ hit.
                   stored in this. Otherwise, it is left unchanged.
 @return \c true if an intersection is found, \c false otherwise. **/
 bool intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, int& face, Vec2& uv) const;
+/** Find where each of a batch of rays first hits this mesh, as for a 
+simulated range sensor. The rays are traced through the Oriented Bounding Box
+Tree in packets, so that each node is visited once per packet rather than once
+per ray. All the arrays must have the same size.
+@param origins     The positions at which the rays begin, in this mesh's frame.
+@param directions  The ray directions.
+@param distances   On entry, the distance beyond which hits are of no 
+                   interest for each ray; use Infinity for no limit. On exit,
+                   the distance to the hit for each ray that hit closer than
+                   that, and unchanged for the others.
+@param faces       The index of the face hit by each ray that hit, and 
+                   unchanged for the others.
+@param uv          The barycentric coordinates of each hit within its face, 
+                   and unchanged for rays that missed.
+@return The number of rays that hit. **/
+int intersectsRays(const ArrayViewConst_<Vec3>& origins, 
+                   const ArrayViewConst_<UnitVec3>& directions,
+                   ArrayView_<Real> distances, ArrayView_<int> faces,
+                   ArrayView_<Vec2> uv) const;
 /** Get the OBBTreeNode which forms the root of this mesh's Oriented Bounding 
 Box Tree. **/
 OBBTreeNode getOBBTreeNode() const;
@@ -1313,6 +1389,21 @@ OBBTreeNode getOBBTreeNode() const;
 because you can create a DecorativeMesh from this and then look at it. **/
 PolygonalMesh createPolygonalMesh() const;
 
+/** Turn on caching of constructed meshes in the given directory, or turn it
+off by passing an empty string, which is the default. Building the edge
+tables and the OBB tree of a large mesh takes a while. With caching on, the
+finished mesh is written to a file in the directory named after a hash of its
+vertex positions and face indices, and constructing the same mesh again later,
+in this process or another one, just reads that file. A file that can't be
+read, was written by a different build, or doesn't match the mesh being
+constructed is ignored and the mesh is built as usual. The directory must
+already exist; this applies to all TriangleMesh objects constructed afterward,
+on any thread. **/
+static void setCacheDirectory(const std::string& directory);
+/** Return the directory set by setCacheDirectory(), or an empty string if
+caching is off. **/
+static std::string getCacheDirectory();
+
 /** Return true if the supplied ContactGeometry object is a triangle mesh. **/
 static bool isInstance(const ContactGeometry& geo)
 {   return geo.getTypeId()==classTypeId(); }
@@ -1342,7 +1433,7 @@ triangles contained within it or its  children. This is a binary tree: each
 non-leaf node has two children. Triangles are stored only in the leaf nodes. **/
 class SimTK_SIMMATH_EXPORT ContactGeometry::TriangleMesh::OBBTreeNode {
 public:
-OBBTreeNode(const OBBTreeNodeImpl& impl);
+OBBTreeNode(const OBBTreeNodeImpl& impl, const int* triangles);
 /** Get the OrientedBoundingBox which encloses all triangles in this node or 
 its children. **/
 const OrientedBoundingBox& getBounds() const;
@@ -1354,16 +1445,18 @@ const OBBTreeNode getFirstChildNode() const;
 /** Get the second child node. Calling this on a leaf node will produce an 
 exception. **/
 const OBBTreeNode getSecondChildNode() const;
-/** Get the indices of all triangles contained in this node. Calling this on a
-non-leaf node will produce an exception. **/
-const Array_<int>& getTriangles() const;
+/** Get the indices of all triangles contained in this node. The returned
+view refers to storage owned by the mesh. Calling this on a non-leaf node will
+produce an exception. **/
+ArrayViewConst_<int> getTriangles() const;
 /** Get the number of triangles inside this node. If this is not a leaf node,
 this is the total number of triangles contained by all children of this
 node. **/
 int getNumTriangles() const;
 
 private:
-const OBBTreeNodeImpl* impl;
+const OBBTreeNodeImpl*  impl;
+const int*              triangles;  // the mesh's triangle index array
 };
 
 //==============================================================================
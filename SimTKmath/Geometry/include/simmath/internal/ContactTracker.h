@@ -67,7 +67,13 @@ class HalfSpaceBrick;
 class HalfSpaceTriangleMesh;
 class HalfSpaceConvexImplicit;
 class SphereSphere;
+class SphereBrick;
+class SphereCylinder;
+class BrickBrick;
 class SphereTriangleMesh;
+class SmoothHeightMapSphere;
+class SmoothHeightMapEllipsoid;
+class SmoothHeightMapTriangleMesh;
 class TriangleMeshTriangleMesh;
 class ConvexImplicitPair;
 class GeneralImplicitPair;
@@ -100,6 +106,19 @@ virtual bool trackContact
     Real                   cutoff,
     Contact&               currentStatus) const = 0;
 
+/** Returns a boolean flag telling the ContactTrackerSubsystem whether 
+trackContact() may be called concurrently from several threads, for different
+pairs of surfaces, as it does when the narrow phase is tracked in parallel 
+(see ContactTrackerSubsystem::setNumberOfThreads()). By default, this method 
+returns false, and all the pairs are tracked on a single thread whenever 
+this tracker is needed. The built-in trackers return true.
+
+@note: By overriding this method, you are telling Simbody that trackContact()
+does not modify any shared data, including mutable members of the tracker. **/
+virtual bool shouldBeParallelIfPossible() const {
+    return false;
+}
+
 /** Given two shapes for which implicit functions are known, and a rough-guess
 contact point for each shape (each measured and expressed in its own surface's
 frame), refine those contact points to obtain the nearest
@@ -193,6 +212,8 @@ bool trackContact
     const ContactGeometry& surface2,
     Real                   cutoff,
     Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 
@@ -217,6 +238,8 @@ bool trackContact
     const ContactGeometry& surface2,
     Real                   cutoff,
     Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 
@@ -241,6 +264,8 @@ bool trackContact
     const ContactGeometry& surface2,
     Real                   cutoff,
     Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 
@@ -265,6 +290,187 @@ bool trackContact
     const ContactGeometry& surface2,
     Real                   cutoff,
     Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+};
+
+
+
+//==============================================================================
+//                       SPHERE-BRICK CONTACT TRACKER
+//==============================================================================
+/** This ContactTracker handles contacts between a ContactGeometry::Sphere
+and a ContactGeometry::Brick, in that order. The result is a
+CircularPointContact at the brick's nearest point to the sphere center. **/
+class SimTK_SIMMATH_EXPORT ContactTracker::SphereBrick 
+:   public ContactTracker {
+public:
+SphereBrick() 
+:   ContactTracker(ContactGeometry::Sphere::classTypeId(),
+                   ContactGeometry::Brick::classTypeId()) {}
+
+bool trackContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1, 
+    const ContactGeometry& surface1,    // the sphere
+    const Transform& X_GS2, 
+    const ContactGeometry& surface2,    // the brick
+    Real                   cutoff,
+    Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+};
+
+
+
+//==============================================================================
+//                       BRICK-BRICK CONTACT TRACKER
+//==============================================================================
+/** This ContactTracker handles contacts between two ContactGeometry::Brick
+objects using the separating axis test. The result is a ManifoldContact with
+up to eight points for face contact, or one point when two edges cross. **/
+class SimTK_SIMMATH_EXPORT ContactTracker::BrickBrick 
+:   public ContactTracker {
+public:
+BrickBrick() 
+:   ContactTracker(ContactGeometry::Brick::classTypeId(),
+                   ContactGeometry::Brick::classTypeId()) {}
+
+bool trackContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1, 
+    const ContactGeometry& surface1,    // brick A
+    const Transform& X_GS2, 
+    const ContactGeometry& surface2,    // brick B
+    Real                   cutoff,
+    Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+};
+
+
+
+//==============================================================================
+//                      SPHERE-CYLINDER CONTACT TRACKER
+//==============================================================================
+/** This ContactTracker handles contacts between a ContactGeometry::Sphere
+and a ContactGeometry::Cylinder, in that order. The cylinder is infinitely
+long so the contact is always with its side; the result is an
+EllipticalPointContact. **/
+class SimTK_SIMMATH_EXPORT ContactTracker::SphereCylinder 
+:   public ContactTracker {
+public:
+SphereCylinder() 
+:   ContactTracker(ContactGeometry::Sphere::classTypeId(),
+                   ContactGeometry::Cylinder::classTypeId()) {}
+
+bool trackContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1, 
+    const ContactGeometry& surface1,    // the sphere
+    const Transform& X_GS2, 
+    const ContactGeometry& surface2,    // the cylinder
+    Real                   cutoff,
+    Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+};
+
+
+
+//==============================================================================
+//               SMOOTH HEIGHT MAP - SPHERE CONTACT TRACKER
+//==============================================================================
+/** This ContactTracker handles contacts between a
+ContactGeometry::SmoothHeightMap and a ContactGeometry::Sphere, in that order.
+The contact point is the height map's nearest point to the sphere center,
+found by Newton iteration on the bicubic patch under the center, so the cost
+doesn't depend on the size of the height map. The sphere center must be over
+the height map's domain. **/
+class SimTK_SIMMATH_EXPORT ContactTracker::SmoothHeightMapSphere
+:   public ContactTracker {
+public:
+SmoothHeightMapSphere()
+:   ContactTracker(ContactGeometry::SmoothHeightMap::classTypeId(),
+                   ContactGeometry::Sphere::classTypeId()) {}
+
+bool trackContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1,
+    const ContactGeometry& surface1,    // the height map
+    const Transform& X_GS2,
+    const ContactGeometry& surface2,    // the sphere
+    Real                   cutoff,
+    Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+};
+
+
+
+//==============================================================================
+//              SMOOTH HEIGHT MAP - ELLIPSOID CONTACT TRACKER
+//==============================================================================
+/** This ContactTracker handles contacts between a
+ContactGeometry::SmoothHeightMap and a ContactGeometry::Ellipsoid, in that
+order. We alternate between finding the ellipsoid point whose normal opposes
+the height map's normal, and the height map's nearest point to that, until
+the normals agree. The ellipsoid center must be over the height map's
+domain. **/
+class SimTK_SIMMATH_EXPORT ContactTracker::SmoothHeightMapEllipsoid
+:   public ContactTracker {
+public:
+SmoothHeightMapEllipsoid()
+:   ContactTracker(ContactGeometry::SmoothHeightMap::classTypeId(),
+                   ContactGeometry::Ellipsoid::classTypeId()) {}
+
+bool trackContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1,
+    const ContactGeometry& surface1,    // the height map
+    const Transform& X_GS2,
+    const ContactGeometry& surface2,    // the ellipsoid
+    Real                   cutoff,
+    Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+};
+
+
+
+//==============================================================================
+//            SMOOTH HEIGHT MAP - TRIANGLE MESH CONTACT TRACKER
+//==============================================================================
+/** This ContactTracker handles contacts between a
+ContactGeometry::SmoothHeightMap and a ContactGeometry::TriangleMesh, in that
+order. It finds the mesh faces with a vertex below the height map, pruning
+the mesh's OBB tree with a bound on the height map's height under each box.
+As for a half space, only penetration is detected so the cutoff must be
+zero. **/
+class SimTK_SIMMATH_EXPORT ContactTracker::SmoothHeightMapTriangleMesh
+:   public ContactTracker {
+public:
+SmoothHeightMapTriangleMesh()
+:   ContactTracker(ContactGeometry::SmoothHeightMap::classTypeId(),
+                   ContactGeometry::TriangleMesh::classTypeId()) {}
+
+bool trackContact
+   (const Contact&         priorStatus,
+    const Transform& X_GS1,
+    const ContactGeometry& surface1,    // the height map
+    const Transform& X_GS2,
+    const ContactGeometry& surface2,    // the mesh
+    Real                   cutoff,
+    Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+
+private:
+void processBox(const ContactGeometry::SmoothHeightMap&           heightMap,
+                const ContactGeometry::TriangleMesh&              mesh,
+                const ContactGeometry::TriangleMesh::OBBTreeNode& node,
+                const Transform& X_HM, BicubicSurface::PatchHint& hint,
+                std::set<int>& insideFaces) const;
 };
 
 
@@ -290,6 +496,8 @@ bool trackContact
     Real                   cutoff,
     Contact&               currentStatus) const override;
 
+bool shouldBeParallelIfPossible() const override {return true;}
+
 private:
 void processBox(const ContactGeometry::TriangleMesh&              mesh, 
                 const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
@@ -322,6 +530,8 @@ bool trackContact
     Real                   cutoff,
     Contact&               currentStatus) const override;
 
+bool shouldBeParallelIfPossible() const override {return true;}
+
 private:
 void processBox
    (const ContactGeometry::TriangleMesh&              mesh, 
@@ -353,6 +563,8 @@ bool trackContact
     Real                   cutoff,
     Contact&               currentStatus) const override;
 
+bool shouldBeParallelIfPossible() const override {return true;}
+
 private:
 void findIntersectingFaces
    (const ContactGeometry::TriangleMesh&                mesh1, 
@@ -403,6 +615,8 @@ bool trackContact
     const ContactGeometry& surface2, // the convex implicit surface
     Real                   cutoff,
     Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 
@@ -426,6 +640,33 @@ bool trackContact
     const ContactGeometry& surface2,
     Real                   cutoff,
     Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+
+/** Find the contact points of two convex implicit shapes as trackContact()
+does, each measured and expressed in its own shape's frame, refined to near 
+machine precision. If \a priorStatus is an EllipticalPointContact between the
+same two shapes, it is used as a warm start: if its contact normal is now a
+separating plane there is no contact, and if the shapes have moved only a 
+little relative to each other since, its contact points are refined directly
+without running MPR. Otherwise this falls back to 
+estimateConvexImplicitPairContactUsingMPR() followed by refineImplicitPair().
+
+@returns \c false if the shapes are definitely not in contact. Otherwise they
+might be, and you must check the depth along the surface normal at 
+\a pointP_A to find out.
+
+The iteration counts are returned so that the cost can be measured; 
+\a numMPRIterations is zero when MPR was skipped. **/
+static bool findContactPoints
+   (const Contact&          priorStatus,
+    const ContactGeometry&  shapeA,
+    const ContactGeometry&  shapeB,
+    const Transform&        X_AB,
+    Vec3&                   pointP_A,
+    Vec3&                   pointQ_B,
+    int&                    numMPRIterations,
+    int&                    numNewtonIterations);
 };
 
 
@@ -453,6 +694,8 @@ bool trackContact
     const ContactGeometry& surface2,
     Real                   cutoff,
     Contact&               currentStatus) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 } // namespace SimTK
@@ -122,6 +122,26 @@ Real BicubicSurface::calcValue(const Vec2& XY) const {
     return calcValue(XY, hint); 
 }
 
+// calcValues(), the fast version.
+void BicubicSurface::calcValues(const ArrayViewConst_<Vec2>& XY, 
+                                ArrayView_<Real> values, 
+                                PatchHint& hint) const {
+    SimTK_ERRCHK_ALWAYS(!isEmpty(), "BicubicSurface::calcValues()",
+        "This method can't be called on an empty handle.");
+    SimTK_APIARGCHECK2_ALWAYS(values.size() == XY.size(), 
+        "BicubicSurface", "calcValues",
+        "Got %d points but room for %d values.", 
+        (int)XY.size(), (int)values.size());
+    guts->calcValues(XY, values, hint); 
+}
+
+// calcValues(), the slow version.
+void BicubicSurface::calcValues(const ArrayViewConst_<Vec2>& XY, 
+                                ArrayView_<Real> values) const {
+    PatchHint hint; // create an empty hint
+    calcValues(XY, values, hint); 
+}
+
 // calcDerivative(), the fast version.
 Real BicubicSurface::calcDerivative
    (const Array_<int>& components, const Vec2& XY, PatchHint& hint) const {
@@ -472,6 +492,33 @@ Real BicubicSurface::Guts::calcValue(const Vec2& aXY, PatchHint& hint) const
 }
 
 
+// Sort the points by the patch they are on, then evaluate them in that order
+// so that each patch's coefficients are calculated only once. Points that
+// are off the surface go first with key -1; getFdF() will complain about them.
+void BicubicSurface::Guts::
+calcValues(const ArrayViewConst_<Vec2>& XY, ArrayView_<Real> values, 
+           PatchHint& hint) const
+{
+    const int n = (int)XY.size();
+    const int nx = _x.size()-1;
+    Array_< std::pair<int,int> > order(n); // (patch key, point index)
+    int x0 = -1, y0 = -1;
+    for (int i=0; i < n; ++i) {
+        int key = -1;
+        if (isSurfaceDefined(XY[i])) {
+            findPatch(XY[i], x0, y0, x0, y0);
+            key = y0*nx + x0;
+        }
+        order[i] = std::make_pair(key, i);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (int k=0; k < n; ++k) {
+        const int i = order[k].second;
+        values[i] = calcValue(XY[i], hint);
+    }
+}
+
 Real BicubicSurface::Guts::calcDerivative
    (const Array_<int>& aDerivComponents, const Vec2& aXY, PatchHint& hint) const
 {
@@ -634,7 +681,8 @@ derivatives at the point XY. These values are stored in the following order:
 */
 void BicubicSurface::Guts::
 getFdF(const Vec2& aXY, int wantLevel, PatchHint& hint) const {
-    ++numAccesses; // All surface accesses come through here.
+    // All surface accesses come through here.
+    numAccesses.fetch_add(1, std::memory_order_relaxed);
 
     //0. Check if the surface is defined for the XY value given.
     SimTK_ERRCHK6_ALWAYS(isSurfaceDefined(aXY), 
@@ -652,7 +700,7 @@ getFdF(const Vec2& aXY, int wantLevel, PatchHint& hint) const {
 
     //1. Check to see if we have already computed values for the requested point.
     if(h.level >= wantLevel && aXY == h.xy){
-        ++numAccessesSamePoint;
+        numAccessesSamePoint.fetch_add(1, std::memory_order_relaxed);
         return;    
     }
 
@@ -660,29 +708,18 @@ getFdF(const Vec2& aXY, int wantLevel, PatchHint& hint) const {
     h.xy = aXY;
     h.level = -1; // we don't know anything about this point
 
-    // We're going to feed calcLowerBoundIndex() our best guess as to the
-    // patch this point is on. For regularly-spaced grid points we can find
-    // it exactly, except for some possible roundoff. Otherwise the best we
-    // can do is supply the current index from the hint.
-    int pXidx = h.x0, pYidx = h.y0;
-    if (_hasRegularSpacing) {
-        pXidx = clamp(0, (int)std::floor((h.xy[0]-_x[0])/_spacing[0]),
-                      _x.size()-2); // can't be last index
-        pYidx = clamp(0, (int)std::floor((h.xy[1]-_y[0])/_spacing[1]),
-                      _y.size()-2);
-    }
-
-    // Compute the indices that define the patch containing this value.
-    int howResolvedX, howResolvedY;
-    const int x0 = calcLowerBoundIndex(_x,aXY[0],pXidx,howResolvedX);
+    // Compute the indices that define the patch containing this value,
+    // starting from the patch in the hint.
+    int x0, y0;
+    const int howResolved = findPatch(aXY, h.x0, h.y0, x0, y0);
     const int x1 = x0+1;
-    const int y0 = calcLowerBoundIndex(_y,aXY[1],pYidx,howResolvedY);
     const int y1 = y0+1;
 
     // 0->same patch, 1->nearby patch, 2->had to search
-    const int howResolved = std::max(howResolvedX, howResolvedY);
-    if      (howResolved == 0) ++numAccessesSamePatch;
-    else if (howResolved == 1) ++numAccessesNearbyPatch;
+    if (howResolved == 0) 
+        numAccessesSamePatch.fetch_add(1, std::memory_order_relaxed);
+    else if (howResolved == 1) 
+        numAccessesNearbyPatch.fetch_add(1, std::memory_order_relaxed);
  
     // Compute Bicubic coefficients only if we're in a new patch
     // else use the old ones, because this is an expensive step!
@@ -852,6 +889,29 @@ static bool isOnPatch(const Vector& aVec, int indxL, Real aVal) {
     return indxL == maxLB;
 }
 
+// Find the patch (x0,y0) containing the point XY, which must be on the
+// surface. (pXidx,pYidx) is the patch to try first, usually the one in a hint;
+// pass -1's if there isn't one. Returns 0 if the point was on that patch, 1 if
+// it was nearby, and 2 if we had to search, as for calcLowerBoundIndex().
+int BicubicSurface::Guts::
+findPatch(const Vec2& XY, int pXidx, int pYidx, int& x0, int& y0) const {
+    // We're going to feed calcLowerBoundIndex() our best guess as to the
+    // patch this point is on. For regularly-spaced grid points we can find
+    // it exactly, except for some possible roundoff. Otherwise the best we
+    // can do is supply the given index.
+    if (_hasRegularSpacing) {
+        pXidx = clamp(0, (int)std::floor((XY[0]-_x[0])/_spacing[0]),
+                      _x.size()-2); // can't be last index
+        pYidx = clamp(0, (int)std::floor((XY[1]-_y[0])/_spacing[1]),
+                      _y.size()-2);
+    }
+
+    int howResolvedX, howResolvedY;
+    x0 = calcLowerBoundIndex(_x,XY[0],pXidx,howResolvedX);
+    y0 = calcLowerBoundIndex(_y,XY[1],pYidx,howResolvedY);
+    return std::max(howResolvedX, howResolvedY);
+}
+
 // howResolved: 0->same patch, 1->nearby patch, 2->search
 int BicubicSurface::Guts::
 calcLowerBoundIndex(const Vector& aVec, Real aVal, int pIdx,
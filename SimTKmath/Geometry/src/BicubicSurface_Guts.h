@@ -38,6 +38,7 @@ nearby patches. **/
 #include "simmath/internal/BicubicSurface.h"
 
 #include <cassert>
+#include <atomic>
 
 namespace SimTK { 
     
@@ -137,6 +138,11 @@ public:
 
     // Calculate the value of the surface at a particular XY coordinate.
     Real calcValue(const Vec2& XY, PatchHint& hint) const;
+
+    // Calculate the value of the surface at each of a set of XY coordinates,
+    // visiting them patch by patch.
+    void calcValues(const ArrayViewConst_<Vec2>& XY, ArrayView_<Real> values,
+                    PatchHint& hint) const;
     
     // Calculate a partial derivative of this function at a particular XY
     // coordinate.
@@ -274,6 +280,8 @@ public:
 private:
     int calcLowerBoundIndex(const Vector& vecV, Real value, int pIdx,
                             int& howResolved) const;
+    int findPatch(const Vec2& XY, int pXidx, int pYidx, 
+                  int& x0, int& y0) const;
     void getCoefficients(const Vec<16>& f, Vec<16>& aV) const;
     void getFdF(const Vec2& aXY, int wantLevel,
                 BicubicSurface::PatchHint& hint) const;
@@ -311,14 +319,16 @@ private:
     // reference count goes to zero.
     mutable int referenceCount;
 
-    // Interesting statistics about the use of this surface.
-    mutable int numAccesses; 
-    mutable int numAccessesSamePoint;
-    mutable int numAccessesSamePatch;
-    mutable int numAccessesNearbyPatch;
+    // Interesting statistics about the use of this surface. These are
+    // atomic since the surface may be queried from several threads at once;
+    // they are only counters so relaxed ordering is enough.
+    mutable std::atomic<int> numAccesses; 
+    mutable std::atomic<int> numAccessesSamePoint;
+    mutable std::atomic<int> numAccessesSamePatch;
+    mutable std::atomic<int> numAccessesNearbyPatch;
     void resetStatistics() const
-    {   numAccesses = numAccessesSamePoint = 0;
-    numAccessesSamePatch = numAccessesNearbyPatch = 0; }
+    {   numAccesses = 0; numAccessesSamePoint = 0;
+        numAccessesSamePatch = 0; numAccessesNearbyPatch = 0; }
 
     // PROPERTIES
     // Array of values for the independent variables (i.e., the spline knot
@@ -262,7 +262,7 @@ void CollisionDetectionAlgorithm::HalfSpaceTriangleMesh::processBox
     
     // Check the triangles.
     
-    const Array_<int>& triangles = node.getTriangles();
+    const ArrayViewConst_<int> triangles = node.getTriangles();
     const Row3 xdir = X_HM.R().row(0);
     const Real tx = X_HM.p()[0];
     for (int i = 0; i < (int) triangles.size(); i++) {
@@ -280,7 +280,7 @@ void CollisionDetectionAlgorithm::HalfSpaceTriangleMesh::addAllTriangles
     std::set<int>& insideFaces) const 
 {
     if (node.isLeafNode()) {
-        const Array_<int>& triangles = node.getTriangles();
+        const ArrayViewConst_<int> triangles = node.getTriangles();
         for (int i = 0; i < (int) triangles.size(); i++)
             insideFaces.insert(triangles[i]);
     }
@@ -339,7 +339,7 @@ void CollisionDetectionAlgorithm::SphereTriangleMesh::processBox
     
     // Check the triangles.
     
-    const Array_<int>& triangles = node.getTriangles();
+    const ArrayViewConst_<int> triangles = node.getTriangles();
     for (int i = 0; i < (int) triangles.size(); i++) {
         Vec2 uv;
         Vec3 nearestPoint = mesh.findNearestPointToFace
@@ -427,8 +427,8 @@ processNodes
     
     // These are both leaf nodes, so check triangles for intersections.
     
-    const Array_<int>& node1triangles = node1.getTriangles();
-    const Array_<int>& node2triangles = node2.getTriangles();
+    const ArrayViewConst_<int> node1triangles = node1.getTriangles();
+    const ArrayViewConst_<int> node2triangles = node2.getTriangles();
     for (int i = 0; i < (int) node2triangles.size(); i++) {
         Vec3 a1 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(node2triangles[i], 0));
         Vec3 a2 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(node2triangles[i], 1));
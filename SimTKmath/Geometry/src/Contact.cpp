@@ -223,6 +223,43 @@ bool BrickHalfSpaceContact::isInstance(const Contact& contact) {
 {   return BrickHalfSpaceContactImpl::classTypeId(); }
 
 
+//==============================================================================
+//                              MANIFOLD CONTACT
+//==============================================================================
+ManifoldContact::ManifoldContact
+   (ContactSurfaceIndex     surf1,
+    ContactSurfaceIndex     surf2,
+    const Transform&        X_S1S2,
+    const UnitVec3&         normal_S1,
+    const Array_<Vec3>&     origins_S1,
+    const Array_<Real>&     depths)
+:   Contact(new ManifoldContactImpl(surf1,surf2,X_S1S2,normal_S1,
+                                    origins_S1,depths))
+{
+    SimTK_APIARGCHECK2_ALWAYS(origins_S1.size() == depths.size(),
+        "ManifoldContact", "ManifoldContact",
+        "Got %d origins but %d depths.",
+        (int)origins_S1.size(), (int)depths.size());
+}
+
+const UnitVec3& ManifoldContact::getNormal() const
+{   return getImpl().normal_S1; }
+int ManifoldContact::getNumPoints() const
+{   return (int)getImpl().origins_S1.size(); }
+const Vec3& ManifoldContact::getOrigin(int i) const
+{   return getImpl().origins_S1[i]; }
+Real ManifoldContact::getDepth(int i) const
+{   return getImpl().depths[i]; }
+
+bool ManifoldContact::isInstance(const Contact& contact) {
+    return (dynamic_cast<const ManifoldContactImpl*>
+        (&contact.getImpl()) != 0);
+}
+
+/*static*/ ContactTypeId ManifoldContact::classTypeId() 
+{   return ManifoldContactImpl::classTypeId(); }
+
+
 //==============================================================================
 //                      TRIANGLE MESH CONTACT & IMPL
 //==============================================================================
@@ -237,6 +274,10 @@ const set<int>& TriangleMeshContact::getSurface1Faces() const
 {   return getImpl().faces1; }
 const set<int>& TriangleMeshContact::getSurface2Faces() const 
 {   return getImpl().faces2; }
+const Array_<int>& TriangleMeshContact::getSurface1FaceIndices() const 
+{   return getImpl().faceIndices1; }
+const Array_<int>& TriangleMeshContact::getSurface2FaceIndices() const 
+{   return getImpl().faceIndices2; }
 
 /*static*/ bool TriangleMeshContact::isInstance(const Contact& contact) 
 {   return (dynamic_cast<const TriangleMeshContactImpl*>(&contact.getImpl())
@@ -249,7 +290,9 @@ TriangleMeshContactImpl::TriangleMeshContactImpl
    (ContactSurfaceIndex surf1, ContactSurfaceIndex surf2,
     const Transform& X_S1S2,
     const set<int>& faces1, const set<int>& faces2) 
-:   ContactImpl(surf1, surf2, X_S1S2), faces1(faces1), faces2(faces2) {}
+:   ContactImpl(surf1, surf2, X_S1S2), faces1(faces1), faces2(faces2),
+    faceIndices1(faces1.begin(), faces1.end()), 
+    faceIndices2(faces2.begin(), faces2.end()) {}
 
 
 
@@ -114,6 +114,23 @@ Vec3 ContactGeometry::findNearestPoint(const Vec3& position, bool& inside, UnitV
     return getImpl().findNearestPoint(position, inside, normal);
 }
 
+void ContactGeometry::findNearestPoints
+   (const ArrayViewConst_<Vec3>& positions, ArrayView_<Vec3> nearestPoints, 
+    ArrayView_<bool> inside, ArrayView_<UnitVec3> normals) const {
+    const int n = positions.size();
+    SimTK_APIARGCHECK4_ALWAYS((int)nearestPoints.size() >= n 
+                              && (int)inside.size() >= n 
+                              && (int)normals.size() >= n,
+        "ContactGeometry", "findNearestPoints",
+        "Got %d positions but room for only %d points, %d inside flags "
+        "and %d normals.", n, (int)nearestPoints.size(), (int)inside.size(),
+        (int)normals.size());
+    if (n == 0)
+        return;
+    getImpl().findNearestPoints(positions.begin(), n, nearestPoints.begin(), 
+                                inside.begin(), normals.begin());
+}
+
 Vec3 ContactGeometry::projectDownhillToNearestPoint(const Vec3& Q) const {
     return getImpl().projectDownhillToNearestPoint(Q);
 }
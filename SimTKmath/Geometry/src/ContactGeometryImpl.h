@@ -27,6 +27,7 @@
 
 #include "simmath/internal/Geo.h"
 #include "simmath/internal/Geo_Sphere.h"
+#include "simmath/internal/Geo_Triangle.h"
 #include "simmath/internal/OBBTree.h"
 #include "simmath/internal/ParticleConSurfaceSystem.h"
 #include "simmath/Differentiator.h"
@@ -34,6 +35,8 @@
 
 #include <atomic>
 #include <limits>
+#include <memory>
+#include <unordered_map>
 
 namespace SimTK {
 
@@ -79,6 +82,16 @@ public:
     virtual Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                                   UnitVec3& normal) const = 0;
 
+    // Override this if a batch of queries can be done faster than one at a
+    // time.
+    virtual void findNearestPoints(const Vec3* positions, int n, 
+                                   Vec3* nearestPoints, bool* inside, 
+                                   UnitVec3* normals) const {
+        for (int i = 0; i < n; ++i)
+            nearestPoints[i] = 
+                findNearestPoint(positions[i], inside[i], normals[i]);
+    }
+
     virtual bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                                Real& distance, UnitVec3& normal) const = 0;
 
@@ -856,7 +869,9 @@ public:
     }
 
     const BicubicSurface& getBicubicSurface() const {return surface;}
-    BicubicSurface::PatchHint& updHint() const {return hint;}
+    // Each thread has its own hint so that concurrent queries don't race;
+    // see the definition for details.
+    BicubicSurface::PatchHint& updHint() const;
 
     ContactGeometryTypeId getTypeId() const override {return classTypeId();}
 
@@ -864,6 +879,26 @@ public:
     Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                           UnitVec3& normal) const override;
 
+    // This is findNearestPoint() using the caller's hint. The search is a
+    // Newton iteration starting at the surface point directly above or below
+    // the given position, so it finds the nearest point in that neighborhood.
+    // The result is always on the surface's domain; inside is true only if
+    // the position is over the domain and below the surface.
+    Vec3 findNearestPoint(const Vec3& position, BicubicSurface::PatchHint& hint,
+                          bool& inside, UnitVec3& normal) const;
+
+    // Calculate the surface height f and its first and second derivatives
+    // at a point on the domain.
+    void calcHeightDerivatives(const Vec2& XY, BicubicSurface::PatchHint& hint,
+                               Real& f, Vec2& df, Mat22& d2f) const;
+
+    // Return an upper bound on the surface height over the rectangle [lo,hi]
+    // of the x-y plane, or -Infinity if the rectangle misses the domain.
+    // This takes the highest Bezier control point of the patches it touches,
+    // which bounds the surface since a Bezier patch lies in the convex hull
+    // of its control points.
+    Real calcMaxHeight(const Vec2& lo, const Vec2& hi) const;
+
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, UnitVec3& normal) const override;
 
@@ -886,7 +921,8 @@ public:
     void calcCurvature(const Vec3& point, Vec2& curvature, 
                        Rotation& orientation) const override {
         Transform X_SP;
-        surface.calcParaboloid(Vec2(point[0],point[1]), hint, X_SP, curvature);
+        surface.calcParaboloid(Vec2(point[0],point[1]), updHint(), 
+                               X_SP, curvature);
         orientation = X_SP.R();
     }
 
@@ -917,7 +953,15 @@ private:
 
 
     BicubicSurface                      surface;
-    mutable BicubicSurface::PatchHint   hint;
+    // Identifies this object's hints; unique among all height maps ever
+    // created.
+    const long long                     serialNumber;
+    // Lower x and y knot of each patch column and row, and the highest
+    // control point of each patch's Bezier form, patch (i,j) at j*nx+i.
+    Array_<Real>                        knotX, knotY;
+    Array_<Real>                        patchMaxHeight;
+    // The narrowest patch in either direction; sets intersectsRay()'s step.
+    Real                                minPatchWidth;
     Geo::Sphere                         boundingSphere;
     SmoothHeightMapImplicitFunction     implicitFunction;
 };
@@ -980,16 +1024,23 @@ private:
 //==============================================================================
 //                            OBB TREE NODE IMPL
 //==============================================================================
+// The OBB tree of a TriangleMesh is stored as a single array of these nodes in
+// depth-first order: a node's first child immediately follows it and its
+// second child is secondChild entries further along. The triangles of a node
+// and all its descendants are the range [firstTriangle, 
+// firstTriangle+numTriangles) of the mesh's shared triangle index array. Nodes
+// hold no pointers, so copying a tree is a plain copy of two arrays.
 class OBBTreeNodeImpl {
 public:
-    OBBTreeNodeImpl() : child1(NULL), child2(NULL), numTriangles(0) {
+    OBBTreeNodeImpl() : secondChild(0), firstTriangle(0), numTriangles(0) {
     }
-    OBBTreeNodeImpl(const OBBTreeNodeImpl& copy);
-    ~OBBTreeNodeImpl();
+    bool isLeafNode() const {return secondChild == 0;}
+    const OBBTreeNodeImpl& getFirstChild() const {return this[1];}
+    const OBBTreeNodeImpl& getSecondChild() const {return this[secondChild];}
+
     OrientedBoundingBox bounds;
-    OBBTreeNodeImpl* child1;
-    OBBTreeNodeImpl* child2;
-    Array_<int> triangles;
+    int secondChild;    // offset to the second child; 0 for a leaf
+    int firstTriangle;
     int numTriangles;
     Vec3 findNearestPoint(const ContactGeometry::TriangleMesh::Impl& mesh, 
                           const Vec3& position, Real cutoff2, Real& distance2, 
@@ -997,6 +1048,14 @@ public:
     bool intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh, 
                        const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, int& face, Vec2& uv) const;
+    // Trace a packet of rays through this subtree; "active" lists those that
+    // enter this node's bounds before their current hit distance. Bit i of
+    // the result is set if ray i found a closer hit here.
+    unsigned long long intersectsRays
+       (const ContactGeometry::TriangleMesh::Impl& mesh, 
+        const Vec3 origins[], const UnitVec3 directions[], 
+        const int active[], int numActive, Real distances[], 
+        int faces[], Vec2 uvs[]) const;
 };
 
 
@@ -1009,6 +1068,7 @@ public:
     class Edge;
     class Face;
     class Vertex;
+    class DistanceField;
 
     Impl(const ArrayViewConst_<Vec3>& vertexPositions, 
          const ArrayViewConst_<int>& faceIndices, bool smooth);
@@ -1025,15 +1085,47 @@ public:
     Vec3 findNearestPoint(const Vec3& position, bool& inside, int& face, 
                           Vec2& uv) const;
     Vec3 findNearestPointToFace(const Vec3& position, int face, Vec2& uv) const;
+    // The same answer as findNearestPoint(), searching only the boxes that
+    // are no farther away than the face nearest a previous, nearby query 
+    // (or all of them if face is -1). The face is updated.
+    Vec3 findNearestPointWithHint(const Vec3& position, bool& inside, 
+                                  int& face, Vec2& uv) const;
     void createPolygonalMesh(PolygonalMesh& mesh) const;
 
+    // Batched kernels that test up to FaceBlockSize faces per call, using a
+    // structure-of-arrays copy of the faces' vertex positions kept in OBB tree
+    // order. "faces" must point into the tree's triangle index array, as 
+    // returned by OBBTreeNode::getTriangles(), and count must be no more 
+    // than FaceBlockSize.
+    static const int FaceBlockSize = 4;
+    // Equivalent to calling findNearestPointToFace() for each face.
+    void findNearestPointsToFaces(const Vec3& position, const int* faces, 
+                                  int count, Vec3 points[], Vec2 uvs[]) const;
+    // Return a bit mask with bit i set if faces[i] overlaps the given 
+    // triangle, which must be expressed in this mesh's frame. This is
+    // equivalent to calling Geo::Triangle::overlapsTriangle() for each face.
+    unsigned findFacesOverlappingTriangle(const Geo::Triangle& triangle,
+                                          const int* faces, int count) const;
+
     DecorativeGeometry createDecorativeGeometry() const override;
     Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                           UnitVec3& normal) const override;
+    void findNearestPoints(const Vec3* positions, int n, 
+                           Vec3* nearestPoints, bool* inside, 
+                           UnitVec3* normals) const override;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, UnitVec3& normal) const override;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, int& face, Vec2& uv) const;
+    // Rays are traced through the OBB tree this many at a time, one bit per
+    // ray in the node traversal's hit masks.
+    static const int RayPacketSize = 64;
+    int intersectsRays(const Vec3* origins, const UnitVec3* directions,
+                       int count, Real* distances, int* hitFaces, 
+                       Vec2* uvs) const;
+    bool intersectsRayWithFace(int face, const Vec3& origin, 
+                               const UnitVec3& direction, Real maxDistance,
+                               Real& distance, Vec2& uv) const;
     void getBoundingSphere(Vec3& center, Real& radius) const override;
 
     bool isSmooth() const override {return false;}
@@ -1046,12 +1138,39 @@ public:
             createNewContactGeometryTypeId();
         return id;
     }
+    void createDistanceField(Real cellSize, Real bandWidth, Real maxError);
+    bool hasDistanceField() const {return (bool)distanceField;}
+    void clearDistanceField() {distanceField.reset();}
+    // The directory holding cached meshes, or empty if caching is off.
+    static void setCacheDirectory(const std::string& directory);
+    static std::string getCacheDirectory();
 private:
+    class ObbBuilder;
     void init(const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices);
-    void createObbTree(OBBTreeNodeImpl& node, const Array_<int>& faceIndices);
+    void createEdges();
+    bool readCache(const std::string& fileName, 
+                   const Array_<Vec3>& vertexPositions, 
+                   const Array_<int>& faceIndices);
+    void writeCache(const std::string& fileName) const;
+    void createObbTree(const Array_<int>& faceIndices);
+    // Append the subtree containing the given faces to the given arrays,
+    // which start out holding some other subtree or nothing. This only reads
+    // the mesh, so several subtrees can be built at once.
+    void createObbSubtree(const Array_<int>& faceIndices, 
+                          Array_<OBBTreeNodeImpl>& nodes,
+                          Array_<int>& triangles) const;
+    // Find the bounds of the given faces and, if there are more than a few,
+    // try to split them in two. Returns false if they make a leaf.
+    bool createObbNode(const Array_<int>& faceIndices, 
+                       OrientedBoundingBox& bounds,
+                       Array_<int>& child1Indices, 
+                       Array_<int>& child2Indices) const;
+    void createObbFaceCoords();
+    const Real* getObbFaceCoords(int vertex, int coord) const
+    {   return &obbFaceCoords[(3*vertex+coord)*obbFaceStride]; }
     void splitObbAxis(const Array_<int>& parentIndices, 
                       Array_<int>& child1Indices, 
-                      Array_<int>& child2Indices, int axis);
+                      Array_<int>& child2Indices, int axis) const;
     void findBoundingSphere(Vec3* point[], int p, int b, 
                             Vec3& center, Real& radius);
     friend class ContactGeometry::TriangleMesh;
@@ -1062,8 +1181,16 @@ private:
     Array_<Vertex>  vertices;
     Vec3            boundingSphereCenter;
     Real            boundingSphereRadius;
-    OBBTreeNodeImpl obb;
-    bool            smooth;
+    Array_<OBBTreeNodeImpl> obbNodes;       // depth-first; root is first
+    Array_<int>             obbTriangles;   // indexed by the nodes
+    // The coordinates of the vertices of the faces in obbTriangles, as nine
+    // arrays (vertex 0 x, vertex 0 y, ... vertex 2 z) of obbFaceStride 
+    // entries each, padded so a full block can be loaded from any position.
+    Array_<Real>            obbFaceCoords;
+    int                     obbFaceStride;
+    bool                    smooth;
+    // Optional; clones share it since it never changes once built.
+    std::shared_ptr<const DistanceField> distanceField;
 };
 
 
@@ -1120,6 +1247,69 @@ public:
 
 
 
+//==============================================================================
+//                      TriangleMeshImpl DISTANCE FIELD
+//==============================================================================
+// A sparse grid of samples of the nearest surface point, the signed distance
+// to it, and the surface normal there. Away from the medial axis the nearest
+// point is a continuous, piecewise linear function of position, so 
+// trilinear interpolation of it is nearly exact; the distance and its 
+// gradient follow from it, and the sign from the interpolated distance. Only 
+// cells near the surface whose interpolated answers were checked against the
+// exact ones are kept, in a hash table from cell index to the samples at its
+// eight corners.
+class ContactGeometry::TriangleMesh::Impl::DistanceField
+:   public ParallelExecutor::Task {
+public:
+    DistanceField(const Impl& mesh, Real cellSize, Real bandWidth, 
+                  Real maxError);
+
+    // Interpolate the nearest point to a position. This returns false if the
+    // position isn't in one of the kept cells or is farther than the band
+    // from the surface; the caller must then do the exact search.
+    bool findNearestPoint(const Vec3& position, Vec3& nearestPoint, 
+                          bool& inside, UnitVec3& normal) const;
+
+    // Samples and cells are computed in blocks of this many, on threads.
+    static const int BlockSize = 256;
+    void execute(int block) override;
+
+private:
+    struct Sample {
+        Vec3    nearestPoint;
+        Real    distance;   // negative inside
+        Vec3    normal;
+    };
+
+    typedef long long Key;
+    Key getKey(int i, int j, int k) const
+    {   return i + (Key)dims[0]*(j + (Key)dims[1]*k); }
+    Vec3 getPoint(Key key) const {
+        const int i = int(key % dims[0]), j = int((key / dims[0]) % dims[1]),
+                  k = int(key / ((Key)dims[0]*dims[1]));
+        return origin + cellSize*Vec3(i, j, k);
+    }
+    bool interpolate(const int corners[8], const Vec3& position, 
+                     const Vec3& cellOrigin, Vec3& nearestPoint, 
+                     bool& inside, UnitVec3& normal) const;
+    void calcSample(int index, int& face);
+    bool checkCell(int index, int& face) const;
+
+    const Impl*     mesh;   // only while building; null after that
+    Vec3            origin;
+    Real            cellSize, bandWidth, maxError;
+    int             dims[3];    // grid points along each axis
+    Array_<Key>     pointKeys;  // grid points that have samples, sorted
+    Array_<Sample>  samples;    // parallel to pointKeys
+    Array_<Key>     cellKeys;   // candidate cells, keyed by their low corner
+    Array_<int>     cellCorners;// 8 sample indices per candidate cell
+    Array_<char>    cellIsGood;
+    std::unordered_map<Key,int> cells; // kept cell -> first of its corners
+    int             phase;      // for execute(): 0 samples, 1 cells
+};
+
+
+
 //==============================================================================
 //                              TORUS IMPL
 //==============================================================================
@@ -95,12 +95,39 @@ findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const {
 
 }
 
+// Clip the ray against the three slabs |x_i| <= h_i. If the origin is 
+// outside, the hit is where the ray enters the last slab; if it is inside, 
+// the hit is where the ray leaves the first slab, as for a sphere.
 bool ContactGeometry::Brick::Impl::
 intersectsRay(const Vec3& origin, const UnitVec3& direction, 
               Real& distance, UnitVec3& normal) const {
-    SimTK_ASSERT_ALWAYS(!"implemented", 
-                        "ContactGeometry::Brick::Impl::intersectsRay()");
-    return false;
+    const Vec3& h = getHalfLengths();
+    Real tEnter = -Infinity, tExit = Infinity;
+    int enterAxis = -1, exitAxis = -1;
+    for (int i=0; i < 3; ++i) {
+        if (direction[i] == 0) {
+            if (std::abs(origin[i]) > h[i])
+                return false; // parallel to the slab and outside it
+            continue;
+        }
+        const Real t1 = (-h[i]-origin[i])/direction[i];
+        const Real t2 = ( h[i]-origin[i])/direction[i];
+        const Real tNear = std::min(t1,t2), tFar = std::max(t1,t2);
+        if (tNear > tEnter) {tEnter = tNear; enterAxis = i;}
+        if (tFar < tExit)   {tExit = tFar;   exitAxis = i;}
+    }
+    if (tEnter > tExit || tExit < 0)
+        return false;
+
+    const bool outside = (tEnter >= 0);
+    const int axis = outside ? enterAxis : exitAxis;
+    distance = outside ? tEnter : tExit;
+    // The normal points away from the brick on the face we cross, which is
+    // against the ray when entering and along it when leaving.
+    normal = UnitVec3(CoordinateAxis(axis));
+    if ((direction[axis] > 0) == outside)
+        normal = -normal;
+    return true;
 }
 
 void ContactGeometry::Brick::Impl::
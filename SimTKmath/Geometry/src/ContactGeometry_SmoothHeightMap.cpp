@@ -32,6 +32,8 @@
 
 #include "ContactGeometryImpl.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <cmath>
 #include <map>
@@ -75,16 +77,37 @@ updImpl() {
     return static_cast<SmoothHeightMap::Impl&>(*impl);
 }
 
+static std::atomic<long long> nextSerialNumber(0);
+
 // This is the main constructor.
 ContactGeometry::SmoothHeightMap::Impl::
 Impl(const BicubicSurface& surface) 
-:   surface(surface) { 
+:   surface(surface), serialNumber(nextSerialNumber++) { 
     implicitFunction.setOwner(*this); 
 
     createBoundingVolumes();
 
 }
 
+// A shared hint would be a data race when several threads query the same
+// height map, so each thread keeps the hint for the height map it queried
+// last. The hint is tagged with the height map's serial number rather than
+// its address since a new height map could be allocated where a deleted one
+// was, and patch hints are only meaningful for the surface that made them.
+// Callers that alternate between many points on the same surface (several
+// wheels on one terrain, say) should keep their own hints and use the
+// BicubicSurface directly.
+BicubicSurface::PatchHint& ContactGeometry::SmoothHeightMap::Impl::
+updHint() const {
+    static thread_local long long                 hintOwner = -1;
+    static thread_local BicubicSurface::PatchHint hint;
+    if (hintOwner != serialNumber) {
+        hint.clear();
+        hintOwner = serialNumber;
+    }
+    return hint;
+}
+
 void ContactGeometry::SmoothHeightMap::Impl::
 assignPatch(const Geo::BicubicBezierPatch& patch, 
             OBBNode& node, int depth,
@@ -180,6 +203,28 @@ createBoundingVolumes() {
     OBBNode& root = obbTree.updRoot();
     splitPatches(0,0,nx,ny,root,0);
 
+    // Record each patch's lower knots and its highest control point for
+    // calcMaxHeight().
+    knotX.resize(nx); knotY.resize(ny); patchMaxHeight.resize(nx*ny);
+    for (int j=0; j<ny; ++j)
+        for (int i=0; i<nx; ++i) {
+            const Geo::BicubicBezierPatch patch = surface.calcBezierPatch(i,j);
+            const Mat<4,4,Vec3>& B = patch.getControlPoints();
+            Real maxHeight = -Infinity;
+            for (int r=0; r<4; ++r)
+                for (int c=0; c<4; ++c)
+                    maxHeight = std::max(maxHeight, B(r,c)[2]);
+            patchMaxHeight[j*nx+i] = maxHeight;
+            if (j==0) knotX[i] = B(0,0)[0];
+            if (i==0) knotY[j] = B(0,0)[1];
+        }
+    const Vec2 maxXY = surface.getMaxXY();
+    minPatchWidth = std::min(maxXY[0]-knotX.back(), maxXY[1]-knotY.back());
+    for (int i=1; i<nx; ++i)
+        minPatchWidth = std::min(minPatchWidth, knotX[i]-knotX[i-1]);
+    for (int j=1; j<ny; ++j)
+        minPatchWidth = std::min(minPatchWidth, knotY[j]-knotY[j-1]);
+
 
     // Create bounding sphere.
     // TODO: fake this using mesh; this needs to be done correctly instead
@@ -202,15 +247,195 @@ DecorativeGeometry ContactGeometry::SmoothHeightMap::Impl::createDecorativeGeome
 
 Vec3 ContactGeometry::SmoothHeightMap::Impl::
 findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const {
-    assert(false);
-    return Vec3(NaN);
+    return findNearestPoint(position, updHint(), inside, normal);
+}
+
+// We minimize half the squared distance from P to the surface point
+// Q(x,y)=(x,y,f(x,y)) with Newton steps, falling back to Gauss-Newton steps
+// (which drop the curvature terms) where the full Hessian is not positive
+// definite, and halving any step that doesn't bring Q closer. Steps are
+// clamped to stay on the domain.
+Vec3 ContactGeometry::SmoothHeightMap::Impl::
+findNearestPoint(const Vec3& P, BicubicSurface::PatchHint& hint,
+                 bool& inside, UnitVec3& normal) const {
+    const int  MaxIterations = 20;
+    const int  MaxHalvings   = 10;
+    const Vec2 lo = surface.getMinXY(), hi = surface.getMaxXY();
+    const Real tol = SignificantReal*(1 + std::max(hi[0]-lo[0], hi[1]-lo[1]));
+    const Vec2 Pxy(P[0], P[1]);
+
+    Vec2 xy(clamp(lo[0], P[0], hi[0]), clamp(lo[1], P[1], hi[1]));
+    Real f; Vec2 df; Mat22 d2f;
+    calcHeightDerivatives(xy, hint, f, df, d2f);
+    inside = (xy == Pxy && P[2] < f);
+
+    Real dist2 = (xy-Pxy).normSqr() + square(f-P[2]);
+    for (int iter=0; iter < MaxIterations; ++iter) {
+        const Real rz = f - P[2];
+        const Vec2 g(xy[0]-P[0] + rz*df[0], xy[1]-P[1] + rz*df[1]);
+        const Mat22 JtJ(1+df[0]*df[0], df[0]*df[1],
+                        df[0]*df[1],   1+df[1]*df[1]);
+        Mat22 H = JtJ + rz*d2f;
+        if (!(H(0,0) > 0 && det(H) > 0))
+            H = JtJ; // always positive definite
+        const Vec2 fullStep = -(H.invert()*g);
+
+        // Take the step, or some fraction of it, if it gets us closer.
+        Vec2 next; Real nextf=f; Vec2 nextdf=df; Mat22 nextd2f=d2f;
+        Real step = 1, nextDist2 = Infinity;
+        for (int h=0; h <= MaxHalvings; ++h, step /= 2) {
+            next = xy + step*fullStep;
+            next[0] = clamp(lo[0], next[0], hi[0]);
+            next[1] = clamp(lo[1], next[1], hi[1]);
+            calcHeightDerivatives(next, hint, nextf, nextdf, nextd2f);
+            nextDist2 = (next-Pxy).normSqr() + square(nextf-P[2]);
+            if (nextDist2 <= dist2)
+                break;
+        }
+        if (!(nextDist2 <= dist2))
+            break; // can't improve; xy is as good as we'll get
+
+        const bool converged = (next-xy).norm() <= tol;
+        xy = next; f = nextf; df = nextdf; d2f = nextd2f; dist2 = nextDist2;
+        if (converged)
+            break;
+    }
+
+    normal = UnitVec3(-df[0], -df[1], 1);
+    return Vec3(xy[0], xy[1], f);
+}
+
+void ContactGeometry::SmoothHeightMap::Impl::
+calcHeightDerivatives(const Vec2& XY, BicubicSurface::PatchHint& hint,
+                      Real& f, Vec2& df, Mat22& d2f) const {
+    static const Array_<int> dx{0}, dy{1}, dxx{0,0}, dxy{0,1}, dyy{1,1};
+    // Asking for a second derivative first gets everything into the hint;
+    // the rest are then just lookups.
+    d2f(0,0) = surface.calcDerivative(dxx, XY, hint);
+    d2f(0,1) = d2f(1,0) = surface.calcDerivative(dxy, XY, hint);
+    d2f(1,1) = surface.calcDerivative(dyy, XY, hint);
+    df[0] = surface.calcDerivative(dx, XY, hint);
+    df[1] = surface.calcDerivative(dy, XY, hint);
+    f = surface.calcValue(XY, hint);
+}
+
+// Find the index of the patch column or row containing v, given the lower
+// knot of each; v's outside the range go to the first or last patch.
+static int findKnotInterval(const Array_<Real>& lowerKnots, Real v) {
+    const int i = (int)(std::upper_bound(lowerKnots.begin(), lowerKnots.end(),
+                                         v) - lowerKnots.begin()) - 1;
+    return clamp(0, i, (int)lowerKnots.size()-1);
+}
+
+Real ContactGeometry::SmoothHeightMap::Impl::
+calcMaxHeight(const Vec2& lo, const Vec2& hi) const {
+    const Vec2 minXY = surface.getMinXY(), maxXY = surface.getMaxXY();
+    if (   hi[0] < minXY[0] || lo[0] > maxXY[0]
+        || hi[1] < minXY[1] || lo[1] > maxXY[1])
+        return -Infinity;
+
+    const int nx = (int)knotX.size();
+    const int i0 = findKnotInterval(knotX, lo[0]);
+    const int i1 = findKnotInterval(knotX, hi[0]);
+    const int j0 = findKnotInterval(knotY, lo[1]);
+    const int j1 = findKnotInterval(knotY, hi[1]);
+    Real maxHeight = -Infinity;
+    for (int j=j0; j <= j1; ++j)
+        for (int i=i0; i <= i1; ++i)
+            maxHeight = std::max(maxHeight, patchMaxHeight[j*nx+i]);
+    return maxHeight;
 }
 
+// We march along the part of the ray that is over the domain in steps of
+// half the narrowest patch, looking for a change in the sign of the ray's
+// height above the surface, and then bisect that step. Steps that are 
+// entirely above calcMaxHeight() don't need the surface at all. A ray that
+// dips under and back out of the surface within a single step can be 
+// missed.
 bool ContactGeometry::SmoothHeightMap::Impl::intersectsRay
    (const Vec3& origin, const UnitVec3& direction, 
     Real& distance, UnitVec3& normal) const 
 {
-    assert(false);
+    const int  MaxBisections = 100;
+    const Vec2 lo = surface.getMinXY(), hi = surface.getMaxXY();
+    BicubicSurface::PatchHint& hint = updHint();
+
+    // Clip the ray to the domain.
+    Real tmin = 0, tmax = Infinity;
+    for (int i=0; i < 2; ++i) {
+        if (direction[i] == 0) {
+            if (origin[i] < lo[i] || origin[i] > hi[i])
+                return false;
+            continue;
+        }
+        const Real t1 = (lo[i]-origin[i])/direction[i];
+        const Real t2 = (hi[i]-origin[i])/direction[i];
+        tmin = std::max(tmin, std::min(t1,t2));
+        tmax = std::min(tmax, std::max(t1,t2));
+    }
+    if (tmin > tmax)
+        return false;
+
+    // The ray point at t, clamped to the domain since clipping can leave it
+    // just outside by roundoff, and its height above the surface.
+    const auto calcXY = [&](Real t) {
+        const Vec3 P = origin + t*direction;
+        return Vec2(clamp(lo[0], P[0], hi[0]), clamp(lo[1], P[1], hi[1]));
+    };
+    const auto calcGap = [&](Real t) {
+        return origin[2] + t*direction[2] - surface.calcValue(calcXY(t), hint);
+    };
+
+    if (tmax == Infinity) {
+        // A vertical ray; it crosses the surface right under its origin.
+        const Real t = -calcGap(0)/direction[2];
+        if (t < 0)
+            return false;
+        distance = t;
+        normal = surface.calcUnitNormal(Vec2(origin[0],origin[1]), hint);
+        return true;
+    }
+
+    const Real dt = minPatchWidth
+        / (2*std::sqrt(square(direction[0]) + square(direction[1])));
+    Real ta = tmin, ga = calcGap(ta);
+    bool found = (ga == 0);
+    while (!found && ta < tmax) {
+        const Real tb = std::min(ta+dt, tmax);
+        const Vec3 Pa = origin + ta*direction, Pb = origin + tb*direction;
+        if (ga > 0) {
+            const Real maxHeight = calcMaxHeight
+               (Vec2(std::min(Pa[0],Pb[0]), std::min(Pa[1],Pb[1])),
+                Vec2(std::max(Pa[0],Pb[0]), std::max(Pa[1],Pb[1])));
+            if (std::min(Pa[2],Pb[2]) > maxHeight) {
+                ta = tb; // only the sign of ga matters
+                continue;
+            }
+        }
+        const Real gb = calcGap(tb);
+        if (gb != 0 && (ga > 0) == (gb > 0)) {
+            ta = tb; ga = gb;
+            continue;
+        }
+
+        // The ray crosses the surface between ta and tb.
+        Real tlo = ta, thi = tb;
+        for (int i=0; i < MaxBisections 
+                      && thi-tlo > SignificantReal*std::max(Real(1),thi); ++i) 
+        {   const Real tmid = (tlo+thi)/2;
+            const Real gmid = calcGap(tmid);
+            if (gmid == 0) {tlo = thi = tmid; break;}
+            if ((gmid > 0) == (ga > 0)) tlo = tmid;
+            else                       thi = tmid;
+        }
+        ta = (tlo+thi)/2;
+        found = true;
+    }
+    if (!found)
+        return false;
+
+    distance = ta;
+    normal = surface.calcUnitNormal(calcXY(ta), hint);
     return true;
 }
 
@@ -30,15 +30,33 @@
 
 #include "ContactGeometryImpl.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
 #include <cmath>
-#include <map>
-#include <set>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The batched face kernels use AVX2 intrinsics when the compiler is targeting
+// a CPU that has them, with one face per lane. Otherwise the faces in a block
+// are processed one at a time.
+#if defined(__AVX2__) && SimTK_DEFAULT_PRECISION == 2
+    #include <immintrin.h>
+    #define SimTK_TRIANGLE_MESH_USE_AVX2
+#endif
+
+#ifdef _WIN32
+    #include <process.h>
+    #define SimTK_GETPID _getpid
+#else
+    #include <unistd.h>
+    #define SimTK_GETPID getpid
+#endif
 
 using namespace SimTK;
-using std::map;
-using std::pair;
-using std::set;
 using std::string;
 using std::cout; using std::endl;
 
@@ -183,9 +201,28 @@ bool ContactGeometry::TriangleMesh::intersectsRay
     return getImpl().intersectsRay(origin, direction, distance, face, uv);
 }
 
+int ContactGeometry::TriangleMesh::intersectsRays
+   (const ArrayViewConst_<Vec3>& origins, 
+    const ArrayViewConst_<UnitVec3>& directions, ArrayView_<Real> distances,
+    ArrayView_<int> faces, ArrayView_<Vec2> uv) const {
+    const int n = origins.size();
+    SimTK_APIARGCHECK_ALWAYS(   (int)directions.size() == n 
+                             && (int)distances.size() == n
+                             && (int)faces.size() == n 
+                             && (int)uv.size() == n,
+        "ContactGeometry::TriangleMesh", "intersectsRays",
+        "The arrays of rays and results must all have the same size.");
+    if (n == 0)
+        return 0;
+    return getImpl().intersectsRays(origins.begin(), directions.begin(), n,
+                                    distances.begin(), faces.begin(), 
+                                    uv.begin());
+}
+
 ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::getOBBTreeNode() const {
-    return OBBTreeNode(getImpl().obb);
+    const Impl& impl = getImpl();
+    return OBBTreeNode(impl.obbNodes[0], impl.obbTriangles.begin());
 }
 
 PolygonalMesh ContactGeometry::TriangleMesh::createPolygonalMesh() const {
@@ -194,6 +231,33 @@ PolygonalMesh ContactGeometry::TriangleMesh::createPolygonalMesh() const {
     return mesh;
 }
 
+void ContactGeometry::TriangleMesh::
+setCacheDirectory(const std::string& directory) {
+    Impl::setCacheDirectory(directory);
+}
+
+std::string ContactGeometry::TriangleMesh::getCacheDirectory() {
+    return Impl::getCacheDirectory();
+}
+
+void ContactGeometry::TriangleMesh::
+createDistanceField(Real cellSize, Real bandWidth, Real maxError) {
+    SimTK_APIARGCHECK3_ALWAYS(cellSize > 0 && bandWidth >= 0 && maxError >= 0,
+        "ContactGeometry::TriangleMesh", "createDistanceField",
+        "The cell size must be positive and the band width and error "
+        "nonnegative, but they were %g, %g and %g.", 
+        cellSize, bandWidth, maxError);
+    updImpl().createDistanceField(cellSize, bandWidth, maxError);
+}
+
+bool ContactGeometry::TriangleMesh::hasDistanceField() const {
+    return getImpl().hasDistanceField();
+}
+
+void ContactGeometry::TriangleMesh::clearDistanceField() {
+    updImpl().clearDistanceField();
+}
+
 const ContactGeometry::TriangleMesh::Impl& 
 ContactGeometry::TriangleMesh::getImpl() const {
     assert(impl);
@@ -246,9 +310,13 @@ UnitVec3 ContactGeometry::TriangleMesh::Impl::findNormalAtPoint
 
 Vec3 ContactGeometry::TriangleMesh::Impl::
 findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const {
+    Vec3 nearestPoint;
+    if (distanceField && distanceField->findNearestPoint(position, 
+                                            nearestPoint, inside, normal))
+        return nearestPoint;
     int face;
     Vec2 uv;
-    Vec3 nearestPoint = findNearestPoint(position, inside, face, uv);
+    nearestPoint = findNearestPoint(position, inside, face, uv);
     normal = findNormalAtPoint(face, uv);
     return nearestPoint;
 }
@@ -257,12 +325,59 @@ Vec3 ContactGeometry::TriangleMesh::Impl::
 findNearestPoint(const Vec3& position, bool& inside, int& face, Vec2& uv) const 
 {
     Real distance2;
-    Vec3 nearestPoint = obb.findNearestPoint(*this, position, MostPositiveReal, distance2, face, uv);
+    Vec3 nearestPoint = obbNodes[0].findNearestPoint(*this, position, MostPositiveReal, distance2, face, uv);
     Vec3 delta = position-nearestPoint;
     inside = (~delta*faces[face].normal < 0);
     return nearestPoint;
 }
 
+void ContactGeometry::TriangleMesh::Impl::
+findNearestPoints(const Vec3* positions, int n, Vec3* nearestPoints, 
+                  bool* inside, UnitVec3* normals) const 
+{   // Neighboring query points usually have nearby nearest points. The 
+    // distance from each point to the face that was nearest the previous one 
+    // bounds the distance to its own nearest face, which lets the tree search
+    // skip every box that is farther away than that. Those boxes could not 
+    // have held the answer, so the results are the same as for 
+    // findNearestPoint(). Points in the distance field, if any, don't need
+    // the search at all.
+    int face = -1;
+    for (int i = 0; i < n; i++) {
+        const Vec3& position = positions[i];
+        if (distanceField && distanceField->findNearestPoint(position, 
+                                nearestPoints[i], inside[i], normals[i]))
+            continue;
+        Vec2 uv;
+        nearestPoints[i] = findNearestPointWithHint(position, inside[i], 
+                                                    face, uv);
+        normals[i] = findNormalAtPoint(face, uv);
+    }
+}
+
+Vec3 ContactGeometry::TriangleMesh::Impl::
+findNearestPointWithHint(const Vec3& position, bool& inside, int& face, 
+                         Vec2& uv) const {
+    Real cutoff2 = MostPositiveReal;
+    const int hintFace = face;
+    Vec2 hintUV;
+    Vec3 hintPoint;
+    if (hintFace >= 0) {
+        hintPoint = findNearestPointToFace(position, hintFace, hintUV);
+        cutoff2 = (1+Real(1e-3))*(hintPoint-position).normSqr() + TinyReal;
+    }
+    Real distance2;
+    Vec3 nearest = obbNodes[0].findNearestPoint(*this, position, cutoff2, 
+                                                distance2, face, uv);
+    if (distance2 == MostPositiveReal) {
+        // Roundoff put even the hint's face just outside the cutoff.
+        nearest = hintPoint;
+        face = hintFace;
+        uv = hintUV;
+    }
+    inside = (~(position-nearest)*faces[face].normal < 0);
+    return nearest;
+}
+
 bool ContactGeometry::TriangleMesh::Impl::
 intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, 
               UnitVec3& normal) const {
@@ -278,9 +393,104 @@ bool ContactGeometry::TriangleMesh::Impl::
 intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, 
               int& face, Vec2& uv) const {
     Real boundsDistance;
-    if (!obb.bounds.intersectsRay(origin, direction, boundsDistance))
+    if (!obbNodes[0].bounds.intersectsRay(origin, direction, boundsDistance))
         return false;
-    return obb.intersectsRay(*this, origin, direction, distance, face, uv);
+    return obbNodes[0].intersectsRay(*this, origin, direction, distance, face, uv);
+}
+
+int ContactGeometry::TriangleMesh::Impl::
+intersectsRays(const Vec3* origins, const UnitVec3* directions, int count,
+               Real* distances, int* hitFaces, Vec2* uvs) const {
+    int numHits = 0;
+    for (int start = 0; start < count; start += RayPacketSize) {
+        const int n = std::min(RayPacketSize, count-start);
+        int active[RayPacketSize];
+        int numActive = 0;
+        for (int i = 0; i < n; i++) {
+            Real entry;
+            if (   obbNodes[0].bounds.intersectsRay(origins[start+i], 
+                                                    directions[start+i], entry)
+                && entry <= distances[start+i])
+                active[numActive++] = i;
+        }
+        if (numActive == 0)
+            continue;
+        const unsigned long long hits = obbNodes[0].intersectsRays(*this,
+            origins+start, directions+start, active, numActive, 
+            distances+start, hitFaces+start, uvs+start);
+        for (int i = 0; i < n; i++)
+            if (hits & (1ULL << i))
+                ++numHits;
+    }
+    return numHits;
+}
+
+// Find where a ray hits a face, if it does at a distance less than 
+// maxDistance. The ray must not be parallel to the face.
+bool ContactGeometry::TriangleMesh::Impl::
+intersectsRayWithFace(int face, const Vec3& origin, const UnitVec3& direction,
+                      Real maxDistance, Real& distance, Vec2& uv) const {
+    const Face& f = faces[face];
+    const UnitVec3& faceNormal = f.normal;
+    Real vd = ~faceNormal*direction;
+    if (vd == 0.0)
+        return false; // The ray is parallel to the plane.
+    const Vec3& vert1 = vertices[f.vertices[0]].pos;
+    Real v0 = ~faceNormal*(vert1-origin);
+    Real t = v0/vd;
+    if (t < 0)
+        return false; // Ray points away from plane of triangle.
+    if (t >= maxDistance)
+        return false; // We already have a closer intersection.
+
+    // Determine whether the intersection point is inside the triangle by 
+    // projecting onto a plane and computing the barycentric coordinates.
+
+    Vec3 ri = origin+direction*t;
+    const Vec3& vert2 = vertices[f.vertices[1]].pos;
+    const Vec3& vert3 = vertices[f.vertices[2]].pos;
+    int axis1, axis2;
+    if (std::abs(faceNormal[1]) > std::abs(faceNormal[0])) {
+        if (std::abs(faceNormal[2]) > std::abs(faceNormal[1])) {
+            axis1 = 0;
+            axis2 = 1;
+        }
+        else {
+            axis1 = 0;
+            axis2 = 2;
+        }
+    }
+    else {
+        if (std::abs(faceNormal[2]) > std::abs(faceNormal[0])) {
+            axis1 = 0;
+            axis2 = 1;
+        }
+        else {
+            axis1 = 1;
+            axis2 = 2;
+        }
+    }
+    Vec2 pos(ri[axis1]-vert1[axis1], ri[axis2]-vert1[axis2]);
+    Vec2 edge1(vert1[axis1]-vert2[axis1], vert1[axis2]-vert2[axis2]);
+    Vec2 edge2(vert1[axis1]-vert3[axis1], vert1[axis2]-vert3[axis2]);
+    Real denom = Real(1)/(edge1%edge2);
+    edge2 *= denom;
+    Real v = edge2%pos;
+    if (v < 0 || v > 1)
+        return false;
+    edge1 *= denom;
+    Real w = pos%edge1;
+    if (w < 0 || w > 1)
+        return false;
+    Real u = 1-v-w;
+    if (u < 0 || u > 1)
+        return false;
+    
+    // It intersects.
+    
+    distance = t;
+    uv = Vec2(u, v);
+    return true;
 }
 
 void ContactGeometry::TriangleMesh::Impl::
@@ -373,7 +583,7 @@ ContactGeometry::TriangleMesh::Impl::Impl
     // face's normal will be pointing back at us. If it is wrong, the face 
     // normal will also be pointing inwards, in roughly the same direction as 
     // the ray.
-    origin -= max(obb.bounds.getSize())*direction;
+    origin -= max(obbNodes[0].bounds.getSize())*direction;
     Real distance;
     int face;
     Vec2 uv;
@@ -399,22 +609,242 @@ ContactGeometry::TriangleMesh::Impl::Impl
     }
 }
 
+
+
+//==============================================================================
+//                      TRIANGLE MESH :: IMPL :: CACHE
+//==============================================================================
+// A cache file holds a CacheHeader, the bounding sphere, and then the raw
+// contents of the vertex, face, edge, OBB node and OBB triangle arrays, just
+// as init() leaves them. The header records the size of each element type so
+// that a file written by a differently laid out build is ignored.
+namespace {
+struct CacheHeader {
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   realSize, vertexSize, faceSize, edgeSize, nodeSize;
+    std::int32_t    numVertices, numFaces, numEdges, numNodes, numTriangles;
+};
+const char          CacheMagic[8] = {'S','i','m','T','K','O','B','B'};
+const std::uint32_t CacheVersion  = 1;
+
+std::mutex cacheDirectoryMutex;
+std::string& updCacheDirectory() {
+    static std::string directory;
+    return directory;
+}
+
+// Continue a 64 bit FNV-1a hash with some more bytes.
+unsigned long long hashBytes(const void* data, std::size_t size, 
+                             unsigned long long hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Return the name of the cache file for a mesh with these vertices and
+// faces, or an empty string if caching is off.
+string findCacheFileName(const Array_<Vec3>& vertexPositions, 
+                         const Array_<int>& faceIndices) {
+    const string directory = 
+        ContactGeometry::TriangleMesh::getCacheDirectory();
+    if (directory.empty())
+        return directory;
+    unsigned long long hash = 14695981039346656037ULL;
+    hash = hashBytes(vertexPositions.begin(), 
+                     vertexPositions.size()*sizeof(Vec3), hash);
+    hash = hashBytes(faceIndices.begin(), faceIndices.size()*sizeof(int), 
+                     hash);
+    char name[64];
+    std::snprintf(name, sizeof(name), "simbody-trianglemesh-%016llx.obb", 
+                  hash);
+    const char last = directory[directory.size()-1];
+    return directory + (last == '/' || last == '\\' ? "" : "/") + name;
+}
+
+// Read n elements into an array; "fill" is only used to size it.
+template <class T> 
+bool readCacheArray(std::FILE* file, int n, const T& fill, Array_<T>& array) {
+    array.resize(n, fill);
+    return n == 0 
+        || std::fread(array.begin(), sizeof(T), n, file) == std::size_t(n);
+}
+
+// Check that every element of an array of indices is in [lo, hi).
+bool isInRange(const int* first, const int* last, int lo, int hi) {
+    for (; first != last; ++first)
+        if (*first < lo || *first >= hi)
+            return false;
+    return true;
+}
+
+// A name for writing a cache file that no other thread or process will use.
+string makeTempCacheFileName(const string& fileName) {
+    static std::atomic<unsigned> count(0);
+    return fileName + "." + std::to_string((long long)SimTK_GETPID()) + "." 
+        + std::to_string(std::hash<std::thread::id>()
+                             (std::this_thread::get_id())) 
+        + "." + std::to_string(count++) + ".tmp";
+}
+
+template <class T> 
+bool writeCacheArray(std::FILE* file, const Array_<T>& array) {
+    return array.empty() 
+        || std::fwrite(array.begin(), sizeof(T), array.size(), file) 
+           == std::size_t(array.size());
+}
+}
+
+void ContactGeometry::TriangleMesh::Impl::
+setCacheDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(cacheDirectoryMutex);
+    updCacheDirectory() = directory;
+}
+
+std::string ContactGeometry::TriangleMesh::Impl::getCacheDirectory() {
+    std::lock_guard<std::mutex> lock(cacheDirectoryMutex);
+    return updCacheDirectory();
+}
+
+// Fill in the mesh from a cache file, returning false, with the mesh still
+// empty, if there is no usable file. Besides the header checks we compare
+// the cached vertex positions and faces against the ones we were given,
+// so a hash collision can't produce the wrong mesh, and check that every 
+// index in the derived arrays is in range, so a damaged file can't send the
+// queries outside them.
+bool ContactGeometry::TriangleMesh::Impl::readCache
+   (const std::string& fileName, const Array_<Vec3>& vertexPositions, 
+    const Array_<int>& faceIndices) 
+{   std::FILE* file = std::fopen(fileName.c_str(), "rb");
+    if (!file)
+        return false;
+    CacheHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+        && std::equal(CacheMagic, CacheMagic+8, header.magic)
+        && header.version == CacheVersion
+        && header.realSize == sizeof(Real)
+        && header.vertexSize == sizeof(Vertex)
+        && header.faceSize == sizeof(Face)
+        && header.edgeSize == sizeof(Edge)
+        && header.nodeSize == sizeof(OBBTreeNodeImpl)
+        && header.numVertices == (int)vertexPositions.size()
+        && 3*header.numFaces == (int)faceIndices.size()
+        && 2*header.numEdges == 3*header.numFaces
+        && header.numNodes > 0 && header.numNodes < 2*header.numFaces
+        && header.numTriangles == header.numFaces
+        && std::fread(&boundingSphereCenter, sizeof(Vec3), 1, file) == 1
+        && std::fread(&boundingSphereRadius, sizeof(Real), 1, file) == 1
+        && readCacheArray(file, header.numVertices, Vertex(Vec3(0)), vertices)
+        && readCacheArray(file, header.numFaces, 
+                          Face(0, 0, 0, UnitVec3(XAxis), 0), faces)
+        && readCacheArray(file, header.numEdges, Edge(0, 0, 0, 0), edges)
+        && readCacheArray(file, header.numNodes, OBBTreeNodeImpl(), obbNodes)
+        && readCacheArray(file, header.numTriangles, 0, obbTriangles);
+    std::fclose(file);
+    for (int i = 0; ok && i < (int)vertices.size(); i++)
+        ok = vertices[i].pos == vertexPositions[i];
+    for (int i = 0; ok && i < (int)faces.size(); i++)
+        ok = std::equal(faces[i].vertices, faces[i].vertices+3, 
+                        &faceIndices[3*i]);
+    const int numVertices = vertices.size(), numFaces = faces.size(), 
+              numEdges = edges.size(), numNodes = obbNodes.size();
+    ok = ok && isInRange(faceIndices.begin(), faceIndices.end(), 
+                         0, numVertices)
+         && isInRange(obbTriangles.begin(), obbTriangles.end(), 0, numFaces);
+    for (int i = 0; ok && i < numVertices; i++)
+        ok = vertices[i].firstEdge >= 0 && vertices[i].firstEdge < numEdges;
+    for (int i = 0; ok && i < numFaces; i++)
+        ok = isInRange(faces[i].edges, faces[i].edges+3, 0, numEdges);
+    for (int i = 0; ok && i < numEdges; i++)
+        ok = isInRange(edges[i].vertices, edges[i].vertices+2, 0, numVertices)
+             && isInRange(edges[i].faces, edges[i].faces+2, 0, numFaces);
+    // The tree is stored depth first, so a node's first child follows it and
+    // its second child comes after the first child's subtree.
+    for (int i = 0; ok && i < numNodes; i++) {
+        const OBBTreeNodeImpl& node = obbNodes[i];
+        ok = node.firstTriangle >= 0 && node.numTriangles >= 0
+             && node.numTriangles <= header.numTriangles - node.firstTriangle
+             && (node.secondChild == 0 
+                 || (node.secondChild > 1 
+                     && node.secondChild < numNodes - i));
+    }
+    if (!ok) {
+        vertices.clear();
+        faces.clear();
+        edges.clear();
+        obbNodes.clear();
+        obbTriangles.clear();
+    }
+    return ok;
+}
+
+// Write the cache file. The file is written under a temporary name unique to
+// this process and thread and then renamed, so that other threads or 
+// processes reading it never see a partial file. Failure isn't an error; the
+// mesh just won't be cached.
+void ContactGeometry::TriangleMesh::Impl::writeCache
+   (const std::string& fileName) const 
+{   CacheHeader header;
+    std::copy(CacheMagic, CacheMagic+8, header.magic);
+    header.version      = CacheVersion;
+    header.realSize     = sizeof(Real);
+    header.vertexSize   = sizeof(Vertex);
+    header.faceSize     = sizeof(Face);
+    header.edgeSize     = sizeof(Edge);
+    header.nodeSize     = sizeof(OBBTreeNodeImpl);
+    header.numVertices  = vertices.size();
+    header.numFaces     = faces.size();
+    header.numEdges     = edges.size();
+    header.numNodes     = obbNodes.size();
+    header.numTriangles = obbTriangles.size();
+
+    const string tempName = makeTempCacheFileName(fileName);
+    std::FILE* file = std::fopen(tempName.c_str(), "wb");
+    if (!file)
+        return;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(&boundingSphereCenter, sizeof(Vec3), 1, file) == 1
+        && std::fwrite(&boundingSphereRadius, sizeof(Real), 1, file) == 1
+        && writeCacheArray(file, vertices)
+        && writeCacheArray(file, faces)
+        && writeCacheArray(file, edges)
+        && writeCacheArray(file, obbNodes)
+        && writeCacheArray(file, obbTriangles);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(tempName.c_str(), fileName.c_str()) != 0)
+        std::remove(tempName.c_str());
+}
+
+
+
+//==============================================================================
+//                  TRIANGLE MESH :: IMPL :: CONSTRUCTION
+//==============================================================================
 void ContactGeometry::TriangleMesh::Impl::init
    (const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices) 
 {   SimTK_APIARGCHECK_ALWAYS(faceIndices.size()%3 == 0, 
         "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl", 
         "The number of indices must be a multiple of 3.");
     int numFaces = faceIndices.size()/3;
+
+    const std::string cacheFile = 
+        findCacheFileName(vertexPositions, faceIndices);
+    if (!cacheFile.empty() && readCache(cacheFile, vertexPositions, faceIndices))
+    {   createObbFaceCoords();
+        return;
+    }
     
     // Create the vertices.
     
     for (int i = 0; i < (int) vertexPositions.size(); i++)
         vertices.push_back(Vertex(vertexPositions[i]));
     
-    // Create the faces and build lists of all the edges.
+    // Create the faces.
     
-    map<pair<int, int>, int> forwardEdges;
-    map<pair<int, int>, int> backwardEdges;
+    faces.reserve(numFaces);
     for (int i = 0; i < numFaces; i++) {
         int start = i*3;
         int v1 = faceIndices[start], v2 = faceIndices[start+1], 
@@ -433,72 +863,8 @@ void ContactGeometry::TriangleMesh::Impl::init
             "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
             "Face %d is degenerate.", i);
         faces.push_back(Face(v1, v2, v3, cross, norm/2));
-        int edges[3][2] = {{v1, v2}, {v2, v3}, {v3, v1}};
-        for (int j = 0; j < 3; j++) {
-            SimTK_APIARGCHECK1_ALWAYS(edges[j][0] != edges[j][1], 
-                "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-                "Vertices %d appears twice in a single face.", edges[j][0]);
-            if (edges[j][0] < edges[j][1]) {
-                SimTK_APIARGCHECK2_ALWAYS
-                   (forwardEdges.find(pair<int, int>(edges[j][0], edges[j][1])) 
-                    == forwardEdges.end(),
-                    "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-                    "Multiple faces have an edge between vertices %d and %d"
-                    " in the same order.", edges[j][0], edges[j][1]);
-                forwardEdges[pair<int, int>(edges[j][0], edges[j][1])] = i;
-            }
-            else {
-                SimTK_APIARGCHECK2_ALWAYS
-                   (backwardEdges.find(pair<int, int>(edges[j][1], edges[j][0]))
-                    == backwardEdges.end(),
-                    "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-                    "Multiple faces have an edge between vertices %d and %d"
-                    " in the same order.", edges[j][1], edges[j][0]);
-                backwardEdges[pair<int, int>(edges[j][1], edges[j][0])] = i;
-            }
-        }
-    }
-    
-    // Create the edges.
-    
-    SimTK_APIARGCHECK_ALWAYS(forwardEdges.size() == backwardEdges.size(), 
-        "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-        "Each edge must be shared by exactly two faces.");
-    for (map<pair<int, int>, int>::iterator iter = forwardEdges.begin(); 
-         iter != forwardEdges.end(); ++iter) {
-        int vert1 = iter->first.first;
-        int vert2 = iter->first.second;
-        int face1 = iter->second;
-        map<pair<int, int>, int>::iterator iter2 = 
-            backwardEdges.find(pair<int, int>(vert1, vert2));
-        SimTK_APIARGCHECK_ALWAYS(iter2 != backwardEdges.end(), 
-            "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-            "Each edge must be shared by exactly two faces.");
-        int face2 = iter2->second;
-        edges.push_back(Edge(vert1, vert2, face1, face2));
-    }
-    
-    // Record the edges for each face.
-    
-    for (int i = 0; i < (int) edges.size(); i++) {
-        Edge& edge = edges[i];
-        int f[2] = {edge.faces[0], edge.faces[1]};
-        for (int j = 0; j < 2; j++) {
-            Face& face = faces[f[j]];
-            if ((edge.vertices[0] == face.vertices[0] || edge.vertices[0] == face.vertices[1]) &&
-                    (edge.vertices[1] == face.vertices[0] || edge.vertices[1] == face.vertices[1]))
-                face.edges[0] = i;
-            else if ((edge.vertices[0] == face.vertices[1] || edge.vertices[0] == face.vertices[2]) &&
-                    (edge.vertices[1] == face.vertices[1] || edge.vertices[1] == face.vertices[2]))
-                face.edges[1] = i;
-            else if ((edge.vertices[0] == face.vertices[2] || edge.vertices[0] == face.vertices[0]) &&
-                    (edge.vertices[1] == face.vertices[2] || edge.vertices[1] == face.vertices[0]))
-                face.edges[2] = i;
-            else
-                SimTK_ASSERT_ALWAYS(false, 
-                    "Face and edge vertices are inconsistent.");
-        }
     }
+    createEdges();
     
     // Record a single edge for each vertex.
     
@@ -534,7 +900,10 @@ void ContactGeometry::TriangleMesh::Impl::init
     Array_<int> allFaces(faces.size());
     for (int i = 0; i < (int) allFaces.size(); i++)
         allFaces[i] = i;
-    createObbTree(obb, allFaces);
+    obbNodes.reserve(2*faces.size());
+    obbTriangles.reserve(faces.size());
+    createObbTree(allFaces);
+    createObbFaceCoords();
     
     // Find the bounding sphere.
     Array_<const Vec3*> points(vertices.size());
@@ -543,95 +912,310 @@ void ContactGeometry::TriangleMesh::Impl::init
     const Geo::Sphere bnd = Geo::Point::calcBoundingSphereIndirect(points);
     boundingSphereCenter = bnd.getCenter();
     boundingSphereRadius = bnd.getRadius();
+
+    if (!cacheFile.empty())
+        writeCache(cacheFile);
 }
 
+// Each edge of each face is a half edge. Sorting the half edges by their
+// vertices puts the two halves of every edge next to each other, with the
+// one going from the lower numbered vertex to the higher one first. The 
+// edges come out ordered by their vertices, as they always have been.
+void ContactGeometry::TriangleMesh::Impl::createEdges() {
+    struct HalfEdge {
+        unsigned long long key; // lower vertex, higher vertex
+        int face, edge;         // face.edges[edge] is this one
+        bool operator<(const HalfEdge& other) const {
+            return key < other.key 
+                || (key == other.key && face < other.face);
+        }
+    };
+    const int numFaces = faces.size();
+    std::vector<HalfEdge> halfEdges(3*numFaces);
+    for (int i = 0; i < numFaces; i++) {
+        const int* v = faces[i].vertices;
+        for (int j = 0; j < 3; j++) {
+            const int from = v[j], to = v[(j+1)%3];
+            SimTK_APIARGCHECK1_ALWAYS(from != to, 
+                "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
+                "Vertices %d appears twice in a single face.", from);
+            const unsigned long long lo = std::min(from, to), 
+                                     hi = std::max(from, to);
+            halfEdges[3*i+j] = {(lo << 32) | hi, i, j};
+        }
+    }
+    std::sort(halfEdges.begin(), halfEdges.end());
+
+    // A half edge goes forward if its face lists the lower vertex first.
+    const auto isForward = [this](const HalfEdge& h) {
+        return faces[h.face].vertices[h.edge] == int(h.key >> 32);
+    };
+    const int numHalfEdges = halfEdges.size();
+    edges.reserve(numHalfEdges/2);
+    for (int i = 0; i < numHalfEdges; i += 2) {
+        const HalfEdge& first = halfEdges[i];
+        const int vert1 = int(first.key >> 32), vert2 = int(first.key);
+        const bool paired = 
+            i+1 < numHalfEdges && halfEdges[i+1].key == first.key;
+        if (paired)
+            SimTK_APIARGCHECK2_ALWAYS
+               (isForward(first) != isForward(halfEdges[i+1]),
+                "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
+                "Multiple faces have an edge between vertices %d and %d"
+                " in the same order.", vert1, vert2);
+        SimTK_APIARGCHECK_ALWAYS(paired 
+            && (i+2 == numHalfEdges || halfEdges[i+2].key != first.key), 
+            "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
+            "Each edge must be shared by exactly two faces.");
+        const HalfEdge& forward  = isForward(first) ? first : halfEdges[i+1];
+        const HalfEdge& backward = isForward(first) ? halfEdges[i+1] : first;
+        faces[forward.face].edges[forward.edge]   = edges.size();
+        faces[backward.face].edges[backward.edge] = edges.size();
+        edges.push_back(Edge(vert1, vert2, forward.face, backward.face));
+    }
+}
+
+
+
+//==============================================================================
+//                      TRIANGLE MESH :: IMPL :: OBB BUILDER
+//==============================================================================
+// Builds the OBB tree of a large mesh on several threads. The top levels of
+// the tree are built serially until the nodes are small enough; the subtree
+// under each of those is then built as a separate Task, in arrays of its own,
+// and finally all the pieces are copied into the mesh in depth-first order.
+// The result is the same tree the serial build makes.
+class ContactGeometry::TriangleMesh::Impl::ObbBuilder
+:   public ParallelExecutor::Task {
+public:
+    // Meshes with fewer faces than this are built serially.
+    static const int MinParallelFaces = 4096;
+
+    explicit ObbBuilder(Impl& mesh) : mesh(mesh), maxSubtreeFaces(0) {}
+
+    void build(const Array_<int>& faceIndices) {
+        // Aim for several subtrees per thread so the work stealing can even
+        // out their different sizes.
+        maxSubtreeFaces = std::max<int>(MinParallelFaces/8, 
+                                        faceIndices.size()/64);
+        const int root = addTopNode(faceIndices);
+        subtreeNodes.resize(subtreeFaces.size());
+        subtreeTriangles.resize(subtreeFaces.size());
+        ParallelExecutor executor;
+        executor.setScheduling(ParallelExecutor::WorkStealingScheduling);
+        executor.execute(*this, subtreeFaces.size());
+        appendTopNode(root);
+    }
+
+    void execute(int index) override {
+        mesh.createObbSubtree(subtreeFaces[index], subtreeNodes[index], 
+                              subtreeTriangles[index]);
+    }
+
+private:
+    // A node in the top levels. It has two children among the top nodes,
+    // or is the root of a subtree built by a Task, or is a leaf.
+    struct TopNode {
+        OrientedBoundingBox bounds;
+        int                 numTriangles;
+        int                 children[2];
+        int                 subtree;
+        Array_<int>         leafFaces;
+    };
+
+    int addTopNode(const Array_<int>& faceIndices) {
+        const int index = topNodes.size();
+        topNodes.emplace_back();
+        topNodes[index].numTriangles = faceIndices.size();
+        topNodes[index].children[0] = topNodes[index].children[1] = -1;
+        topNodes[index].subtree = -1;
+        if ((int)faceIndices.size() <= maxSubtreeFaces) {
+            topNodes[index].subtree = subtreeFaces.size();
+            subtreeFaces.push_back(faceIndices);
+            return index;
+        }
+        OrientedBoundingBox bounds;
+        Array_<int> child1Indices, child2Indices;
+        const bool split = mesh.createObbNode(faceIndices, bounds, 
+                                              child1Indices, child2Indices);
+        topNodes[index].bounds = bounds;
+        if (!split) {
+            topNodes[index].leafFaces = faceIndices;
+            return index;
+        }
+        const int child1 = addTopNode(child1Indices);
+        const int child2 = addTopNode(child2Indices);
+        topNodes[index].children[0] = child1;
+        topNodes[index].children[1] = child2;
+        return index;
+    }
+
+    void appendTopNode(int index) {
+        const TopNode& top = topNodes[index];
+        Array_<OBBTreeNodeImpl>& nodes = mesh.obbNodes;
+        Array_<int>& triangles = mesh.obbTriangles;
+        if (top.subtree >= 0) {
+            const int firstTriangle = triangles.size();
+            for (OBBTreeNodeImpl node : subtreeNodes[top.subtree]) {
+                node.firstTriangle += firstTriangle;
+                nodes.push_back(node);
+            }
+            const Array_<int>& subtree = subtreeTriangles[top.subtree];
+            triangles.insert(triangles.end(), subtree.begin(), subtree.end());
+            return;
+        }
+        const int nodeIndex = nodes.size();
+        nodes.push_back(OBBTreeNodeImpl());
+        nodes[nodeIndex].bounds = top.bounds;
+        nodes[nodeIndex].numTriangles = top.numTriangles;
+        nodes[nodeIndex].firstTriangle = triangles.size();
+        if (top.children[0] < 0) {
+            triangles.insert(triangles.end(), top.leafFaces.begin(), 
+                             top.leafFaces.end());
+            return;
+        }
+        appendTopNode(top.children[0]);
+        nodes[nodeIndex].secondChild = nodes.size()-nodeIndex;
+        appendTopNode(top.children[1]);
+    }
+
+    Impl&                           mesh;
+    int                             maxSubtreeFaces;
+    Array_<TopNode>                 topNodes;
+    Array_<Array_<int> >            subtreeFaces;
+    Array_<Array_<OBBTreeNodeImpl> > subtreeNodes;
+    Array_<Array_<int> >            subtreeTriangles;
+};
+
 void ContactGeometry::TriangleMesh::Impl::createObbTree
-   (OBBTreeNodeImpl& node, const Array_<int>& faceIndices) 
+   (const Array_<int>& faceIndices) 
+{   if ((int)faceIndices.size() < ObbBuilder::MinParallelFaces)
+        createObbSubtree(faceIndices, obbNodes, obbTriangles);
+    else
+        ObbBuilder(*this).build(faceIndices);
+}
+
+// Append the subtree containing the given faces to the end of the node array.
+// The nodes are created in depth-first order, so a node's triangles and those
+// of its descendants end up contiguous in the triangle index array.
+void ContactGeometry::TriangleMesh::Impl::createObbSubtree
+   (const Array_<int>& faceIndices, Array_<OBBTreeNodeImpl>& nodes,
+    Array_<int>& triangles) const
+{   const int nodeIndex = nodes.size();
+    nodes.push_back(OBBTreeNodeImpl());
+    nodes[nodeIndex].numTriangles = faceIndices.size();
+    nodes[nodeIndex].firstTriangle = triangles.size();
+    OrientedBoundingBox bounds;
+    Array_<int> child1Indices, child2Indices;
+    const bool split = createObbNode(faceIndices, bounds, 
+                                     child1Indices, child2Indices);
+    nodes[nodeIndex].bounds = bounds;
+    if (split) {
+        createObbSubtree(child1Indices, nodes, triangles);
+        nodes[nodeIndex].secondChild = nodes.size()-nodeIndex;
+        createObbSubtree(child2Indices, nodes, triangles);
+        return;
+    }
+    
+    // This is a leaf node.
+    
+    triangles.insert(triangles.end(), faceIndices.begin(), faceIndices.end());
+}
+
+bool ContactGeometry::TriangleMesh::Impl::createObbNode
+   (const Array_<int>& faceIndices, OrientedBoundingBox& bounds,
+    Array_<int>& child1Indices, Array_<int>& child2Indices) const
 {   // Find all vertices in the node and build the OrientedBoundingBox.
-    node.numTriangles = faceIndices.size();
-    set<int> vertexIndices;
+    Array_<int> vertexIndices;
+    vertexIndices.reserve(3*faceIndices.size());
     for (int i = 0; i < (int) faceIndices.size(); i++) 
         for (int j = 0; j < 3; j++)
-            vertexIndices.insert(faces[faceIndices[i]].vertices[j]);
-    Vector_<Vec3> points((int)vertexIndices.size());
-    int index = 0;
-    for (set<int>::iterator iter = vertexIndices.begin(); 
-                            iter != vertexIndices.end(); ++iter)
-        points[index++] = vertices[*iter].pos;
-    node.bounds = OrientedBoundingBox(points);
-    if (faceIndices.size() > 3) {
-
-        // Order the axes by size.
-
-        int axisOrder[3];
-        const Vec3& size = node.bounds.getSize();
-        if (size[0] > size[1]) {
-            if (size[0] > size[2]) {
-                axisOrder[0] = 0;
-                if (size[1] > size[2]) {
-                    axisOrder[1] = 1;
-                    axisOrder[2] = 2;
-                }
-                else {
-                    axisOrder[1] = 2;
-                    axisOrder[2] = 1;
-                }
+            vertexIndices.push_back(faces[faceIndices[i]].vertices[j]);
+    std::sort(vertexIndices.begin(), vertexIndices.end());
+    const int numPoints = (int)(std::unique(vertexIndices.begin(), 
+                                            vertexIndices.end()) 
+                                - vertexIndices.begin());
+    Vector_<Vec3> points(numPoints);
+    for (int i = 0; i < numPoints; i++)
+        points[i] = vertices[vertexIndices[i]].pos;
+    bounds = OrientedBoundingBox(points);
+    if (faceIndices.size() <= 3)
+        return false;
+
+    // Order the axes by size.
+
+    int axisOrder[3];
+    const Vec3 size = bounds.getSize();
+    if (size[0] > size[1]) {
+        if (size[0] > size[2]) {
+            axisOrder[0] = 0;
+            if (size[1] > size[2]) {
+                axisOrder[1] = 1;
+                axisOrder[2] = 2;
             }
             else {
-                axisOrder[0] = 2;
-                axisOrder[1] = 0;
+                axisOrder[1] = 2;
                 axisOrder[2] = 1;
             }
         }
-        else if (size[0] > size[2]) {
-            axisOrder[0] = 1;
+        else {
+            axisOrder[0] = 2;
             axisOrder[1] = 0;
-            axisOrder[2] = 2;
+            axisOrder[2] = 1;
+        }
+    }
+    else if (size[0] > size[2]) {
+        axisOrder[0] = 1;
+        axisOrder[1] = 0;
+        axisOrder[2] = 2;
+    }
+    else {
+        if (size[1] > size[2]) {
+            axisOrder[0] = 1;
+            axisOrder[1] = 2;
         }
         else {
-            if (size[1] > size[2]) {
-                axisOrder[0] = 1;
-                axisOrder[1] = 2;
-            }
-            else {
-                axisOrder[0] = 2;
-                axisOrder[1] = 1;
-            }
-            axisOrder[2] = 0;
+            axisOrder[0] = 2;
+            axisOrder[1] = 1;
         }
+        axisOrder[2] = 0;
+    }
 
-        // Try splitting along each axis.
+    // Try splitting along each axis.
 
-        for (int i = 0; i < 3; i++) {
-            Array_<int> child1Indices, child2Indices;
-            splitObbAxis(faceIndices, child1Indices, child2Indices, 
-                         axisOrder[i]);
-            if (child1Indices.size() > 0 && child2Indices.size() > 0) {
-                // It was successfully split, so create the child nodes.
-
-                node.child1 = new OBBTreeNodeImpl();
-                node.child2 = new OBBTreeNodeImpl();
-                createObbTree(*node.child1, child1Indices);
-                createObbTree(*node.child2, child2Indices);
-                return;
-            }
+    for (int i = 0; i < 3; i++) {
+        child1Indices.clear();
+        child2Indices.clear();
+        splitObbAxis(faceIndices, child1Indices, child2Indices, 
+                     axisOrder[i]);
+        if (child1Indices.size() > 0 && child2Indices.size() > 0)
+            return true;
+    }
+    return false;
+}
+
+void ContactGeometry::TriangleMesh::Impl::createObbFaceCoords() {
+    const int n = obbTriangles.size();
+    obbFaceStride = n + FaceBlockSize-1;
+    obbFaceCoords.assign(9*obbFaceStride, Real(0));
+    for (int i = 0; i < n; i++) {
+        const Face& face = faces[obbTriangles[i]];
+        for (int j = 0; j < 3; j++) {
+            const Vec3& pos = vertices[face.vertices[j]].pos;
+            for (int k = 0; k < 3; k++)
+                obbFaceCoords[(3*j+k)*obbFaceStride + i] = pos[k];
         }
     }
-    
-    // This is a leaf node.
-    
-    node.triangles.insert(node.triangles.begin(), faceIndices.begin(), 
-                          faceIndices.end());
 }
 
 void ContactGeometry::TriangleMesh::Impl::splitObbAxis
    (const Array_<int>& parentIndices, Array_<int>& child1Indices, 
-    Array_<int>& child2Indices, int axis) 
+    Array_<int>& child2Indices, int axis) const
 {   // For each face, find its minimum and maximum extent along the axis.
     Vector minExtent(parentIndices.size());
     Vector maxExtent(parentIndices.size());
     for (int i = 0; i < (int) parentIndices.size(); i++) {
-        int* vertexIndices = faces[parentIndices[i]].vertices;
+        const int* vertexIndices = faces[parentIndices[i]].vertices;
         Real minVal = vertices[vertexIndices[0]].pos[axis];
         Real maxVal = vertices[vertexIndices[0]].pos[axis];
         minVal = std::min(minVal, vertices[vertexIndices[1]].pos[axis]);
@@ -659,16 +1243,14 @@ void ContactGeometry::TriangleMesh::Impl::splitObbAxis
     }
 }
 
-Vec3 ContactGeometry::TriangleMesh::Impl::findNearestPointToFace
-   (const Vec3& position, int face, Vec2& uv) const {
-    // Calculate the distance between a point in space and a face of the mesh.
+// Find the point on the triangle (vert1, vert2, vert3) nearest to position.
+static Vec3 findNearestPointOnTriangle
+   (const Vec3& vert1, const Vec3& vert2, const Vec3& vert3, 
+    const Vec3& position, Vec2& uv) {
+    // Calculate the distance between a point in space and a triangle.
     // This algorithm is based on a description by David Eberly found at 
     // http://www.geometrictools.com/Documentation/DistancePoint3Triangle3.pdf.
     
-    const ContactGeometry::TriangleMesh::Impl::Face& fc = faces[face];
-    const Vec3& vert1 = vertices[fc.vertices[0]].pos;
-    const Vec3& vert2 = vertices[fc.vertices[1]].pos;
-    const Vec3& vert3 = vertices[fc.vertices[2]].pos;
     const Vec3 e0 = vert2-vert1;
     const Vec3 e1 = vert3-vert1;
     const Vec3 delta = vert1-position;
@@ -677,7 +1259,6 @@ Vec3 ContactGeometry::TriangleMesh::Impl::findNearestPointToFace
     const Real c = e1.normSqr();
     const Real d = ~e0*delta;
     const Real e = ~e1*delta;
-    const Real f = delta.normSqr();
     const Real det = a*c-b*b;
     Real s = b*e-c*d;
     Real t = b*d-a*e;
@@ -767,63 +1348,488 @@ Vec3 ContactGeometry::TriangleMesh::Impl::findNearestPointToFace
 }
 
 
+Vec3 ContactGeometry::TriangleMesh::Impl::findNearestPointToFace
+   (const Vec3& position, int face, Vec2& uv) const {
+    const ContactGeometry::TriangleMesh::Impl::Face& fc = faces[face];
+    return findNearestPointOnTriangle(vertices[fc.vertices[0]].pos, 
+                                      vertices[fc.vertices[1]].pos,
+                                      vertices[fc.vertices[2]].pos, 
+                                      position, uv);
+}
+
+#ifdef SimTK_TRIANGLE_MESH_USE_AVX2
+namespace {
+// One Real for each of four faces.
+struct Lanes {
+    Lanes() {}
+    Lanes(__m256d x) : x(x) {}
+    explicit Lanes(Real r) : x(_mm256_set1_pd(r)) {}
+    __m256d x;
+};
+
+inline Lanes select(Lanes mask, Lanes ifTrue, Lanes ifFalse) 
+{   return _mm256_blendv_pd(ifFalse.x, ifTrue.x, mask.x); }
+inline Lanes operator+(Lanes a, Lanes b) {return _mm256_add_pd(a.x, b.x);}
+inline Lanes operator-(Lanes a, Lanes b) {return _mm256_sub_pd(a.x, b.x);}
+inline Lanes operator*(Lanes a, Lanes b) {return _mm256_mul_pd(a.x, b.x);}
+inline Lanes operator/(Lanes a, Lanes b) {return _mm256_div_pd(a.x, b.x);}
+inline Lanes operator-(Lanes a) 
+{   return _mm256_xor_pd(a.x, _mm256_set1_pd(-0.0)); }
+inline Lanes operator&(Lanes a, Lanes b) {return _mm256_and_pd(a.x, b.x);}
+inline Lanes operator|(Lanes a, Lanes b) {return _mm256_or_pd(a.x, b.x);}
+inline Lanes operator<(Lanes a, Lanes b) 
+{   return _mm256_cmp_pd(a.x, b.x, _CMP_LT_OQ); }
+inline Lanes operator<=(Lanes a, Lanes b) 
+{   return _mm256_cmp_pd(a.x, b.x, _CMP_LE_OQ); }
+inline Lanes operator>(Lanes a, Lanes b) 
+{   return _mm256_cmp_pd(a.x, b.x, _CMP_GT_OQ); }
+inline Lanes operator>=(Lanes a, Lanes b) 
+{   return _mm256_cmp_pd(a.x, b.x, _CMP_GE_OQ); }
+inline Lanes loadLanes(const Real* p) {return _mm256_loadu_pd(p);}
+
+// A Vec3 for each of four faces.
+struct Vec3Lanes {
+    Vec3Lanes() {}
+    Vec3Lanes(Lanes x, Lanes y, Lanes z) {v[0] = x; v[1] = y; v[2] = z;}
+    explicit Vec3Lanes(const Vec3& u) 
+    {   for (int i = 0; i < 3; i++) v[i] = Lanes(u[i]); }
+    Lanes v[3];
+};
+inline Vec3Lanes operator-(const Vec3Lanes& a, const Vec3Lanes& b) 
+{   return Vec3Lanes(a.v[0]-b.v[0], a.v[1]-b.v[1], a.v[2]-b.v[2]); }
+inline Lanes dot(const Vec3Lanes& a, const Vec3Lanes& b) 
+{   return a.v[0]*b.v[0] + a.v[1]*b.v[1] + a.v[2]*b.v[2]; }
+inline Vec3Lanes cross(const Vec3Lanes& a, const Vec3Lanes& b) {
+    return Vec3Lanes(a.v[1]*b.v[2] - a.v[2]*b.v[1],
+                     a.v[2]*b.v[0] - a.v[0]*b.v[2],
+                     a.v[0]*b.v[1] - a.v[1]*b.v[0]);
+}
+}
+#endif
+
+const int ContactGeometry::TriangleMesh::Impl::FaceBlockSize;
+
+void ContactGeometry::TriangleMesh::Impl::findNearestPointsToFaces
+   (const Vec3& position, const int* faces, int count, 
+    Vec3 points[], Vec2 uvs[]) const {
+    const int first = (int)(faces - obbTriangles.begin());
+    assert(0 <= first && first+count <= (int)obbTriangles.size());
+    assert(count <= FaceBlockSize);
+#ifdef SimTK_TRIANGLE_MESH_USE_AVX2
+    // This is findNearestPointOnTriangle() with every branch evaluated in
+    // all lanes, and the results for each lane's region selected afterwards.
+    Vec3Lanes vert[3];
+    for (int j = 0; j < 3; j++)
+        for (int k = 0; k < 3; k++)
+            vert[j].v[k] = loadLanes(getObbFaceCoords(j, k) + first);
+    const Vec3Lanes e0 = vert[1]-vert[0];
+    const Vec3Lanes e1 = vert[2]-vert[0];
+    const Vec3Lanes delta = vert[0]-Vec3Lanes(position);
+    const Lanes a = dot(e0, e0);
+    const Lanes b = dot(e0, e1);
+    const Lanes c = dot(e1, e1);
+    const Lanes d = dot(e0, delta);
+    const Lanes e = dot(e1, delta);
+    const Lanes det = a*c-b*b;
+    const Lanes s0 = b*e-c*d;
+    const Lanes t0 = b*d-a*e;
+    const Lanes zero(0), one(1), two(2);
+    const Lanes sNegative = s0 < zero;
+    const Lanes tNegative = t0 < zero;
+
+    // The nearest points on edges 0 and 1.
+    const Lanes sEdge = select(d >= zero, zero, 
+                               select(-d >= a, one, -d/a));
+    const Lanes tEdge = select(e >= zero, zero, 
+                               select(-e >= c, one, -e/c));
+
+    // Regions 0, 3, 4 and 5.
+    const Lanes invDet = one/det;
+    const Lanes s4 = select(d < zero, sEdge, zero);
+    const Lanes t4 = select(d < zero, zero, tEdge);
+    const Lanes sInside = select(sNegative, select(tNegative, s4, zero),
+                                            select(tNegative, sEdge, s0*invDet));
+    const Lanes tInside = select(sNegative, select(tNegative, t4, tEdge),
+                                            select(tNegative, zero, t0*invDet));
+
+    // Regions 1, 2 and 6.
+    const Lanes denom = a-two*b+c;
+    const Lanes temp0r2 = b+d, temp1r2 = c+e, numerr2 = temp1r2-temp0r2;
+    const Lanes s2 = select(temp1r2 > temp0r2, 
+                            select(numerr2 >= denom, one, numerr2/denom), zero);
+    const Lanes t2 = select(temp1r2 > temp0r2, one-s2,
+                            select(temp1r2 <= zero, one, 
+                                   select(e >= zero, zero, -e/c)));
+    const Lanes temp0r6 = b+e, temp1r6 = a+d, numerr6 = temp1r6-temp0r6;
+    const Lanes t6 = select(temp1r6 > temp0r6,
+                            select(numerr6 >= denom, one, numerr6/denom), zero);
+    const Lanes s6 = select(temp1r6 > temp0r6, one-t6,
+                            select(temp1r6 <= zero, one, 
+                                   select(e >= zero, zero, -d/a)));
+    const Lanes numerr1 = c+e-b-d;
+    const Lanes s1 = select(numerr1 <= zero, zero,
+                            select(numerr1 >= denom, one, numerr1/denom));
+    const Lanes t1 = one-s1;
+    const Lanes sOutside = select(sNegative, s2, select(tNegative, s6, s1));
+    const Lanes tOutside = select(sNegative, t2, select(tNegative, t6, t1));
+
+    const Lanes inside = s0+t0 <= det;
+    const Lanes s = select(inside, sInside, sOutside);
+    const Lanes t = select(inside, tInside, tOutside);
+    const Lanes u = one-s-t;
+    Real result[5][FaceBlockSize];
+    for (int k = 0; k < 3; k++)
+        _mm256_storeu_pd(result[k], (vert[0].v[k] + s*e0.v[k] + t*e1.v[k]).x);
+    _mm256_storeu_pd(result[3], u.x);
+    _mm256_storeu_pd(result[4], s.x);
+    for (int i = 0; i < count; i++) {
+        points[i] = Vec3(result[0][i], result[1][i], result[2][i]);
+        uvs[i] = Vec2(result[3][i], result[4][i]);
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        Vec3 vert[3];
+        for (int j = 0; j < 3; j++)
+            for (int k = 0; k < 3; k++)
+                vert[j][k] = getObbFaceCoords(j, k)[first+i];
+        points[i] = findNearestPointOnTriangle(vert[0], vert[1], vert[2], 
+                                               position, uvs[i]);
+    }
+#endif
+}
+
+unsigned ContactGeometry::TriangleMesh::Impl::findFacesOverlappingTriangle
+   (const Geo::Triangle& triangle, const int* faces, int count) const {
+    const int first = (int)(faces - obbTriangles.begin());
+    assert(0 <= first && first+count <= (int)obbTriangles.size());
+    assert(count <= FaceBlockSize);
+
+    // Most candidate pairs are rejected because one triangle lies entirely
+    // on one side of the other's plane. Those are the first two tests of 
+    // Geo::Triangle::overlapsTriangle(), which are repeated here with the 
+    // same arithmetic for all faces at once. Only the faces that survive 
+    // them get the full test.
+    unsigned candidates = 0;
+#ifdef SimTK_TRIANGLE_MESH_USE_AVX2
+    const Vec3Lanes p1(triangle.getVertex(0));
+    const Vec3Lanes q1(triangle.getVertex(1));
+    const Vec3Lanes r1(triangle.getVertex(2));
+    Vec3Lanes vert[3];
+    for (int j = 0; j < 3; j++)
+        for (int k = 0; k < 3; k++)
+            vert[j].v[k] = loadLanes(getObbFaceCoords(j, k) + first);
+    const Vec3Lanes& p2 = vert[0];
+    const Vec3Lanes& q2 = vert[1];
+    const Vec3Lanes& r2 = vert[2];
+    const Lanes zero(0);
+
+    const Vec3Lanes n2 = cross(p2-r2, q2-r2);
+    const Lanes dp1 = dot(p1-r2, n2);
+    const Lanes dq1 = dot(q1-r2, n2);
+    const Lanes dr1 = dot(r1-r2, n2);
+    const Lanes separated1 = (dp1*dq1 > zero) & (dp1*dr1 > zero);
+
+    const Vec3Lanes n1 = cross(q1-p1, r1-p1);
+    const Lanes dp2 = dot(p2-r1, n1);
+    const Lanes dq2 = dot(q2-r1, n1);
+    const Lanes dr2 = dot(r2-r1, n1);
+    const Lanes separated2 = (dp2*dq2 > zero) & (dp2*dr2 > zero);
+
+    candidates = ~(unsigned)_mm256_movemask_pd((separated1 | separated2).x);
+#else
+    candidates = ~0u;
+#endif
+    candidates &= (1u << count)-1;
+    
+    unsigned overlapping = 0;
+    for (int i = 0; i < count; i++) {
+        if (!(candidates & (1u << i)))
+            continue;
+        Vec3 vert[3];
+        for (int j = 0; j < 3; j++)
+            for (int k = 0; k < 3; k++)
+                vert[j][k] = getObbFaceCoords(j, k)[first+i];
+        if (triangle.overlapsTriangle(Geo::Triangle(vert[0], vert[1], vert[2])))
+            overlapping |= 1u << i;
+    }
+    return overlapping;
+}
+
+
 //==============================================================================
-//                            OBB TREE NODE IMPL
+//                  TRIANGLE MESH :: IMPL :: DISTANCE FIELD
 //==============================================================================
 
-OBBTreeNodeImpl::OBBTreeNodeImpl(const OBBTreeNodeImpl& copy) 
-:   bounds(copy.bounds), triangles(copy.triangles), 
-    numTriangles(copy.numTriangles) {
-    if (copy.child1 == NULL) {
-        child1 = NULL;
-        child2 = NULL;
+ContactGeometry::TriangleMesh::Impl::DistanceField::DistanceField
+   (const Impl& mesh, Real cellSize, Real bandWidth, Real maxError)
+:   mesh(&mesh), cellSize(cellSize), bandWidth(bandWidth), 
+    maxError(maxError)
+{   // The grid covers the mesh's bounding box plus the band and a cell of 
+    // slack on every side.
+    Vec3 lo(Infinity), hi(-Infinity);
+    for (const Vertex& v : mesh.vertices)
+        for (int i = 0; i < 3; i++) {
+            lo[i] = std::min(lo[i], v.pos[i]);
+            hi[i] = std::max(hi[i], v.pos[i]);
+        }
+    const Real margin = bandWidth + cellSize;
+    origin = lo - Vec3(margin);
+    for (int i = 0; i < 3; i++) {
+        const Real n = std::ceil((hi[i]-lo[i] + 2*margin)/cellSize) + 1;
+        SimTK_APIARGCHECK1_ALWAYS(n < (1 << 20), 
+            "ContactGeometry::TriangleMesh", "createDistanceField",
+            "A cell size of %g needs too many grid points to cover the mesh.",
+            cellSize);
+        dims[i] = (int)n;
     }
-    else {
-        child1 = new OBBTreeNodeImpl(*copy.child1);
-        child2 = new OBBTreeNodeImpl(*copy.child2);
+
+    // Every cell that might be within the band of some face is a candidate.
+    for (const Face& f : mesh.faces) {
+        Vec3 flo(Infinity), fhi(-Infinity);
+        for (int v = 0; v < 3; v++)
+            for (int i = 0; i < 3; i++) {
+                flo[i] = std::min(flo[i], mesh.vertices[f.vertices[v]].pos[i]);
+                fhi[i] = std::max(fhi[i], mesh.vertices[f.vertices[v]].pos[i]);
+            }
+        int clo[3], chi[3];
+        for (int i = 0; i < 3; i++) {
+            clo[i] = std::max(0, 
+                (int)std::floor((flo[i]-bandWidth-origin[i])/cellSize));
+            chi[i] = std::min(dims[i]-2, 
+                (int)std::floor((fhi[i]+bandWidth-origin[i])/cellSize));
+        }
+        for (int k = clo[2]; k <= chi[2]; k++)
+            for (int j = clo[1]; j <= chi[1]; j++)
+                for (int i = clo[0]; i <= chi[0]; i++)
+                    cellKeys.push_back(getKey(i, j, k));
+    }
+    std::sort(cellKeys.begin(), cellKeys.end());
+    cellKeys.erase(std::unique(cellKeys.begin(), cellKeys.end()), 
+                   cellKeys.end());
+
+    // Their corners are the grid points that need samples.
+    const Key cornerOffsets[8] = 
+       {0, getKey(1,0,0), getKey(0,1,0), getKey(1,1,0),
+        getKey(0,0,1), getKey(1,0,1), getKey(0,1,1), getKey(1,1,1)};
+    pointKeys.reserve(8*cellKeys.size());
+    for (Key cell : cellKeys)
+        for (Key offset : cornerOffsets)
+            pointKeys.push_back(cell + offset);
+    std::sort(pointKeys.begin(), pointKeys.end());
+    pointKeys.erase(std::unique(pointKeys.begin(), pointKeys.end()), 
+                    pointKeys.end());
+    cellCorners.resize(8*cellKeys.size());
+    for (int c = 0; c < (int)cellKeys.size(); c++)
+        for (int v = 0; v < 8; v++)
+            cellCorners[8*c+v] = int(std::lower_bound(pointKeys.begin(), 
+                pointKeys.end(), cellKeys[c]+cornerOffsets[v]) 
+                - pointKeys.begin());
+
+    // Sample the grid points, then check the cells, on all threads.
+    ParallelExecutor executor;
+    executor.setScheduling(ParallelExecutor::WorkStealingScheduling);
+    samples.resize(pointKeys.size());
+    phase = 0;
+    executor.execute(*this, (pointKeys.size()+BlockSize-1)/BlockSize);
+    cellIsGood.resize(cellKeys.size());
+    phase = 1;
+    executor.execute(*this, (cellKeys.size()+BlockSize-1)/BlockSize);
+
+    // Keep the good cells, and only the corners they use.
+    Array_<int> newIndex(samples.size(), -1);
+    Array_<Sample> usedSamples;
+    Array_<int> usedCorners;
+    for (int c = 0; c < (int)cellKeys.size(); c++) {
+        if (!cellIsGood[c])
+            continue;
+        cells[cellKeys[c]] = usedCorners.size();
+        for (int v = 0; v < 8; v++) {
+            int& index = newIndex[cellCorners[8*c+v]];
+            if (index < 0) {
+                index = usedSamples.size();
+                usedSamples.push_back(samples[cellCorners[8*c+v]]);
+            }
+            usedCorners.push_back(index);
+        }
+    }
+    samples.swap(usedSamples);
+    samples.shrink_to_fit();
+    cellCorners.swap(usedCorners);
+    cellCorners.shrink_to_fit();
+    pointKeys.clear(); pointKeys.shrink_to_fit();
+    cellKeys.clear(); cellKeys.shrink_to_fit();
+    cellIsGood.clear(); cellIsGood.shrink_to_fit();
+    this->mesh = nullptr;
+}
+
+void ContactGeometry::TriangleMesh::Impl::DistanceField::execute(int block) {
+    // The keys are sorted, so consecutive points and cells are neighbors 
+    // along x and usually share a nearest face.
+    const int count = phase == 0 ? (int)pointKeys.size() 
+                                 : (int)cellKeys.size();
+    const int end = std::min(count, (block+1)*BlockSize);
+    int face = -1;
+    for (int i = block*BlockSize; i < end; i++) {
+        if (phase == 0)
+            calcSample(i, face);
+        else
+            cellIsGood[i] = checkCell(i, face);
+    }
+}
+
+void ContactGeometry::TriangleMesh::Impl::DistanceField::
+calcSample(int index, int& face) {
+    const Vec3 point = getPoint(pointKeys[index]);
+    bool inside;
+    Vec2 uv;
+    Sample& sample = samples[index];
+    sample.nearestPoint = mesh->findNearestPointWithHint(point, inside, 
+                                                         face, uv);
+    const Real distance = (point-sample.nearestPoint).norm();
+    sample.distance = inside ? -distance : distance;
+    sample.normal = mesh->findNormalAtPoint(face, uv).asVec3();
+}
+
+// A cell is kept if it comes within the band and its interpolated answers
+// match the exact ones at its center and the centers of its faces and of
+// its octants.
+bool ContactGeometry::TriangleMesh::Impl::DistanceField::
+checkCell(int index, int& face) const {
+    const int* corners = &cellCorners[8*index];
+    Real nearestCorner = Infinity;
+    for (int v = 0; v < 8; v++)
+        nearestCorner = std::min(nearestCorner, 
+                                 std::abs(samples[corners[v]].distance));
+    if (nearestCorner > bandWidth)
+        return false;
+
+    const Vec3 cellOrigin = getPoint(cellKeys[index]);
+    const Vec3 testPoints[15] = 
+       {Vec3(.5,.5,.5), Vec3(0,.5,.5), Vec3(1,.5,.5), Vec3(.5,0,.5),
+        Vec3(.5,1,.5), Vec3(.5,.5,0), Vec3(.5,.5,1),
+        Vec3(.25,.25,.25), Vec3(.75,.25,.25), Vec3(.25,.75,.25),
+        Vec3(.75,.75,.25), Vec3(.25,.25,.75), Vec3(.75,.25,.75),
+        Vec3(.25,.75,.75), Vec3(.75,.75,.75)};
+    for (const Vec3& t : testPoints) {
+        const Vec3 position = cellOrigin + cellSize*t;
+        Vec3 nearest;
+        bool inside;
+        UnitVec3 normal;
+        if (!interpolate(corners, position, cellOrigin, nearest, inside, 
+                         normal))
+            return false;
+        bool exactInside;
+        Vec2 uv;
+        const Vec3 exact = mesh->findNearestPointWithHint(position, 
+                                                exactInside, face, uv);
+        // The error peaks where the nearest point's kinks cross the cell,
+        // which may be between the test points, so leave a margin.
+        if ((nearest-exact).norm() > maxError/2)
+            return false;
+        // Right at the surface either answer for inside is acceptable.
+        if (inside != exactInside && (position-exact).norm() > maxError)
+            return false;
+    }
+    return true;
+}
+
+bool ContactGeometry::TriangleMesh::Impl::DistanceField::
+interpolate(const int corners[8], const Vec3& position, 
+            const Vec3& cellOrigin, Vec3& nearestPoint, bool& inside, 
+            UnitVec3& normal) const {
+    const Vec3 f = (position-cellOrigin)/cellSize;
+    const Vec3 g = Vec3(1)-f;
+    const Real weights[8] = 
+       {g[0]*g[1]*g[2], f[0]*g[1]*g[2], g[0]*f[1]*g[2], f[0]*f[1]*g[2],
+        g[0]*g[1]*f[2], f[0]*g[1]*f[2], g[0]*f[1]*f[2], f[0]*f[1]*f[2]};
+    Real distance = 0;
+    Vec3 nearestSum(0), normalSum(0);
+    for (int v = 0; v < 8; v++) {
+        const Sample& sample = samples[corners[v]];
+        nearestSum += weights[v]*sample.nearestPoint;
+        distance   += weights[v]*sample.distance;
+        normalSum  += weights[v]*sample.normal;
+    }
+    if (std::abs(distance) > bandWidth)
+        return false;
+    // The samples' normals can cancel across a thin wall; such cells don't 
+    // survive checkCell() anyway.
+    const Real normalNorm = normalSum.norm();
+    if (normalNorm < Real(0.5))
+        return false;
+    nearestPoint = nearestSum;
+    inside = (distance < 0);
+    normal = UnitVec3(normalSum/normalNorm, true);
+    return true;
+}
+
+bool ContactGeometry::TriangleMesh::Impl::DistanceField::
+findNearestPoint(const Vec3& position, Vec3& nearestPoint, bool& inside, 
+                 UnitVec3& normal) const {
+    int ijk[3];
+    for (int i = 0; i < 3; i++) {
+        const Real x = std::floor((position[i]-origin[i])/cellSize);
+        if (!(x >= 0 && x < dims[i]-1)) // also rejects NaN
+            return false;
+        ijk[i] = (int)x;
     }
+    const auto cell = cells.find(getKey(ijk[0], ijk[1], ijk[2]));
+    if (cell == cells.end())
+        return false;
+    const Vec3 cellOrigin = origin + cellSize*Vec3(ijk[0], ijk[1], ijk[2]);
+    return interpolate(&cellCorners[cell->second], position, cellOrigin, 
+                       nearestPoint, inside, normal);
 }
 
-OBBTreeNodeImpl::~OBBTreeNodeImpl() {
-    if (child1 != NULL)
-        delete child1;
-    if (child2 != NULL)
-        delete child2;
+void ContactGeometry::TriangleMesh::Impl::
+createDistanceField(Real cellSize, Real bandWidth, Real maxError) {
+    distanceField = std::make_shared<const DistanceField>
+                        (*this, cellSize, bandWidth, maxError);
 }
 
+
+//==============================================================================
+//                            OBB TREE NODE IMPL
+//==============================================================================
+
 Vec3 OBBTreeNodeImpl::findNearestPoint
    (const ContactGeometry::TriangleMesh::Impl& mesh, 
     const Vec3& position, Real cutoff2, 
     Real& distance2, int& face, Vec2& uv) const 
 {
     Real tol = 100*Eps;
-    if (child1 != NULL) {
+    if (!isLeafNode()) {
+        const OBBTreeNodeImpl& child1 = getFirstChild();
+        const OBBTreeNodeImpl& child2 = getSecondChild();
+
         // Recursively check the child nodes.
         
         Real child1distance2 = MostPositiveReal, 
              child2distance2 = MostPositiveReal;
-        int child1face, child2face;
+        int child1face = -1, child2face = -1;
         Vec2 child1uv, child2uv;
         Vec3 child1point, child2point;
         Real child1BoundsDist2 = 
-            (child1->bounds.findNearestPoint(position)-position).normSqr();
+            (child1.bounds.findNearestPoint(position)-position).normSqr();
         Real child2BoundsDist2 = 
-            (child2->bounds.findNearestPoint(position)-position).normSqr();
+            (child2.bounds.findNearestPoint(position)-position).normSqr();
         if (child1BoundsDist2 < child2BoundsDist2) {
             if (child1BoundsDist2 < cutoff2) {
-                child1point = child1->findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
+                child1point = child1.findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
                 if (child2BoundsDist2 < child1distance2 && child2BoundsDist2 < cutoff2)
-                    child2point = child2->findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
+                    child2point = child2.findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
             }
         }
         else {
             if (child2BoundsDist2 < cutoff2) {
-                child2point = child2->findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
+                child2point = child2.findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
                 if (child1BoundsDist2 < child2distance2 && child1BoundsDist2 < cutoff2)
-                    child1point = child1->findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
+                    child1point = child1.findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
             }
         }
-        if (   child1distance2 <= child2distance2*(1+tol) 
+        // Neither child may have had anything within the cutoff.
+        if (   child1distance2 < MostPositiveReal
+            && child1distance2 <= child2distance2*(1+tol) 
             && child2distance2 <= child1distance2*(1+tol)) {
             // Decide based on angle which one to use.
             
@@ -848,19 +1854,28 @@ Vec3 OBBTreeNodeImpl::findNearestPoint
     }    
     // This is a leaf node, so check each triangle for its distance to the point.
     
+    const int* triangles = &mesh.obbTriangles[firstTriangle];
     distance2 = MostPositiveReal;
     Vec3 nearestPoint;
-    for (int i = 0; i < (int) triangles.size(); i++) {
-        Vec2 triangleUV;
-        Vec3 p = mesh.findNearestPointToFace(position, triangles[i], triangleUV);
-        Vec3 offset = p-position;
-        // TODO: volatile to work around compiler bug
-        volatile Real d2 = offset.normSqr(); 
-        if (d2 < distance2 || (d2 < distance2*(1+tol) && std::abs(~offset*mesh.faces[triangles[i]].normal) > std::abs(~offset*mesh.faces[face].normal))) {
-            nearestPoint = p;
-            distance2 = d2;
-            face = triangles[i];
-            uv = triangleUV;
+    const int BlockSize = ContactGeometry::TriangleMesh::Impl::FaceBlockSize;
+    for (int block = 0; block < numTriangles; block += BlockSize) {
+        const int count = std::min(BlockSize, numTriangles-block);
+        Vec3 points[BlockSize];
+        Vec2 uvs[BlockSize];
+        mesh.findNearestPointsToFaces(position, triangles+block, count, 
+                                      points, uvs);
+        for (int j = 0; j < count; j++) {
+            const int i = block+j;
+            const Vec3& p = points[j];
+            Vec3 offset = p-position;
+            // TODO: volatile to work around compiler bug
+            volatile Real d2 = offset.normSqr(); 
+            if (d2 < distance2 || (d2 < distance2*(1+tol) && std::abs(~offset*mesh.faces[triangles[i]].normal) > std::abs(~offset*mesh.faces[face].normal))) {
+                nearestPoint = p;
+                distance2 = d2;
+                face = triangles[i];
+                uv = uvs[j];
+            }
         }
     }
     return nearestPoint;
@@ -870,34 +1885,37 @@ bool OBBTreeNodeImpl::
 intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
               const Vec3& origin, const UnitVec3& direction, Real& distance, 
               int& face, Vec2& uv) const {
-    if (child1 != NULL) {
+    if (!isLeafNode()) {
+        const OBBTreeNodeImpl& child1 = getFirstChild();
+        const OBBTreeNodeImpl& child2 = getSecondChild();
+
         // Recursively check the child nodes.
         
         Real child1distance, child2distance;
-        int child1face, child2face;
+        int child1face = -1, child2face = -1;
         Vec2 child1uv, child2uv;
-        bool child1intersects = child1->bounds.intersectsRay(origin, direction, child1distance);
-        bool child2intersects = child2->bounds.intersectsRay(origin, direction, child2distance);
+        bool child1intersects = child1.bounds.intersectsRay(origin, direction, child1distance);
+        bool child2intersects = child2.bounds.intersectsRay(origin, direction, child2distance);
         if (child1intersects) {
             if (child2intersects) {
                 // The ray intersects both child nodes.  First check the closer one.
                 
                 if (child1distance < child2distance) {
-                    child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
+                    child1intersects = child1.intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
                     if (!child1intersects || child2distance < child1distance)
-                        child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
+                        child2intersects = child2.intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
                 }
                 else {
-                    child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
+                    child2intersects = child2.intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
                     if (!child2intersects || child1distance < child2distance)
-                        child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
+                        child1intersects = child1.intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
                 }
             }
             else
-                child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
+                child1intersects = child1.intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
         }
         else if (child2intersects)
-            child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
+            child2intersects = child2.intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
         
         // If either one had an intersection, return the closer one.
         
@@ -919,71 +1937,71 @@ intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
     // This is a leaf node, so check each triangle for an intersection with the 
     // ray.
     
+    const int* triangles = &mesh.obbTriangles[firstTriangle];
     bool foundIntersection = false;
-    for (int i = 0; i < (int) triangles.size(); i++) {
-        const UnitVec3& faceNormal = mesh.faces[triangles[i]].normal;
-        Real vd = ~faceNormal*direction;
-        if (vd == 0.0)
-            continue; // The ray is parallel to the plane.
-        const Vec3& vert1 = mesh.vertices[mesh.faces[triangles[i]].vertices[0]].pos;
-        Real v0 = ~faceNormal*(vert1-origin);
-        Real t = v0/vd;
-        if (t < 0)
-            continue; // Ray points away from plane of triangle.
-        if (foundIntersection && t >= distance)
-            continue; // We already have a closer intersection.
-
-        // Determine whether the intersection point is inside the triangle by projecting onto
-        // a plane and computing the barycentric coordinates.
-
-        Vec3 ri = origin+direction*t;
-        const Vec3& vert2 = mesh.vertices[mesh.faces[triangles[i]].vertices[1]].pos;
-        const Vec3& vert3 = mesh.vertices[mesh.faces[triangles[i]].vertices[2]].pos;
-        int axis1, axis2;
-        if (std::abs(faceNormal[1]) > std::abs(faceNormal[0])) {
-            if (std::abs(faceNormal[2]) > std::abs(faceNormal[1])) {
-                axis1 = 0;
-                axis2 = 1;
-            }
-            else {
-                axis1 = 0;
-                axis2 = 2;
-            }
+    for (int i = 0; i < numTriangles; i++) {
+        if (mesh.intersectsRayWithFace(triangles[i], origin, direction, 
+                foundIntersection ? distance : Infinity, distance, uv)) {
+            face = triangles[i];
+            foundIntersection = true;
         }
-        else {
-            if (std::abs(faceNormal[2]) > std::abs(faceNormal[0])) {
-                axis1 = 0;
-                axis2 = 1;
-            }
-            else {
-                axis1 = 1;
-                axis2 = 2;
+    }
+    return foundIntersection;
+}
+
+unsigned long long OBBTreeNodeImpl::
+intersectsRays(const ContactGeometry::TriangleMesh::Impl& mesh,
+               const Vec3 origins[], const UnitVec3 directions[],
+               const int active[], int numActive, Real distances[], 
+               int faces[], Vec2 uvs[]) const {
+    unsigned long long hits = 0;
+    if (isLeafNode()) {
+        const int* triangles = &mesh.obbTriangles[firstTriangle];
+        for (int k = 0; k < numActive; k++) {
+            const int ray = active[k];
+            for (int i = 0; i < numTriangles; i++)
+                if (mesh.intersectsRayWithFace(triangles[i], origins[ray], 
+                        directions[ray], distances[ray], distances[ray], 
+                        uvs[ray])) {
+                    faces[ray] = triangles[i];
+                    hits |= 1ULL << ray;
+                }
+        }
+        return hits;
+    }
+
+    // Find which rays enter each child's bounds before their current hit,
+    // then visit the child the packet reaches first.
+    const OBBTreeNodeImpl* child[2] = {&getFirstChild(), &getSecondChild()};
+    int  childActive[2][ContactGeometry::TriangleMesh::Impl::RayPacketSize];
+    Real childEntry[2][ContactGeometry::TriangleMesh::Impl::RayPacketSize];
+    int  numChildActive[2] = {0, 0};
+    Real nearestEntry[2] = {Infinity, Infinity};
+    for (int c = 0; c < 2; c++)
+        for (int k = 0; k < numActive; k++) {
+            const int ray = active[k];
+            Real entry;
+            if (   child[c]->bounds.intersectsRay(origins[ray], 
+                                                  directions[ray], entry)
+                && entry <= distances[ray]) {
+                childActive[c][numChildActive[c]] = ray;
+                childEntry[c][numChildActive[c]++] = entry;
+                nearestEntry[c] = std::min(nearestEntry[c], entry);
             }
         }
-        Vec2 pos(ri[axis1]-vert1[axis1], ri[axis2]-vert1[axis2]);
-        Vec2 edge1(vert1[axis1]-vert2[axis1], vert1[axis2]-vert2[axis2]);
-        Vec2 edge2(vert1[axis1]-vert3[axis1], vert1[axis2]-vert3[axis2]);
-        Real denom = Real(1)/(edge1%edge2);
-        edge2 *= denom;
-        Real v = edge2%pos;
-        if (v < 0 || v > 1)
-            continue;
-        edge1 *= denom;
-        Real w = pos%edge1;
-        if (w < 0 || w > 1)
-            continue;
-        Real u = 1-v-w;
-        if (u < 0 || u > 1)
-            continue;
-        
-        // It intersects.
-        
-        distance = t;
-        face = triangles[i];
-        uv = Vec2(u, v);
-        foundIntersection = true;
+    const int first = nearestEntry[1] < nearestEntry[0] ? 1 : 0;
+    for (int c : {first, 1-first}) {
+        // Hits found in the first child may have put the second one out of
+        // reach for some of the rays.
+        int n = 0;
+        for (int k = 0; k < numChildActive[c]; k++)
+            if (childEntry[c][k] <= distances[childActive[c][k]])
+                childActive[c][n++] = childActive[c][k];
+        if (n > 0)
+            hits |= child[c]->intersectsRays(mesh, origins, directions, 
+                        childActive[c], n, distances, faces, uvs);
     }
-    return foundIntersection;
+    return hits;
 }
 
 
@@ -994,7 +2012,8 @@ intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
 //==============================================================================
 
 ContactGeometry::TriangleMesh::OBBTreeNode::
-OBBTreeNode(const OBBTreeNodeImpl& impl) : impl(&impl) {}
+OBBTreeNode(const OBBTreeNodeImpl& impl, const int* triangles) 
+:   impl(&impl), triangles(triangles) {}
 
 const OrientedBoundingBox& 
 ContactGeometry::TriangleMesh::OBBTreeNode::getBounds() const {
@@ -1002,28 +2021,29 @@ ContactGeometry::TriangleMesh::OBBTreeNode::getBounds() const {
 }
 
 bool ContactGeometry::TriangleMesh::OBBTreeNode::isLeafNode() const {
-    return (impl->child1 == NULL);
+    return impl->isLeafNode();
 }
 
 const ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::OBBTreeNode::getFirstChildNode() const {
-    SimTK_ASSERT_ALWAYS(impl->child1, 
+    SimTK_ASSERT_ALWAYS(!impl->isLeafNode(), 
         "Called getFirstChildNode() on a leaf node");
-    return OBBTreeNode(*impl->child1);
+    return OBBTreeNode(impl->getFirstChild(), triangles);
 }
 
 const ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::OBBTreeNode::getSecondChildNode() const {
-    SimTK_ASSERT_ALWAYS(impl->child2, 
-        "Called getFirstChildNode() on a leaf node");
-    return OBBTreeNode(*impl->child2);
+    SimTK_ASSERT_ALWAYS(!impl->isLeafNode(), 
+        "Called getSecondChildNode() on a leaf node");
+    return OBBTreeNode(impl->getSecondChild(), triangles);
 }
 
-const Array_<int>& ContactGeometry::TriangleMesh::OBBTreeNode::
+ArrayViewConst_<int> ContactGeometry::TriangleMesh::OBBTreeNode::
 getTriangles() const {
-    SimTK_ASSERT_ALWAYS(impl->child2 == NULL, 
+    SimTK_ASSERT_ALWAYS(impl->isLeafNode(), 
         "Called getTriangles() on a non-leaf node");
-    return impl->triangles;
+    const int* first = triangles + impl->firstTriangle;
+    return ArrayViewConst_<int>(first, first + impl->numTriangles);
 }
 
 int ContactGeometry::TriangleMesh::OBBTreeNode::getNumTriangles() const {
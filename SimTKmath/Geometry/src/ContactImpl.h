@@ -229,6 +229,34 @@ friend class BrickHalfSpaceContact;
 
 
 
+//==============================================================================
+//                           MANIFOLD CONTACT IMPL
+//==============================================================================
+/** This is the internal implementation class for ManifoldContact. **/
+class ManifoldContactImpl : public ContactImpl {
+public:
+    ManifoldContactImpl
+       (ContactSurfaceIndex surf1, ContactSurfaceIndex surf2,
+        const Transform& X_S1S2, const UnitVec3& normal_S1,
+        const Array_<Vec3>& origins_S1, const Array_<Real>& depths)
+    :   ContactImpl(surf1, surf2, X_S1S2), normal_S1(normal_S1),
+        origins_S1(origins_S1), depths(depths) {}
+
+    ContactTypeId getTypeId() const override {return classTypeId();}
+    static ContactTypeId classTypeId() {
+        static const ContactTypeId tid = createNewContactTypeId();
+        return tid;
+    }
+
+private:
+friend class ManifoldContact;
+    UnitVec3        normal_S1;
+    Array_<Vec3>    origins_S1;
+    Array_<Real>    depths;
+};
+
+
+
 //==============================================================================
 //                            TRIANGLE MESH IMPL
 //==============================================================================
@@ -252,6 +280,9 @@ friend class TriangleMeshContact;
 
     const std::set<int> faces1;
     const std::set<int> faces2;
+    // The same faces in ascending order, for callers that visit every one.
+    const Array_<int>   faceIndices1;
+    const Array_<int>   faceIndices2;
 };
 
 
@@ -23,6 +23,8 @@
 
 #include "SimTKmath.h"
 
+#include "ContactGeometryImpl.h"
+
 #include <algorithm>
 using std::pair; using std::make_pair;
 #include <iostream>
@@ -768,6 +770,650 @@ bool ContactTracker::SphereSphere::trackContact
 
 
 
+//==============================================================================
+//                       SPHERE-BRICK CONTACT TRACKER
+//==============================================================================
+// Cost is ~60 flops if no contact, ~220 with contact.
+// The brick's nearest point to the sphere center is the center clamped to the
+// brick, unless the center is inside. Then the nearest point is on the face
+// the center is closest to. The brick is flat at either point (or has an
+// infinitely sharp edge or corner that we treat as flat) so the sphere's
+// radius is also the effective radius.
+bool ContactTracker::SphereBrick::trackContact
+   (const Contact&         priorStatus,
+    const Transform&       X_GS,
+    const ContactGeometry& geoSphere,
+    const Transform&       X_GB,
+    const ContactGeometry& geoBrick,
+    Real                   cutoff,
+    Contact&               currentStatus) const
+{
+    SimTK_ASSERT
+       (   geoSphere.getTypeId()==ContactGeometry::Sphere::classTypeId()
+        && geoBrick.getTypeId()==ContactGeometry::Brick::classTypeId(),
+       "ContactTracker::SphereBrick::trackContact()");
+
+    // No need for an expensive dynamic cast here; we know what we have.
+    const ContactGeometry::Sphere& sphere =
+        ContactGeometry::Sphere::getAs(geoSphere);
+    const ContactGeometry::Brick& brick =
+        ContactGeometry::Brick::getAs(geoBrick);
+    const Real  r = sphere.getRadius();
+    const Vec3& h = brick.getHalfLengths();
+
+    // p_BC is the vector from the brick center to the sphere center C.
+    const Vec3 p_BC = ~X_GB.R()*(X_GS.p() - X_GB.p()); // 18 flops
+
+    // Find the brick's nearest point Q to C and the brick's outward normal
+    // there, which points towards C if C is outside.
+    Vec3 p_BQ(clamp(-h[0], p_BC[0], h[0]),
+              clamp(-h[1], p_BC[1], h[1]),
+              clamp(-h[2], p_BC[2], h[2]));
+    const Vec3 p_QC = p_BC - p_BQ; // 3 flops
+    const Real d2 = p_QC.normSqr(); // 5 flops
+    if (d2 > square(r + cutoff)) { // 3 flops
+        currentStatus.clear(); // not touching
+        return true; // successful return
+    }
+
+    UnitVec3 n_B; Real depth;
+    if (d2 > square(SignificantReal)) { // C is outside
+        const Real d = std::sqrt(d2); // ~20 flops
+        n_B = UnitVec3(p_QC/d, true); // ~20 flops
+        depth = r - d;
+    } else { // C is inside; pick the face it is closest to
+        int axis = 0; Real gap = h[0] - std::abs(p_BC[0]);
+        for (int i=1; i < 3; ++i) {
+            const Real gapi = h[i] - std::abs(p_BC[i]);
+            if (gapi < gap) axis = i, gap = gapi;
+        }
+        const Real sign = p_BC[axis] < 0 ? Real(-1) : Real(1);
+        p_BQ[axis] = sign*h[axis];
+        n_B = UnitVec3(CoordinateAxis(axis));
+        if (sign < 0) n_B = -n_B;
+        depth = r + gap;
+    }
+
+    // The common normal points from the sphere to the brick, and the origin
+    // is half way between the brick's point Q and the sphere's deepest point.
+    const Transform X_SB = ~X_GS*X_GB; // 63 flops
+    const UnitVec3 normal_S = X_SB.R()*(-n_B); // 15 flops
+    const Vec3 origin_S = X_SB*(p_BQ - (depth/2)*n_B); // 25 flops
+
+    currentStatus = CircularPointContact(priorStatus.getSurface1(), r,
+                                         priorStatus.getSurface2(), Infinity,
+                                         X_SB, r, depth, origin_S, normal_S);
+    return true; // success
+}
+
+
+
+//==============================================================================
+//                       BRICK-BRICK CONTACT TRACKER
+//==============================================================================
+namespace {
+
+// Clip the n points of the convex polygon "in" against the plane
+// sign*x[axis] <= limit, writing the clipped polygon to "out" and returning
+// its number of points. Each clip adds at most one point.
+int clipPolygon(const Vec3* in, int n, int axis, Real sign, Real limit,
+                Vec3* out) {
+    int m = 0;
+    for (int i=0; i < n; ++i) {
+        const Vec3& a = in[i];
+        const Vec3& b = in[(i+1) % n];
+        const Real da = sign*a[axis] - limit; // <= 0 means inside
+        const Real db = sign*b[axis] - limit;
+        if (da <= 0)
+            out[m++] = a;
+        if ((da < 0 && db > 0) || (da > 0 && db < 0))
+            out[m++] = a + (da/(da-db))*(b-a);
+    }
+    return m;
+}
+
+// Find the contact points when a face of brick R (the reference brick) gives
+// the separating axis. The reference face is the one on R's coordinate
+// direction "axis" whose outward normal nR=sign*axis points towards brick I
+// (the incident brick). We clip I's face that most nearly opposes nR against
+// the sides of the reference face and keep the points that are below it, or
+// within the cutoff. Their origins are half way between the two surfaces, in
+// R; at most 8 points result.
+int findFaceContactPoints(const Vec3& hR, const Vec3& hI,
+                          const Transform& X_RI, int axis, Real sign,
+                          Real cutoff, Vec3 origins_R[8], Real depths[8]) {
+    const UnitVec3 nR = sign > 0 ?  UnitVec3(CoordinateAxis(axis))
+                                : -UnitVec3(CoordinateAxis(axis));
+    const Vec3 nR_I = ~X_RI.R()*nR; // 15 flops
+
+    // The incident face's normal is I's coordinate direction k most nearly
+    // antiparallel to nR.
+    int k = 0;
+    for (int j=1; j < 3; ++j)
+        if (std::abs(nR_I[j]) > std::abs(nR_I[k])) k = j;
+    const int u = (k+1) % 3, v = (k+2) % 3;
+    Vec3 corner_I(0);
+    corner_I[k] = nR_I[k] > 0 ? -hI[k] : hI[k];
+
+    Vec3 polygon[2][8];
+    const Real su[4] = {1, -1, -1, 1}, sv[4] = {1, 1, -1, -1};
+    for (int i=0; i < 4; ++i) {
+        corner_I[u] = su[i]*hI[u]; corner_I[v] = sv[i]*hI[v];
+        polygon[0][i] = X_RI*corner_I; // 18 flops
+    }
+
+    int n = 4, current = 0;
+    for (int side=1; side < 3; ++side) {
+        const int j = (axis+side) % 3;
+        n = clipPolygon(polygon[current], n, j,  1, hR[j],
+                        polygon[1-current]); current = 1-current;
+        n = clipPolygon(polygon[current], n, j, -1, hR[j],
+                        polygon[1-current]); current = 1-current;
+    }
+
+    int numPoints = 0;
+    for (int i=0; i < n; ++i) {
+        const Vec3& p_R = polygon[current][i];
+        const Real depth = hR[axis] - sign*p_R[axis];
+        if (depth <= -cutoff) continue;
+        origins_R[numPoints] = p_R + (depth/2)*nR;
+        depths[numPoints] = depth;
+        ++numPoints;
+    }
+    return numPoints;
+}
+
+// Find the contact point when the separating axis n_A is the cross product
+// of A's coordinate direction i and B's coordinate direction j. The deepest
+// points are on the edges along those directions that support each brick in
+// the direction of the other; we return the point half way between the
+// closest points of those edges, in A.
+Vec3 findEdgeContactPoint(const Vec3& hA, const Vec3& hB,
+                          const Transform& X_AB, int i, int j,
+                          const UnitVec3& n_A) {
+    const Vec3 n_B = ~X_AB.R()*n_A;
+    Vec3 p_A(0), q_B(0); // edge centers
+    for (int k=0; k < 3; ++k) {
+        if (k != i) p_A[k] = n_A[k] > 0 ? hA[k] : -hA[k];
+        if (k != j) q_B[k] = n_B[k] > 0 ? -hB[k] : hB[k];
+    }
+    const Vec3 q_A = X_AB*q_B;
+    const UnitVec3 dA = UnitVec3(CoordinateAxis(i));
+    const UnitVec3& dB = X_AB.R().getAxisUnitVec(CoordinateAxis(j));
+
+    // Closest points of the lines p+s*dA and q+t*dB, clamped to the edges.
+    // The edges are not parallel or we wouldn't have used their axis.
+    const Vec3 w = p_A - q_A;
+    const Real b = ~dA*dB, d = ~dA*w, e = ~dB*w;
+    const Real oodenom = 1/(1 - b*b);
+    const Real s = clamp(-hA[i], (b*e - d)*oodenom, hA[i]);
+    const Real t = clamp(-hB[j], (e - b*d)*oodenom, hB[j]);
+    return (p_A + s*dA + q_A + t*dB)/2;
+}
+
+}
+
+// Cost is ~500 flops if no contact, more for contact depending on how many
+// points there are.
+// This is the separating axis test: two convex polyhedra are separated if
+// and only if their projections onto some axis are, and for two boxes the
+// axes to check are the 3 face normals of each and the 9 cross products of
+// their edge directions. If none separates them, the one with the least
+// overlap gives the contact normal and determines the contact points. We
+// prefer face axes over edge axes, and brick A's faces over brick B's, unless
+// the other is clearly better, so that the choice does not flip back and
+// forth between nearly equal axes from one step to the next.
+bool ContactTracker::BrickBrick::trackContact
+   (const Contact&         priorStatus,
+    const Transform&       X_GA,
+    const ContactGeometry& geoBrickA,
+    const Transform&       X_GB,
+    const ContactGeometry& geoBrickB,
+    Real                   cutoff,
+    Contact&               currentStatus) const
+{
+    SimTK_ASSERT
+       (   geoBrickA.getTypeId()==ContactGeometry::Brick::classTypeId()
+        && geoBrickB.getTypeId()==ContactGeometry::Brick::classTypeId(),
+       "ContactTracker::BrickBrick::trackContact()");
+
+    const Vec3& hA = ContactGeometry::Brick::getAs(geoBrickA).getHalfLengths();
+    const Vec3& hB = ContactGeometry::Brick::getAs(geoBrickB).getHalfLengths();
+
+    const Transform X_AB = ~X_GA*X_GB; // 63 flops
+    const Mat33& R = X_AB.R().asMat33(); // columns are B's axes in A
+    const Vec3&  p = X_AB.p();           // B's center in A
+    const Vec3   p_B = ~R*p;             // same, in B (15 flops)
+
+    // Separation along each face axis; > 0 means separated.
+    Real sepA = -Infinity, sepB = -Infinity; int axisA = -1, axisB = -1;
+    for (int i=0; i < 3; ++i) {
+        const Real rB = hB[0]*std::abs(R(i,0)) + hB[1]*std::abs(R(i,1))
+                      + hB[2]*std::abs(R(i,2));
+        const Real sep = std::abs(p[i]) - hA[i] - rB;
+        if (sep >= cutoff) {currentStatus.clear(); return true;}
+        if (sep > sepA) sepA = sep, axisA = i;
+    }
+    for (int j=0; j < 3; ++j) {
+        const Real rA = hA[0]*std::abs(R(0,j)) + hA[1]*std::abs(R(1,j))
+                      + hA[2]*std::abs(R(2,j));
+        const Real sep = std::abs(p_B[j]) - rA - hB[j];
+        if (sep >= cutoff) {currentStatus.clear(); return true;}
+        if (sep > sepB) sepB = sep, axisB = j;
+    }
+
+    // Edge-edge axes; skip nearly parallel edges since those are covered by
+    // the face axes.
+    Real sepE = -Infinity; int edgeA = -1, edgeB = -1; UnitVec3 axisE;
+    for (int i=0; i < 3; ++i) {
+        const UnitVec3 dA = UnitVec3(CoordinateAxis(i));
+        for (int j=0; j < 3; ++j) {
+            const Vec3 cross = dA % R.col(j);
+            const Real len = cross.norm();
+            if (len < Real(1e-6)) continue;
+            const UnitVec3 n_A(cross/len, true);
+            const Vec3 n_B = ~R*n_A;
+            const Real rA = hA[0]*std::abs(n_A[0]) + hA[1]*std::abs(n_A[1])
+                          + hA[2]*std::abs(n_A[2]);
+            const Real rB = hB[0]*std::abs(n_B[0]) + hB[1]*std::abs(n_B[1])
+                          + hB[2]*std::abs(n_B[2]);
+            const Real sep = std::abs(~p*n_A) - rA - rB;
+            if (sep >= cutoff) {currentStatus.clear(); return true;}
+            if (sep > sepE) sepE = sep, edgeA = i, edgeB = j, axisE = n_A;
+        }
+    }
+
+    // Hysteresis: only switch to a less preferred axis if it is clearly
+    // better. Separations are negative here unless within the cutoff.
+    const Real absTol = Real(0.01)*std::min(min(hA), min(hB));
+    const Real relTol = Real(0.95);
+    const bool useB = sepB > relTol*sepA + absTol;
+    const Real sepFace = useB ? sepB : sepA;
+    const bool useEdge = sepE > relTol*sepFace + absTol;
+
+    Vec3 origins_A[8]; Real depths[8]; int numPoints = 0;
+    UnitVec3 normal_A; // from A towards B
+    if (useEdge) {
+        normal_A = ~p*axisE < 0 ? -axisE : axisE;
+        origins_A[0] = findEdgeContactPoint(hA, hB, X_AB, edgeA, edgeB,
+                                            normal_A);
+        depths[0] = -sepE;
+        numPoints = 1;
+    } else if (useB) {
+        // A's center is on the -sign side of B's face axis.
+        const Real sign = p_B[axisB] < 0 ? Real(-1) : Real(1);
+        normal_A = X_AB.R().getAxisUnitVec(CoordinateAxis(axisB));
+        if (sign < 0) normal_A = -normal_A;
+        numPoints = findFaceContactPoints(hB, hA, ~X_AB, axisB, -sign, cutoff,
+                                          origins_A, depths);
+        for (int i=0; i < numPoints; ++i)
+            origins_A[i] = X_AB*origins_A[i]; // measured in B until now
+    } else {
+        const Real sign = p[axisA] < 0 ? Real(-1) : Real(1);
+        normal_A = UnitVec3(CoordinateAxis(axisA));
+        if (sign < 0) normal_A = -normal_A;
+        numPoints = findFaceContactPoints(hA, hB, X_AB, axisA, sign, cutoff,
+                                          origins_A, depths);
+    }
+
+    if (numPoints == 0) {
+        currentStatus.clear(); // not touching
+        return true; // successful return
+    }
+
+    currentStatus = ManifoldContact(priorStatus.getSurface1(),
+                                    priorStatus.getSurface2(), X_AB, normal_A,
+                                    Array_<Vec3>(origins_A,
+                                                 origins_A + numPoints),
+                                    Array_<Real>(depths, depths + numPoints));
+    return true; // success
+}
+
+
+
+//==============================================================================
+//                      SPHERE-CYLINDER CONTACT TRACKER
+//==============================================================================
+// Cost is ~30 flops if no contact, ~250 with contact.
+// The cylinder is infinitely long so the nearest point to the sphere center
+// is always on the side, straight out from the axis. There the cylinder has
+// curvature 1/R around its circumference and none along its axis; adding the
+// sphere's curvature 1/r in every direction gives the relative curvatures.
+bool ContactTracker::SphereCylinder::trackContact
+   (const Contact&         priorStatus,
+    const Transform&       X_GS,
+    const ContactGeometry& geoSphere,
+    const Transform&       X_GC,
+    const ContactGeometry& geoCylinder,
+    Real                   cutoff,
+    Contact&               currentStatus) const
+{
+    SimTK_ASSERT
+       (   geoSphere.getTypeId()==ContactGeometry::Sphere::classTypeId()
+        && geoCylinder.getTypeId()==ContactGeometry::Cylinder::classTypeId(),
+       "ContactTracker::SphereCylinder::trackContact()");
+
+    // No need for an expensive dynamic cast here; we know what we have.
+    const Real r = ContactGeometry::Sphere::getAs(geoSphere).getRadius();
+    const Real R = ContactGeometry::Cylinder::getAs(geoCylinder).getRadius();
+
+    // p_CS is the vector from the cylinder origin to the sphere center, in C.
+    const Vec3 p_CS = ~X_GC.R()*(X_GS.p() - X_GC.p()); // 18 flops
+    const Real rho2 = square(p_CS[0]) + square(p_CS[1]); // 3 flops
+    if (rho2 > square(r + R + cutoff)) { // 3 flops
+        currentStatus.clear(); // not touching
+        return true; // successful return
+    }
+
+    const Real rho = std::sqrt(rho2); // ~20 flops
+    if (rho < SignificantReal) {    // 1 flop
+        // TODO: The sphere center is on the axis so every direction is
+        // equally good. We should use past information to pick one.
+        return false;
+    }
+    const Real depth = r + R - rho;
+
+    // Outward cylinder normal at its nearest point Q, pointing at the sphere
+    // center. The contact frame P has z pointing the other way (from the
+    // sphere to the cylinder), x around the circumference (maximum
+    // curvature) and y along the cylinder axis (minimum curvature).
+    const UnitVec3 n_C(Vec3(p_CS[0]/rho, p_CS[1]/rho, 0), true); // ~20 flops
+    Rotation R_CP;
+    R_CP.setRotationFromUnitVecsTrustMe
+       (UnitVec3(Vec3(-n_C[1], n_C[0], 0), true), -UnitVec3(ZAxis), -n_C);
+    const Vec3 p_CQ(R*n_C[0], R*n_C[1], p_CS[2]);
+    const Transform X_CP(R_CP, p_CQ - (depth/2)*n_C);
+
+    const Transform X_SC = ~X_GS*X_GC; // 63 flops
+    currentStatus = EllipticalPointContact(priorStatus.getSurface1(),
+                                           priorStatus.getSurface2(),
+                                           X_SC, X_SC*X_CP,
+                                           Vec2(1/r + 1/R, 1/r), depth);
+    return true; // success
+}
+
+
+//==============================================================================
+//               SMOOTH HEIGHT MAP - SPHERE CONTACT TRACKER
+//==============================================================================
+namespace {
+// A valley curved more tightly than the body resting in it makes the contact
+// conforming, which a point contact can't represent. We don't let the
+// difference paraboloid get flatter than a tenth of the body's own least
+// curvature so that the Hertz force model stays well defined there.
+void limitConformingCurvatures(Real bodyCurvature, Vec2& k) {
+    const Real kmin = bodyCurvature/10;
+    k[0] = std::max(k[0], kmin);
+    k[1] = std::max(k[1], kmin);
+}
+}
+
+bool ContactTracker::SmoothHeightMapSphere::trackContact
+   (const Contact&         priorStatus,
+    const Transform&       X_GH,
+    const ContactGeometry& geoHeightMap,
+    const Transform&       X_GS,
+    const ContactGeometry& geoSphere,
+    Real                   cutoff,
+    Contact&               currentStatus) const
+{
+    SimTK_ASSERT
+       (   ContactGeometry::SmoothHeightMap::isInstance(geoHeightMap)
+        && ContactGeometry::Sphere::isInstance(geoSphere),
+       "ContactTracker::SmoothHeightMapSphere::trackContact()");
+
+    // No need for an expensive dynamic cast here; we know what we have.
+    const ContactGeometry::SmoothHeightMap::Impl& heightMap =
+        ContactGeometry::SmoothHeightMap::getAs(geoHeightMap).getImpl();
+    const BicubicSurface& surface = heightMap.getBicubicSurface();
+    const Real r = ContactGeometry::Sphere::getAs(geoSphere).getRadius();
+
+    const Transform X_HS = ~X_GH*X_GS;
+    const Vec3& center_H = X_HS.p();
+    const Vec2  center_xy(center_H[0], center_H[1]);
+
+    // The sphere can only touch the part of the height map right under it,
+    // and only if that rises to within the cutoff of the sphere's bottom.
+    const Vec2 reach(r + cutoff);
+    if (   !surface.isSurfaceDefined(center_xy)
+        || center_H[2] - r >= heightMap.calcMaxHeight(center_xy - reach,
+                                                      center_xy + reach)
+                              + cutoff) {
+        currentStatus.clear(); // not touching
+        return true; // successful return
+    }
+
+    BicubicSurface::PatchHint& hint = heightMap.updHint();
+    bool inside; UnitVec3 normal_H;
+    const Vec3 Q_H = heightMap.findNearestPoint(center_H, hint, inside,
+                                                normal_H);
+    const Real distance = (inside ? -1 : 1)*(center_H - Q_H).norm();
+    const Real depth = r - distance;
+
+    if (depth <= -cutoff) {
+        currentStatus.clear(); // not touching
+        return true; // successful return
+    }
+
+    // The sphere adds its curvature equally in all directions, so the
+    // difference paraboloid has the height map's principal directions. Its
+    // frame P has z along the height map's outward normal, which points
+    // from surface1 to surface2 as required.
+    Transform X_HP; Vec2 k;
+    surface.calcParaboloid(Vec2(Q_H[0], Q_H[1]), hint, X_HP, k);
+    k += Vec2(1/r);
+    limitConformingCurvatures(1/r, k);
+
+    // Shift the origin half way into the overlap.
+    X_HP.updP() = Q_H - (depth/2)*normal_H;
+    currentStatus = EllipticalPointContact(priorStatus.getSurface1(),
+                                           priorStatus.getSurface2(),
+                                           X_HS, X_HP, k, depth);
+    return true; // success
+}
+
+
+
+//==============================================================================
+//              SMOOTH HEIGHT MAP - ELLIPSOID CONTACT TRACKER
+//==============================================================================
+bool ContactTracker::SmoothHeightMapEllipsoid::trackContact
+   (const Contact&         priorStatus,
+    const Transform&       X_GH,
+    const ContactGeometry& geoHeightMap,
+    const Transform&       X_GE,
+    const ContactGeometry& geoEllipsoid,
+    Real                   cutoff,
+    Contact&               currentStatus) const
+{
+    SimTK_ASSERT
+       (   ContactGeometry::SmoothHeightMap::isInstance(geoHeightMap)
+        && ContactGeometry::Ellipsoid::isInstance(geoEllipsoid),
+       "ContactTracker::SmoothHeightMapEllipsoid::trackContact()");
+
+    const int  MaxIterations = 20;
+    const Real NormalTol     = 1e-10;
+
+    // No need for an expensive dynamic cast here; we know what we have.
+    const ContactGeometry::SmoothHeightMap::Impl& heightMap =
+        ContactGeometry::SmoothHeightMap::getAs(geoHeightMap).getImpl();
+    const BicubicSurface& surface = heightMap.getBicubicSurface();
+    const ContactGeometry::Ellipsoid& ellipsoid =
+        ContactGeometry::Ellipsoid::getAs(geoEllipsoid);
+    const Vec3& radii = ellipsoid.getRadii();
+    const Real  rmax  = std::max(radii[0], std::max(radii[1], radii[2]));
+
+    const Transform X_HE = ~X_GH*X_GE;
+    const Vec3& center_H = X_HE.p();
+    const Vec2  center_xy(center_H[0], center_H[1]);
+
+    // Same quick rejection as for a sphere, using the largest radius.
+    const Vec2 reach(rmax + cutoff);
+    if (   !surface.isSurfaceDefined(center_xy)
+        || center_H[2] - rmax >= heightMap.calcMaxHeight(center_xy - reach,
+                                                         center_xy + reach)
+                                 + cutoff) {
+        currentStatus.clear(); // not touching
+        return true; // successful return
+    }
+
+    // Start with the height map's normal under the center. Each iteration
+    // finds the ellipsoid point P facing opposite the current normal and
+    // the height map point Q nearest P, whose normal is the next guess.
+    BicubicSurface::PatchHint& hint = heightMap.updHint();
+    Real f; Vec2 df; Mat22 d2f;
+    heightMap.calcHeightDerivatives(center_xy, hint, f, df, d2f);
+    UnitVec3 normal_H(-df[0], -df[1], 1);
+    UnitVec3 normalP_E; // the ellipsoid's normal at P
+    Vec3 P_E, P_H, Q_H;
+    for (int iter=0; iter < MaxIterations; ++iter) {
+        normalP_E = ~X_HE.R()*(-normal_H);
+        P_E = ellipsoid.findPointWithThisUnitNormal(normalP_E);
+        P_H = X_HE*P_E;
+        if (!surface.isSurfaceDefined(Vec2(P_H[0], P_H[1]))) {
+            currentStatus.clear(); // hanging over the edge
+            return true;
+        }
+        bool inside; UnitVec3 nextNormal_H;
+        Q_H = heightMap.findNearestPoint(P_H, hint, inside, nextNormal_H);
+        const bool converged =
+            (nextNormal_H - normal_H).norm() <= NormalTol;
+        normal_H = nextNormal_H;
+        if (converged)
+            break;
+    }
+
+    const Real depth = dot(Q_H - P_H, normal_H); // > 0 if P is below Q
+    if (depth <= -cutoff) {
+        currentStatus.clear(); // not touching
+        return true; // successful return
+    }
+
+    // Combine the height map's paraboloid at Q with the ellipsoid's at P.
+    // The result uses the height map's frame, whose z is the outward normal
+    // pointing from surface1 to surface2 as required.
+    Transform X_HT; Vec2 kT;
+    surface.calcParaboloid(Vec2(Q_H[0], Q_H[1]), hint, X_HT, kT);
+    Transform X_EP; Vec2 kE;
+    ellipsoid.findParaboloidAtPointWithNormal(P_E, normalP_E, X_EP, kE);
+    // The ellipsoid's max curvature direction must be in the height map's
+    // tangent plane; the normals agree only to within the tolerance.
+    const Vec3 xE_H = X_HE.R()*X_EP.x();
+    const UnitVec3 maxDirE_H(xE_H - dot(xE_H, X_HT.z())*X_HT.z());
+
+    Transform X_HC; Vec2 k;
+    ContactGeometry::combineParaboloids(X_HT.R(), kT, maxDirE_H, kE,
+                                        X_HC.updR(), k);
+    limitConformingCurvatures(1/rmax, k);
+    X_HC.updP() = Q_H - (depth/2)*X_HT.z();
+
+    currentStatus = EllipticalPointContact(priorStatus.getSurface1(),
+                                           priorStatus.getSurface2(),
+                                           X_HE, X_HC, k, depth);
+    return true; // success
+}
+
+
+
+//==============================================================================
+//            SMOOTH HEIGHT MAP - TRIANGLE MESH CONTACT TRACKER
+//==============================================================================
+bool ContactTracker::SmoothHeightMapTriangleMesh::trackContact
+   (const Contact&         priorStatus,
+    const Transform&       X_GH,
+    const ContactGeometry& geoHeightMap,
+    const Transform&       X_GM,
+    const ContactGeometry& geoMesh,
+    Real                   cutoff,
+    Contact&               currentStatus) const
+{
+    SimTK_ASSERT_ALWAYS
+       (   ContactGeometry::SmoothHeightMap::isInstance(geoHeightMap)
+        && ContactGeometry::TriangleMesh::isInstance(geoMesh),
+       "ContactTracker::SmoothHeightMapTriangleMesh::trackContact()");
+
+    // We can't handle a "proximity" test, only penetration.
+    SimTK_ASSERT_ALWAYS(cutoff==0,
+       "ContactTracker::SmoothHeightMapTriangleMesh::trackContact()");
+
+    // No need for an expensive dynamic cast here; we know what we have.
+    const ContactGeometry::SmoothHeightMap& heightMap =
+        ContactGeometry::SmoothHeightMap::getAs(geoHeightMap);
+    const ContactGeometry::TriangleMesh& mesh =
+        ContactGeometry::TriangleMesh::getAs(geoMesh);
+
+    // Transform giving mesh (S2) frame in the height map (S1) frame.
+    const Transform X_HM = (~X_GH)*X_GM;
+
+    // Neighboring faces share vertices and patches, so one hint serves
+    // the whole search.
+    BicubicSurface::PatchHint hint;
+    std::set<int> insideFaces;
+    processBox(heightMap, mesh, mesh.getOBBTreeNode(), X_HM, hint,
+               insideFaces);
+
+    if (insideFaces.empty()) {
+        currentStatus.clear(); // not touching
+        return true; // successful return
+    }
+
+    currentStatus = TriangleMeshContact(priorStatus.getSurface1(),
+                                        priorStatus.getSurface2(),
+                                        X_HM,
+                                        std::set<int>(), insideFaces);
+    return true; // success
+}
+
+
+// Check a single OBB and its contents (recursively) against the height map,
+// appending any penetrating faces to the insideFaces list.
+void ContactTracker::SmoothHeightMapTriangleMesh::processBox
+   (const ContactGeometry::SmoothHeightMap&           heightMap,
+    const ContactGeometry::TriangleMesh&              mesh,
+    const ContactGeometry::TriangleMesh::OBBTreeNode& node,
+    const Transform& X_HM, BicubicSurface::PatchHint& hint,
+    std::set<int>& insideFaces) const
+{   // First check the node's bounding box against the height map under it.
+    const OrientedBoundingBox& bounds = node.getBounds();
+    const Transform X_HB = X_HM*bounds.getTransform(); // box frame in H
+    const Vec3 halfSize_B = bounds.getSize()/2;
+    const Vec3 center_H = X_HB*halfSize_B;
+    // Half the size of the box's axis-aligned bounding box in H.
+    const Vec3 halfSize_H = X_HB.R().asMat33().abs()*halfSize_B;
+    const Vec2 lo(center_H[0]-halfSize_H[0], center_H[1]-halfSize_H[1]);
+    const Vec2 hi(center_H[0]+halfSize_H[0], center_H[1]+halfSize_H[1]);
+    if (center_H[2]-halfSize_H[2] >= heightMap.getImpl().calcMaxHeight(lo,hi))
+        return; // no penetration
+
+    // Box may be penetrated. If it is not a leaf node, check its children.
+    if (!node.isLeafNode()) {
+        processBox(heightMap, mesh, node.getFirstChildNode(), X_HM, hint,
+                   insideFaces);
+        processBox(heightMap, mesh, node.getSecondChildNode(), X_HM, hint,
+                   insideFaces);
+        return;
+    }
+
+    // This is a leaf OBB node that may be penetrating, so some of its
+    // triangles may be penetrating.
+    const BicubicSurface& surface = heightMap.getBicubicSurface();
+    const ArrayViewConst_<int> triangles = node.getTriangles();
+    for (int i = 0; i < (int) triangles.size(); i++) {
+        for (int vx=0; vx < 3; ++vx) {
+            const int  vertex = mesh.getFaceVertex(triangles[i], vx);
+            const Vec3 vertexPos_H = X_HM*mesh.getVertexPosition(vertex);
+            const Vec2 vertex_xy(vertexPos_H[0], vertexPos_H[1]);
+            if (   surface.isSurfaceDefined(vertex_xy)
+                && vertexPos_H[2] < surface.calcValue(vertex_xy, hint)) {
+                insideFaces.insert(triangles[i]);
+                break; // done with this face
+            }
+        }
+    }
+}
+
+
+
 //==============================================================================
 //                  HALFSPACE - TRIANGLE MESH CONTACT TRACKER
 //==============================================================================
@@ -869,7 +1515,7 @@ void ContactTracker::HalfSpaceTriangleMesh::processBox
     
     // This is a leaf OBB node that is penetrating, so some of its triangles
     // may be penetrating.
-    const Array_<int>& triangles = node.getTriangles();
+    const ArrayViewConst_<int> triangles = node.getTriangles();
     for (int i = 0; i < (int) triangles.size(); i++) {
         for (int vx=0; vx < 3; ++vx) {
             const int   vertex         = mesh.getFaceVertex(triangles[i], vx);
@@ -888,7 +1534,7 @@ void ContactTracker::HalfSpaceTriangleMesh::addAllTriangles
     std::set<int>& insideFaces) const 
 {
     if (node.isLeafNode()) {
-        const Array_<int>& triangles = node.getTriangles();
+        const ArrayViewConst_<int> triangles = node.getTriangles();
         for (int i = 0; i < (int) triangles.size(); i++)
             insideFaces.insert(triangles[i]);
     }
@@ -973,13 +1619,19 @@ void ContactTracker::SphereTriangleMesh::processBox
     }
     
     // This is a leaf node that may be penetrating; check the triangles.
-    const Array_<int>& triangles = node.getTriangles();
-    for (unsigned i = 0; i < triangles.size(); i++) {
-        Vec2 uv;
-        Vec3 nearest_M = mesh.findNearestPointToFace
-                                    (center_M, triangles[i], uv);
-        if ((nearest_M-center_M).normSqr() < radius2)
-            insideFaces.insert(triangles[i]);
+    typedef ContactGeometry::TriangleMesh::Impl MeshImpl;
+    const MeshImpl& meshImpl = mesh.getImpl();
+    const ArrayViewConst_<int> triangles = node.getTriangles();
+    const int numTriangles = triangles.size();
+    for (int block = 0; block < numTriangles; block += MeshImpl::FaceBlockSize) {
+        const int count = std::min(MeshImpl::FaceBlockSize, numTriangles-block);
+        Vec3 nearest_M[MeshImpl::FaceBlockSize];
+        Vec2 uv[MeshImpl::FaceBlockSize];
+        meshImpl.findNearestPointsToFaces(center_M, triangles.begin()+block, 
+                                          count, nearest_M, uv);
+        for (int i = 0; i < count; i++)
+            if ((nearest_M[i]-center_M).normSqr() < radius2)
+                insideFaces.insert(triangles[block+i]);
     }
 }
 
@@ -1094,25 +1746,32 @@ findIntersectingFaces
     
     // These are both leaf nodes, so check triangles for intersections.
     
-    const Array_<int>& node1triangles = node1.getTriangles();
-    const Array_<int>& node2triangles = node2.getTriangles();
+    // Each triangle of node2 is tested against a block of node1's triangles
+    // at a time.
+    
+    typedef ContactGeometry::TriangleMesh::Impl MeshImpl;
+    const MeshImpl& mesh1Impl = mesh1.getImpl();
+    const ArrayViewConst_<int> node1triangles = node1.getTriangles();
+    const ArrayViewConst_<int> node2triangles = node2.getTriangles();
+    const int numTriangles1 = node1triangles.size();
     for (unsigned i = 0; i < node2triangles.size(); i++) {
         const int face2 = node2triangles[i];
         Vec3 a1 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 0));
         Vec3 a2 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 1));
         Vec3 a3 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 2));
         const Geo::Triangle A(a1,a2,a3);
-        for (unsigned j = 0; j < node1triangles.size(); j++) {
-            const int face1 = node1triangles[j];
-            const Vec3& b1 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 0));
-            const Vec3& b2 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 1));
-            const Vec3& b3 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 2));
-            const Geo::Triangle B(b1,b2,b3);
-            if (A.overlapsTriangle(B)) 
-            {   // The triangles intersect.
-                triangles1.insert(face1);
-                triangles2.insert(face2);
-            }
+        for (int block = 0; block < numTriangles1; 
+             block += MeshImpl::FaceBlockSize) {
+            const int count = 
+                std::min(MeshImpl::FaceBlockSize, numTriangles1-block);
+            const unsigned overlapping = mesh1Impl.findFacesOverlappingTriangle
+                (A, node1triangles.begin()+block, count);
+            for (int j = 0; j < count; j++)
+                if (overlapping & (1u << j)) 
+                {   // The triangles intersect.
+                    triangles1.insert(node1triangles[block+j]);
+                    triangles2.insert(face2);
+                }
         }
     }
 }
@@ -1284,18 +1943,17 @@ bool ContactTracker::ConvexImplicitPair::trackContact
     const Transform X_AB = ~X_GA*X_GB; // 63 flops
     const Rotation& R_AB = X_AB.R();
 
-    // 1. Get a rough guess at the contact points P and Q and contact normal.
+    // 1. Find the contact points P and Q, starting from the prior contact if
+    //    there was one, and refine them to near machine precision.
     Vec3 pointP_A, pointQ_B; // on A and B, resp.
-    UnitVec3 norm_A;
-    int numMPRIters;
-    const bool mightBeContact = estimateConvexImplicitPairContactUsingMPR
-                                   (shapeA, shapeB, X_AB,
-                                    pointP_A, pointQ_B, norm_A, numMPRIters);
+    int numMPRIters, numNewtonIters;
+    const bool mightBeContact = findContactPoints(priorStatus, shapeA, shapeB,
+        X_AB, pointP_A, pointQ_B, numMPRIters, numNewtonIters);
 
     #ifdef MPR_DEBUG
-    std::cout << "MPR: " << (mightBeContact?"MAYBE":"NO") << std::endl;
+    printf("MPR %2d iters, Newton %2d iters: %s\n", numMPRIters, 
+        numNewtonIters, mightBeContact ? "MAYBE" : "NO");
     std::cout << "  P=" << X_GA*pointP_A << " Q=" << X_GB*pointQ_B << std::endl;
-    std::cout << "  N=" << X_GA.R()*norm_A << std::endl;
     #endif
 
     if (!mightBeContact) {
@@ -1303,15 +1961,9 @@ bool ContactTracker::ConvexImplicitPair::trackContact
         return true; // successful return
     }
 
-    // 2. Refine the contact points to near machine precision.
-    const Real accuracyRequested = SignificantReal;
-    Real accuracyAchieved; int numNewtonIters;
-    bool converged = refineImplicitPair(shapeA, pointP_A, shapeB, pointQ_B,
-        X_AB, accuracyRequested, accuracyAchieved, numNewtonIters);
-
     const Vec3 pointQ_A = X_AB*pointQ_B;  // Q on B, measured & expressed in A
 
-    // 3. Compute the curvatures and surface normals of the two surfaces at 
+    // 2. Compute the curvatures and surface normals of the two surfaces at 
     //    P and Q. Once we have the first normal we can check whether there was
     //    actually any contact and duck out early if not.
     Rotation R_AP; Vec2 curvatureP;
@@ -1323,8 +1975,7 @@ bool ContactTracker::ConvexImplicitPair::trackContact
     const Real depth = dot(pointP_A-pointQ_A, R_AP.z());
 
     #ifdef MPR_DEBUG
-    printf("MPR %2d iters, Newton %2d iters->accuracy=%g depth=%g\n",
-        numMPRIters, numNewtonIters, accuracyAchieved, depth);
+    printf("  depth=%g\n", depth);
     #endif  
 
     if (depth <= 0) {
@@ -1338,7 +1989,7 @@ bool ContactTracker::ConvexImplicitPair::trackContact
     shapeB.calcCurvature(pointQ_B, curvatureQ, R_BQ);
     const UnitVec3 maxDirB_A(R_AB*R_BQ.x()); // re-express in A
 
-    // 4. Compute the effective contact frame C and corresponding relative
+    // 3. Compute the effective contact frame C and corresponding relative
     //    curvatures.
     Transform X_AC; Vec2 curvatureC;
 
@@ -1350,7 +2001,7 @@ bool ContactTracker::ConvexImplicitPair::trackContact
                                         maxDirB_A, curvatureQ, 
                                         X_AC.updR(), curvatureC);
 
-    // 5. Return the elliptical point contact for force generation.
+    // 4. Return the elliptical point contact for force generation.
     currentStatus = EllipticalPointContact(priorStatus.getSurface1(),
                                            priorStatus.getSurface2(),
                                            X_AB, X_AC, curvatureC, depth);
@@ -1359,6 +2010,78 @@ bool ContactTracker::ConvexImplicitPair::trackContact
 
 
 
+// Persistent contacts are usually found very near where they were on the
+// previous step, so the prior contact's normal and points are tried first. 
+// Its normal (z of the contact frame, pointing away from A) costs just one 
+// support evaluation to test as a separating plane. Its points P and Q lie 
+// half the depth either side of the contact frame origin; they are fixed in 
+// their own shapes so they remain a good starting guess for Newton as long as
+// the shapes haven't moved much relative to each other. A converged answer 
+// whose normal has flipped is the wrong solution of the contact equations, so
+// we start over with MPR in that case.
+/*static*/ bool ContactTracker::ConvexImplicitPair::findContactPoints
+   (const Contact&          priorStatus,
+    const ContactGeometry&  shapeA,
+    const ContactGeometry&  shapeB,
+    const Transform&        X_AB,
+    Vec3&                   pointP_A,
+    Vec3&                   pointQ_B,
+    int&                    numMPRIters,
+    int&                    numNewtonIters)
+{
+    const Real accuracyRequested = SignificantReal;
+    Real accuracyAchieved;
+    numMPRIters = numNewtonIters = 0;
+
+    if (EllipticalPointContact::isInstance(priorStatus)) {
+        const EllipticalPointContact& prior = 
+            EllipticalPointContact::getAs(priorStatus);
+        const Transform& X_AC = prior.getContactFrame();
+        const UnitVec3&  normal_A = X_AC.z();
+
+        const Support support(shapeA, shapeB, X_AB, normal_A);
+        if (support.depth <= 0) { // origin outside prior support plane
+            UnitVec3 dirInA;
+            support.getResult(pointP_A, pointQ_B, dirInA);
+            return false;
+        }
+
+        // Use the same length scale as MPR to decide what "much" is.
+        Vec3 cA, cB; Real rA, rB;
+        shapeA.getBoundingSphere(cA,rA); shapeB.getBoundingSphere(cB,rB);
+        const Real lengthScale = Real(0.25)*std::min(rA,rB);
+
+        const Vec3 halfDepth_A = (prior.getDepth()/2)*normal_A;
+        const Vec3 priorQ_A    = X_AC.p() - halfDepth_A;
+        const Vec3 priorQ_B    = ~prior.getTransform()*priorQ_A;
+        if ((X_AB*priorQ_B - priorQ_A).normSqr() <= square(lengthScale)) {
+            pointP_A = X_AC.p() + halfDepth_A;
+            pointQ_B = priorQ_B;
+            const bool converged = refineImplicitPair(shapeA, pointP_A, 
+                shapeB, pointQ_B, X_AB, accuracyRequested, accuracyAchieved, 
+                numNewtonIters);
+            if (converged 
+                && ~shapeA.calcSurfaceUnitNormal(pointP_A)*normal_A > 0)
+                return true;
+        }
+    }
+
+    // Cold start: get a rough guess at the contact points P and Q, then 
+    // refine them.
+    UnitVec3 norm_A;
+    if (!estimateConvexImplicitPairContactUsingMPR(shapeA, shapeB, X_AB,
+                                    pointP_A, pointQ_B, norm_A, numMPRIters))
+        return false;
+
+    int numColdNewtonIters;
+    refineImplicitPair(shapeA, pointP_A, shapeB, pointQ_B, X_AB, 
+        accuracyRequested, accuracyAchieved, numColdNewtonIters);
+    numNewtonIters += numColdNewtonIters;
+    return true;
+}
+
+
+
 //==============================================================================
 //                GENERAL IMPLICIT SURFACE PAIR CONTACT TRACKER
 //==============================================================================
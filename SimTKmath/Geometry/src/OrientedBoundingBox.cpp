@@ -26,8 +26,60 @@
 #include "simmath/LinearAlgebra.h"
 #include "simmath/internal/OrientedBoundingBox.h"
 
+// The box tests below are written with AVX2 intrinsics when the compiler is
+// targeting a CPU that has them, operating on one Vec3 per 256-bit register
+// with the fourth lane zeroed. Otherwise the scalar code is used.
+#if defined(__AVX2__) && SimTK_DEFAULT_PRECISION == 2
+    #include <immintrin.h>
+    #define SimTK_OBB_USE_AVX2
+#endif
+
 namespace SimTK {
 
+#ifdef SimTK_OBB_USE_AVX2
+namespace {
+// Load a Vec3 into the first three lanes of a register, zeroing the fourth.
+// A masked load never touches the memory past the end of the Vec3.
+inline __m256d load3(const Real* v) {
+    return _mm256_maskload_pd(v, _mm256_set_epi64x(0, -1, -1, -1));
+}
+
+inline void store3(Real* v, __m256d x) {
+    _mm256_maskstore_pd(v, _mm256_set_epi64x(0, -1, -1, -1), x);
+}
+
+inline __m256d abs4(__m256d x) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+// Return (~c0*v, ~c1*v, ~c2*v, ~c2*v), that is, ~M*v where c0, c1 and c2 are
+// the columns of M, each with a zero fourth lane.
+inline __m256d transposeTimes(__m256d c0, __m256d c1, __m256d c2, __m256d v) {
+    const __m256d h01 = _mm256_hadd_pd(_mm256_mul_pd(c0, v), 
+                                       _mm256_mul_pd(c1, v));
+    const __m256d h22 = _mm256_hadd_pd(_mm256_mul_pd(c2, v), 
+                                       _mm256_mul_pd(c2, v));
+    return _mm256_add_pd(_mm256_permute2f128_pd(h01, h22, 0x20),
+                         _mm256_permute2f128_pd(h01, h22, 0x31));
+}
+
+// Return M*v = c0*v[0] + c1*v[1] + c2*v[2].
+inline __m256d times(__m256d c0, __m256d c1, __m256d c2, __m256d v) {
+    const __m256d x = _mm256_permute4x64_pd(v, 0x00);
+    const __m256d y = _mm256_permute4x64_pd(v, 0x55);
+    const __m256d z = _mm256_permute4x64_pd(v, 0xAA);
+    return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(c0, x), 
+                                       _mm256_mul_pd(c1, y)),
+                         _mm256_mul_pd(c2, z));
+}
+
+// True if any lane of a is greater than the same lane of b.
+inline bool anyGreater(__m256d a, __m256d b) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ)) != 0;
+}
+}
+#endif
+
 OrientedBoundingBox::OrientedBoundingBox() {
 }
 
@@ -164,6 +216,44 @@ bool OrientedBoundingBox::intersectsBox(const OrientedBoundingBox& box) const {
     // an additional check which allows an early acceptance if the center of
     // one box is inside the other one.
     
+#ifdef SimTK_OBB_USE_AVX2
+    {
+        // The first six tests, done three axes at a time.
+
+        const __m256d rc0 = load3(&r(0,0));
+        const __m256d rc1 = load3(&r(0,1));
+        const __m256d rc2 = load3(&r(0,2));
+        const __m256d ac0 = abs4(rc0);
+        const __m256d ac1 = abs4(rc1);
+        const __m256d ac2 = abs4(rc2);
+        const __m256d av = load3(&a[0]);
+        const __m256d bv = load3(&b[0]);
+        const __m256d dv = load3(&d[0]);
+
+        // The three axes of this box.
+
+        const __m256d dist1 = abs4(dv);
+        if (anyGreater(dist1, _mm256_add_pd(av, times(ac0, ac1, ac2, bv))))
+            return false;
+        if (!anyGreater(dist1, av))
+            return true;
+
+        // The three axes of the other box. The fourth lane of 
+        // transposeTimes() duplicates the third, so it is zeroed before the
+        // comparisons.
+
+        const __m256d mask3 = _mm256_castsi256_pd(
+                                    _mm256_set_epi64x(0, -1, -1, -1));
+        const __m256d dist2 = _mm256_and_pd(mask3,
+                                    abs4(transposeTimes(rc0, rc1, rc2, dv)));
+        const __m256d ra = _mm256_and_pd(mask3, 
+                                    transposeTimes(ac0, ac1, ac2, av));
+        if (anyGreater(dist2, _mm256_add_pd(ra, bv)))
+            return false;
+        if (!anyGreater(dist2, bv))
+            return true;
+    }
+#else
     // First check the three axes of this box.
     
     bool accept = true;
@@ -193,6 +283,7 @@ bool OrientedBoundingBox::intersectsBox(const OrientedBoundingBox& box) const {
     }
     if (accept)
         return true;
+#endif
     
     // Now check the nine axes formed from cross products of one axis from each 
     // box.
@@ -340,6 +431,24 @@ bool OrientedBoundingBox::intersectsRay
 }
 
 Vec3 OrientedBoundingBox::findNearestPoint(const Vec3& position) const {
+#ifdef SimTK_OBB_USE_AVX2
+    const Mat33& r = transform.R().asMat33();
+    const __m256d c0 = load3(&r(0,0));
+    const __m256d c1 = load3(&r(0,1));
+    const __m256d c2 = load3(&r(0,2));
+    const __m256d origin = load3(&transform.p()[0]);
+    
+    // Transform the point to the bounding box's reference frame, clamp it to
+    // the box, then transform it back again.
+    
+    const __m256d p = transposeTimes(c0, c1, c2, 
+                          _mm256_sub_pd(load3(&position[0]), origin));
+    const __m256d clamped = _mm256_min_pd(_mm256_max_pd(p, _mm256_setzero_pd()),
+                                          load3(&size[0]));
+    Vec3 nearest;
+    store3(&nearest[0], _mm256_add_pd(origin, times(c0, c1, c2, clamped)));
+    return nearest;
+#else
     // Transform the point to the bounding box's reference frame.
     
     Vec3 p = ~getTransform()*position;
@@ -362,6 +471,7 @@ Vec3 OrientedBoundingBox::findNearestPoint(const Vec3& position) const {
     // Transform it back again.
     
     return getTransform()*p;
+#endif
 }
 
 void OrientedBoundingBox::getCorners(Vec3 corners[8]) const {
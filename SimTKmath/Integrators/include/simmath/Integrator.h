@@ -330,6 +330,10 @@ public:
     /// of whether those iterations led to convergence or to successful steps. This is the sum of
     /// the number of convergent and divergent iterations which are available separately.
     int getNumIterations() const;
+    /// Get the accumulated time spent taking internal steps (including the
+    /// failed attempts) since the last call to resetAllStatistics(). This is
+    /// updated only while profiling is enabled; see Profiler.
+    const TimingCounter& getStepTimingCounter() const;
 
     /// Set the time at which the simulation should end.  The default is infinity.  Some integrators may
     /// not support this option.
@@ -410,7 +410,9 @@ AbstractIntegratorRep::stepTo(Real reportTime, Real scheduledEventTime) {
          
           //---------------- TAKE ONE STEP --------------------
           // Now take a step and see whether an event occurred.
-          bool eventOccurred = takeOneStep(tMax, reportTime);
+          bool eventOccurred;
+          {   Profiler::Scope scope(stepTimingCounter, "integrator");
+              eventOccurred = takeOneStep(tMax, reportTime); }
           //---------------------------------------------------
 
           ++internalStepsTaken;
@@ -390,7 +390,8 @@ stepTo(Real reportTime, Real scheduledEventTime) {
             cpodes->getNumNonlinSolvConvFails(&oldNonlinConvFailures);
 
             //---------------------step------------------------
-            res = cpodes->step(tMax, &tret, yout, ypout, mode);
+            {   Profiler::Scope scope(stepTimingCounter, "integrator");
+                res = cpodes->step(tMax, &tret, yout, ypout, mode); }
             //-------------------------------------------------
             if (res == CPodes::TstopReturn && isFakeTstop)
                 res = CPodes::Success;
@@ -232,6 +232,9 @@ int Integrator::getNumDivergentIterations() const {
 int Integrator::getNumIterations() const {
     return getRep().getNumIterations();
 }
+const TimingCounter& Integrator::getStepTimingCounter() const {
+    return getRep().getStepTimingCounter();
+}
 
 void Integrator::setFinalTime(Real tFinal) {
     assert(tFinal == -1. || (0. <= tFinal));
@@ -333,6 +336,7 @@ IntegratorRep::IntegratorRep
 void IntegratorRep::initialize(const State& initState) {
   try
   { invalidateIntegratorInternalState();
+    stepTimingCounter.setName(String(getMethodName()) + "::step");
 
     // Copy the supplied initial state into the integrator.
     updAdvancedState() = initState;
@@ -939,6 +939,7 @@ protected:
         statsQProjections = statsUProjections = 0;
         statsRealizationFailures = 0;
         statsQProjectionFailures = statsUProjectionFailures = 0;
+        stepTimingCounter.reset();
     }
 
     int getNumRealizations() const {return statsRealizations;} 
@@ -949,6 +950,9 @@ protected:
     int getNumQProjectionFailures() const {return statsQProjectionFailures;} 
     int getNumUProjectionFailures() const {return statsUProjectionFailures;} 
 
+    const TimingCounter& getStepTimingCounter() const 
+    {   return stepTimingCounter; }
+
 private:
     class EventSorter {
     public:
@@ -1004,6 +1008,8 @@ protected:
     mutable int statsQProjections, statsUProjections;
     mutable int statsRealizations;
     mutable int statsRealizationFailures;
+    // Time spent in the integration method's steps, while profiling.
+    mutable TimingCounter stepTimingCounter;
 private:
 
         // SYSTEM INFORMATION
@@ -0,0 +1,198 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+
+using namespace SimTK;
+
+namespace {
+const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                 ContactSurfaceIndex(1));
+}
+
+// A sphere touching a face, an edge, and with its center inside the brick.
+void testSphereBrick() {
+    const ContactTracker::SphereBrick tracker;
+    const ContactGeometry::Sphere sphere(0.5);
+    const ContactGeometry::Brick brick(Vec3(1, 2, 3));
+    const Transform X_GB(Rotation(0.3, ZAxis), Vec3(1, 2, 3));
+    Contact contact;
+
+    // Resting on brick's +y face.
+    SimTK_TEST(tracker.trackContact(untracked, X_GB*Transform(Vec3(0.2, 2.4, 0)),
+        sphere, X_GB, brick, 0, contact));
+    SimTK_TEST(CircularPointContact::isInstance(contact));
+    const CircularPointContact& face = CircularPointContact::getAs(contact);
+    SimTK_TEST_EQ(face.getDepth(), 0.1);
+    SimTK_TEST_EQ(face.getEffectiveRadius(), 0.5);
+    SimTK_TEST_EQ(face.getNormal(), Vec3(0, -1, 0));
+    SimTK_TEST_EQ(face.getOrigin(), Vec3(0, -0.45, 0));
+
+    // Over the edge between the +x and +y faces.
+    SimTK_TEST(tracker.trackContact(untracked, X_GB*Transform(Vec3(1.3, 2.3, 1)),
+        sphere, X_GB, brick, 0, contact));
+    const CircularPointContact& edge = CircularPointContact::getAs(contact);
+    SimTK_TEST_EQ(edge.getDepth(), 0.5 - 0.3*std::sqrt(2.));
+    SimTK_TEST_EQ(edge.getNormal(), -UnitVec3(1, 1, 0));
+    SimTK_TEST_EQ(edge.getOrigin(),
+        Vec3(-0.3, -0.3, 0) - (edge.getDepth()/2)*UnitVec3(1, 1, 0));
+
+    // Center just inside the +y face.
+    SimTK_TEST(tracker.trackContact(untracked, X_GB*Transform(Vec3(0, 1.9, 0)),
+        sphere, X_GB, brick, 0, contact));
+    const CircularPointContact& deep = CircularPointContact::getAs(contact);
+    SimTK_TEST_EQ(deep.getDepth(), 0.6);
+    SimTK_TEST_EQ(deep.getNormal(), Vec3(0, -1, 0));
+
+    // Separated, unless the cutoff is large enough.
+    SimTK_TEST(tracker.trackContact(untracked, X_GB*Transform(Vec3(0, 2.6, 0)),
+        sphere, X_GB, brick, 0, contact));
+    SimTK_TEST(contact.isEmpty());
+    SimTK_TEST(tracker.trackContact(untracked, X_GB*Transform(Vec3(0, 2.6, 0)),
+        sphere, X_GB, brick, 0.2, contact));
+    SimTK_TEST_EQ(CircularPointContact::getAs(contact).getDepth(), -0.1);
+
+    // Everywhere the depth agrees with the box's own nearest point.
+    const Geo::Box box = brick.getGeoBox();
+    for (int i = 0; i < 200; ++i) {
+        const Vec3 center_B(1.6*std::sin(1.3*i), 2.6*std::sin(0.7*i+1),
+                            3.6*std::sin(0.4*i+2));
+        bool inside;
+        const Vec3 nearest_B = box.findClosestPointOnSurface(center_B, inside);
+        const Real distance = (inside ? -1 : 1)*(center_B - nearest_B).norm();
+        SimTK_TEST(tracker.trackContact(untracked, X_GB*Transform(center_B),
+            sphere, X_GB, brick, 1, contact));
+        if (distance > 1.5) {
+            SimTK_TEST(contact.isEmpty());
+            continue;
+        }
+        const CircularPointContact& point =
+            CircularPointContact::getAs(contact);
+        SimTK_TEST_EQ_TOL(point.getDepth(), 0.5 - distance, 1e-10);
+        // The brick's contact point is its nearest point to the center.
+        SimTK_TEST_EQ_TOL(point.getOrigin()
+            - (point.getDepth()/2)*point.getNormal(),
+            nearest_B - center_B, 1e-10);
+    }
+}
+
+// Two cubes stacked face to face, twisted, and edge to edge.
+void testBrickBrick() {
+    const ContactTracker::BrickBrick tracker;
+    const ContactGeometry::Brick cube(Vec3(0.5));
+    Contact contact;
+
+    // Aligned: one point at each corner of the touching faces.
+    SimTK_TEST(tracker.trackContact(untracked, Transform(), cube,
+        Transform(Vec3(0.1, 0.95, 0)), cube, 0, contact));
+    SimTK_TEST(ManifoldContact::isInstance(contact));
+    const ManifoldContact& aligned = ManifoldContact::getAs(contact);
+    SimTK_TEST_EQ(aligned.getNormal(), Vec3(0, 1, 0));
+    SimTK_TEST(aligned.getNumPoints() == 4);
+    for (int i = 0; i < aligned.getNumPoints(); ++i) {
+        SimTK_TEST_EQ(aligned.getDepth(i), 0.05);
+        SimTK_TEST_EQ(aligned.getOrigin(i)[1], 0.475);
+        SimTK_TEST(std::abs(aligned.getOrigin(i)[0]) <= 0.5 + 1e-12);
+    }
+
+    // Twisted 45 degrees: the faces overlap in an octagon.
+    SimTK_TEST(tracker.trackContact(untracked, Transform(), cube,
+        Transform(Rotation(Pi/4, YAxis), Vec3(0, 0.95, 0)), cube, 0, contact));
+    const ManifoldContact& twisted = ManifoldContact::getAs(contact);
+    SimTK_TEST_EQ(twisted.getNormal(), Vec3(0, 1, 0));
+    SimTK_TEST(twisted.getNumPoints() == 8);
+    for (int i = 0; i < twisted.getNumPoints(); ++i)
+        SimTK_TEST_EQ(twisted.getDepth(i), 0.05);
+
+    // A tilted cube resting on a slab: the slab (surface2) has the reference
+    // face and the normal still points from surface1 to surface2.
+    const ContactGeometry::Brick slab(Vec3(2, 1, 2));
+    const Transform X_GA(Rotation(0.1, XAxis), Vec3(0, 1.4, 0));
+    SimTK_TEST(tracker.trackContact(untracked, X_GA, cube,
+        Transform(), slab, 0, contact));
+    const ManifoldContact& tilted = ManifoldContact::getAs(contact);
+    SimTK_TEST_EQ(tilted.getNormal(), ~X_GA.R()*Vec3(0, -1, 0));
+    SimTK_TEST(tilted.getNumPoints() == 4);
+    for (int i = 0; i < tilted.getNumPoints(); ++i) {
+        const Real d = tilted.getDepth(i);
+        SimTK_TEST(d > 0);
+        // The cube's point is one of its bottom corners; the slab's point is
+        // right below it on the slab's top face.
+        const Vec3 corner = tilted.getOrigin(i) + (d/2)*tilted.getNormal();
+        SimTK_TEST_EQ(corner.abs(), Vec3(0.5));
+        SimTK_TEST_EQ(corner[1], -0.5);
+        SimTK_TEST_EQ((X_GA*(corner - d*tilted.getNormal()))[1], 1);
+    }
+
+    // Crossed edges meet at a single point.
+    const Real h = std::sqrt(0.5);
+    SimTK_TEST(tracker.trackContact(untracked,
+        Transform(Rotation(Pi/4, ZAxis)), cube,
+        Transform(Rotation(Pi/4, XAxis), Vec3(0, 2*h - 0.02, 0)), cube, 0,
+        contact));
+    const ManifoldContact& crossed = ManifoldContact::getAs(contact);
+    SimTK_TEST(crossed.getNumPoints() == 1);
+    SimTK_TEST_EQ(crossed.getDepth(0), 0.02);
+    SimTK_TEST_EQ(crossed.getNormal(), Rotation(-Pi/4, ZAxis)*Vec3(0, 1, 0));
+    SimTK_TEST_EQ(crossed.getOrigin(0),
+        Rotation(-Pi/4, ZAxis)*Vec3(0, h - 0.01, 0));
+
+    // Separated.
+    SimTK_TEST(tracker.trackContact(untracked, Transform(), cube,
+        Transform(Vec3(0, 1.1, 0)), cube, 0, contact));
+    SimTK_TEST(contact.isEmpty());
+}
+
+// A sphere against the side of the infinite cylinder.
+void testSphereCylinder() {
+    const ContactTracker::SphereCylinder tracker;
+    const ContactGeometry::Sphere sphere(0.5);
+    const ContactGeometry::Cylinder cylinder(1);
+    const Transform X_GC(Rotation(0.4, XAxis), Vec3(1, 2, 3));
+    Contact contact;
+
+    SimTK_TEST(tracker.trackContact(untracked, X_GC*Transform(Vec3(1.4, 0, 7)),
+        sphere, X_GC, cylinder, 0, contact));
+    SimTK_TEST(EllipticalPointContact::isInstance(contact));
+    const EllipticalPointContact& point =
+        EllipticalPointContact::getAs(contact);
+    SimTK_TEST_EQ(point.getDepth(), 0.1);
+    SimTK_TEST_EQ(point.getCurvatures(), Vec2(3, 2));
+    const Transform& X_SC = point.getContactFrame();
+    SimTK_TEST_EQ(X_SC.p(), Vec3(-0.45, 0, 0));
+    SimTK_TEST_EQ(X_SC.z(), Vec3(-1, 0, 0));
+    SimTK_TEST_EQ(std::abs(X_SC.y()[2]), 1); // minimum curvature along axis
+
+    // Separated.
+    SimTK_TEST(tracker.trackContact(untracked, X_GC*Transform(Vec3(0, 1.6, 0)),
+        sphere, X_GC, cylinder, 0, contact));
+    SimTK_TEST(contact.isEmpty());
+}
+
+int main() {
+    SimTK_START_TEST("TestAnalyticContactTrackers");
+        SimTK_SUBTEST(testSphereBrick);
+        SimTK_SUBTEST(testBrickBrick);
+        SimTK_SUBTEST(testSphereCylinder);
+    SimTK_END_TEST();
+}
@@ -1035,12 +1035,100 @@ void testHint() {
 
 }
 
+// Points scattered over the patches in no particular order give the same
+// values one at a time or as a batch, but the batch computes each patch only
+// once.
+void testCalcValues() {
+    const Real xData[4] = { .1, 1, 2, 10 };
+    const Real yData[5] = { -3, -2, 0, 1, 3 };
+    const Real fData[] = { 1,   2,   3,   4,   5,
+                           1.1, 2.1, 3.1, 4.1, 5.1,
+                           1,   2,   3,   4,   5,
+                           1.2, 2.2, 3.2, 4.2, 5.2 };
+    const Vector x(4,   xData);
+    const Vector y(5,   yData);
+    const Matrix f(4,5, fData);
+    const BicubicSurface irregular(x, y, f, 0);
+    const BicubicSurface regular(Vec2(-1, 2), Vec2(.5, .25), f, 0);
+
+    for (const BicubicSurface* surf : {&irregular, &regular}) {
+        const Vec2 lo = surf->getMinXY(), hi = surf->getMaxXY();
+        Array_<Vec2> XY;
+        for (int i=0; i < 200; ++i)
+            XY.push_back(Vec2(lo[0] + (hi[0]-lo[0])*(1+std::sin(2.3*i))/2,
+                              lo[1] + (hi[1]-lo[1])*(1+std::sin(1.7*i+1))/2));
+        XY.push_back(hi); // the far corner is on the surface too
+
+        Array_<Real> values(XY.size());
+        surf->resetStatistics();
+        surf->calcValues(XY, values);
+        SimTK_TEST(surf->getNumAccesses() == (int)XY.size());
+        int nx, ny; surf->getNumPatches(nx, ny);
+        SimTK_TEST(surf->getNumAccessesSamePatch()
+                   + surf->getNumAccessesSamePoint()
+                   >= (int)XY.size() - nx*ny);
+
+        BicubicSurface::PatchHint hint;
+        for (unsigned i=0; i < XY.size(); ++i)
+            SimTK_TEST(values[i] == surf->calcValue(XY[i], hint));
+    }
+
+    Array_<Real> values(1);
+    SimTK_TEST_MUST_THROW(irregular.calcValues(Array_<Vec2>(2), values));
+    SimTK_TEST_MUST_THROW(irregular.calcValues(Array_<Vec2>(1, Vec2(-5,0)),
+                                               values));
+}
+
+// Several threads query the same height map at once; each gets the same
+// answers it would get alone.
+class HeightMapQueryTask : public ParallelExecutor::Task {
+public:
+    HeightMapQueryTask(const ContactGeometry::SmoothHeightMap& terrain,
+                       const Array_<Vec3>& points, Array_<Real>& values)
+    :   terrain(terrain), points(points), values(values) {}
+    void execute(int i) override {
+        values[i] = terrain.calcSurfaceValue(points[i]);
+    }
+private:
+    const ContactGeometry::SmoothHeightMap& terrain;
+    const Array_<Vec3>&                     points;
+    Array_<Real>&                           values;
+};
+
+void testConcurrentHeightMapQueries() {
+    Matrix f(20, 30);
+    for (int i=0; i < f.nrow(); ++i)
+        for (int j=0; j < f.ncol(); ++j)
+            f(i,j) = std::sin(.3*i)*std::cos(.2*j);
+    const ContactGeometry::SmoothHeightMap
+        terrain(BicubicSurface(Vec2(0), Vec2(.1), f, 0));
+    const BicubicSurface& surf = terrain.getBicubicSurface();
+
+    Array_<Vec3> points;
+    for (int i=0; i < 2000; ++i)
+        points.push_back(Vec3(.95*(1+std::sin(1.1*i)), 1.45*(1+std::sin(.7*i)),
+                              .5*std::sin(.3*i)));
+    Array_<Real> values(points.size()), expected(points.size());
+    for (unsigned i=0; i < points.size(); ++i)
+        expected[i] = surf.calcValue(Vec2(points[i][0], points[i][1]))
+                      - points[i][2];
+
+    ParallelExecutor executor(4);
+    HeightMapQueryTask task(terrain, points, values);
+    for (int rep=0; rep < 10; ++rep) {
+        executor.execute(task, (int)points.size());
+        SimTK_TEST(values == expected);
+    }
+}
+
 int main() {
     //Evaluate the bicubic surface interpolation against an analytical 
     //function. Throw an error if the values of the function are different
     //at the knot points, or different within tolerance at the mid grid points
     SimTK_START_TEST("Testing Bicubic Interpolation");
         SimTK_SUBTEST(testHint);
+        SimTK_SUBTEST(testCalcValues);
+        SimTK_SUBTEST(testConcurrentHeightMapQueries);
 
     cout << "\n---------------------------------------------"<< endl;
     cout<< "\n\nANALYTICAL FUNCTION COMPARISON:" << endl;
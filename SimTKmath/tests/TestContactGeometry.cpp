@@ -226,6 +226,52 @@ void testEllipsoid() {
     }
 }
 
+void testBrick() {
+    // Create a brick.
+
+    Vec3 halfLengths(1, 2, 3);
+    ContactGeometry::Brick brick(halfLengths);
+
+    // Check intersections with rays from outside and inside.
+
+    Real distance;
+    UnitVec3 normal;
+    ASSERT(!brick.intersectsRay(Vec3(2, 0, 0), UnitVec3(1, 0, 0), distance, normal));
+    ASSERT(!brick.intersectsRay(Vec3(2, 0, 0), UnitVec3(0, 1, 1), distance, normal));
+    ASSERT(!brick.intersectsRay(Vec3(2, 3, 0), UnitVec3(-1, 0.5, 0), distance, normal));
+    ASSERT(brick.intersectsRay(Vec3(4, 0, 0), UnitVec3(-1, 0, 0), distance, normal));
+    assertEqual(3.0, distance);
+    assertEqual(Vec3(1, 0, 0), normal);
+    ASSERT(brick.intersectsRay(Vec3(0, -5, 1), UnitVec3(0, 1, 0), distance, normal));
+    assertEqual(3.0, distance);
+    assertEqual(Vec3(0, -1, 0), normal);
+    ASSERT(brick.intersectsRay(Vec3(0, 0, 0), UnitVec3(0, 0, -1), distance, normal));
+    assertEqual(3.0, distance);
+    assertEqual(Vec3(0, 0, -1), normal);
+    ASSERT(brick.intersectsRay(Vec3(0, 0, 0), UnitVec3(1, 1, 1), distance, normal));
+    assertEqual(Sqrt3, distance);
+    assertEqual(Vec3(1, 0, 0), normal);
+
+    // Every hit is on the surface, where the normal is the face's.
+
+    Random::Gaussian random(0, 3);
+    for (int i = 0; i < 100; i++) {
+        Vec3 origin(random.getValue(), random.getValue(), random.getValue());
+        UnitVec3 direction(random.getValue(), random.getValue(), random.getValue());
+        if (!brick.intersectsRay(origin, direction, distance, normal))
+            continue;
+        Vec3 hit = origin+distance*direction;
+        int axis = 0;
+        for (int j = 1; j < 3; j++)
+            if (abs(hit[j])/halfLengths[j] > abs(hit[axis])/halfLengths[axis])
+                axis = j;
+        assertEqual(abs(hit[axis]), halfLengths[axis]);
+        Vec3 expectedNormal(0);
+        expectedNormal[axis] = hit[axis] > 0 ? 1 : -1;
+        assertEqual(expectedNormal, normal.asVec3());
+    }
+}
+
 void testTorus() {
     Real radius = r;
     Real tubeRadius = 0.75;
@@ -468,6 +514,7 @@ int main() {
         testSphere();
         testEllipsoid();
         testCylinder();
+        testBrick();
         testTorus();
 
         // TODO clean up these tests and use them
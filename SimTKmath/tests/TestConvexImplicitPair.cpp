@@ -0,0 +1,140 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+
+using namespace SimTK;
+
+// The pose of ellipsoid B in ellipsoid A's frame at step i of a slow relative
+// motion during which they stay in contact.
+Transform poseOfBInA(int i) {
+    return Transform(Rotation(0.3 + 0.01*i, UnitVec3(1, 0.5, 0.2)),
+                     Vec3(0.02*i, 2.9 - 0.002*i, 0.5 - 0.005*i));
+}
+
+// Check that two elliptical point contacts describe the same contact.
+void compareContacts(const Contact& actual, const Contact& expected) {
+    SimTK_TEST(EllipticalPointContact::isInstance(actual));
+    SimTK_TEST(EllipticalPointContact::isInstance(expected));
+    const EllipticalPointContact& a = EllipticalPointContact::getAs(actual);
+    const EllipticalPointContact& e = EllipticalPointContact::getAs(expected);
+    SimTK_TEST_EQ_TOL(a.getDepth(), e.getDepth(), 1e-8);
+    SimTK_TEST_EQ_TOL(a.getContactFrame().p(), e.getContactFrame().p(), 1e-8);
+    SimTK_TEST_EQ_TOL(a.getContactFrame().z(), e.getContactFrame().z(), 1e-8);
+    SimTK_TEST_EQ_TOL(a.getCurvatures(), e.getCurvatures(), 1e-6);
+}
+
+// Starting from the prior contact must find the same contact as starting
+// from scratch, without running MPR and with fewer Newton iterations.
+void testWarmStartMatchesColdStart() {
+    const ContactGeometry::Ellipsoid shapeA(Vec3(1, 2, 1.5));
+    const ContactGeometry::Ellipsoid shapeB(Vec3(0.8, 1.2, 1.6));
+    const ContactTracker::ConvexImplicitPair tracker
+       (ContactGeometry::Ellipsoid::classTypeId(),
+        ContactGeometry::Ellipsoid::classTypeId());
+    const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                     ContactSurfaceIndex(1));
+    const Transform X_GA(Rotation(0.4, YAxis), Vec3(1, 2, 3));
+
+    Contact prior = untracked;
+    int coldMPRIters = 0, coldNewtonIters = 0, warmNewtonIters = 0;
+    for (int i = 0; i < 30; ++i) {
+        const Transform X_GB = X_GA*poseOfBInA(i);
+        Contact cold, warm;
+        SimTK_TEST(tracker.trackContact(untracked, X_GA, shapeA, X_GB, shapeB,
+                                        0, cold));
+        SimTK_TEST(tracker.trackContact(prior, X_GA, shapeA, X_GB, shapeB,
+                                        0, warm));
+        compareContacts(warm, cold);
+        prior = warm;
+
+        Vec3 pointP_A, pointQ_B;
+        int numMPRIters, numNewtonIters;
+        SimTK_TEST(ContactTracker::ConvexImplicitPair::findContactPoints
+           (untracked, shapeA, shapeB, poseOfBInA(i), pointP_A, pointQ_B,
+            numMPRIters, numNewtonIters));
+        coldMPRIters += numMPRIters;
+        coldNewtonIters += numNewtonIters;
+        if (i > 0) {
+            SimTK_TEST(ContactTracker::ConvexImplicitPair::findContactPoints
+               (cold, shapeA, shapeB, poseOfBInA(i+1), pointP_A, pointQ_B,
+                numMPRIters, numNewtonIters));
+            SimTK_TEST(numMPRIters == 0);
+            warmNewtonIters += numNewtonIters;
+        }
+    }
+    SimTK_TEST(coldMPRIters > 0);
+    SimTK_TEST(warmNewtonIters < coldNewtonIters);
+}
+
+// A prior contact from a very different pose must not be trusted, and one
+// whose normal now separates the shapes proves there is no contact.
+void testWarmStartFallsBack() {
+    const ContactGeometry::Ellipsoid shapeA(Vec3(1, 2, 1.5));
+    const ContactGeometry::Sphere shapeB(1);
+    const ContactTracker::ConvexImplicitPair tracker
+       (ContactGeometry::Ellipsoid::classTypeId(),
+        ContactGeometry::Sphere::classTypeId());
+    const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                     ContactSurfaceIndex(1));
+    const Transform X_GA;
+
+    // In contact on the +y side of A.
+    Contact prior;
+    SimTK_TEST(tracker.trackContact(untracked, X_GA, shapeA,
+        Transform(Vec3(0, 2.8, 0)), shapeB, 0, prior));
+    SimTK_TEST(EllipticalPointContact::isInstance(prior));
+
+    // Now in contact on the -x side instead.
+    const Transform X_GB(Vec3(-1.8, 0.3, 0.2));
+    Contact cold, warm;
+    SimTK_TEST(tracker.trackContact(untracked, X_GA, shapeA, X_GB, shapeB,
+                                    0, cold));
+    SimTK_TEST(tracker.trackContact(prior, X_GA, shapeA, X_GB, shapeB,
+                                    0, warm));
+    compareContacts(warm, cold);
+    Vec3 pointP_A, pointQ_B;
+    int numMPRIters, numNewtonIters;
+    SimTK_TEST(ContactTracker::ConvexImplicitPair::findContactPoints
+       (prior, shapeA, shapeB, X_GB, pointP_A, pointQ_B,
+        numMPRIters, numNewtonIters));
+    SimTK_TEST(numMPRIters > 0);
+
+    // Moved just out of contact along the prior normal.
+    const Transform X_GB2(Vec3(0, 3.01, 0));
+    SimTK_TEST(!ContactTracker::ConvexImplicitPair::findContactPoints
+       (prior, shapeA, shapeB, X_GB2, pointP_A, pointQ_B,
+        numMPRIters, numNewtonIters));
+    SimTK_TEST(numMPRIters == 0 && numNewtonIters == 0);
+    Contact separated;
+    SimTK_TEST(tracker.trackContact(prior, X_GA, shapeA, X_GB2, shapeB,
+                                    0, separated));
+    SimTK_TEST(separated.isEmpty());
+}
+
+int main() {
+    SimTK_START_TEST("TestConvexImplicitPair");
+        SimTK_SUBTEST(testWarmStartMatchesColdStart);
+        SimTK_SUBTEST(testWarmStartFallsBack);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,269 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+
+using namespace SimTK;
+
+namespace {
+const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                 ContactSurfaceIndex(1));
+
+// A height map sampled from z = a*x + b*y + c on [-5,5]x[-4,4], which is a
+// tilted plane.
+ContactGeometry::SmoothHeightMap createPlane(Real a, Real b, Real c) {
+    Matrix f(21, 17);
+    for (int i=0; i < f.nrow(); ++i)
+        for (int j=0; j < f.ncol(); ++j)
+            f(i,j) = a*(-5 + .5*i) + b*(-4 + .5*j) + c;
+    return ContactGeometry::SmoothHeightMap
+       (BicubicSurface(Vec2(-5,-4), Vec2(.5), f, 0));
+}
+
+// A height map with bumps, sampled from z = .3*sin(x)*cos(1.3*y).
+ContactGeometry::SmoothHeightMap createBumps() {
+    Matrix f(41, 33);
+    for (int i=0; i < f.nrow(); ++i)
+        for (int j=0; j < f.ncol(); ++j)
+            f(i,j) = .3*std::sin(-5 + .25*i)*std::cos(1.3*(-4 + .25*j));
+    return ContactGeometry::SmoothHeightMap
+       (BicubicSurface(Vec2(-5,-4), Vec2(.25), f, 0));
+}
+}
+
+// The nearest point on a bumpy height map is no farther than any point on a
+// fine sampling of the surface near it, and the normal points at the query
+// point.
+void testFindNearestPoint() {
+    const ContactGeometry::SmoothHeightMap bumps = createBumps();
+    const BicubicSurface& surface = bumps.getBicubicSurface();
+    for (int i=0; i < 50; ++i) {
+        const Vec3 P(3*std::sin(1.7*i), 2.5*std::sin(.9*i+1),
+                     .6*std::sin(.5*i+2));
+        bool inside; UnitVec3 normal;
+        const Vec3 Q = bumps.findNearestPoint(P, inside, normal);
+        SimTK_TEST(inside == (P[2] < surface.calcValue(Vec2(P[0],P[1]))));
+        SimTK_TEST_EQ_TOL(Q[2], surface.calcValue(Vec2(Q[0],Q[1])), 1e-12);
+        SimTK_TEST_EQ(normal, surface.calcUnitNormal(Vec2(Q[0],Q[1])));
+        const Real dist = (P-Q).norm();
+        if (dist > 1e-6)
+            SimTK_TEST_EQ_TOL(normal, (inside ? -1 : 1)*(P-Q)/dist, 1e-8);
+
+        BicubicSurface::PatchHint hint;
+        for (Real dx=-.5; dx <= .5; dx += .05)
+            for (Real dy=-.5; dy <= .5; dy += .05) {
+                const Vec2 xy(P[0]+dx, P[1]+dy);
+                const Vec3 S(xy[0], xy[1], surface.calcValue(xy, hint));
+                SimTK_TEST(dist <= (P-S).norm() + 1e-12);
+            }
+    }
+}
+
+// A ray hits a bumpy height map at a point on the surface, with the
+// surface's normal there, and doesn't pass through the surface before that.
+void testIntersectsRay() {
+    const ContactGeometry::SmoothHeightMap bumps = createBumps();
+    const BicubicSurface& surface = bumps.getBicubicSurface();
+    Real distance; UnitVec3 normal;
+    int numHits = 0;
+    for (int i=0; i < 50; ++i) {
+        const Vec3 origin(3*std::sin(1.7*i), 2.5*std::sin(.9*i+1),
+                          1 + .5*std::sin(.5*i+2));
+        const UnitVec3 direction(std::sin(1.3*i), std::cos(1.3*i),
+                                 -.3 - .2*std::sin(.7*i));
+        if (!bumps.intersectsRay(origin, direction, distance, normal))
+            continue;
+        ++numHits;
+        const Vec3 P = origin + distance*direction;
+        const Vec2 xy(P[0], P[1]);
+        SimTK_TEST_EQ_TOL(P[2], surface.calcValue(xy), 1e-10);
+        SimTK_TEST_EQ(normal, surface.calcUnitNormal(xy));
+        for (Real t=0; t < distance; t += distance/200) {
+            const Vec3 Q = origin + t*direction;
+            SimTK_TEST(Q[2] >= surface.calcValue(Vec2(Q[0],Q[1])) - 1e-10);
+        }
+    }
+    SimTK_TEST(numHits > 20);
+
+    // Straight down, straight up from below, and away from the surface.
+    const Vec2 xy(.7, -1.2);
+    const Real z = surface.calcValue(xy);
+    SimTK_TEST(bumps.intersectsRay(Vec3(xy[0], xy[1], 2), UnitVec3(0, 0, -1),
+                                   distance, normal));
+    SimTK_TEST_EQ(distance, 2 - z);
+    SimTK_TEST_EQ(normal, surface.calcUnitNormal(xy));
+    SimTK_TEST(bumps.intersectsRay(Vec3(xy[0], xy[1], -2), UnitVec3(0, 0, 1),
+                                   distance, normal));
+    SimTK_TEST_EQ(distance, 2 + z);
+    SimTK_TEST(!bumps.intersectsRay(Vec3(xy[0], xy[1], 2), UnitVec3(1, 1, 1),
+                                    distance, normal));
+    SimTK_TEST(!bumps.intersectsRay(Vec3(10, 0, 0), UnitVec3(1, 0, -1),
+                                    distance, normal));
+}
+
+// On a tilted plane a sphere gets the same depth, normal and curvatures as
+// against a half space.
+void testSphereOnPlane() {
+    const ContactTracker::SmoothHeightMapSphere tracker;
+    const ContactGeometry::SmoothHeightMap plane = createPlane(.2, -.1, .3);
+    const ContactGeometry::Sphere sphere(.5);
+    const UnitVec3 n(-.2, .1, 1);
+    const Transform X_GH(Rotation(.4, XAxis), Vec3(1, 2, 3));
+    const Vec3 onPlane(1, -.5, .2*1 - .1*-.5 + .3);
+    Contact contact;
+
+    for (Real height : {.45, .3, -.1}) {
+        const Vec3 center_H = onPlane + height*n;
+        SimTK_TEST(tracker.trackContact(untracked, X_GH,
+            plane, X_GH*Transform(center_H), sphere, 0, contact));
+        SimTK_TEST(EllipticalPointContact::isInstance(contact));
+        const EllipticalPointContact& point =
+            EllipticalPointContact::getAs(contact);
+        SimTK_TEST_EQ(point.getDepth(), .5 - height);
+        SimTK_TEST_EQ(point.getCurvatures(), Vec2(2));
+        const Transform& X_HC = point.getContactFrame();
+        SimTK_TEST_EQ(X_HC.z(), n);
+        SimTK_TEST_EQ(X_HC.p(), center_H - (.5 - point.getDepth()/2)*n);
+    }
+
+    // Above the plane, unless the cutoff is large enough.
+    const Transform X_HS(onPlane + .6*n);
+    SimTK_TEST(tracker.trackContact(untracked, X_GH, plane, X_GH*X_HS,
+                                    sphere, 0, contact));
+    SimTK_TEST(contact.isEmpty());
+    SimTK_TEST(tracker.trackContact(untracked, X_GH, plane, X_GH*X_HS,
+                                    sphere, .2, contact));
+    SimTK_TEST_EQ(EllipticalPointContact::getAs(contact).getDepth(), -.1);
+
+    // Off the edge of the height map.
+    SimTK_TEST(tracker.trackContact(untracked, X_GH, plane,
+        X_GH*Transform(Vec3(5.2, 0, 1)), sphere, 0, contact));
+    SimTK_TEST(contact.isEmpty());
+}
+
+// On a bump the contact curvature adds the bump's to the sphere's.
+void testSphereOnBump() {
+    const ContactTracker::SmoothHeightMapSphere tracker;
+    const ContactGeometry::SmoothHeightMap bumps = createBumps();
+    const ContactGeometry::Sphere sphere(.5);
+    Contact contact;
+
+    // The top of the bump at x=pi/2, y=0.
+    const Vec2 top(Pi/2, 0);
+    const Real z = bumps.getBicubicSurface().calcValue(top);
+    SimTK_TEST(tracker.trackContact(untracked, Transform(), bumps,
+        Transform(Vec3(top[0], top[1], z + .45)), sphere, 0, contact));
+    const EllipticalPointContact& point =
+        EllipticalPointContact::getAs(contact);
+    SimTK_TEST_EQ_TOL(point.getDepth(), .05, 1e-4);
+    SimTK_TEST_EQ_TOL(point.getContactFrame().z(), Vec3(0, 0, 1), 1e-3);
+    // f = .3 sin(x) cos(1.3 y) has curvatures .3*1.69 across y and .3
+    // across x at the top, approximately given the interpolation.
+    SimTK_TEST_EQ_TOL(point.getCurvatures(), Vec2(2 + .507, 2 + .3), 1e-2);
+}
+
+// An ellipsoid on a tilted plane gets the same contact as on a half space.
+void testEllipsoidOnPlane() {
+    const ContactTracker::SmoothHeightMapEllipsoid tracker;
+    const ContactTracker::HalfSpaceEllipsoid halfSpaceTracker;
+    const ContactGeometry::SmoothHeightMap plane = createPlane(.2, -.1, .3);
+    const ContactGeometry::HalfSpace halfSpace;
+    const ContactGeometry::Ellipsoid ellipsoid(Vec3(.5, .3, .4));
+    // The half space's outward normal is -x; turn it into the plane's.
+    const UnitVec3 n(-.2, .1, 1);
+    const Transform X_HP(Rotation(-n, XAxis), Vec3(0, 0, .3));
+    Contact contact, expected;
+
+    for (int i=0; i < 10; ++i) {
+        const Rotation R(BodyRotationSequence, 1.1*i, XAxis, .7*i, YAxis,
+                         .3*i, ZAxis);
+        const Vec3 onPlane(.3*i-1.5, .2*i-1, .2*(.3*i-1.5) - .1*(.2*i-1) + .3);
+        const Transform X_HE(R, onPlane + (.3 + .02*i)*n);
+        SimTK_TEST(tracker.trackContact(untracked, Transform(), plane, X_HE,
+                                        ellipsoid, 0, contact));
+        SimTK_TEST(halfSpaceTracker.trackContact(untracked, X_HP, halfSpace,
+                                                 X_HE, ellipsoid, 0,
+                                                 expected));
+        SimTK_TEST(contact.isEmpty() == expected.isEmpty());
+        if (expected.isEmpty())
+            continue;
+        const EllipticalPointContact& actualPoint =
+            EllipticalPointContact::getAs(contact);
+        const EllipticalPointContact& expectedPoint =
+            EllipticalPointContact::getAs(expected);
+        SimTK_TEST_EQ_TOL(actualPoint.getDepth(), expectedPoint.getDepth(),
+                          1e-9);
+        SimTK_TEST_EQ_TOL(actualPoint.getCurvatures(),
+                          expectedPoint.getCurvatures(), 1e-8);
+        const Transform X_HC = X_HP*expectedPoint.getContactFrame();
+        const Transform& actualX_HC = actualPoint.getContactFrame();
+        SimTK_TEST_EQ_TOL(actualX_HC.p(), X_HC.p(), 1e-9);
+        SimTK_TEST_EQ_TOL(actualX_HC.z(), X_HC.z(), 1e-9);
+        SimTK_TEST_EQ_TOL(std::abs(dot(actualX_HC.x(), X_HC.x())), 1, 1e-6);
+    }
+}
+
+// A mesh on a tilted plane touches the same faces as on a half space.
+void testMeshOnPlane() {
+    const ContactTracker::SmoothHeightMapTriangleMesh tracker;
+    const ContactTracker::HalfSpaceTriangleMesh halfSpaceTracker;
+    const ContactGeometry::SmoothHeightMap plane = createPlane(.2, -.1, .3);
+    const ContactGeometry::HalfSpace halfSpace;
+    const ContactGeometry::TriangleMesh mesh
+       (PolygonalMesh::createSphereMesh(.5, 2));
+    const UnitVec3 n(-.2, .1, 1);
+    const Transform X_HP(Rotation(-n, XAxis), Vec3(0, 0, .3));
+    Contact contact, expected;
+
+    for (int i=0; i < 10; ++i) {
+        const Transform X_HM(Rotation(.5*i, YAxis),
+                             Vec3(.3*i-1.5, .2*i-1, .3+.03*i));
+        SimTK_TEST(tracker.trackContact(untracked, Transform(), plane, X_HM,
+                                        mesh, 0, contact));
+        SimTK_TEST(halfSpaceTracker.trackContact(untracked, X_HP, halfSpace,
+                                                 X_HM, mesh, 0, expected));
+        SimTK_TEST(contact.isEmpty() == expected.isEmpty());
+        if (expected.isEmpty())
+            continue;
+        SimTK_TEST(TriangleMeshContact::getAs(contact).getSurface2FaceIndices()
+            == TriangleMeshContact::getAs(expected).getSurface2FaceIndices());
+        SimTK_TEST(TriangleMeshContact::getAs(contact)
+                   .getSurface1FaceIndices().empty());
+    }
+
+    // Well above the plane.
+    SimTK_TEST(tracker.trackContact(untracked, Transform(), plane,
+        Transform(Vec3(0, 0, 2)), mesh, 0, contact));
+    SimTK_TEST(contact.isEmpty());
+}
+
+int main() {
+    SimTK_START_TEST("TestSmoothHeightMapTrackers");
+        SimTK_SUBTEST(testFindNearestPoint);
+        SimTK_SUBTEST(testIntersectsRay);
+        SimTK_SUBTEST(testSphereOnPlane);
+        SimTK_SUBTEST(testSphereOnBump);
+        SimTK_SUBTEST(testEllipsoidOnPlane);
+        SimTK_SUBTEST(testMeshOnPlane);
+    SimTK_END_TEST();
+}
@@ -22,6 +22,9 @@
  * -------------------------------------------------------------------------- */
 
 #include "SimTKmath.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
 #include <vector>
 #include <exception>
 
@@ -156,7 +159,7 @@ void addOctohedron(vector<Vec3>& vertices, vector<int>& faceIndices, Vec3 offset
 
 void validateOBBTree(const ContactGeometry::TriangleMesh& mesh, ContactGeometry::TriangleMesh::OBBTreeNode node, ContactGeometry::TriangleMesh::OBBTreeNode parent, vector<int>& faceReferenceCount) {
     if (node.isLeafNode()) {
-        const Array_<int>& triangles = node.getTriangles();
+        const ArrayViewConst_<int> triangles = node.getTriangles();
         SimTK_TEST(triangles.size() > 0);
         SimTK_TEST(triangles.size() == node.getNumTriangles());
         for (int i = 0; i < (int) triangles.size(); i++) {
@@ -225,6 +228,53 @@ void testRayIntersection() {
     SimTK_TEST(!mesh.intersectsRay(Vec3(-1, -1, -1), UnitVec3(-1, -1, -1), distance, normal));
 }
 
+// Tracing rays in packets finds the same hits as tracing them one at a time,
+// and respects the distance limit passed in for each ray.
+void testRayPackets() {
+    ContactGeometry::TriangleMesh mesh(PolygonalMesh::createSphereMesh(1, 3));
+    const int numRays = 300; // several packets, the last one partial
+    Array_<Vec3> origins(numRays);
+    Array_<UnitVec3> directions(numRays);
+    for (int i = 0; i < numRays; i++) {
+        origins[i] = 2*Vec3(std::sin(1.7*i), std::sin(0.9*i+1), std::sin(0.5*i+2));
+        // Mostly aim near the middle so that many rays hit.
+        directions[i] = UnitVec3(0.4*Vec3(std::sin(2.3*i), std::cos(1.1*i), 
+                                          std::sin(0.7*i+3)) - origins[i]);
+    }
+
+    for (Real limit : {Real(Infinity), Real(2)}) {
+        Array_<Real> distances(numRays, limit);
+        Array_<int> faces(numRays, -1);
+        Array_<Vec2> uvs(numRays);
+        const int numHits = mesh.intersectsRays(origins, directions, distances, 
+                                                faces, uvs);
+        int expectedHits = 0;
+        for (int i = 0; i < numRays; i++) {
+            Real distance;
+            int face;
+            Vec2 uv;
+            const bool hit = mesh.intersectsRay(origins[i], directions[i], 
+                                                distance, face, uv)
+                             && distance < limit;
+            SimTK_TEST(hit == (faces[i] >= 0));
+            if (!hit) {
+                SimTK_TEST(distances[i] == limit);
+                continue;
+            }
+            ++expectedHits;
+            SimTK_TEST_EQ(distances[i], distance);
+            const Vec3 hitPoint = 
+                      uvs[i][0]  *mesh.getVertexPosition(mesh.getFaceVertex(faces[i], 0))
+                    + uvs[i][1]  *mesh.getVertexPosition(mesh.getFaceVertex(faces[i], 1))
+                + (1-uvs[i][0]-uvs[i][1])
+                             *mesh.getVertexPosition(mesh.getFaceVertex(faces[i], 2));
+            SimTK_TEST_EQ(hitPoint, origins[i]+distances[i]*directions[i]);
+        }
+        SimTK_TEST(numHits == expectedHits);
+        SimTK_TEST(numHits > numRays/4);
+    }
+}
+
 void testSmoothMesh() {
     // Create two octrohedral meshes: one smooth and one not.
     
@@ -307,14 +357,362 @@ void testBoundingSphere() {
     }
 }
 
+// The nearest point found through the OBB tree, which tests the faces of each
+// leaf in blocks, must be the nearest of all the faces.
+void testFindNearestPointMatchesAllFaces() {
+    ContactGeometry::TriangleMesh mesh(PolygonalMesh::createSphereMesh(1, 3));
+    SimTK_TEST(mesh.getNumFaces() == 512);
+    Random::Gaussian random(0, 1);
+    random.setSeed(5);
+    for (int i = 0; i < 200; i++) {
+        Vec3 pos(random.getValue(), random.getValue(), random.getValue());
+        bool inside;
+        int face;
+        Vec2 uv;
+        Vec3 nearest = mesh.findNearestPoint(pos, inside, face, uv);
+        SimTK_TEST_EQ(mesh.findPoint(face, uv), nearest);
+        Real minDistance2 = MostPositiveReal;
+        for (int j = 0; j < mesh.getNumFaces(); j++) {
+            Vec2 faceUV;
+            Vec3 faceNearest = mesh.findNearestPointToFace(pos, j, faceUV);
+            SimTK_TEST_EQ(mesh.findPoint(j, faceUV), faceNearest);
+            minDistance2 = std::min(minDistance2, (faceNearest-pos).normSqr());
+        }
+        SimTK_TEST_EQ((nearest-pos).normSqr(), minDistance2);
+    }
+}
+
+// Every pair of overlapping faces of two intersecting meshes must be reported
+// by the mesh-mesh contact tracker, which tests the faces in blocks.
+void testMeshMeshOverlappingFaces() {
+    ContactGeometry::TriangleMesh mesh1(PolygonalMesh::createSphereMesh(1, 2));
+    ContactGeometry::TriangleMesh mesh2(PolygonalMesh::createSphereMesh(0.7, 2));
+    const ContactTracker::TriangleMeshTriangleMesh tracker;
+    Random::Uniform random(-1, 1);
+    random.setSeed(9);
+    for (int i = 0; i < 10; i++) {
+        const Transform X_GM1(Rotation(random.getValue(), 
+                                       UnitVec3(random.getValue(), 1, 0)),
+                              Vec3(0));
+        const Transform X_GM2(Rotation(random.getValue(), 
+                                       UnitVec3(0, 1, random.getValue())),
+                              Vec3(1.2, 0.1*random.getValue(), 0));
+        Contact contact;
+        SimTK_TEST(tracker.trackContact(
+            UntrackedContact(ContactSurfaceIndex(0), ContactSurfaceIndex(1)),
+            X_GM1, mesh1, X_GM2, mesh2, 0, contact));
+        SimTK_TEST(TriangleMeshContact::isInstance(contact));
+        const TriangleMeshContact& meshContact = 
+            TriangleMeshContact::getAs(contact);
+
+        const Transform X_M1M2 = ~X_GM1*X_GM2;
+        int numOverlapping = 0;
+        for (int f2 = 0; f2 < mesh2.getNumFaces(); f2++) {
+            const Geo::Triangle A(
+                X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(f2, 0)),
+                X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(f2, 1)),
+                X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(f2, 2)));
+            for (int f1 = 0; f1 < mesh1.getNumFaces(); f1++) {
+                const Geo::Triangle B(
+                    mesh1.getVertexPosition(mesh1.getFaceVertex(f1, 0)),
+                    mesh1.getVertexPosition(mesh1.getFaceVertex(f1, 1)),
+                    mesh1.getVertexPosition(mesh1.getFaceVertex(f1, 2)));
+                if (!A.overlapsTriangle(B))
+                    continue;
+                ++numOverlapping;
+                SimTK_TEST(meshContact.getSurface1Faces().count(f1) == 1);
+                SimTK_TEST(meshContact.getSurface2Faces().count(f2) == 1);
+            }
+        }
+        SimTK_TEST(numOverlapping > 0);
+
+        // The face arrays hold the same faces as the sets, in order.
+        const std::set<int>& faces1 = meshContact.getSurface1Faces();
+        const Array_<int>& faceIndices1 = meshContact.getSurface1FaceIndices();
+        SimTK_TEST(faceIndices1.size() == faces1.size());
+        SimTK_TEST(std::equal(faces1.begin(), faces1.end(), 
+                              faceIndices1.begin()));
+        const std::set<int>& faces2 = meshContact.getSurface2Faces();
+        const Array_<int>& faceIndices2 = meshContact.getSurface2FaceIndices();
+        SimTK_TEST(faceIndices2.size() == faces2.size());
+        SimTK_TEST(std::equal(faces2.begin(), faces2.end(), 
+                              faceIndices2.begin()));
+    }
+}
+
+// A batch of nearest point queries must give the same answers as querying
+// each point by itself, whether or not neighboring points are close together.
+void testFindNearestPoints() {
+    ContactGeometry::TriangleMesh mesh(PolygonalMesh::createSphereMesh(1, 3));
+    ContactGeometry::Ellipsoid ellipsoid(Vec3(1, 2, 3));
+    const ContactGeometry* geometries[] = {&mesh, &ellipsoid};
+    Array_<Vec3> positions;
+    for (int i = 0; i < 100; i++) // a path of neighboring points
+        positions.push_back(Vec3(std::cos(0.05*i), 0.02*i, std::sin(0.05*i))
+                            *(0.5 + 0.01*i));
+    for (int i = 0; i < 100; i++) // scattered points
+        positions.push_back(Vec3(std::sin(2.1*i), std::sin(3.7*i+1), 
+                                 std::sin(5.3*i+2))*1.5);
+    const int n = positions.size();
+    for (const ContactGeometry* geometry : geometries) {
+        Array_<Vec3> nearestPoints(n);
+        Array_<bool> inside(n);
+        Array_<UnitVec3> normals(n);
+        geometry->findNearestPoints(positions, nearestPoints, inside, normals);
+        for (int i = 0; i < n; i++) {
+            bool expectedInside;
+            UnitVec3 expectedNormal;
+            const Vec3 expected = geometry->findNearestPoint(positions[i], 
+                                      expectedInside, expectedNormal);
+            SimTK_TEST_EQ(nearestPoints[i], expected);
+            SimTK_TEST(inside[i] == expectedInside);
+            SimTK_TEST_EQ(normals[i], expectedNormal);
+        }
+
+        // Querying part of the batch fills in only that part.
+        Array_<Vec3> partPoints(n, Vec3(NaN));
+        Array_<bool> partInside(n);
+        Array_<UnitVec3> partNormals(n);
+        geometry->findNearestPoints(positions(10, 20), partPoints(10, 20), 
+                                    partInside(10, 20), partNormals(10, 20));
+        SimTK_TEST(isNaN(partPoints[9][0]) && isNaN(partPoints[30][0]));
+        for (int i = 10; i < 30; i++)
+            SimTK_TEST_EQ(partPoints[i], nearestPoints[i]);
+    }
+}
+
+// A mesh large enough to have its OBB tree built on several threads must get
+// a complete tree, and its edges must agree with its faces.
+void testLargeMesh() {
+    ContactGeometry::TriangleMesh mesh(PolygonalMesh::createSphereMesh(1, 5));
+    SimTK_TEST(mesh.getNumFaces() == 8192);
+    SimTK_TEST(mesh.getNumEdges() == 3*mesh.getNumFaces()/2);
+    for (int i = 0; i < mesh.getNumFaces(); i++)
+        for (int j = 0; j < 3; j++) {
+            const int edge = mesh.getFaceEdge(i, j);
+            const int v1 = mesh.getFaceVertex(i, j);
+            const int v2 = mesh.getFaceVertex(i, (j+1)%3);
+            SimTK_TEST(mesh.getEdgeVertex(edge, 0) == std::min(v1, v2));
+            SimTK_TEST(mesh.getEdgeVertex(edge, 1) == std::max(v1, v2));
+            SimTK_TEST(mesh.getEdgeFace(edge, 0) == i 
+                       || mesh.getEdgeFace(edge, 1) == i);
+        }
+    vector<int> faceReferenceCount(mesh.getNumFaces(), 0);
+    validateOBBTree(mesh, mesh.getOBBTreeNode(), mesh.getOBBTreeNode(), faceReferenceCount);
+    for (int i = 0; i < (int) faceReferenceCount.size(); i++)
+        SimTK_TEST(faceReferenceCount[i] == 1);
+}
+
+void compareOBBTrees(ContactGeometry::TriangleMesh::OBBTreeNode node1,
+                     ContactGeometry::TriangleMesh::OBBTreeNode node2) {
+    SimTK_TEST(node1.getNumTriangles() == node2.getNumTriangles());
+    SimTK_TEST(node1.getBounds().getTransform().p() 
+               == node2.getBounds().getTransform().p());
+    SimTK_TEST(node1.getBounds().getSize() == node2.getBounds().getSize());
+    SimTK_TEST(node1.isLeafNode() == node2.isLeafNode());
+    if (node1.isLeafNode()) {
+        SimTK_TEST(node1.getTriangles() == node2.getTriangles());
+    }
+    else {
+        compareOBBTrees(node1.getFirstChildNode(), node2.getFirstChildNode());
+        compareOBBTrees(node1.getSecondChildNode(), 
+                        node2.getSecondChildNode());
+    }
+}
+
+// A mesh read back from the cache must be the same as the one that was
+// written.
+void testCache() {
+    SimTK_TEST(ContactGeometry::TriangleMesh::getCacheDirectory().empty());
+    const PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 4);
+    ContactGeometry::TriangleMesh uncached(sphere);
+    ContactGeometry::TriangleMesh::setCacheDirectory(".");
+    SimTK_TEST(ContactGeometry::TriangleMesh::getCacheDirectory() == ".");
+    ContactGeometry::TriangleMesh written(sphere);
+    ContactGeometry::TriangleMesh read(sphere);
+    ContactGeometry::TriangleMesh::setCacheDirectory("");
+    for (const ContactGeometry::TriangleMesh* mesh : {&written, &read}) {
+        SimTK_TEST(mesh->getNumVertices() == uncached.getNumVertices());
+        SimTK_TEST(mesh->getNumFaces() == uncached.getNumFaces());
+        SimTK_TEST(mesh->getNumEdges() == uncached.getNumEdges());
+        for (int i = 0; i < uncached.getNumVertices(); i++)
+            SimTK_TEST(mesh->getVertexPosition(i) 
+                       == uncached.getVertexPosition(i));
+        for (int i = 0; i < uncached.getNumFaces(); i++) {
+            SimTK_TEST(mesh->getFaceNormal(i) == uncached.getFaceNormal(i));
+            SimTK_TEST(mesh->getFaceArea(i) == uncached.getFaceArea(i));
+            for (int j = 0; j < 3; j++) {
+                SimTK_TEST(mesh->getFaceVertex(i, j) 
+                           == uncached.getFaceVertex(i, j));
+                SimTK_TEST(mesh->getFaceEdge(i, j) 
+                           == uncached.getFaceEdge(i, j));
+            }
+        }
+        for (int i = 0; i < uncached.getNumEdges(); i++)
+            for (int j = 0; j < 2; j++) {
+                SimTK_TEST(mesh->getEdgeVertex(i, j) 
+                           == uncached.getEdgeVertex(i, j));
+                SimTK_TEST(mesh->getEdgeFace(i, j) 
+                           == uncached.getEdgeFace(i, j));
+            }
+        compareOBBTrees(mesh->getOBBTreeNode(), uncached.getOBBTreeNode());
+        bool inside;
+        UnitVec3 normal;
+        SimTK_TEST(mesh->findNearestPoint(Vec3(.3, .2, .1), inside, normal)
+                   == uncached.findNearestPoint(Vec3(.3, .2, .1), inside, 
+                                                normal));
+    }
+
+    // A mesh with different vertex positions doesn't find that file.
+    Array_<Vec3> vertices;
+    Array_<int> faces;
+    for (int i = 0; i < sphere.getNumVertices(); i++)
+        vertices.push_back(1.5*sphere.getVertexPosition(i));
+    for (int i = 0; i < sphere.getNumFaces(); i++)
+        for (int j = 0; j < 3; j++)
+            faces.push_back(sphere.getFaceVertex(i, j));
+    ContactGeometry::TriangleMesh::setCacheDirectory(".");
+    ContactGeometry::TriangleMesh scaled(vertices, faces);
+    ContactGeometry::TriangleMesh::setCacheDirectory("");
+    SimTK_TEST_EQ(scaled.getVertexPosition(7), 
+                  1.5*uncached.getVertexPosition(7));
+    for (int i = 0; i < (int) vertices.size(); i++)
+        SimTK_TEST(scaled.getOBBTreeNode().getBounds()
+                   .containsPoint(vertices[i]));
+}
+
+// The name findCacheFileName() gives the cache file for these arrays.
+std::string getCacheFileName(const Array_<Vec3>& vertices, 
+                             const Array_<int>& faces) {
+    unsigned long long hash = 14695981039346656037ULL;
+    const unsigned char* bytes = (const unsigned char*)vertices.begin();
+    for (size_t i = 0; i < vertices.size()*sizeof(Vec3); i++)
+        hash = (hash ^ bytes[i])*1099511628211ULL;
+    bytes = (const unsigned char*)faces.begin();
+    for (size_t i = 0; i < faces.size()*sizeof(int); i++)
+        hash = (hash ^ bytes[i])*1099511628211ULL;
+    char name[64];
+    std::snprintf(name, sizeof(name), "./simbody-trianglemesh-%016llx.obb", 
+                  hash);
+    return name;
+}
+
+// A damaged cache file whose vertices and faces still match is rejected
+// rather than trusted, and the mesh is built from scratch.
+void testDamagedCache() {
+    const ContactGeometry::TriangleMesh 
+        uncached(PolygonalMesh::createSphereMesh(1, 3));
+    Array_<Vec3> vertices;
+    Array_<int> faces;
+    for (int i = 0; i < uncached.getNumVertices(); i++)
+        vertices.push_back(uncached.getVertexPosition(i));
+    for (int i = 0; i < uncached.getNumFaces(); i++)
+        for (int j = 0; j < 3; j++)
+            faces.push_back(uncached.getFaceVertex(i, j));
+    ContactGeometry::TriangleMesh::setCacheDirectory(".");
+    ContactGeometry::TriangleMesh written(vertices, faces);
+    const std::string fileName = getCacheFileName(vertices, faces);
+
+    // The file ends with the OBB tree's triangle indices; point the last one
+    // far outside the mesh.
+    std::FILE* file = std::fopen(fileName.c_str(), "r+b");
+    SimTK_TEST(file != NULL);
+    if (file) {
+        const int bad = 1 << 30;
+        std::fseek(file, -(long)sizeof(int), SEEK_END);
+        std::fwrite(&bad, sizeof(int), 1, file);
+        std::fclose(file);
+    }
+    ContactGeometry::TriangleMesh rebuilt(vertices, faces);
+    ContactGeometry::TriangleMesh::setCacheDirectory("");
+    compareOBBTrees(rebuilt.getOBBTreeNode(), uncached.getOBBTreeNode());
+    bool inside;
+    UnitVec3 normal;
+    SimTK_TEST(rebuilt.findNearestPoint(Vec3(.3, .2, .1), inside, normal)
+               == uncached.findNearestPoint(Vec3(.3, .2, .1), inside, 
+                                            normal));
+}
+
+// Points in a mesh's distance field must get nearest points within the 
+// requested error of the exact ones, and the same inside flag; points 
+// outside the band, and meshes without a field, get the exact answers.
+void testDistanceField() {
+    const PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 3);
+    ContactGeometry::TriangleMesh exact(sphere);
+    ContactGeometry::TriangleMesh mesh(sphere);
+    SimTK_TEST(!mesh.hasDistanceField());
+    const Real maxError = 1e-2;
+    mesh.createDistanceField(0.05, 0.1, maxError);
+    SimTK_TEST(mesh.hasDistanceField());
+    SimTK_TEST_MUST_THROW(mesh.createDistanceField(0, 0.1, maxError));
+
+    // A copy shares the field.
+    ContactGeometry::TriangleMesh copy(mesh);
+    SimTK_TEST(copy.hasDistanceField());
+
+    Array_<Vec3> positions;
+    for (int i = 0; i < 500; i++) {
+        const UnitVec3 dir(std::sin(2.1*i), std::sin(3.7*i+1), 
+                           std::sin(5.3*i+2));
+        positions.push_back(dir*(0.85 + 0.3*std::sin(1.3*i)));
+    }
+    const int n = positions.size();
+    Array_<Vec3> nearestPoints(n);
+    Array_<bool> inside(n);
+    Array_<UnitVec3> normals(n);
+    mesh.findNearestPoints(positions, nearestPoints, inside, normals);
+    int numInBand = 0, numInterpolated = 0;
+    for (int i = 0; i < n; i++) {
+        bool exactInside, meshInside;
+        UnitVec3 exactNormal, meshNormal;
+        const Vec3 expected = exact.findNearestPoint(positions[i], 
+                                  exactInside, exactNormal);
+        const Vec3 found = mesh.findNearestPoint(positions[i], meshInside, 
+                                                 meshNormal);
+        SimTK_TEST(found == nearestPoints[i]);
+        SimTK_TEST(meshInside == inside[i]);
+        const Real distance = (positions[i]-expected).norm();
+        if (distance > 0.1 + maxError) {
+            SimTK_TEST(found == expected);
+            SimTK_TEST(meshNormal == exactNormal);
+        } else {
+            SimTK_TEST((found-expected).norm() <= maxError);
+            SimTK_TEST(~meshNormal*exactNormal > 0.99);
+            ++numInBand;
+            if (found != expected)
+                ++numInterpolated;
+        }
+        if (distance > maxError)
+            SimTK_TEST(meshInside == exactInside);
+    }
+    // Cells near the edges of this coarse mesh are dropped, but most of 
+    // the points in the band should still have used the field.
+    SimTK_TEST(2*numInterpolated > numInBand);
+
+    mesh.clearDistanceField();
+    SimTK_TEST(!mesh.hasDistanceField() && copy.hasDistanceField());
+    bool inside0;
+    UnitVec3 normal0, normal1;
+    SimTK_TEST(mesh.findNearestPoint(positions[0], inside0, normal0)
+               == exact.findNearestPoint(positions[0], inside0, normal1));
+}
+
 int main() {
     SimTK_START_TEST("TestTriangleMesh");
         SimTK_SUBTEST(testTriangleMesh);
         SimTK_SUBTEST(testIncorrectMeshes);
         SimTK_SUBTEST(testOBBTree);
         SimTK_SUBTEST(testRayIntersection);
+        SimTK_SUBTEST(testRayPackets);
         SimTK_SUBTEST(testSmoothMesh);
         SimTK_SUBTEST(testFindNearestPoint);
+        SimTK_SUBTEST(testFindNearestPointMatchesAllFaces);
+        SimTK_SUBTEST(testMeshMeshOverlappingFaces);
+        SimTK_SUBTEST(testFindNearestPoints);
         SimTK_SUBTEST(testBoundingSphere);
+        SimTK_SUBTEST(testLargeMesh);
+        SimTK_SUBTEST(testCache);
+        SimTK_SUBTEST(testDamagedCache);
+        SimTK_SUBTEST(testDistanceField);
     SimTK_END_TEST();
 }
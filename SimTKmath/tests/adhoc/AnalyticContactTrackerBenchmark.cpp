@@ -0,0 +1,139 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program compares the closed-form sphere-brick, brick-brick and
+sphere-cylinder contact trackers with tracking the same shapes represented as
+triangle meshes, which is what you had to do before those trackers existed.
+Each pair is placed in a series of random touching poses and the average time
+per trackContact() call is printed for both representations. Usage:
+
+    AnalyticContactTrackerBenchmark [numPoses] [meshResolution]
+*/
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+namespace {
+
+// Average ns per call of tracker.trackContact() over all the poses of
+// surface2 relative to surface1.
+double timeTracker(const ContactTracker& tracker,
+                   const ContactGeometry& surface1,
+                   const ContactGeometry& surface2,
+                   const Array_<Transform>& poses, int& numContacts) {
+    const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                     ContactSurfaceIndex(1));
+    Contact contact;
+    numContacts = 0;
+    const long long start = realTimeInNs();
+    for (int i = 0; i < (int)poses.size(); ++i) {
+        tracker.trackContact(untracked, Transform(), surface1, poses[i],
+                             surface2, 0, contact);
+        if (!contact.isEmpty())
+            ++numContacts;
+    }
+    return double(realTimeInNs() - start)/poses.size();
+}
+
+void compare(const char* name,
+             const ContactTracker& analytic,
+             const ContactGeometry& analytic1,
+             const ContactGeometry& analytic2,
+             const ContactTracker& mesh,
+             const ContactGeometry& mesh1,
+             const ContactGeometry& mesh2,
+             const Array_<Transform>& poses) {
+    int analyticContacts, meshContacts;
+    const double analyticNs =
+        timeTracker(analytic, analytic1, analytic2, poses, analyticContacts);
+    const double meshNs =
+        timeTracker(mesh, mesh1, mesh2, poses, meshContacts);
+    std::printf("%-16s %10.3f %10.3f %8.1fx %8d %8d\n", name,
+                1e-3*analyticNs, 1e-3*meshNs, meshNs/analyticNs,
+                analyticContacts, meshContacts);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int numPoses   = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int resolution = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    const Vec3 halfLengths(0.5, 0.3, 0.4);
+    const Real radius = 0.3;
+    const ContactGeometry::Brick brick(halfLengths);
+    const ContactGeometry::Sphere sphere(radius);
+    const ContactGeometry::Cylinder cylinder(radius);
+    const ContactGeometry::TriangleMesh brickMesh
+       (PolygonalMesh::createBrickMesh(halfLengths, resolution));
+    const ContactGeometry::TriangleMesh sphereMesh
+       (PolygonalMesh::createSphereMesh(radius, resolution));
+    // The mesh has to stop somewhere; make it much longer than the poses.
+    const ContactGeometry::TriangleMesh cylinderMesh
+       (PolygonalMesh::createCylinderMesh(ZAxis, radius, 10, resolution));
+
+    // Random orientations with the centers at about the distance where the
+    // shapes just touch, so most poses are in contact.
+    Random::Uniform random(-1, 1);
+    random.setSeed(5);
+    Array_<Transform> brickPoses, spherePoses;
+    for (int i = 0; i < numPoses; ++i) {
+        const Rotation R(BodyRotationSequence,
+                         Pi*random.getValue(), XAxis,
+                         Pi*random.getValue(), YAxis,
+                         Pi*random.getValue(), ZAxis);
+        const UnitVec3 dir(Vec3(random.getValue(), random.getValue(),
+                                random.getValue()));
+        brickPoses.push_back(Transform(R, 0.75*dir));
+        spherePoses.push_back(Transform(R, 0.6*dir));
+    }
+
+    std::printf("%d poses, mesh resolution %d (%d brick faces, "
+                "%d sphere faces)\n", numPoses, resolution,
+                brickMesh.getNumFaces(), sphereMesh.getNumFaces());
+    std::printf("%-16s %10s %10s %9s %8s %8s\n", "pair", "closed(us)",
+                "mesh(us)", "speedup", "contacts", "mesh");
+    compare("sphere-brick",
+            ContactTracker::SphereBrick(), sphere, brick,
+            ContactTracker::SphereTriangleMesh(), sphere, brickMesh,
+            spherePoses);
+    compare("brick-brick",
+            ContactTracker::BrickBrick(), brick, brick,
+            ContactTracker::TriangleMeshTriangleMesh(), brickMesh, brickMesh,
+            brickPoses);
+    compare("sphere-cylinder",
+            ContactTracker::SphereCylinder(), sphere, cylinder,
+            ContactTracker::SphereTriangleMesh(), sphere, cylinderMesh,
+            spherePoses);
+    // Users often meshed the sphere as well.
+    compare("sphere-brick(2)",
+            ContactTracker::SphereBrick(), sphere, brick,
+            ContactTracker::TriangleMeshTriangleMesh(), sphereMesh, brickMesh,
+            spherePoses);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program measures how much ContactTracker::ConvexImplicitPair saves by
+starting from the prior contact. Random ellipsoid-ellipsoid and
+sphere-ellipsoid pairs in contact each move a little per step, as they would
+from one time step to the next. Each step is tracked from scratch and from the
+previous step's contact, and the average MPR and Newton iteration counts and
+times per pair are printed. Usage:
+
+    ConvexImplicitPairBenchmark [numPairs] [numSteps]
+*/
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+int main(int argc, char** argv) {
+    const int numPairs = argc > 1 ? std::atoi(argv[1]) : 200;
+    const int numSteps = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    Random::Uniform random(0.5, 1.5);
+    random.setSeed(3);
+    Array_<ContactGeometry> shapesA, shapesB;
+    Array_<Transform> posesB;        // in A, at step 0
+    Array_<SpatialVec> velocitiesB;  // per step
+    for (int i = 0; i < numPairs; ++i) {
+        const Vec3 radiiA(random.getValue(), random.getValue(),
+                          random.getValue());
+        const Vec3 radiiB(random.getValue(), random.getValue(),
+                          random.getValue());
+        shapesA.push_back(ContactGeometry::Ellipsoid(radiiA));
+        if (i % 2)
+            shapesB.push_back(ContactGeometry::Ellipsoid(radiiB));
+        else
+            shapesB.push_back(ContactGeometry::Sphere(radiiB[0]));
+        // Start slightly interpenetrating along A's y axis.
+        posesB.push_back(Transform(Rotation(random.getValue(), XAxis),
+            Vec3(0, radiiA[1] + 0.9*radiiB.norm()/std::sqrt(3.), 0)));
+        velocitiesB.push_back(SpatialVec(
+            0.002*Vec3(random.getValue(), random.getValue(),
+                       random.getValue()),
+            0.0005*Vec3(random.getValue()-1, random.getValue()-1,
+                        random.getValue()-1)));
+    }
+
+    const ContactTracker::ConvexImplicitPair ellipsoidPair
+       (ContactGeometry::Ellipsoid::classTypeId(),
+        ContactGeometry::Ellipsoid::classTypeId());
+    const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                     ContactSurfaceIndex(1));
+    Array_<Contact> prior(numPairs, untracked);
+    long long coldMPR = 0, coldNewton = 0, warmMPR = 0, warmNewton = 0;
+    long long coldNs = 0, warmNs = 0;
+    int numContacts = 0;
+    for (int step = 0; step < numSteps; ++step) {
+        for (int i = 0; i < numPairs; ++i) {
+            const Transform& X_AB = posesB[i];
+            Vec3 pointP_A, pointQ_B;
+            int numMPR, numNewton;
+            ContactTracker::ConvexImplicitPair::findContactPoints(untracked,
+                shapesA[i], shapesB[i], X_AB, pointP_A, pointQ_B,
+                numMPR, numNewton);
+            coldMPR += numMPR; coldNewton += numNewton;
+            ContactTracker::ConvexImplicitPair::findContactPoints(prior[i],
+                shapesA[i], shapesB[i], X_AB, pointP_A, pointQ_B,
+                numMPR, numNewton);
+            warmMPR += numMPR; warmNewton += numNewton;
+
+            Contact contact;
+            long long start = realTimeInNs();
+            ellipsoidPair.trackContact(untracked, Transform(), shapesA[i],
+                                       X_AB, shapesB[i], 0, contact);
+            coldNs += realTimeInNs() - start;
+            start = realTimeInNs();
+            ellipsoidPair.trackContact(prior[i], Transform(), shapesA[i],
+                                       X_AB, shapesB[i], 0, contact);
+            warmNs += realTimeInNs() - start;
+            if (!contact.isEmpty())
+                ++numContacts;
+            prior[i] = contact.isEmpty() ? Contact(untracked) : contact;
+
+            // Move B a little relative to A.
+            const SpatialVec& V = velocitiesB[i];
+            posesB[i] = Transform(Rotation(V[0].norm(), UnitVec3(V[0]))
+                                  *X_AB.R(), X_AB.p() + V[1]);
+        }
+    }
+
+    const double numQueries = double(numPairs)*numSteps;
+    std::printf("%d pairs, %d steps, %.1f%% in contact\n", numPairs, numSteps,
+                100*numContacts/numQueries);
+    std::printf("%6s %12s %12s %12s\n", "start", "MPR iters", "Newton iters",
+                "time(us)");
+    std::printf("%6s %12.2f %12.2f %12.3f\n", "cold", coldMPR/numQueries,
+                coldNewton/numQueries, 1e-3*coldNs/numQueries);
+    std::printf("%6s %12.2f %12.2f %12.3f\n", "warm", warmMPR/numQueries,
+                warmNewton/numQueries, 1e-3*warmNs/numQueries);
+    return 0;
+}
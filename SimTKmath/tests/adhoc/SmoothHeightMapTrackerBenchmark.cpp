@@ -0,0 +1,152 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program compares tracking a sphere on rough terrain represented as a
+ContactGeometry::SmoothHeightMap with the same terrain represented as a
+triangle mesh, which is what you had to do before the height map trackers
+existed. The terrain is made larger and larger while the sphere stays the
+same size; the height map tracker's cost shouldn't grow with it. The
+average time per trackContact() call is printed for both. Usage:
+
+    SmoothHeightMapTrackerBenchmark [numPoses]
+*/
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+namespace {
+
+// Average ns per call of tracker.trackContact() over all the poses of the
+// sphere, with the terrain at the origin.
+double timeTracker(const ContactTracker& tracker,
+                   const ContactGeometry& terrain,
+                   const ContactGeometry& sphere,
+                   const Array_<Transform>& poses, bool sphereFirst,
+                   int& numContacts) {
+    const UntrackedContact untracked(ContactSurfaceIndex(0),
+                                     ContactSurfaceIndex(1));
+    Contact contact;
+    numContacts = 0;
+    const long long start = realTimeInNs();
+    for (int i = 0; i < (int)poses.size(); ++i) {
+        if (sphereFirst)
+            tracker.trackContact(untracked, poses[i], sphere, Transform(),
+                                 terrain, 0, contact);
+        else
+            tracker.trackContact(untracked, Transform(), terrain, poses[i],
+                                 sphere, 0, contact);
+        if (!contact.isEmpty())
+            ++numContacts;
+    }
+    return double(realTimeInNs() - start)/poses.size();
+}
+
+
+// A closed slab whose top is the terrain sampled at the grid points and
+// whose bottom is flat at z=bottom; a TriangleMesh has to be closed.
+PolygonalMesh createTerrainSlab(const Matrix& f, Real spacing, Real bottom) {
+    const int nx = f.nrow(), ny = f.ncol();
+    PolygonalMesh slab;
+    for (int side=0; side < 2; ++side)
+        for (int i=0; i < nx; ++i)
+            for (int j=0; j < ny; ++j)
+                slab.addVertex(Vec3(i*spacing, j*spacing,
+                                    side==0 ? f(i,j) : bottom));
+    const auto top = [&](int i, int j) {return i*ny + j;};
+    const auto bot = [&](int i, int j) {return nx*ny + i*ny + j;};
+    for (int i=0; i < nx-1; ++i)
+        for (int j=0; j < ny-1; ++j) {
+            slab.addFace(Array_<int>{top(i,j), top(i+1,j), top(i+1,j+1),
+                                     top(i,j+1)});
+            slab.addFace(Array_<int>{bot(i,j), bot(i,j+1), bot(i+1,j+1),
+                                     bot(i+1,j)});
+        }
+    // Walls around the edge.
+    for (int i=0; i < nx-1; ++i) {
+        slab.addFace(Array_<int>{top(i,0), bot(i,0), bot(i+1,0),
+                                 top(i+1,0)});
+        slab.addFace(Array_<int>{top(i+1,ny-1), bot(i+1,ny-1), bot(i,ny-1),
+                                 top(i,ny-1)});
+    }
+    for (int j=0; j < ny-1; ++j) {
+        slab.addFace(Array_<int>{top(0,j+1), bot(0,j+1), bot(0,j),
+                                 top(0,j)});
+        slab.addFace(Array_<int>{top(nx-1,j), bot(nx-1,j), bot(nx-1,j+1),
+                                 top(nx-1,j+1)});
+    }
+    return slab;
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int numPoses = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const Real radius  = 0.3;
+    const Real spacing = 0.25;
+    const ContactGeometry::Sphere sphere(radius);
+
+    std::printf("%d poses, sphere radius %g, terrain spacing %g\n",
+                numPoses, radius, spacing);
+    std::printf("%8s %10s %10s %9s %8s %8s\n", "grid", "map(us)",
+                "mesh(us)", "speedup", "contacts", "mesh");
+    for (int n : {16, 64, 256}) {
+        // Rolling hills over the whole grid.
+        Matrix f(n+1, n+1);
+        for (int i=0; i <= n; ++i)
+            for (int j=0; j <= n; ++j)
+                f(i,j) = 0.2*std::sin(0.9*i*spacing)*std::cos(0.7*j*spacing);
+        const BicubicSurface surface(Vec2(0), Vec2(spacing), f, 0);
+        const ContactGeometry::SmoothHeightMap heightMap(surface);
+        const ContactGeometry::TriangleMesh mesh
+           (createTerrainSlab(f, spacing, -1));
+
+        // Put the sphere just touching the terrain at random places.
+        Random::Uniform random(0, 1);
+        random.setSeed(5);
+        Array_<Transform> poses;
+        for (int i=0; i < numPoses; ++i) {
+            const Vec2 xy(n*spacing*(0.1 + 0.8*random.getValue()),
+                          n*spacing*(0.1 + 0.8*random.getValue()));
+            const Real z = surface.calcValue(xy) + 0.95*radius;
+            poses.push_back(Transform(Vec3(xy[0], xy[1], z)));
+        }
+
+        int mapContacts, meshContacts;
+        const double mapNs =
+            timeTracker(ContactTracker::SmoothHeightMapSphere(), heightMap,
+                        sphere, poses, false, mapContacts);
+        // The mesh tracker wants the sphere first.
+        const double meshNs =
+            timeTracker(ContactTracker::SphereTriangleMesh(), mesh, sphere,
+                        poses, true, meshContacts);
+        std::printf("%4dx%-3d %10.3f %10.3f %8.1fx %8d %8d\n", n, n,
+                    1e-3*mapNs, 1e-3*meshNs, meshNs/mapNs,
+                    mapContacts, meshContacts);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program times the construction of large ContactGeometry::TriangleMesh
+objects: building them from scratch, building them with caching turned on
+(which also writes the cache file), and then loading them from the cache.
+The sphere meshes used have 2*4^(resolution+1) faces; resolution 8 gives
+about half a million. The cache files are written to the given directory,
+which must exist. Usage:
+
+    TriangleMeshConstructionBenchmark [cacheDirectory] [maxResolution]
+*/
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace SimTK;
+
+namespace {
+
+// Milliseconds taken to construct a TriangleMesh from the given mesh.
+double timeConstruction(const PolygonalMesh& polygonalMesh) {
+    const long long start = realTimeInNs();
+    ContactGeometry::TriangleMesh mesh(polygonalMesh);
+    return 1e-6*double(realTimeInNs() - start);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const std::string cacheDirectory = argc > 1 ? argv[1] : ".";
+    const int maxResolution = argc > 2 ? std::atoi(argv[2]) : 8;
+
+    std::printf("%d processors, cache in %s\n", 
+                ParallelExecutor::getNumProcessors(), cacheDirectory.c_str());
+    std::printf("%8s %12s %12s %12s\n", "faces", "build(ms)", "write(ms)",
+                "load(ms)");
+    for (int resolution = 4; resolution <= maxResolution; ++resolution) {
+        const PolygonalMesh sphere = 
+            PolygonalMesh::createSphereMesh(1, resolution);
+        const double buildMs = timeConstruction(sphere);
+        ContactGeometry::TriangleMesh::setCacheDirectory(cacheDirectory);
+        const double writeMs = timeConstruction(sphere);
+        const double loadMs = timeConstruction(sphere);
+        ContactGeometry::TriangleMesh::setCacheDirectory("");
+        std::printf("%8d %12.1f %12.1f %12.1f\n", sphere.getNumFaces(),
+                    buildMs, writeMs, loadMs);
+    }
+    return 0;
+}
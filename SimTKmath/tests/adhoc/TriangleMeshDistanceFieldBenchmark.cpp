@@ -0,0 +1,94 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program compares nearest point queries on a ContactGeometry::TriangleMesh
+with and without a distance field, for points scattered through a band around 
+the surface of a sphere mesh with 2*4^(resolution+1) faces. It reports how
+long the field took to build, how much faster the queries were, and the
+largest difference between the two answers. Usage:
+
+    TriangleMeshDistanceFieldBenchmark [resolution] [cellSize] [maxError]
+*/
+
+#include "SimTKmath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+namespace {
+
+// Milliseconds taken to find the nearest points to all the positions.
+double timeQueries(const ContactGeometry::TriangleMesh& mesh,
+                   const Array_<Vec3>& positions, Array_<Vec3>& nearest) {
+    const int n = positions.size();
+    nearest.resize(n);
+    const long long start = realTimeInNs();
+    for (int i = 0; i < n; ++i) {
+        bool in;
+        UnitVec3 normal;
+        nearest[i] = mesh.findNearestPoint(positions[i], in, normal);
+    }
+    return 1e-6*double(realTimeInNs() - start);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int resolution = argc > 1 ? std::atoi(argv[1]) : 6;
+    const Real cellSize = argc > 2 ? std::atof(argv[2]) : 0.01;
+    const Real maxError = argc > 3 ? std::atof(argv[3]) : 1e-4;
+    const Real bandWidth = 0.05;
+
+    const PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, resolution);
+    const ContactGeometry::TriangleMesh exact(sphere);
+    ContactGeometry::TriangleMesh mesh(sphere);
+    const long long start = realTimeInNs();
+    mesh.createDistanceField(cellSize, bandWidth, maxError);
+    const double buildMs = 1e-6*double(realTimeInNs() - start);
+
+    Array_<Vec3> positions;
+    const int numPoints = 200000;
+    for (int i = 0; i < numPoints; ++i) {
+        const UnitVec3 dir(std::sin(2.1*i), std::sin(3.7*i+1), 
+                           std::sin(5.3*i+2));
+        positions.push_back(dir*(1 + 0.9*bandWidth*std::sin(1.3*i)));
+    }
+    Array_<Vec3> exactPoints, fieldPoints;
+    const double exactMs = timeQueries(exact, positions, exactPoints);
+    const double fieldMs = timeQueries(mesh, positions, fieldPoints);
+    Real worst = 0;
+    for (int i = 0; i < numPoints; ++i)
+        worst = std::max(worst, (fieldPoints[i]-exactPoints[i]).norm());
+
+    std::printf("%d faces, cell %g, max error %g: field built in %.1f ms\n",
+                sphere.getNumFaces(), cellSize, maxError, buildMs);
+    std::printf("%d queries: exact %.1f ms, field %.1f ms (%.1fx), "
+                "largest difference %g\n", numPoints, exactMs, fieldMs,
+                exactMs/fieldMs, worst);
+    return 0;
+}
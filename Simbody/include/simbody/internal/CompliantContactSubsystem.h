@@ -85,6 +85,21 @@ has not been set.
 @see getDissipatedEnergy(),setDissipatedEnergy(),setTrackDissipatedEnergy() **/
 bool getTrackDissipatedEnergy() const;
 
+/** Set the number of threads used to calculate the contact forces. The
+forces are calculated in parallel across contacts, and the result does not
+depend on the number of threads. If there are only a few point contacts
+they are calculated serially, since the parallel overhead would outweigh the
+gain. The default is the number of processors. The forces are calculated
+serially whenever any of the active contacts needs a generator whose
+ContactForceGenerator::shouldBeParallelIfPossible() returns false, which is
+the default for generators you register with adoptForceGenerator().
+
+@note This method should NOT be called while realizing Stage::Dynamics. **/
+void setNumberOfThreads(unsigned numThreads);
+/** Return the maximum number of threads used to calculate contact
+forces. **/
+int getNumberOfThreads() const;
+
 /** Determine how many of the active Contacts are currently generating
 contact forces. You can call this at Velocity stage or later; the contact
 forces will be realized first if necessary before we report how many there 
@@ -241,6 +256,8 @@ SimTK_PIMPL_DOWNCAST(CompliantContactSubsystem, ForceSubsystem);
 
 //--------------------------------------------------------------------------
                                  private:
+// The built-in generators may share this subsystem's executor.
+friend class ContactForceGenerator;
 class CompliantContactSubsystemImpl& updImpl();
 const CompliantContactSubsystemImpl& getImpl() const;
 };
@@ -622,6 +639,7 @@ class HertzElliptical;          // for EllipticalPointContact
 // Penalty-based models enforcing non-penetration but without attempting
 // to model the contacting materials physically.
 class BrickHalfSpacePenalty;    // for BrickHalfSpaceContact
+class ManifoldPenalty;          // for ManifoldContact
 
 // These are for response to unknown ContactTypeIds.
 class DoNothing;     // do nothing if called
@@ -671,6 +689,21 @@ virtual void calcContactPatch
     const SpatialVec&       V_S1S2,  // relative surface velocity (S2 in S1)
     ContactPatch&           patch) const = 0;
 
+/** Returns a boolean flag telling the CompliantContactSubsystem whether 
+calcContactForce() may be called concurrently from several threads, for 
+different contacts, as it does when the contact forces are calculated in 
+parallel (see CompliantContactSubsystem::setNumberOfThreads()). By default, 
+this method returns false, and all the contact forces are calculated on a 
+single thread whenever this generator is needed. The built-in generators 
+return true.
+
+@note: By overriding this method, you are telling Simbody that 
+calcContactForce() does not modify any shared data, including mutable members
+of the generator. **/
+virtual bool shouldBeParallelIfPossible() const {
+    return false;
+}
+
 
 //--------------------------------------------------------------------------
 private:
@@ -711,6 +744,8 @@ void calcContactPatch
     const Contact&          overlapping,
     const SpatialVec&       V_S1S2,
     ContactPatch&           patch) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 
@@ -741,6 +776,8 @@ void calcContactPatch
     const Contact&          overlapping,
     const SpatialVec&       V_S1S2,
     ContactPatch&           patch) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 
@@ -769,6 +806,38 @@ void calcContactPatch
     const Contact&          overlapping,
     const SpatialVec&       V_S1S2,
     ContactPatch&           patch) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
+};
+
+
+
+//==============================================================================
+//                          MANIFOLD PENALTY GENERATOR
+//==============================================================================
+
+/** This ContactForceGenerator handles contacts described by a set of points
+with a common normal, such as between two bricks. It applies the same
+per-point penalty model as BrickHalfSpacePenalty at each point. **/
+class SimTK_SIMBODY_EXPORT ContactForceGenerator::ManifoldPenalty 
+:   public ContactForceGenerator {
+public:
+ManifoldPenalty() 
+:   ContactForceGenerator(ManifoldContact::classTypeId()) {}
+
+void calcContactForce
+   (const State&            state,
+    const Contact&          overlapping,
+    const SpatialVec&       V_S1S2,
+    ContactForce&           contactForce) const override;
+
+void calcContactPatch
+   (const State&            state,
+    const Contact&          overlapping,
+    const SpatialVec&       V_S1S2,
+    ContactPatch&           patch) const override;
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 
@@ -797,6 +866,8 @@ void calcContactPatch
     const SpatialVec&       V_S1S2,
     ContactPatch&           patch) const override;
 
+bool shouldBeParallelIfPossible() const override {return true;}
+
 private:
 void calcContactForceAndDetails
    (const State&            state,
@@ -807,14 +878,14 @@ void calcContactForceAndDetails
 
 void calcWeightedPatchCentroid
    (const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    const Array_<int>&                      insideFaces,
     Vec3&                                   weightedPatchCentroid,
     Real&                                   patchArea) const;
                        
 void processOneMesh
    (const State&                            state,
     const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    const Array_<int>&                      insideFaces,
     const Transform&                        X_MO, 
     const SpatialVec&                       V_MO,
     const ContactGeometry&                  other,
@@ -859,6 +930,8 @@ void calcContactPatch
     ContactPatch&           patch) const override
 {   SimTK_ASSERT_ALWAYS(!"implemented",
         "ContactForceGenerator::DoNothing::calcContactPatch() not implemented yet."); }
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 
@@ -890,6 +963,8 @@ void calcContactPatch
     ContactPatch&           patch) const override
 {   SimTK_ASSERT_ALWAYS(!"implemented",
         "ContactForceGenerator::ThrowError::calcContactPatch() not implemented yet."); }
+
+bool shouldBeParallelIfPossible() const override {return true;}
 };
 
 } // namespace SimTK
@@ -1218,6 +1218,33 @@ explicit Implementation(SimbodyMatterSubsystem&);
 /** Return a reference to the matter subsystem containing this constraint. **/
 const SimbodyMatterSubsystem& getMatterSubsystem() const;
 
+/** Returns a boolean flag telling Simbody whether this Constraint's error and
+force methods may be called concurrently from several threads, as the matter
+subsystem does when it assembles G*M^-1*~G in parallel (see
+SimbodyMatterSubsystem::setNumberOfThreads()). By default, this method returns
+false, and the whole assembly is done on a single thread whenever this
+Constraint is enabled.
+
+@note: By overriding this method, you are telling Simbody that the
+calc...Errors() and addIn...ConstraintForces() methods of this Implementation
+do not modify any shared data, including mutable members of the
+Implementation and lazily evaluated cache entries in the State. **/
+virtual bool shouldBeParallelIfPossible() const {
+    return false;
+}
+
+/** Returns a boolean flag telling Simbody whether the forces applied by this
+Constraint's addIn...ConstraintForces() methods for multipliers lambda are
+exactly ~G*lambda, where G is the constraint Jacobian formed from its
+calc...Errors() methods. That is true of most constraints but not, for
+example, of some working constraints such as sliding friction. G*M^-1*~G is
+symmetric only if every enabled Constraint says so, in which case the matter 
+subsystem can factor it with a faster symmetric factorization. By default, 
+this method returns false. **/
+virtual bool hasSymmetricForceTransmission() const {
+    return false;
+}
+
     // Topological information//
 
 /** Call this if you want to make sure that the next realizeTopology() call 
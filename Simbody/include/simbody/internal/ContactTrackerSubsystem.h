@@ -240,9 +240,57 @@ indicated types of contact geometry. If the tracker requires the geometry
 types to be in reverse order from the (surface1,surface2) order given here,
 then the return argument \a reverseOrder will be set true, otherwise it will
 be false. If no tracker was registered, this will be the default tracker. **/
-const ContactTracker& getContactTracker(ContactGeometryTypeId surface1, 
+const ContactTracker& getContactTracker(ContactGeometryTypeId surface1,
                                         ContactGeometryTypeId surface2,
                                         bool& reverseOrder) const;
+
+/** Set the number of threads used to track the surface pairs that survive the
+broad phase. The narrow phase is parallelized across pairs; the resulting
+Contacts, their order and their ContactIds are the same for any number of
+threads. When there are only a few cheap pairs (spheres and half spaces)
+they are tracked serially, since the parallel overhead would outweigh the
+gain. The default is the number of processors. The pairs are tracked
+serially whenever any of them needs a tracker whose 
+ContactTracker::shouldBeParallelIfPossible() returns false, which is the 
+default for trackers you register with adoptContactTracker().
+
+@note This method should NOT be called while contacts are being tracked. **/
+void setNumberOfThreads(unsigned numThreads);
+
+/** Return the maximum number of threads used for narrow-phase tracking. **/
+int getNumberOfThreads() const;
+/**@}**/
+
+/**@name                         Ray Casting
+These methods find where rays first hit the contact surfaces, for simulating
+range sensors for example. **/
+/**@{**/
+
+/** The result of casting one ray with castRays(). **/
+class RayHit;
+
+/** Find the nearest intersection of each of a batch of rays with all the
+contact surfaces, at the positions in \a state, which must have been realized
+through Stage::Position. Ray i starts at origins[i] and goes in direction
+directions[i], both in Ground; only hits no farther than \a maxDistance
+(which may be Infinity) are reported. On return hits[i] tells which surface
+ray i hit first, at what distance, the surface normal there (in Ground) and,
+for a TriangleMesh, which face.
+
+Each ray is first tested against the broad-phase bubble of every surface,
+and a surface is examined only for the rays that enter its bubble before
+they have hit something nearer. Rays are processed in packets, with the
+surfaces visited in order of the packet's nearest bubble entry so that near
+hits cull the surfaces behind them. Meshes trace a whole packet through
+their OBB tree at once using ContactGeometry::TriangleMesh::intersectsRays().
+The packets are distributed over up to getNumberOfThreads() threads; the
+result does not depend on the number of threads. Torus surfaces, which don't
+support ray intersection, are ignored. **/
+void castRays(const State&                      state,
+              const ArrayViewConst_<Vec3>&      origins,
+              const ArrayViewConst_<UnitVec3>&  directions,
+              Real                              maxDistance,
+              Array_<RayHit>&                   hits) const;
 /**@}**/
 
 /**@name                     Advanced/Obscure
@@ -291,6 +339,27 @@ const ContactTrackerSubsystemImpl& getImpl() const;
 
 
 
+/** This is the result of casting one ray with
+ContactTrackerSubsystem::castRays(). If the ray hit nothing, the surface index
+is invalid, the distance is Infinity and the face is -1. **/
+class ContactTrackerSubsystem::RayHit {
+public:
+    RayHit() : distance(Infinity), face(-1) {}
+    /** Return true if the ray hit some surface. **/
+    bool isHit() const {return surface.isValid();}
+
+    /** The surface that the ray hit first. **/
+    ContactSurfaceIndex surface;
+    /** The distance along the ray to the hit point. **/
+    Real                distance;
+    /** The outward surface normal at the hit point, in Ground. **/
+    UnitVec3            normal;
+    /** The TriangleMesh face that was hit, or -1 for other geometry. **/
+    int                 face;
+};
+
+
+
 //==============================================================================
 //                            CONTACT SNAPSHOT
 //==============================================================================
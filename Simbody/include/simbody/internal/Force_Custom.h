@@ -261,6 +261,19 @@ public:
     virtual bool shouldBeParallelIfPossible() const {
         return false;
     }
+    /**
+     * If shouldBeParallelIfPossible() returns true, this gives a rough
+     * estimate of how expensive calcForce() is, in units of the cost of a
+     * simple force element such as Force::TwoPointLinearSpring.
+     * GeneralForceSubsystem groups the forces it calculates in parallel into
+     * chunks of similar total cost, so that many cheap forces are calculated
+     * together instead of each becoming a separate parallel task. The default
+     * of 1000 treats the force as expensive enough to get a chunk of its own;
+     * override this if you have many cheap parallel forces.
+     */
+    virtual Real getEvaluationCost() const {
+        return 1000;
+    }
     /** The following methods may optionally be overridden to do specialized 
     realization for a Force. **/
     //@{
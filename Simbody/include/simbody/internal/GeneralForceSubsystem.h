@@ -87,22 +87,53 @@ public:
        (State& state, ForceIndex index, bool shouldBeDisabled) const;
        
     /** Set the number of threads that the GeneralForceSubsystem can use to
-    calculate computationally expensive forces (that have the
-    shouldBeParallelIfPossible() method overridden). By default, the
-    number of threads is the number of total processors (including hyperthreads)
-    on the machine.
+    calculate forces. By default, the number of threads is the number of total
+    processors (including hyperthreads) on the machine.
+
+    Forces that are safe to calculate concurrently with other forces are
+    divided into chunks of similar estimated cost, and the chunks are
+    calculated in parallel. That includes Force::Custom elements whose
+    implementation overrides shouldBeParallelIfPossible() (see
+    Force::Custom::Implementation::getEvaluationCost()), and the simple
+    built-in force elements such as springs, dampers, constant forces and
+    bushings. All other forces are calculated one after another on a single
+    thread. If the total cost of the forces is small they are all calculated
+    serially, since the parallel overhead would outweigh the gain.
     
     @note This method should NOT be called while realizing Stage::Dynamics.**/
     void setNumberOfThreads(unsigned numThreads);
     
     /** Returns the number of threads that the GeneralForceSubsystem can
-    use to calculate computationally expensive forces (that have the
-    shouldBeParallelIfPossible() method overridden).
+    use to calculate forces.
     
     @return Maximum number of threads GeneralForceSubsystem can use for force
     computations**/
     int getNumberOfThreads() const;
 
+    /** Request that the force contributions be summed in an order that does
+    not depend on the number of threads. The forces calculated in parallel
+    are summed in chunks and blocks of chunks whose partial sums are then
+    added together pairwise; normally the number of chunks and blocks depends
+    on the number of threads, so the results are reproducible from run to run
+    but may differ in the last bits if the number of threads is changed. With
+    this option they are fixed, which makes the results bitwise identical for
+    any number of threads at the cost of some extra work even when running
+    serially. The default is false.
+    @see ParallelExecutor::parallelReduce() **/
+    void setDeterministicForceSummation(bool deterministic);
+
+    /** Returns whether the force contributions are summed in an order that
+    does not depend on the number of threads.
+    @see setDeterministicForceSummation() **/
+    bool getDeterministicForceSummation() const;
+
+    /** Return the accumulated time spent in the calcForce() method of the
+    Force with the given index. This is updated only while profiling is
+    enabled (see Profiler); the counters of all the forces that have been
+    evaluated are also included in System::getTimingCounters(). This must
+    not be called until the System's topology has been realized. **/
+    const TimingCounter& getForceTimingCounter(ForceIndex index) const;
+
     /** Every Subsystem is owned by a System; a GeneralForceSubsystem expects
     to be owned by a MultibodySystem. This method returns a const reference
     to the containing MultibodySystem and will throw an exception if there is
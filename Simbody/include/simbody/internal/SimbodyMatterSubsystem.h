@@ -205,6 +205,96 @@ void setShowDefaultGeometry(bool show);
 geometry that can be used to visualize this multibody system. **/
 bool getShowDefaultGeometry() const;
 
+/** Set the number of threads that the matter subsystem can use for the
+operators that are assembled one independent column at a time, currently
+the constraint-space matrix G*M^-1*~G used by
+calcProjectedMInv(), solveForConstraintImpulses() and forward dynamics with
+constraints. By default, the number of threads is the number of total
+processors (including hyperthreads) on the machine.
+
+The columns are only assembled in parallel when there are enough constraint
+equations to make that worthwhile, when the call is not already running on
+one of the shared pool's worker threads, and when every enabled Constraint is
+safe to evaluate concurrently. That includes all the built-in constraints
+except the CoordinateCoupler, SpeedCoupler and PrescribedMotion constraints,
+and Constraint::Custom elements whose implementation overrides
+Constraint::Custom::Implementation::shouldBeParallelIfPossible(). The result
+does not depend on the number of threads.
+
+@note This method should NOT be called while another thread is using this
+subsystem. **/
+void setNumberOfThreads(unsigned numThreads);
+
+/** Returns the number of threads that the matter subsystem can use; see
+setNumberOfThreads(). **/
+int getNumberOfThreads() const;
+
+/** Enable or disable level-parallel tree recursions. Most of Simbody's O(n)
+algorithms sweep the multibody tree one level at a time, either from Ground
+out to the tips or back in, and the mobilized bodies at the same level 
+(distance from Ground) are independent of one another. With this enabled,
+levels with at least getMinParallelLevelWidth() mobilized bodies are split
+among up to getNumberOfThreads() threads. That is the case for position and 
+velocity kinematics, articulated body inertias, forward and inverse dynamics,
+and multiplication by M and M^-1. This pays off for wide trees such as swarms
+of free bodies or granular particles; it is off by default.
+
+The results don't depend on the number of threads. Custom mobilizers 
+(MobilizedBody::Custom and MobilizedBody::FunctionBased) are evaluated 
+concurrently when this is enabled, so their implementations must be thread 
+safe.
+
+@note This method should NOT be called while another thread is using this
+subsystem. **/
+void setUseLevelParallelism(bool useLevelParallelism);
+
+/** Returns whether level-parallel tree recursions are enabled; see
+setUseLevelParallelism(). **/
+bool getUseLevelParallelism() const;
+
+/** Set the minimum number of mobilized bodies a level of the multibody tree
+must have to be processed in parallel when level parallelism is enabled. The
+default is 64. Narrower levels don't have enough work to make up for the cost
+of starting the threads. See setUseLevelParallelism().
+
+@note This method should NOT be called while another thread is using this
+subsystem. **/
+void setMinParallelLevelWidth(int minWidth);
+
+/** Returns the minimum width of a level of the multibody tree that is 
+processed in parallel; see setMinParallelLevelWidth(). **/
+int getMinParallelLevelWidth() const;
+
+/** Enable or disable subtree-parallel tree recursions. The mobilized bodies
+attached directly to Ground (base bodies) and their descendents form 
+independent subtrees, unless a Constraint acts on more than one of them in 
+which case those are treated as a single subtree. When this is enabled and
+there is more than one independent subtree, the O(n) recursions covered by
+setUseLevelParallelism() give each thread a range of whole subtrees to 
+process from base to tip (or tip to base) on its own, so the threads don't
+have to wait for one another at every level. That suits systems like many
+free bodies or several separate robots sharing a scene, especially deep 
+ones. When there is only one subtree the recursions go level by level as
+usual, in parallel if setUseLevelParallelism() is enabled. This is off by
+default.
+
+The results don't depend on the number of threads, and the same thread 
+safety requirement for custom mobilizers applies as for 
+setUseLevelParallelism().
+
+@note This method should NOT be called while another thread is using this
+subsystem. **/
+void setUseSubtreeParallelism(bool useSubtreeParallelism);
+
+/** Returns whether subtree-parallel tree recursions are enabled; see
+setUseSubtreeParallelism(). **/
+bool getUseSubtreeParallelism() const;
+
+/** Returns the number of independent subtrees of Ground found when the
+topology was realized; see setUseSubtreeParallelism(). This is zero if 
+Ground has no children. Topology stage must have been realized. **/
+int getNumIndependentSubtrees() const;
+
 /** The number of bodies includes all mobilized bodies \e including Ground,
 which is the first mobilized body, at MobilizedBodyIndex 0. (Note: if 
 special particle handling were implemented, the count here would \e not 
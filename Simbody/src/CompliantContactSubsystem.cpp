@@ -36,8 +36,77 @@ patch analysis methods.
 #include "simbody/internal/SimbodyMatterSubsystem.h"
 #include "simbody/internal/MultibodySystem.h"
 
+#include <algorithm>
+
 namespace SimTK {
 
+namespace {
+
+// Contact force costs are in units of the cost of a point contact such as
+// HertzCircular (roughly 100-200ns); see estimateForceCost().
+
+// Below this total cost it is cheaper to calculate the forces serially than
+// to hand them to other threads.
+const Real MinParallelForceCost = 200;
+// Chunks of contacts are made at least this expensive so that the parallel
+// bookkeeping stays small compared to the work in each chunk.
+const Real MinForceChunkCost = 50;
+
+// Elastic foundation patches with fewer springs than this find the nearest
+// points on the other surface serially. Each query descends the other 
+// surface's bounding volume tree, so it costs several point contacts.
+const int MinParallelSpringCount = 1000;
+// The smallest number of springs given to a thread at a time.
+const int MinSpringChunkSize = 64;
+
+// Mesh contacts are integrated over all the overlapping faces and cost much
+// more than point contacts.
+Real estimateForceCost(const Contact& contact) {
+    return TriangleMeshContact::isInstance(contact) ? 100 : 1;
+}
+
+// The ground-frame pose and velocity of the contact surfaces that are
+// involved in active contacts, calculated once per Velocity stage and shared
+// by all the contacts each surface is involved in. Entries for other surfaces
+// are garbage. The arrays keep their heap space from one evaluation to the
+// next.
+struct SurfaceKinematics {
+    Array_<Transform,ContactSurfaceIndex>   X_GS;
+    Array_<SpatialVec,ContactSurfaceIndex>  V_GS;
+    Array_<bool,ContactSurfaceIndex>        isNeeded;
+    Array_<ContactSurfaceIndex>             needed;
+};
+
+// Finds the nearest points on a surface to a contiguous chunk of the given
+// points. Each chunk writes only its own part of the results.
+class FindNearestPointsTask : public ParallelExecutor::Task {
+public:
+    FindNearestPointsTask(const ContactGeometry& geometry, 
+                          const Array_<Vec3>& positions, int chunkSize,
+                          Array_<Vec3>& nearestPoints, Array_<bool>& inside,
+                          Array_<UnitVec3>& normals)
+    :   m_geometry(geometry), m_positions(positions), m_chunkSize(chunkSize),
+        m_nearestPoints(nearestPoints), m_inside(inside), m_normals(normals) {}
+
+    void execute(int chunk) override {
+        const int begin = chunk*m_chunkSize;
+        const int length = std::min(m_chunkSize, 
+                                    (int)m_positions.size()-begin);
+        m_geometry.findNearestPoints(m_positions(begin, length), 
+            m_nearestPoints(begin, length), m_inside(begin, length), 
+            m_normals(begin, length));
+    }
+private:
+    const ContactGeometry&  m_geometry;
+    const Array_<Vec3>&     m_positions;
+    const int               m_chunkSize;
+    Array_<Vec3>&           m_nearestPoints;
+    Array_<bool>&           m_inside;
+    Array_<UnitVec3>&       m_normals;
+};
+
+}
+
 //==============================================================================
 //                    COMPLIANT CONTACT SUBSYSTEM IMPL
 //==============================================================================
@@ -52,8 +121,24 @@ CompliantContactSubsystemImpl(const ContactTrackerSubsystem& tracker)
     m_ooTransitionVelocity(1/m_transitionVelocity), 
     m_trackDissipatedEnergy(false), m_defaultGenerator(0) 
 {   
+    // The default number of threads is the number of processors; call
+    // setNumberOfThreads() to override it. Mesh contacts cost far more than
+    // point contacts, so let idle threads steal work from busy ones.
+    m_executor = new ParallelExecutor();
+    m_executor->setScheduling(ParallelExecutor::WorkStealingScheduling);
 }
 
+void setNumberOfThreads(unsigned numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "CompliantContactSubsystemImpl",
+        "setNumberOfThreads", "Number of threads must be positive");
+    m_executor = new ParallelExecutor(numThreads,
+        ParallelExecutor::WorkStealingScheduling);
+}
+
+int getNumberOfThreads() const {return m_executor->getMaxThreads();}
+
+ParallelExecutor& updExecutor() const {return *m_executor;}
+
 Real getTransitionVelocity() const  {return m_transitionVelocity;}
 Real getOOTransitionVelocity() const  {return m_ooTransitionVelocity;}
 void setTransitionVelocity(Real vt) 
@@ -112,21 +197,13 @@ bool calcContactPatchDetailsById(const State&   state,
         return false;
     }
 
-    const Transform& X_S1S2 = contact.getTransform();
     const ContactSurfaceIndex surf1(contact.getSurface1());
     const ContactSurfaceIndex surf2(contact.getSurface2());
-    const MobilizedBody& mobod1 = m_tracker.getMobilizedBody(surf1);
-    const MobilizedBody& mobod2 = m_tracker.getMobilizedBody(surf2);
-
-    const Transform X_GS1 = mobod1.findFrameTransformInGround
-        (state, m_tracker.getContactSurfaceTransform(surf1));
-    const Transform X_GS2 = mobod2.findFrameTransformInGround
-        (state, m_tracker.getContactSurfaceTransform(surf2));
-
-    const SpatialVec V_GS1 = mobod1.findFrameVelocityInGround
-        (state, m_tracker.getContactSurfaceTransform(surf1));
-    const SpatialVec V_GS2 = mobod2.findFrameVelocityInGround
-        (state, m_tracker.getContactSurfaceTransform(surf2));
+    const SurfaceKinematics& kin = getSurfaceKinematics(state);
+    const Transform&  X_GS1 = kin.X_GS[surf1];
+    const Transform&  X_GS2 = kin.X_GS[surf2];
+    const SpatialVec& V_GS1 = kin.V_GS[surf1];
+    const SpatialVec& V_GS2 = kin.V_GS[surf2];
 
     // Calculate the relative velocity of S2 in S1, expressed in S1.
     const SpatialVec V_S1S2 =
@@ -231,6 +308,11 @@ int realizeSubsystemTopologyImpl(State& s) const override {
     wThis->m_potEnergyCacheIx = allocateLazyCacheEntry(s, 
         Stage::Position, new Value<Real>(NaN));
 
+    // The surface poses and velocities are shared by the force calculation
+    // and calcContactPatchDetailsById().
+    wThis->m_surfaceKinematicsCacheIx = allocateLazyCacheEntry(s, 
+        Stage::Velocity, new Value<SurfaceKinematics>());
+
     // This state variable is used to integrate power to get dissipated
     // energy. Allocate only if requested.
     if (m_trackDissipatedEnergy) {
@@ -354,9 +436,20 @@ void markPotentialEnergyCacheValid(const State& s) const
 void markForceCacheValid(const State& s) const
 {   markCacheValueRealized(s,m_forceCacheIx); }
 
+const SurfaceKinematics& getSurfaceKinematics(const State& s) const;
 void ensurePotentialEnergyCacheValid(const State&) const;
 void ensureForceCacheValid(const State&) const;
 
+void calcContactForce(const State& state, const Contact& contact,
+                      const SurfaceKinematics& kin, 
+                      ContactForce& force) const;
+void calcContactForces(const State& state, const ContactSnapshot& active,
+                       const SurfaceKinematics& kin, int begin, int end,
+                       Array_<ContactForce>& forces) const;
+
+class CalcSurfaceKinematicsTask;
+class CalcContactForcesTask;
+
 
 
     // TOPOLOGY "STATE"
@@ -383,6 +476,9 @@ GeneratorMap                        m_generators;
 // this will either do nothing silently or throw an error.
 ContactForceGenerator*              m_defaultGenerator;
 
+// This calculates the contact forces in parallel.
+mutable ClonePtr<ParallelExecutor>  m_executor;
+
     // TOPOLOGY "CACHE"
 
 // These must be set during realizeTopology and treated as const thereafter.
@@ -391,6 +487,7 @@ ContactForceGenerator*              m_defaultGenerator;
 ZIndex                              m_dissipatedEnergyIx;
 CacheEntryIndex                     m_potEnergyCacheIx;
 CacheEntryIndex                     m_forceCacheIx;
+CacheEntryIndex                     m_surfaceKinematicsCacheIx;
 };
 
 void CompliantContactSubsystemImpl::
@@ -432,59 +529,205 @@ ensurePotentialEnergyCacheValid(const State& state) const {
 }
 
 
-void CompliantContactSubsystemImpl::
-ensureForceCacheValid(const State& state) const {
-    if (isForceCacheValid(state)) return;
+// Calculates the pose and velocity of a contiguous range of the needed
+// surfaces.
+class CompliantContactSubsystemImpl::CalcSurfaceKinematicsTask 
+:   public ParallelExecutor::Task {
+public:
+    CalcSurfaceKinematicsTask(const ContactTrackerSubsystem& tracker,
+                              const State& state, int chunkSize,
+                              SurfaceKinematics& kin)
+    :   m_tracker(tracker), m_state(state), m_chunkSize(chunkSize), 
+        m_kin(kin) {}
+
+    void execute(int chunk) override {
+        const int end = std::min((chunk+1)*m_chunkSize, 
+                                 (int)m_kin.needed.size());
+        for (int i=chunk*m_chunkSize; i < end; ++i) {
+            const ContactSurfaceIndex surf = m_kin.needed[i];
+            const MobilizedBody& mobod = m_tracker.getMobilizedBody(surf);
+            const Transform& X_BS = m_tracker.getContactSurfaceTransform(surf);
+            m_kin.X_GS[surf] = mobod.getBodyTransform(m_state)*X_BS;
+            m_kin.V_GS[surf] = mobod.findFrameVelocityInGround(m_state, X_BS);
+        }
+    }
+private:
+    const ContactTrackerSubsystem&  m_tracker;
+    const State&                    m_state;
+    const int                       m_chunkSize;
+    SurfaceKinematics&              m_kin;
+};
+
+const SurfaceKinematics& CompliantContactSubsystemImpl::
+getSurfaceKinematics(const State& state) const {
+    if (isCacheValueRealized(state, m_surfaceKinematicsCacheIx))
+        return Value<SurfaceKinematics>::downcast
+                    (getCacheEntry(state, m_surfaceKinematicsCacheIx));
 
     SimTK_STAGECHECK_GE_ALWAYS(getStage(state), Stage::Velocity,
-        "CompliantContactSubystemImpl::ensureForceCacheValid()");
+        "CompliantContactSubystemImpl::getSurfaceKinematics()");
+
+    SurfaceKinematics& kin = Value<SurfaceKinematics>::updDowncast
+                                (updCacheEntry(state, m_surfaceKinematicsCacheIx));
+    const int numSurfaces = m_tracker.getNumSurfaces();
+    kin.X_GS.resize(numSurfaces);
+    kin.V_GS.resize(numSurfaces);
+    kin.isNeeded.resize(numSurfaces);
+    std::fill(kin.isNeeded.begin(), kin.isNeeded.end(), false);
+    kin.needed.clear();
+
+    // Find the surfaces that are involved in unbroken contacts.
+    const ContactSnapshot& active = m_tracker.getActiveContacts(state);
+    for (int i=0; i < active.getNumContacts(); ++i) {
+        const Contact& contact = active.getContact(i);
+        if (contact.getCondition() == Contact::Broken)
+            continue;
+        const ContactSurfaceIndex surfs[2] = 
+            {contact.getSurface1(), contact.getSurface2()};
+        for (ContactSurfaceIndex surf : surfs)
+            if (!kin.isNeeded[surf]) {
+                kin.isNeeded[surf] = true;
+                kin.needed.push_back(surf);
+            }
+    }
 
-    Array_<ContactForce>& forces = updForceCache(state);
-    forces.clear();
+    // Each surface costs about a fifth of a point contact force.
+    const int numNeeded = (int)kin.needed.size();
+    const int numThreads = std::min(getNumberOfThreads(),
+                                    ParallelExecutor::getNumSharedThreads());
+    const int chunkSize = (int)(5*MinForceChunkCost);
+    const int numChunks = (numNeeded + chunkSize-1)/chunkSize;
+    CalcSurfaceKinematicsTask task(m_tracker, state, chunkSize, kin);
+    if (numThreads == 1 || numNeeded < 5*MinParallelForceCost)
+        for (int chunk=0; chunk < numChunks; ++chunk)
+            task.execute(chunk);
+    else
+        m_executor->execute(task, numChunks);
+
+    markCacheValueRealized(state, m_surfaceKinematicsCacheIx);
+    return kin;
+}
 
+// Calculate the force for one unbroken contact, in Ground. The force is
+// invalid if the contact isn't generating any force.
+void CompliantContactSubsystemImpl::
+calcContactForce(const State& state, const Contact& contact,
+                 const SurfaceKinematics& kin, ContactForce& force) const {
+    const ContactSurfaceIndex surf1(contact.getSurface1());
+    const ContactSurfaceIndex surf2(contact.getSurface2());
+    const Transform& X_GS1 = kin.X_GS[surf1];
 
-    const ContactSnapshot& active = m_tracker.getActiveContacts(state);
-    const int nContacts = active.getNumContacts();
-    for (int i=0; i<nContacts; ++i) {
+    // Calculate the relative velocity of S2 in S1, expressed in S1.
+    const SpatialVec V_S1S2 = findRelativeVelocity
+       (X_GS1, kin.V_GS[surf1], kin.X_GS[surf2], kin.V_GS[surf2]); // 51 flops
+
+    const ContactForceGenerator& generator = 
+        getForceGenerator(contact.getTypeId());
+    // Calculate the contact force measured and expressed in S1.
+    generator.calcContactForce(state, contact, V_S1S2, force);
+    // Re-express the contact force in Ground for later use.
+    if (force.isValid())
+        force.changeFrameInPlace(X_GS1); // switch to Ground
+}
+
+// Calculate the forces for active contacts begin through end-1, each into
+// the slot with the same index. Broken contacts get an invalid force.
+void CompliantContactSubsystemImpl::
+calcContactForces(const State& state, const ContactSnapshot& active,
+                  const SurfaceKinematics& kin, int begin, int end,
+                  Array_<ContactForce>& forces) const {
+    for (int i=begin; i < end; ++i) {
         const Contact& contact = active.getContact(i);
         if (contact.getCondition() == Contact::Broken) {
             // No need to generate forces; this will be gone next time.
+            forces[i].clear();
             continue;
         }
-        const Transform& X_S1S2 = contact.getTransform();
-        const ContactSurfaceIndex surf1(contact.getSurface1());
-        const ContactSurfaceIndex surf2(contact.getSurface2());
-        const MobilizedBody& mobod1 = m_tracker.getMobilizedBody(surf1);
-        const MobilizedBody& mobod2 = m_tracker.getMobilizedBody(surf2);
-
-        // TODO: These two are expensive (63 flops each) and shouldn't have 
-        // to be recalculated here since we must have used them in creating
-        // the Contact and X_S1S2.
-        const Transform X_GS1 = mobod1.findFrameTransformInGround
-            (state, m_tracker.getContactSurfaceTransform(surf1));
-        const Transform X_GS2 = mobod2.findFrameTransformInGround
-            (state, m_tracker.getContactSurfaceTransform(surf2));
-
-        const SpatialVec V_GS1 = mobod1.findFrameVelocityInGround
-            (state, m_tracker.getContactSurfaceTransform(surf1));
-        const SpatialVec V_GS2 = mobod2.findFrameVelocityInGround
-            (state, m_tracker.getContactSurfaceTransform(surf2));
-
-        // Calculate the relative velocity of S2 in S1, expressed in S1.
-        const SpatialVec V_S1S2 =
-            findRelativeVelocity(X_GS1, V_GS1, X_GS2, V_GS2);   // 51 flops
+        calcContactForce(state, contact, kin, forces[i]);
+    }
+}
 
-        const ContactForceGenerator& generator = 
-            getForceGenerator(contact.getTypeId());
-        forces.push_back(); // allocate a new garbage ContactForce
-        // Calculate the contact force measured and expressed in S1.
-        generator.calcContactForce(state, contact, V_S1S2, forces.back());
-        // Re-express the contact force in Ground for later use.
-        if (forces.back().isValid())
-            forces.back().changeFrameInPlace(X_GS1); // switch to Ground
-        else
-            forces.pop_back(); // never mind ...
+// Calculates the forces for a contiguous chunk of the active contacts.
+class CompliantContactSubsystemImpl::CalcContactForcesTask 
+:   public ParallelExecutor::Task {
+public:
+    CalcContactForcesTask(const CompliantContactSubsystemImpl& impl,
+                          const State& state, const ContactSnapshot& active,
+                          const SurfaceKinematics& kin,
+                          const Array_<int>& chunkStarts,
+                          Array_<ContactForce>& forces)
+    :   m_impl(impl), m_state(state), m_active(active), m_kin(kin),
+        m_chunkStarts(chunkStarts), m_forces(forces) {}
+
+    void execute(int chunk) override {
+        m_impl.calcContactForces(m_state, m_active, m_kin, 
+            m_chunkStarts[chunk], m_chunkStarts[chunk+1], m_forces);
     }
+private:
+    const CompliantContactSubsystemImpl&    m_impl;
+    const State&                            m_state;
+    const ContactSnapshot&                  m_active;
+    const SurfaceKinematics&                m_kin;
+    const Array_<int>&                      m_chunkStarts;
+    Array_<ContactForce>&                   m_forces;
+};
+
+// The contacts are divided into contiguous chunks of similar estimated cost
+// and the chunks are calculated in parallel if there is enough work and every
+// generator involved allows it. Each contact has its own slot in the force
+// cache; afterwards the invalid forces are squeezed out, keeping the contact
+// order. The cache array is reused, so once it has grown large enough the
+// forces are calculated without any heap allocation.
+void CompliantContactSubsystemImpl::
+ensureForceCacheValid(const State& state) const {
+    if (isForceCacheValid(state)) return;
+
+    SimTK_STAGECHECK_GE_ALWAYS(getStage(state), Stage::Velocity,
+        "CompliantContactSubystemImpl::ensureForceCacheValid()");
+
+    const ContactSnapshot& active = m_tracker.getActiveContacts(state);
+    const SurfaceKinematics& kin = getSurfaceKinematics(state);
+    const int nContacts = active.getNumContacts();
+
+    Array_<ContactForce>& forces = updForceCache(state);
+    forces.resize(nContacts);
+
+    const int numThreads = std::min(getNumberOfThreads(),
+                                    ParallelExecutor::getNumSharedThreads());
+    Real totalCost = 0;
+    bool canBeParallel = true;
+    if (numThreads > 1)
+        for (int i=0; i<nContacts; ++i) {
+            const Contact& contact = active.getContact(i);
+            totalCost += estimateForceCost(contact);
+            canBeParallel &= getForceGenerator(contact.getTypeId())
+                                .shouldBeParallelIfPossible();
+        }
+
+    if (numThreads == 1 || totalCost < MinParallelForceCost 
+        || !canBeParallel)
+        calcContactForces(state, active, kin, 0, nContacts, forces);
+    else {
+        Array_<int> chunkStarts(1, 0);
+        ParallelExecutor::appendChunksByCost(nContacts,
+            [&](int i) {return estimateForceCost(active.getContact(i));},
+            ParallelExecutor::calcTargetChunkCost(totalCost, numThreads,
+                                                  MinForceChunkCost),
+            chunkStarts);
+
+        CalcContactForcesTask task(*this, state, active, kin, chunkStarts, 
+                                   forces);
+        m_executor->execute(task, (int)chunkStarts.size()-1);
+    }
+
+    int numValid = 0;
+    for (int i=0; i<nContacts; ++i)
+        if (forces[i].isValid()) {
+            if (numValid != i)
+                forces[numValid] = forces[i];
+            ++numValid;
+        }
+    forces.resize(numValid);
 
     markForceCacheValid(state);
 }
@@ -525,6 +768,7 @@ CompliantContactSubsystem::CompliantContactSubsystem
     adoptForceGenerator(new ContactForceGenerator::HertzCircular());
     adoptForceGenerator(new ContactForceGenerator::HertzElliptical());
     adoptForceGenerator(new ContactForceGenerator::BrickHalfSpacePenalty());
+    adoptForceGenerator(new ContactForceGenerator::ManifoldPenalty());
     adoptForceGenerator(new ContactForceGenerator::ElasticFoundation());
     adoptDefaultForceGenerator(new ContactForceGenerator::DoNothing());
 }
@@ -545,6 +789,11 @@ void CompliantContactSubsystem::setTrackDissipatedEnergy(bool shouldTrack)
 bool CompliantContactSubsystem::getTrackDissipatedEnergy() const
 {   return getImpl().getTrackDissipatedEnergy(); }
 
+void CompliantContactSubsystem::setNumberOfThreads(unsigned numThreads)
+{   updImpl().setNumberOfThreads(numThreads); }
+int CompliantContactSubsystem::getNumberOfThreads() const
+{   return getImpl().getNumberOfThreads(); }
+
 int CompliantContactSubsystem::getNumContactForces(const State& s) const
 {   return getImpl().getNumContactForces(s); }
 
@@ -1179,77 +1428,43 @@ void ContactForceGenerator::HertzElliptical::calcContactPatch
                                        &patch_S1.m_elements);
 }
 
-// Given a set of vertices of surface B penetrating a halfspace H with given
-// surface normal n, generate at each vertex a normal force resisting 
-// its penetration and penetration rate, and a tangential force resisting slip.
-// The model applied at each vertex is just a kx force; that really only makes
+// Given a set of points of surface B penetrating surface H along a common
+// normal n (pointing out of H), and the penetration depth of each, generate
+// at each point a normal force resisting its penetration and penetration 
+// rate, and a tangential force resisting slip. The points are on the
+// undeformed surface of B and everything is measured and expressed in H.
+// The model applied at each point is just a kx force; that really only makes
 // sense for face-face contact where the contact area doesn't change with
 // the penetration depth. A single-vertex contact displaces a volume 
 // proportional to x^3, a single-edge contact displaces x^2 but we're 
-// igoring that here.
-static void calcPointHalfSpacePenaltyForce
+// igoring that here. Points that aren't penetrating are skipped; the return
+// value is the number that were. contactForce_H and details must have been
+// cleared by the caller; contactForce_H is only filled in if the return
+// value is nonzero.
+static int calcPointPenaltyForce
    (const CompliantContactSubsystem& subsys,
     const ContactTrackerSubsystem&   tracker, 
-    const State&                     state,
-    const BrickHalfSpaceContact&     contact,
+    const Contact&                   contact,
+    const UnitVec3&                  normal_H,
+    const Vec3*                      points_H,
+    const Real*                      depths,
+    int                              numPoints,
     const SpatialVec&                V_HB, // relative surface velocity, B in H
     ContactForce&                    contactForce_H,
     Array_<ContactDetail>*           details) // pass as null if you don't care
 {
-    contactForce_H.clear(); // no contact; invalidate return result
-    if (details) details->clear();
-
-    const int lowestVertex = contact.getLowestVertex();
-    const Real lowestDepth = contact.getDepth();
-
-    if (lowestDepth <= 0) {
-        return; // not contacting
-    }
-
-    const ContactSurfaceIndex surfHx = contact.getSurface1();
-    const ContactSurfaceIndex surfBx = contact.getSurface2();
-    const Transform&          X_HB   = contact.getTransform();
+    const ContactSurface&  surfH  = 
+        tracker.getContactSurface(contact.getSurface1());
+    const ContactSurface&  surfB  = 
+        tracker.getContactSurface(contact.getSurface2());
+    const ContactMaterial& matH   = surfH.getMaterial();
+    const ContactMaterial& matB   = surfB.getMaterial();
 
     // Abbreviations.
-    const Rotation& R_HB = X_HB.R(); // orientation of B in H
-    const Vec3&     p_HB = X_HB.p(); // position of Bo in H
+    const Vec3&     p_HB = contact.getTransform().p(); // position of Bo in H
     const Vec3&     w_HB = V_HB[0];  // ang. vel. of B in H
     const Vec3&     v_HB = V_HB[1];  // vel. of Bo in H
 
-    const ContactSurface&  surfH  = tracker.getContactSurface(surfHx);
-    const ContactSurface&  surfB  = tracker.getContactSurface(surfBx);
-    const ContactMaterial& matH   = surfH.getMaterial();
-    const ContactMaterial& matB   = surfB.getMaterial();
-
-    const ContactGeometry::HalfSpace& halfSpace =
-        ContactGeometry::HalfSpace::getAs(surfH.getShape());
-    const ContactGeometry::Brick& brick = 
-        ContactGeometry::Brick::getAs(surfB.getShape());
-
-    const UnitVec3 normal_H = halfSpace.getNormal();
-
-    // The Box represents the Brick surface as a convex mesh with known 
-    // connectivity. We know the vertex that is most penetrated. There are
-    // three faces connected to that vertex; we want the one whose normal
-    // is closest to antiparallel to the half-space normal.
-    const Geo::Box& box = brick.getGeoBox();
-    int faces[3], which[3];
-    box.getVertexFaces(lowestVertex, faces, which);
-    // We want the most negative cosine we can get.
-    int bestFace = -1, bestWhich = -1; Real bestCos = Infinity;
-    for (int f=0; f < 3; ++f) {
-        const int face = faces[f];
-        const Real cos = 
-            dot(normal_H, R_HB.getAxisUnitVec(box.getFaceCoordinateDirection(face)));
-        if (cos < bestCos)
-            bestFace=face, bestWhich=which[f], bestCos=cos;
-    }
-
-    SimTK_ASSERT_ALWAYS(bestCos < 0,
-      "calcPointHalfSpacePenaltyForce(): lowest vertex should have had a face "
-      "roughly antiparallel to the half-space. Is something wrong with the box "
-      "mesh connectivity?");
-
     // Calculate composite material properties.
     // TODO: this pairwise material calculation (~60 flops) could be cached.
 
@@ -1278,10 +1493,9 @@ static void calcPointHalfSpacePenaltyForce
     Real uv = 2*uvH*uvB; if (uv!=0) uv /= (uvH+uvB);
     assert(us >= ud);
 
-    // Accumulate force applied by the half-space to the brick, as though it
-    // were applied at the half-space origin. We'll move it to the center of
-    // pressure later (the moment will change in that case). This is expressed
-    // in H.
+    // Accumulate force applied by H to B, as though it were applied at H's
+    // origin. We'll move it to the center of pressure later (the moment will
+    // change in that case). This is expressed in H.
     SpatialVec FB_H(Vec3(0),Vec3(0));
     Real totalPE = 0;    // accumulate potential energy
     Real totalPower = 0; // accumulate dissipated power
@@ -1294,18 +1508,14 @@ static void calcPointHalfSpacePenaltyForce
     Real totalNormalMoment = 0;
 
 
-    int vertices[4];
-    box.getFaceVertices(bestFace, vertices);
     int nActiveVertices = 0;
-    for (int i=0; i < 4; ++i) {
-        const int  vx  = vertices[i];
-        const Vec3 v_B = box.getVertexPos(vx);
-        const Vec3 v_H = X_HB * v_B;          // 18 flops
-        const Real x   = -dot(v_H, normal_H); // undeformed pen. depth; 6 flops
+    for (int i=0; i < numPoints; ++i) {
+        const Vec3& v_H = points_H[i];
+        const Real  x   = depths[i];  // undeformed penetration depth
         if (x <= 0) continue; // not penetrated (1 flop)
 
         // Actual contact point moves closer to stiffer surface. Would be at
-        // v_H if brick were very stiff and half-space very soft.
+        // v_H if B were very stiff and H very soft.
         const Vec3 contactPt_H = v_H + (x*sB)*normal_H;
         const Real fK = k*x; // normal force due to stiffness (>= 0)
         const Real pe = k*x*x/2;
@@ -1400,7 +1610,8 @@ static void calcPointHalfSpacePenaltyForce
         }
     }
 
-    assert(nActiveVertices); // at least the deepest vertex should be active
+    if (nActiveVertices == 0)
+        return 0; // nothing penetrated; leave contactForce_H alone
 
     if (totalNormalMoment > 0)
         centerOfPressure_H /= totalNormalMoment;
@@ -1415,6 +1626,75 @@ static void calcPointHalfSpacePenaltyForce
     contactForce_H.setForceOnSurface2(FB_H);
     contactForce_H.setPotentialEnergy(totalPE);
     contactForce_H.setPowerDissipation(totalPower);
+    return nActiveVertices;
+}
+
+// Given a brick B penetrating a halfspace H, find the brick face that is
+// contacting the halfspace and apply the point penalty model above at each
+// of its vertices.
+static void calcPointHalfSpacePenaltyForce
+   (const CompliantContactSubsystem& subsys,
+    const ContactTrackerSubsystem&   tracker, 
+    const State&                     state,
+    const BrickHalfSpaceContact&     contact,
+    const SpatialVec&                V_HB, // relative surface velocity, B in H
+    ContactForce&                    contactForce_H,
+    Array_<ContactDetail>*           details) // pass as null if you don't care
+{
+    contactForce_H.clear(); // no contact; invalidate return result
+    if (details) details->clear();
+
+    const int lowestVertex = contact.getLowestVertex();
+    const Real lowestDepth = contact.getDepth();
+
+    if (lowestDepth <= 0) {
+        return; // not contacting
+    }
+
+    const Transform& X_HB = contact.getTransform();
+    const Rotation&  R_HB = X_HB.R(); // orientation of B in H
+
+    const ContactGeometry::HalfSpace& halfSpace = ContactGeometry::HalfSpace::
+        getAs(tracker.getContactSurface(contact.getSurface1()).getShape());
+    const ContactGeometry::Brick& brick = ContactGeometry::Brick::
+        getAs(tracker.getContactSurface(contact.getSurface2()).getShape());
+
+    const UnitVec3 normal_H = halfSpace.getNormal();
+
+    // The Box represents the Brick surface as a convex mesh with known 
+    // connectivity. We know the vertex that is most penetrated. There are
+    // three faces connected to that vertex; we want the one whose normal
+    // is closest to antiparallel to the half-space normal.
+    const Geo::Box& box = brick.getGeoBox();
+    int faces[3], which[3];
+    box.getVertexFaces(lowestVertex, faces, which);
+    // We want the most negative cosine we can get.
+    int bestFace = -1, bestWhich = -1; Real bestCos = Infinity;
+    for (int f=0; f < 3; ++f) {
+        const int face = faces[f];
+        const Real cos = 
+            dot(normal_H, R_HB.getAxisUnitVec(box.getFaceCoordinateDirection(face)));
+        if (cos < bestCos)
+            bestFace=face, bestWhich=which[f], bestCos=cos;
+    }
+
+    SimTK_ASSERT_ALWAYS(bestCos < 0,
+      "calcPointHalfSpacePenaltyForce(): lowest vertex should have had a face "
+      "roughly antiparallel to the half-space. Is something wrong with the box "
+      "mesh connectivity?");
+
+    int vertices[4];
+    box.getFaceVertices(bestFace, vertices);
+    Vec3 points_H[4]; Real depths[4];
+    for (int i=0; i < 4; ++i) {
+        points_H[i] = X_HB * box.getVertexPos(vertices[i]); // 18 flops
+        depths[i]   = -dot(points_H[i], normal_H);          // 6 flops
+    }
+
+    const int nActiveVertices = 
+        calcPointPenaltyForce(subsys, tracker, contact, normal_H, points_H,
+                              depths, 4, V_HB, contactForce_H, details);
+    assert(nActiveVertices); // at least the deepest vertex should be active
 }
 
 //==============================================================================
@@ -1472,6 +1752,77 @@ void ContactForceGenerator::BrickHalfSpacePenalty::calcContactPatch
 
 
 
+//==============================================================================
+//                          MANIFOLD PENALTY GENERATOR
+//==============================================================================
+// The given Contact object has a set of points sharing a common normal, each
+// with its own depth. We apply the point penalty model at each one, using 
+// the point on the undeformed surface2 as calcPointPenaltyForce() expects.
+static void calcManifoldPenaltyForce
+   (const CompliantContactSubsystem& subsys,
+    const ContactTrackerSubsystem&   tracker, 
+    const ManifoldContact&           contact,
+    const SpatialVec&                V_S1S2,
+    ContactForce&                    contactForce_S1,
+    Array_<ContactDetail>*           details) // pass as null if you don't care
+{
+    contactForce_S1.clear(); // no contact; invalidate return result
+    if (details) details->clear();
+
+    // Brick-brick contacts have at most 8 points; avoid the heap for those.
+    const int numPoints = contact.getNumPoints();
+    Vec3 pointBuf[8]; Real depthBuf[8];
+    Array_<Vec3> pointArray; Array_<Real> depthArray;
+    Vec3* points_S1 = pointBuf; Real* depths = depthBuf;
+    if (numPoints > 8) {
+        pointArray.resize(numPoints); depthArray.resize(numPoints);
+        points_S1 = pointArray.data(); depths = depthArray.data();
+    }
+
+    const UnitVec3& normal_S1 = contact.getNormal();
+    for (int i=0; i < numPoints; ++i) {
+        depths[i]    = contact.getDepth(i);
+        points_S1[i] = contact.getOrigin(i) - (depths[i]/2)*normal_S1;
+    }
+
+    calcPointPenaltyForce(subsys, tracker, contact, normal_S1, points_S1,
+                          depths, numPoints, V_S1S2, contactForce_S1, details);
+}
+
+void ContactForceGenerator::ManifoldPenalty::calcContactForce
+   (const State&            state,
+    const Contact&          overlap,    // contains X_S1S2
+    const SpatialVec&       V_S1S2,     // relative surface velocity, S2 in S1
+    ContactForce&           contactForce_S1) const
+{
+    SimTK_ASSERT(ManifoldContact::isInstance(overlap),
+        "ContactForceGenerator::ManifoldPenalty::calcContactForce(): expected"
+        " ManifoldContact.");
+
+    const CompliantContactSubsystem& subsys = getCompliantContactSubsystem();
+    calcManifoldPenaltyForce(subsys, subsys.getContactTrackerSubsystem(),
+                             ManifoldContact::getAs(overlap), V_S1S2,
+                             contactForce_S1, 0);
+}
+
+void ContactForceGenerator::ManifoldPenalty::calcContactPatch
+   (const State&      state,
+    const Contact&    overlap,
+    const SpatialVec& V_S1S2,
+    ContactPatch&     patch_S1) const
+{  
+    SimTK_ASSERT(ManifoldContact::isInstance(overlap),
+        "ContactForceGenerator::ManifoldPenalty::calcContactPatch(): expected"
+        " ManifoldContact.");
+
+    const CompliantContactSubsystem& subsys = getCompliantContactSubsystem();
+    calcManifoldPenaltyForce(subsys, subsys.getContactTrackerSubsystem(),
+                             ManifoldContact::getAs(overlap), V_S1S2,
+                             patch_S1.m_resultant, &patch_S1.m_elements);
+}
+
+
+
 //==============================================================================
 //                         ELASTIC FOUNDATION GENERATOR
 //==============================================================================
@@ -1619,7 +1970,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
         const ContactGeometry::TriangleMesh& mesh1 = 
             ContactGeometry::TriangleMesh::getAs(shape1);
 
-        calcWeightedPatchCentroid(mesh1, contact.getSurface1Faces(),
+        calcWeightedPatchCentroid(mesh1, contact.getSurface1FaceIndices(),
                                   weightedPatchCentroid1_S1, patchArea1);
     }
     if (shape2.getTypeId() == ContactGeometry::TriangleMesh::classTypeId()) {
@@ -1627,7 +1978,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
             ContactGeometry::TriangleMesh::getAs(shape2);
         Vec3 weightedPatchCentroid2_S2;
 
-        calcWeightedPatchCentroid(mesh2, contact.getSurface2Faces(),
+        calcWeightedPatchCentroid(mesh2, contact.getSurface2FaceIndices(),
                                   weightedPatchCentroid2_S2, patchArea2);
         // Remeasure patch2's weighted centroid from surface1's frame;
         // be sure to weight the new offset also.
@@ -1695,7 +2046,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
             ContactGeometry::TriangleMesh::getAs(shape1);
 
         processOneMesh(state, 
-            mesh, contact.getSurface1Faces(),
+            mesh, contact.getSurface1FaceIndices(),
             X_S1S2, V_S1S2, shape2,
             s1, areaScale1,
             kh, c, us, ud, uv,
@@ -1725,7 +2076,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
             wantDetails ? contactDetails_S1->size() : 0;
 
         processOneMesh(state, 
-            mesh, contact.getSurface2Faces(),
+            mesh, contact.getSurface2FaceIndices(),
             X_S2S1, V_S2S1, shape1,
             s2, areaScale2,
             kh, c, us, ud, uv,
@@ -1790,14 +2141,13 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
 void ContactForceGenerator::ElasticFoundation::
 calcWeightedPatchCentroid
    (const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    const Array_<int>&                      insideFaces,
     Vec3&                                   weightedPatchCentroid,
     Real&                                   patchArea) const
 {
     weightedPatchCentroid = Vec3(0); patchArea = 0;
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter)
-    {   const int  face = *iter;
+    for (int i=0; i < (int)insideFaces.size(); ++i)
+    {   const int  face = insideFaces[i];
         const Real area = mesh.getFaceArea(face);
         weightedPatchCentroid   += area*mesh.findCentroid(face); 
         patchArea               += area; 
@@ -1824,7 +2174,7 @@ void ContactForceGenerator::ElasticFoundation::
 processOneMesh
    (const State&                            state,
     const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    const Array_<int>&                      insideFaces,
     const Transform&                        X_MO, 
     const SpatialVec&                       V_MO,
     const ContactGeometry&                  other,
@@ -1861,21 +2211,41 @@ processOneMesh
     const Real vtrans   = subsys.getTransitionVelocity();
     const Real ooVtrans = subsys.getOOTransitionVelocity(); // 1/vtrans
 
+    // Find the nearest point on the other surface to each spring in one
+    // batch, since neighboring springs are likely to have nearby nearest 
+    // points. This is most of the cost of a large patch, so split it among
+    // threads if we aren't already running on one.
+    const int numSprings = (int)insideFaces.size();
+    Array_<Vec3>     springPos_O(numSprings), nearestPoint_O(numSprings);
+    Array_<bool>     inside(numSprings);
+    Array_<UnitVec3> normal_O(numSprings); // not used
+    const Transform X_OM = ~X_MO;
+    for (int i=0; i < numSprings; ++i)  // 18 flops each
+        springPos_O[i] = X_OM*mesh.findCentroid(insideFaces[i]);
+    const int numThreads = std::min(subsys.getNumberOfThreads(),
+                                    ParallelExecutor::getNumSharedThreads());
+    if (numThreads == 1 || numSprings < MinParallelSpringCount
+        || ParallelExecutor::isWorkerThread())
+        other.findNearestPoints(springPos_O, nearestPoint_O, inside, normal_O);
+    else {
+        const int numChunks = ParallelExecutor::calcNumChunks(numSprings,
+            numThreads, MinSpringChunkSize);
+        const int chunkSize = (numSprings + numChunks-1)/numChunks;
+        FindNearestPointsTask task(other, springPos_O, chunkSize, 
+                                   nearestPoint_O, inside, normal_O);
+        subsys.getImpl().updExecutor()
+            .execute(task, (numSprings + chunkSize-1)/chunkSize);
+    }
+
     // Now loop over all the faces again, evaluate the force from each 
     // spring, and apply it at the patch centroid.
     // This costs roughly 300 flops per contacting face.
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter) 
-    {   const int   face        = *iter;
+    for (int i=0; i < numSprings; ++i) 
+    {   if (!inside[i])
+            continue;
+        const int   face        = insideFaces[i];
         const Vec3  springPos_M = mesh.findCentroid(face);
         const Real  faceArea    = areaScaleFactor*mesh.getFaceArea(face);
-
-        bool        inside;
-        UnitVec3    normal_O; // not used
-        const Vec3  nearestPoint_O = // 18 flops + cost of findNearestPoint
-            other.findNearestPoint(~X_MO*springPos_M, inside, normal_O);
-        if (!inside)
-            continue;
         
         // Although the "spring" is associated with just one surface (the mesh M)
         // it is considered here to include the compression of both surfaces
@@ -1888,7 +2258,7 @@ processOneMesh
         // i.e., in the  direction that the force will be applied to the 
         // "other" body. This is the same convention we use for the patch 
         // normal for Hertz contact.
-        const Vec3 nearestPoint_M = X_MO*nearestPoint_O; // 18 flops
+        const Vec3 nearestPoint_M = X_MO*nearestPoint_O[i]; // 18 flops
         const Vec3 overlap_M      = springPos_M - nearestPoint_M; // 3 flops
         const Real overlap        = overlap_M.norm(); // ~40 flops
 
@@ -105,6 +105,18 @@ void setIsConditional(bool isConditional) {
 
 bool isConditional() const {return constraintIsConditional;}
 
+// Whether the error and force methods may be called concurrently from
+// several threads. The built-in constraints only read the State once any
+// lazily evaluated cache entries they use have been realized; Custom
+// constraints have to say so explicitly.
+virtual bool isThreadSafe() const {return true;}
+
+// Whether the forces applied for multipliers lambda are exactly ~G*lambda, 
+// making this constraint's rows and columns of G*M^-1*~G symmetric. The 
+// built-in constraints are written that way; Custom constraints have to say
+// so explicitly.
+virtual bool hasSymmetricForceTransmission() const {return true;}
+
 typedef std::map<MobilizedBodyIndex,ConstrainedBodyIndex>       
     MobilizedBody2ConstrainedBodyMap;
 typedef std::map<MobilizedBodyIndex,ConstrainedMobilizerIndex>  
@@ -2964,6 +2976,12 @@ Custom::Implementation& updImplementation() {
     return *implementation;
 }
 
+bool isThreadSafe() const override
+{   return getImplementation().shouldBeParallelIfPossible(); }
+
+bool hasSymmetricForceTransmission() const override
+{   return getImplementation().hasSymmetricForceTransmission(); }
+
 // Forward all the virtuals to the Custom::Implementation virtuals.
 void realizeTopologyVirtual(State& s) const override {getImplementation().realizeTopology(s);}
 void realizeModelVirtual   (State& s) const override {getImplementation().realizeModel(s);}
@@ -32,6 +32,7 @@ using std::pair; using std::make_pair;
 #include <iostream>
 using std::cout; using std::endl;
 #include <set>
+#include <algorithm>
 
 using namespace SimTK;
 
@@ -67,53 +68,366 @@ static std::ostream& operator<<(std::ostream& o, const Bubble& bb) {
     return o;
 }
 
-// For spatial sorting of bubbles.
-class BubbleExtent {
+typedef std::map< pair<ContactGeometryTypeId,ContactGeometryTypeId>,
+                  pair<ContactTracker*,bool> > TrackerMap;
+
+// A map from unordered pairs of indices (bubbles or contact surfaces) to 
+// values of type T, stored in a single open-addressing hash table with linear
+// probing. The pair (i,j) is the same as (j,i). Once the table has grown to
+// its working size, insertions and removals don't allocate heap space.
+template <class T>
+class PairHashMap {
 public:
-    BubbleExtent(Real start, Real end, BubbleIndex index) 
-    :   start(start), end(end), index(index) {}
-    BubbleExtent() {}
-    bool operator<(const BubbleExtent& e) const 
-    {   return start < e.start; }
-    Real        start, end; // span along chosen sort axis
-    BubbleIndex index;
+    class Entry {
+    public:
+        int getLow()  const {return (int)(key >> 32);}
+        int getHigh() const {return (int)(key & 0xffffffffULL);}
+        bool operator<(const Entry& e) const {return key < e.key;}
+
+        unsigned long long  key; // low index in the upper 32 bits
+        T                   value;
+    };
+
+    PairHashMap() : m_size(0), m_mask(0) {}
+
+    int size() const {return m_size;}
+    bool empty() const {return m_size == 0;}
+
+    // Remove all the entries but keep the heap space.
+    void clear() {
+        for (Entry& slot : m_slots)
+            slot.key = EmptyKey;
+        m_size = 0;
+    }
+
+    // Make room for n entries without growing.
+    void reserve(int n) {
+        if (2*n > (int)m_slots.size())
+            rehash(2*n);
+    }
+
+    // Insert the pair (i,j) with the given value unless it is already present,
+    // in which case its value is left alone. Returns true if it was inserted.
+    bool insert(int i, int j, const T& value) {
+        if (2*(m_size+1) > (int)m_slots.size())
+            rehash(2*(m_size+1));
+        const unsigned long long key = makeKey(i, j);
+        unsigned slot = getHome(key);
+        for (; m_slots[slot].key != EmptyKey; slot = (slot+1) & m_mask)
+            if (m_slots[slot].key == key)
+                return false;
+        m_slots[slot].key = key;
+        m_slots[slot].value = value;
+        ++m_size;
+        return true;
+    }
+
+    // Return a pointer to the value for the pair (i,j), or null if the pair
+    // is not present.
+    const T* find(int i, int j) const {
+        if (m_size == 0)
+            return nullptr;
+        const unsigned long long key = makeKey(i, j);
+        for (unsigned slot = getHome(key); m_slots[slot].key != EmptyKey;
+             slot = (slot+1) & m_mask)
+            if (m_slots[slot].key == key)
+                return &m_slots[slot].value;
+        return nullptr;
+    }
+
+    // Remove the pair (i,j) if present. Returns true if it was present. The
+    // entries after it in its probe sequence are shifted back so that no
+    // tombstones are needed.
+    bool erase(int i, int j) {
+        if (m_size == 0)
+            return false;
+        const unsigned long long key = makeKey(i, j);
+        unsigned hole = getHome(key);
+        for (; m_slots[hole].key != key; hole = (hole+1) & m_mask)
+            if (m_slots[hole].key == EmptyKey)
+                return false;
+        for (unsigned next = (hole+1) & m_mask; m_slots[next].key != EmptyKey;
+             next = (next+1) & m_mask) {
+            // An entry can fill the hole only if its home slot is not
+            // cyclically in (hole,next].
+            const unsigned home = getHome(m_slots[next].key);
+            if (((next - home) & m_mask) >= ((next - hole) & m_mask)) {
+                m_slots[hole] = m_slots[next];
+                hole = next;
+            }
+        }
+        m_slots[hole].key = EmptyKey;
+        --m_size;
+        return true;
+    }
+
+    // Call f(entry) for every entry, in no particular order.
+    template <class F> void forEach(F f) const {
+        for (const Entry& slot : m_slots)
+            if (slot.key != EmptyKey)
+                f(slot);
+    }
+
+    // Get all the entries sorted by (low,high) index.
+    void getSortedEntries(Array_<Entry>& entries) const {
+        entries.clear();
+        entries.reserve(m_size);
+        forEach([&entries](const Entry& e) {entries.push_back(e);});
+        std::sort(entries.begin(), entries.end());
+    }
+
+private:
+    static const unsigned long long EmptyKey = ~0ULL;
+
+    static unsigned long long makeKey(int i, int j) {
+        if (i > j) std::swap(i,j);
+        return ((unsigned long long)i << 32) | (unsigned long long)j;
+    }
+    // Fibonacci hashing; the table size is a power of two.
+    unsigned getHome(unsigned long long key) const {
+        return (unsigned)((key * 0x9E3779B97F4A7C15ULL) >> 32) & m_mask;
+    }
+
+    void rehash(int minSlots) {
+        int numSlots = 16;
+        while (numSlots < minSlots) numSlots *= 2;
+        Array_<Entry> old;
+        old.swap(m_slots);
+        m_slots.resize(numSlots);
+        m_mask = numSlots-1;
+        m_size = 0;
+        clear();
+        for (const Entry& e : old)
+            if (e.key != EmptyKey)
+                insert(e.getLow(), e.getHigh(), e.value);
+    }
+
+    Array_<Entry>   m_slots;
+    int             m_size;
+    unsigned        m_mask;
 };
-static std::ostream& operator<<(std::ostream& o, const BubbleExtent& bx) {
-    o << bx.index << ":(" << bx.start << "," << bx.end << ")";
-    return o;
-}
 
-typedef std::map< pair<ContactGeometryTypeId,ContactGeometryTypeId>,
-                  pair<ContactTracker*,bool> > TrackerMap;
+// This is the candidate pair set used for the narrow phase. It maps each
+// pair of contact surfaces that might be touching to that pair's Contact 
+// object if it is currently being tracked (null if it is new). The surface
+// order in the Contact object is determined by the order required by the
+// corresponding tracker.
+typedef PairHashMap<const Contact*> SurfacePairMap;
+
+// Persistent sweep-and-prune along all three axes over a set of axis-aligned
+// boxes. The box endpoints are kept sorted along each axis and re-sorted by 
+// insertion sort whenever the boxes move, so when they have moved only a
+// little since the last update the cost is linear in the number of boxes plus
+// the number of endpoints that changed places. Each time a lower endpoint 
+// moves past an upper endpoint the two boxes start or stop overlapping along
+// that axis, and the set of boxes that overlap along all three axes is
+// updated accordingly.
+//
+// The stored boxes are enlarged by a margin and are only replaced when the
+// real box is no longer inside, so bodies that are jiggling in place (e.g.
+// resting on a floor at nearly the same height) don't cause any re-sorting.
+// The overlapping pairs are therefore a superset of the pairs whose real
+// boxes overlap.
+class SweepAndPrune {
+public:
+    // Set the number of boxes; if this changes, the next update() starts
+    // from scratch.
+    void setNumBoxes(int numBoxes) {
+        if (numBoxes != (int)m_lower.size()) {
+            m_lower.resize(numBoxes);
+            m_upper.resize(numBoxes);
+            clear();
+        }
+    }
+    int getNumBoxes() const {return (int)m_lower.size();}
+
+    // If the box [lower,upper] has moved out of the stored box, store it
+    // again enlarged by margin in every direction.
+    void setBox(int box, const Vec3& lower, const Vec3& upper, Real margin) {
+        for (int axis=0; axis < 3; ++axis)
+            if (lower[axis] < m_lower[box][axis] 
+                || upper[axis] > m_upper[box][axis]) {
+                m_lower[box] = lower - margin;
+                m_upper[box] = upper + margin;
+                return;
+            }
+    }
 
-// This type maps a contact surface onto a set of all the higher-numbered
-// contact surfaces it might be touching, and for each of those we keep
-// a pointer to that pair's Contact object if it is currently being tracked
-// (null if it is new). You must use the *lower* numbered surface as the key 
-// when inserting a pair so that any given pair of surfaces appears just once.
-// However, the surface order in the Contact object will be determined by
-// the order required by the corresponding tracker.
-// TODO: replace with a fast data structure
-typedef std::map<ContactSurfaceIndex,const Contact*> ContactSurfaceSet;
-typedef std::map<ContactSurfaceIndex,ContactSurfaceSet> PairMap;
-
-std::ostream& operator<<(std::ostream& o, const ContactSurfaceSet& css) {
-    ContactSurfaceSet::const_iterator p = css.begin();
-    o << "{";
-    for (; p != css.end(); ++p) {
-        if (p!=css.begin()) o << ", ";
-        o << p->first << ":0x" << p->second;
-    }
-    return o << "}";
-}
-
-std::ostream& operator<<(std::ostream& o, const PairMap& pm) {
-    PairMap::const_iterator p = pm.begin();
-    for (; p != pm.end(); ++p) {
-        if (p != pm.begin()) o << endl;
-        o << p->first << "->" << p->second;
+    // Forget the stored boxes, the sort order and the overlapping pairs.
+    void clear() {
+        m_lower.fill(Vec3(Infinity));
+        m_upper.fill(Vec3(-Infinity));
+        for (int axis=0; axis < 3; ++axis)
+            m_endpoints[axis].clear();
+        m_pairs.clear();
     }
-    return o;
+
+    // Bring the overlapping pairs up to date after the boxes have been set.
+    void update() {
+        if (m_endpoints[0].empty() && !m_lower.empty()) {
+            initialize();
+            return;
+        }
+        for (int axis=0; axis < 3; ++axis) {
+            Array_<Endpoint>& endpoints = m_endpoints[axis];
+            for (Endpoint& e : endpoints)
+                e.value = e.isUpper ? m_upper[e.box][axis] 
+                                    : m_lower[e.box][axis];
+            insertionSort(endpoints);
+        }
+    }
+
+    // The pairs of boxes that overlap along all three axes; the values are
+    // meaningless.
+    const PairHashMap<char>& getOverlappingPairs() const {return m_pairs;}
+
+private:
+    struct Endpoint {
+        Real value;
+        int  box;
+        bool isUpper;
+    };
+    // Boxes that just touch overlap, so lower endpoints go first in a tie.
+    static bool precedes(const Endpoint& e, const Endpoint& f) {
+        return e.value < f.value 
+            || (e.value == f.value && !e.isUpper && f.isUpper);
+    }
+
+    bool overlap(int box1, int box2) const {
+        for (int axis=0; axis < 3; ++axis)
+            if (m_lower[box1][axis] > m_upper[box2][axis] 
+                || m_lower[box2][axis] > m_upper[box1][axis])
+                return false;
+        return true;
+    }
+
+    void insertionSort(Array_<Endpoint>& endpoints) {
+        const int numEndpoints = (int)endpoints.size();
+        for (int i=1; i < numEndpoints; ++i) {
+            const Endpoint e = endpoints[i];
+            int j = i;
+            for (; j > 0 && precedes(e, endpoints[j-1]); --j) {
+                const Endpoint& f = endpoints[j-1];
+                if (!e.isUpper && f.isUpper) {
+                    // e's box now starts before f's box ends.
+                    if (overlap(e.box, f.box))
+                        m_pairs.insert(e.box, f.box, 0);
+                } else if (e.isUpper && !f.isUpper) {
+                    // e's box now ends before f's box starts.
+                    m_pairs.erase(e.box, f.box);
+                }
+                endpoints[j] = f;
+            }
+            endpoints[j] = e;
+        }
+    }
+
+    // Sort from scratch, then sweep along the x axis to find the pairs. 
+    void initialize() {
+        const int numBoxes = (int)m_lower.size();
+        for (int axis=0; axis < 3; ++axis) {
+            Array_<Endpoint>& endpoints = m_endpoints[axis];
+            endpoints.resize(2*numBoxes);
+            for (int box=0; box < numBoxes; ++box) {
+                Endpoint& lower = endpoints[2*box];
+                Endpoint& upper = endpoints[2*box+1];
+                lower.value = m_lower[box][axis]; 
+                lower.box = box; lower.isUpper = false;
+                upper.value = m_upper[box][axis]; 
+                upper.box = box; upper.isUpper = true;
+            }
+            std::sort(endpoints.begin(), endpoints.end(), precedes);
+        }
+
+        m_pairs.clear();
+        Array_<int> open; // boxes whose x extent contains the sweep point
+        Array_<int> openPosition(numBoxes, -1);
+        for (const Endpoint& e : m_endpoints[0]) {
+            if (e.isUpper) { // remove from the open list
+                const int pos = openPosition[e.box];
+                open[pos] = open.back();
+                openPosition[open[pos]] = pos;
+                open.pop_back();
+            } else {
+                for (int box : open)
+                    if (overlap(box, e.box))
+                        m_pairs.insert(box, e.box, 0);
+                openPosition[e.box] = (int)open.size();
+                open.push_back(e.box);
+            }
+        }
+    }
+
+    Array_<Vec3>        m_lower, m_upper;
+    Array_<Endpoint>    m_endpoints[3]; // sorted along each axis
+    PairHashMap<char>   m_pairs;
+};
+
+// The broad phase of one State, kept in a lazy cache entry. The cached value
+// stays put when positions change, so the sweep-and-prune is brought up to
+// date from the sort order of the previous positions realized in this State
+// (or the State it was copied from). The bubble centers are just reusable
+// scratch space.
+struct BroadPhase {
+    SweepAndPrune               sweepAndPrune;
+    Array_<Vec3,BubbleIndex>    bubbleCenters;
+};
+
+// Narrow-phase tracking costs are in units of the cost of tracking a pair of
+// spheres (roughly 100ns); see estimateTrackingCost().
+
+// Below this total cost it is cheaper to track the pairs serially than to
+// hand them to other threads.
+const Real MinParallelTrackingCost = 200;
+// Chunks of pairs are made at least this expensive so that the parallel
+// bookkeeping stays small compared to the work in each chunk.
+const Real MinTrackingChunkCost = 50;
+
+// Spheres, half spaces, bricks and cylinders are tracked in closed form.
+// Anything else involves iteration or searching a mesh, and costs anywhere
+// from a microsecond to milliseconds.
+Real estimateTrackingCost(ContactGeometryTypeId typeId1, 
+                          ContactGeometryTypeId typeId2) {
+    const auto isCheap = [](ContactGeometryTypeId typeId) {
+        return typeId == ContactGeometry::Sphere::classTypeId()
+            || typeId == ContactGeometry::HalfSpace::classTypeId()
+            || typeId == ContactGeometry::Brick::classTypeId()
+            || typeId == ContactGeometry::Cylinder::classTypeId();
+    };
+    return isCheap(typeId1) && isCheap(typeId2) ? 1 : 100;
+}
+
+// One surface pair that survived the broad phase, with the surfaces in the
+// order required by its tracker. Each pair is tracked into its own slot so
+// that pairs can be tracked in parallel and then be added to the snapshot in
+// a deterministic order.
+struct NarrowPhasePair {
+    ContactSurfaceIndex     surf1, surf2;
+    const ContactTracker*   tracker;
+    const Contact*          prev;   // null if not currently tracked
+    Real                    cost;   // see estimateTrackingCost()
+    Contact                 next;   // empty if the pair is not interesting
+};
+
+// Rays are cast in packets of this many, which is also the packet size
+// TriangleMesh::intersectsRays() uses, so each packet traces a mesh's OBB
+// tree together.
+const int RayPacketSize = 64;
+
+// Return the distance along a ray at which it enters a sphere (zero if it
+// starts inside), or Infinity if it misses. A half space's bubble has
+// infinite radius and contains every ray origin.
+Real calcBubbleEntry(const Vec3& origin, const UnitVec3& direction,
+                     const Vec3& center, Real radius) {
+    const Vec3 toCenter = center - origin;
+    const Real c = toCenter.normSqr() - radius*radius;
+    if (c <= 0)
+        return 0;
+    const Real b = ~toCenter*direction;
+    const Real disc = b*b - c;
+    if (b <= 0 || disc < 0)
+        return Infinity; // outside and heading away, or passes by
+    return b - std::sqrt(disc);
 }
 
 } // end of anonymous namespace
@@ -127,12 +441,24 @@ public:
 // Constructor registers a default set of Trackers to use with geometry
 // we know about. These can be overridden later.
 ContactTrackerSubsystemImpl() : m_defaultTracker(0) {
+    // The default number of threads is the number of processors; call
+    // setNumberOfThreads() to override it. The cost of tracking a pair 
+    // varies widely, so let idle threads steal work from busy ones.
+    m_executor = new ParallelExecutor();
+    m_executor->setScheduling(ParallelExecutor::WorkStealingScheduling);
+
     adoptContactTracker(new ContactTracker::HalfSpaceSphere());
     adoptContactTracker(new ContactTracker::SphereSphere());
     adoptContactTracker(new ContactTracker::HalfSpaceEllipsoid());
     adoptContactTracker(new ContactTracker::HalfSpaceBrick());
+    adoptContactTracker(new ContactTracker::SphereBrick());
+    adoptContactTracker(new ContactTracker::SphereCylinder());
+    adoptContactTracker(new ContactTracker::BrickBrick());
     adoptContactTracker(new ContactTracker::HalfSpaceTriangleMesh());
     adoptContactTracker(new ContactTracker::SphereTriangleMesh());
+    adoptContactTracker(new ContactTracker::SmoothHeightMapSphere());
+    adoptContactTracker(new ContactTracker::SmoothHeightMapEllipsoid());
+    adoptContactTracker(new ContactTracker::SmoothHeightMapTriangleMesh());
     adoptContactTracker(new ContactTracker::TriangleMeshTriangleMesh());
 
     // Handle sphere-ellipsoid and ellipsoid-ellipsoid by treating them as
@@ -167,6 +493,15 @@ void adoptContactTracker(ContactTracker* tracker) {
     m_contactTrackers[make_pair(low,high)] = make_pair(tracker, mustReverse);
 }
 
+void setNumberOfThreads(unsigned numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ContactTrackerSubsystemImpl",
+        "setNumberOfThreads", "Number of threads must be positive");
+    m_executor = new ParallelExecutor(numThreads,
+        ParallelExecutor::WorkStealingScheduling);
+}
+
+int getNumberOfThreads() const {return m_executor->getMaxThreads();}
+
 // Return the MultibodySystem which owns this ContactTrackerSubsystem.
 const MultibodySystem& getMultibodySystem() const 
 {   return MultibodySystem::downcast(getSystem()); }
@@ -208,6 +543,10 @@ ContactSnapshot& updNextPredictedContacts(const State& state) const {
         (updDiscreteVarUpdateValue(state, m_predictedContactsIx));
     return contacts;
 }
+BroadPhase& updBroadPhase(const State& state) const {
+    return Value<BroadPhase>::updDowncast
+        (updCacheEntry(state, m_broadPhaseIx));
+}
 
 // Run through all the bodies to find the contact surfaces, assigning each
 // a unique ContactSurfaceIndex. Then for each surface, get its geometry
@@ -231,6 +570,8 @@ int realizeSubsystemTopologyImpl(State& state) const override {
     wThis->m_mobodContactSurfaceIndex.resize(numBodies);
     wThis->m_surfaces.clear();
     wThis->m_bubbles.clear();
+    wThis->m_broadPhaseIx = allocateLazyCacheEntry
+        (state, Stage::Position, new Value<BroadPhase>());
 
     // ContactSurfaceIndex assignments are sequential within a MobilizedBody
     // so we need only record the first one in order to be able to respond
@@ -275,84 +616,59 @@ int realizeSubsystemVelocityImpl(const State& state) const override {
 }
 
 // Adds new pairs to the existing set, if not already present.
-void addInBroadPhasePairs(const State& state, PairMap& pairs) const {
+void addInBroadPhasePairs(const State& state, SurfacePairMap& pairs) const {
     const int numBubbles = getNumBubbles();
-    
-    // Perform a sweep-and-prune on a single axis to identify potential 
-    // contacts. First, find which axis has the most variation in body 
-    // locations. That is the axis we will use.
-    // TODO: this one-axis method is not good enough in general
-    
-    Vector_<Vec3> centers(numBubbles);
-    for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
-        const Bubble&  bubb = m_bubbles[bbx];
-        const Surface& surf = m_surfaces[bubb.surface];
-        centers[bbx] = surf.mobod->getBodyTransform(state) 
-                        * bubb.getCenter();
-    }
-    Vec3 average = mean(centers);
-    Vec3 var(0);
-    for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx)
-        var += abs(centers[bbx]-average);
-    int axis = (var[0] > var[1] ? 0 : 1);
-    if (var[2] > var[axis])
-        axis = 2;
-    
-    // Find the extent of each bubble along the axis and sort them by 
-    // starting location.
-    Array_<BubbleExtent,int> extents(numBubbles);
-    for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
-        const Real radius = m_bubbles[bbx].getRadius();
-        const Real center = centers[bbx][axis];
-        extents[bbx] = BubbleExtent(center-radius, center+radius, bbx);
-    }
-    //cout << "Bubble extents:" << extents << "\n";
-
-    // Expensive: O(n log n)
-    std::sort(extents.begin(), extents.end());
-    
-    // Now sweep along the axis, finding potential contacts.
-    
-    for (int ex1=0; ex1 < numBubbles; ++ex1) {
-        const BubbleExtent& extent1 = extents[ex1];
-        const Bubble&       bubb1   = m_bubbles[extent1.index];
-        const Real          radius1 = bubb1.getRadius();
-        const Vec3&         center1 = centers[extent1.index];
-
-        // Loop over just the overlapping bubbles.
-        for (int ex2(ex1+1); ex2 < numBubbles; ++ex2) {
-            const BubbleExtent& extent2 = extents[ex2];
-            if (extent2.start > extent1.end)
-                break;  // no more bubbles can overlap with extent1
-
-            // These bubbles do overlap along this axis. See if they are
-            // actually touching.
-            const Bubble& bubb2   = m_bubbles[extent2.index];
-            const Real    radius2 = bubb2.getRadius();
-            const Vec3&   center2 = centers[extent2.index];
-            if ((center1-center2).normSqr() > square(radius1+radius2))
-                continue; // nope
-
-            // The bubbles are touching. We'll add the corresponding surfaces
-            // to the narrow-phase list unless there are relevant exclusions.
-            const Surface& surf1 = m_surfaces[bubb1.surface];
-            const Surface& surf2 = m_surfaces[bubb2.surface];
-            // Ignore if on the same body.
-            if (surf1.mobod == surf2.mobod) continue;
-            assert(bubb1.surface != bubb2.surface); // duh!
-            // Ignore if surfaces are in a common clique.
-            if (surf1.surface->isInSameClique(*surf2.surface)) continue;
-            // We'll need to do a narrow phase investigation of these two
-            // surfaces; use the lower-numbered one as the index to avoid
-            // duplicates.
-            ContactSurfaceIndex low=bubb1.surface, high=bubb2.surface;
-            if (low > high) std::swap(low,high);
-            ContactSurfaceSet& surfSet = pairs[low];
-            // Insert this pair with null Contact if the pair isn't already
-            // in the PairMap.
-            surfSet.insert(make_pair(high,(Contact*)0));
+    BroadPhase& broadPhase = updBroadPhase(state);
+    SweepAndPrune& sweepAndPrune = broadPhase.sweepAndPrune;
+    Array_<Vec3,BubbleIndex>& centers = broadPhase.bubbleCenters;
+
+    // Update the State's sweep-and-prune with each bubble's bounding box in
+    // Ground, unless that has been done already for these positions. It 
+    // keeps track of the pairs of boxes that overlap. A bubble can move by a
+    // tenth of its radius before its stored box is replaced.
+    if (!isCacheValueRealized(state, m_broadPhaseIx)) {
+        centers.resize(numBubbles);
+        sweepAndPrune.setNumBoxes(numBubbles);
+        for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
+            const Bubble&  bubb = m_bubbles[bbx];
+            const Surface& surf = m_surfaces[bubb.surface];
+            const Vec3 center = surf.mobod->getBodyTransform(state)
+                                * bubb.getCenter();
+            const Vec3 radius(bubb.getRadius());
+            centers[bbx] = center;
+            sweepAndPrune.setBox(bbx, center-radius, center+radius, 
+                                 Real(0.1)*bubb.getRadius());
         }
+        sweepAndPrune.update();
+        markCacheValueRealized(state, m_broadPhaseIx);
     }
+
+    // Now see which of the bubbles with overlapping boxes are touching.
+    pairs.reserve(pairs.size() + sweepAndPrune.getOverlappingPairs().size());
+    sweepAndPrune.getOverlappingPairs().forEach(
+        [&](const PairHashMap<char>::Entry& entry) {
+        const Bubble& bubb1   = m_bubbles[BubbleIndex(entry.getLow())];
+        const Bubble& bubb2   = m_bubbles[BubbleIndex(entry.getHigh())];
+        const Vec3&   center1 = centers[BubbleIndex(entry.getLow())];
+        const Vec3&   center2 = centers[BubbleIndex(entry.getHigh())];
+        if ((center1-center2).normSqr() 
+                > square(bubb1.getRadius()+bubb2.getRadius()))
+            return; // nope
+
+        // The bubbles are touching. We'll add the corresponding surfaces
+        // to the narrow-phase list unless there are relevant exclusions.
+        const Surface& surf1 = m_surfaces[bubb1.surface];
+        const Surface& surf2 = m_surfaces[bubb2.surface];
+        // Ignore if on the same body.
+        if (surf1.mobod == surf2.mobod) return;
+        assert(bubb1.surface != bubb2.surface); // duh!
+        // Ignore if surfaces are in a common clique.
+        if (surf1.surface->isInSameClique(*surf2.surface)) return;
+        // We'll need to do a narrow phase investigation of these two
+        // surfaces. Insert this pair with null Contact if the pair isn't 
+        // already in the set.
+        pairs.insert(bubb1.surface, bubb2.surface, nullptr);
+    });
 }
 
 // Call this any time after positions are known, to ensure that the active
@@ -384,98 +700,316 @@ void ensureActiveContactsUpdated(const State& state) const {
     // TODO: Can we reuse heap space in this cache entry?
     nextActive.clear();
 
-    PairMap interesting;
+    SurfacePairMap interesting;
+    interesting.reserve(active.getNumContacts()+predicted.getNumContacts());
     for (int i=0; i < active.getNumContacts(); ++i) {
         const Contact& contact = active.getContact(i);
-        ContactSurfaceIndex low=contact.getSurface1(), 
-                            high=contact.getSurface2();
-        if (low > high) std::swap(low,high);
-        ContactSurfaceSet& others = interesting[low];
-        assert(others.find(high)==others.end());
-        others[high] = &contact;
+        assert(!interesting.find(contact.getSurface1(),contact.getSurface2()));
+        interesting.insert(contact.getSurface1(), contact.getSurface2(), 
+                           &contact);
     }
     for (int i=0; i < predicted.getNumContacts(); ++i) {
         const Contact& contact = predicted.getContact(i);
-        ContactSurfaceIndex low=contact.getSurface1(), 
-                            high=contact.getSurface2();
-        if (low > high) std::swap(low,high);
-        ContactSurfaceSet& others = interesting[low];
-        assert(others.find(high)==others.end());
-        others[high] = &contact;
+        assert(!interesting.find(contact.getSurface1(),contact.getSurface2()));
+        interesting.insert(contact.getSurface1(), contact.getSurface2(), 
+                           &contact);
     }
     // This will ignore pairs that we already inserted above; new ones
     // will be inserted with null Contact object pointers.
     addInBroadPhasePairs(state, interesting);
-    //cout << "Interesting pairs:\n" << interesting << "\n";
-
-    PairMap::const_iterator p = interesting.begin();
-    for (; p != interesting.end(); ++p) {
-        const ContactSurfaceIndex index1 = p->first;
-        const Transform transform1 = 
-            m_surfaces[index1].mobod->getBodyTransform(state)
-                * m_surfaces[index1].X_BS;
-        const ContactGeometry& geom1 = m_surfaces[index1].surface->getShape();
-        const ContactGeometryTypeId typeId1 = geom1.getTypeId();
-
-        const ContactSurfaceSet& others = p->second;
-        ContactSurfaceSet::const_iterator q = others.begin();
-        for (; q != others.end(); ++q) {
-            const ContactSurfaceIndex index2 = q->first;
-            const Transform transform2 = 
-                m_surfaces[index2].mobod->getBodyTransform(state)
-                    * m_surfaces[index2].X_BS;
-            const ContactGeometry& geom2 = 
-                m_surfaces[index2].surface->getShape();
-            const ContactGeometryTypeId typeId2 = geom2.getTypeId();
-            if (!hasContactTracker(typeId1,typeId2))
-                continue; // No algorithm available for detecting collisions between these two objects.
-            bool mustReverse;
-            const ContactTracker& tracker = 
-                getContactTracker(typeId1, typeId2, mustReverse);
-
-            // Put the surfaces in the order required by the tracker.
-            const ContactSurfaceIndex trackSurf1 = (mustReverse? index2:index1);
-            const ContactSurfaceIndex trackSurf2 = (mustReverse? index1:index2);
-
-            UntrackedContact untracked; // empty handle in case we need it
-            const Contact* prev = q->second;
-            if (prev && prev->getCondition() == Contact::Broken)
-                prev = 0; // that contact expired
-            if (!prev) { 
-                untracked = UntrackedContact(trackSurf1, trackSurf2);
-                prev = &untracked;
-            }
-            Contact next; // empty handle
-            if (mustReverse)
-                tracker.trackContact
-                   (*prev, transform2,geom2, transform1,geom1, 0/*TODO*/, next);
-            else
-                tracker.trackContact
-                   (*prev, transform1,geom1, transform2,geom2, 0/*TODO*/, next);
-
-            if (!next.isEmpty()) {
-                next.setSurfaces(trackSurf1,trackSurf2);
-                next.setContactId(prev->getCondition()==Contact::Untracked
-                                    ? Contact::createNewContactId()
-                                    : prev->getContactId()); // persistent
-                if (   prev->getCondition()==Contact::Untracked
-                    || prev->getCondition()==Contact::Anticipated)
-                    next.setCondition(Contact::NewContact);
-                else { // was NewContact or Ongoing; now Ongoing or Broken
-                    assert(prev->getCondition()==Contact::NewContact
-                           || prev->getCondition()==Contact::Ongoing);
-                    if (next.getTypeId() != BrokenContact::classTypeId())
-                        next.setCondition(Contact::Ongoing);
-                    // Condition will already by Broken for a BrokenContact
-                }
-                nextActive.adoptContact(next);
-            }
+
+    // Track the pairs in order of surface index so that the contacts come
+    // out in the same order regardless of the history of the hash table.
+    Array_<SurfacePairMap::Entry> entries;
+    interesting.getSortedEntries(entries);
+    Array_<NarrowPhasePair> pairs;
+    pairs.reserve(entries.size());
+    for (const SurfacePairMap::Entry& p : entries) {
+        const ContactSurfaceIndex index1(p.getLow()), index2(p.getHigh());
+        const ContactGeometryTypeId typeId1 = 
+            m_surfaces[index1].surface->getShape().getTypeId();
+        const ContactGeometryTypeId typeId2 = 
+            m_surfaces[index2].surface->getShape().getTypeId();
+        if (!hasContactTracker(typeId1,typeId2))
+            continue; // No algorithm available for detecting collisions between these two objects.
+        bool mustReverse;
+        const ContactTracker& tracker = 
+            getContactTracker(typeId1, typeId2, mustReverse);
+
+        // Put the surfaces in the order required by the tracker.
+        NarrowPhasePair pair;
+        pair.surf1   = (mustReverse? index2:index1);
+        pair.surf2   = (mustReverse? index1:index2);
+        pair.tracker = &tracker;
+        pair.prev    = p.value;
+        if (pair.prev && pair.prev->getCondition() == Contact::Broken)
+            pair.prev = 0; // that contact expired
+        pair.cost    = estimateTrackingCost(typeId1, typeId2);
+        pairs.push_back(pair);
+    }
+
+    trackPairs(state, pairs);
+
+    // New ContactIds are handed out here, in pair order, so they don't
+    // depend on the order in which the pairs were tracked.
+    for (NarrowPhasePair& pair : pairs) {
+        Contact& next = pair.next;
+        if (next.isEmpty())
+            continue;
+        const bool wasUntracked = 
+            !pair.prev || pair.prev->getCondition()==Contact::Untracked;
+        next.setSurfaces(pair.surf1,pair.surf2);
+        next.setContactId(wasUntracked
+                            ? Contact::createNewContactId()
+                            : pair.prev->getContactId()); // persistent
+        if (   wasUntracked
+            || pair.prev->getCondition()==Contact::Anticipated)
+            next.setCondition(Contact::NewContact);
+        else { // was NewContact or Ongoing; now Ongoing or Broken
+            assert(pair.prev->getCondition()==Contact::NewContact
+                   || pair.prev->getCondition()==Contact::Ongoing);
+            if (next.getTypeId() != BrokenContact::classTypeId())
+                next.setCondition(Contact::Ongoing);
+            // Condition will already by Broken for a BrokenContact
         }
+        nextActive.adoptContact(next);
     }
 
     markDiscreteVarUpdateValueRealized(state, m_activeContactsIx);
 }
 
+// Run the pair's tracker, writing only to the pair's own slot.
+void trackPair(const State& state, NarrowPhasePair& pair) const {
+    const Surface& surf1 = m_surfaces[pair.surf1];
+    const Surface& surf2 = m_surfaces[pair.surf2];
+    const Transform transform1 = 
+        surf1.mobod->getBodyTransform(state) * surf1.X_BS;
+    const Transform transform2 = 
+        surf2.mobod->getBodyTransform(state) * surf2.X_BS;
+
+    UntrackedContact untracked; // empty handle in case we need it
+    const Contact* prev = pair.prev;
+    if (!prev) { 
+        untracked = UntrackedContact(pair.surf1, pair.surf2);
+        prev = &untracked;
+    }
+    pair.tracker->trackContact
+       (*prev, transform1,surf1.surface->getShape(), 
+               transform2,surf2.surface->getShape(), 0/*TODO*/, pair.next);
+}
+
+// This tracks a contiguous chunk of the pairs.
+class TrackPairsTask : public ParallelExecutor::Task {
+public:
+    TrackPairsTask(const ContactTrackerSubsystemImpl& impl, 
+                   const State& state, Array_<NarrowPhasePair>& pairs,
+                   const Array_<int>& chunkStarts)
+    :   m_impl(impl), m_state(state), m_pairs(pairs), 
+        m_chunkStarts(chunkStarts) {}
+
+    void execute(int chunk) override {
+        for (int i=m_chunkStarts[chunk]; i < m_chunkStarts[chunk+1]; ++i)
+            m_impl.trackPair(m_state, m_pairs[i]);
+    }
+private:
+    const ContactTrackerSubsystemImpl&  m_impl;
+    const State&                        m_state;
+    Array_<NarrowPhasePair>&            m_pairs;
+    const Array_<int>&                  m_chunkStarts;
+};
+
+// Track all the pairs, in parallel if there is enough work and every tracker
+// involved allows it. The pairs are divided into contiguous chunks of similar
+// estimated cost.
+void trackPairs(const State& state, Array_<NarrowPhasePair>& pairs) const {
+    const int numPairs = (int)pairs.size();
+    const int numThreads = std::min(getNumberOfThreads(),
+                                    ParallelExecutor::getNumSharedThreads());
+    Real totalCost = 0;
+    bool canBeParallel = true;
+    for (const NarrowPhasePair& pair : pairs) {
+        totalCost += pair.cost;
+        canBeParallel &= pair.tracker->shouldBeParallelIfPossible();
+    }
+    if (numThreads == 1 || totalCost < MinParallelTrackingCost 
+        || !canBeParallel) {
+        for (NarrowPhasePair& pair : pairs)
+            trackPair(state, pair);
+        return;
+    }
+
+    Array_<int> chunkStarts(1, 0);
+    ParallelExecutor::appendChunksByCost(numPairs, 
+        [&](int i) {return pairs[i].cost;},
+        ParallelExecutor::calcTargetChunkCost(totalCost, numThreads,
+                                              MinTrackingChunkCost),
+        chunkStarts);
+
+    TrackPairsTask task(*this, state, pairs, chunkStarts);
+    m_executor->execute(task, (int)chunkStarts.size()-1);
+}
+
+// Cast one packet of rays, given every surface's pose and bubble center in
+// Ground. The surfaces are visited in order of the packet's nearest entry
+// into their bubbles; a surface is examined only for the rays that enter its
+// bubble before their current hit.
+void castRayPacket(const Vec3* origins, const UnitVec3* directions, int n,
+                   const Array_<Transform,ContactSurfaceIndex>& X_GS,
+                   const Array_<Vec3,BubbleIndex>& centers,
+                   ContactTrackerSubsystem::RayHit* hits) const {
+    Array_<pair<Real,BubbleIndex> > candidates;
+    for (BubbleIndex bbx(0); bbx < getNumBubbles(); ++bbx) {
+        const Real radius = m_bubbles[bbx].getRadius();
+        Real nearest = Infinity;
+        for (int i=0; i < n; ++i) {
+            const Real entry = calcBubbleEntry(origins[i], directions[i],
+                                               centers[bbx], radius);
+            if (entry <= hits[i].distance)
+                nearest = std::min(nearest, entry);
+        }
+        if (nearest < Infinity)
+            candidates.push_back(make_pair(nearest, bbx));
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    Vec3     origins_S[RayPacketSize];
+    UnitVec3 directions_S[RayPacketSize];
+    Real     distances[RayPacketSize];
+    int      faces[RayPacketSize], rays[RayPacketSize];
+    Vec2     uvs[RayPacketSize];
+    for (const pair<Real,BubbleIndex>& candidate : candidates) {
+        const Bubble& bubble = m_bubbles[candidate.second];
+        const ContactSurfaceIndex surfx = bubble.surface;
+        const ContactGeometry& geo = m_surfaces[surfx].surface->getShape();
+        if (ContactGeometry::Torus::isInstance(geo))
+            continue; // Torus doesn't implement intersectsRay()
+        const Transform& X_GSurf = X_GS[surfx];
+
+        int numRays = 0;
+        for (int i=0; i < n; ++i) {
+            if (calcBubbleEntry(origins[i], directions[i],
+                    centers[candidate.second], bubble.getRadius())
+                > hits[i].distance)
+                continue;
+            rays[numRays] = i;
+            origins_S[numRays] = ~X_GSurf*origins[i];
+            directions_S[numRays] = ~X_GSurf.R()*directions[i];
+            distances[numRays] = hits[i].distance;
+            ++numRays;
+        }
+
+        if (ContactGeometry::TriangleMesh::isInstance(geo)) {
+            const ContactGeometry::TriangleMesh& mesh =
+                ContactGeometry::TriangleMesh::getAs(geo);
+            for (int k=0; k < numRays; ++k)
+                faces[k] = -1;
+            mesh.intersectsRays(
+                ArrayViewConst_<Vec3>(origins_S, origins_S+numRays),
+                ArrayViewConst_<UnitVec3>(directions_S, directions_S+numRays),
+                ArrayView_<Real>(distances, distances+numRays),
+                ArrayView_<int>(faces, faces+numRays),
+                ArrayView_<Vec2>(uvs, uvs+numRays));
+            for (int k=0; k < numRays; ++k) {
+                if (faces[k] < 0)
+                    continue;
+                ContactTrackerSubsystem::RayHit& hit = hits[rays[k]];
+                hit.surface  = surfx;
+                hit.distance = distances[k];
+                hit.normal   = X_GSurf.R()*mesh.findNormalAtPoint(faces[k],
+                                                                  uvs[k]);
+                hit.face     = faces[k];
+            }
+            continue;
+        }
+
+        for (int k=0; k < numRays; ++k) {
+            Real distance; UnitVec3 normal;
+            if (!geo.intersectsRay(origins_S[k], directions_S[k],
+                                   distance, normal)
+                || !(distance <= distances[k]))
+                continue;
+            ContactTrackerSubsystem::RayHit& hit = hits[rays[k]];
+            hit.surface  = surfx;
+            hit.distance = distance;
+            hit.normal   = X_GSurf.R()*normal;
+            hit.face     = -1;
+        }
+    }
+}
+
+// This casts a contiguous range of ray packets.
+class CastRaysTask : public ParallelExecutor::Task {
+public:
+    CastRaysTask(const ContactTrackerSubsystemImpl& impl,
+                 const ArrayViewConst_<Vec3>& origins,
+                 const ArrayViewConst_<UnitVec3>& directions,
+                 const Array_<Transform,ContactSurfaceIndex>& X_GS,
+                 const Array_<Vec3,BubbleIndex>& centers,
+                 Array_<ContactTrackerSubsystem::RayHit>& hits)
+    :   m_impl(impl), m_origins(origins), m_directions(directions),
+        m_X_GS(X_GS), m_centers(centers), m_hits(hits) {}
+
+    void execute(int packet) override {
+        const int start = packet*RayPacketSize;
+        const int n = std::min(RayPacketSize, (int)m_origins.size()-start);
+        m_impl.castRayPacket(&m_origins[start], &m_directions[start], n,
+                             m_X_GS, m_centers, &m_hits[start]);
+    }
+private:
+    const ContactTrackerSubsystemImpl&              m_impl;
+    const ArrayViewConst_<Vec3>&                    m_origins;
+    const ArrayViewConst_<UnitVec3>&                m_directions;
+    const Array_<Transform,ContactSurfaceIndex>&    m_X_GS;
+    const Array_<Vec3,BubbleIndex>&                 m_centers;
+    Array_<ContactTrackerSubsystem::RayHit>&        m_hits;
+};
+
+void castRays(const State& state, const ArrayViewConst_<Vec3>& origins,
+              const ArrayViewConst_<UnitVec3>& directions, Real maxDistance,
+              Array_<ContactTrackerSubsystem::RayHit>& hits) const {
+    SimTK_APIARGCHECK2_ALWAYS(origins.size() == directions.size(),
+        "ContactTrackerSubsystem", "castRays",
+        "There are %d ray origins but %d directions.",
+        (int)origins.size(), (int)directions.size());
+    const int numRays = (int)origins.size();
+    hits.clear();
+    hits.resize(numRays);
+    if (numRays == 0)
+        return;
+    for (ContactTrackerSubsystem::RayHit& hit : hits)
+        hit.distance = maxDistance;
+
+    // Put the surfaces and their bubbles in Ground once for all the rays.
+    Array_<Transform,ContactSurfaceIndex> X_GS(getNumSurfaces());
+    for (ContactSurfaceIndex surfx(0); surfx < getNumSurfaces(); ++surfx) {
+        const Surface& surf = m_surfaces[surfx];
+        X_GS[surfx] = surf.mobod->getBodyTransform(state)*surf.X_BS;
+    }
+    Array_<Vec3,BubbleIndex> centers(getNumBubbles());
+    for (BubbleIndex bbx(0); bbx < getNumBubbles(); ++bbx) {
+        const Bubble& bubb = m_bubbles[bbx];
+        centers[bbx] = m_surfaces[bubb.surface].mobod->getBodyTransform(state)
+                       * bubb.getCenter();
+    }
+
+    const int numPackets = (numRays + RayPacketSize - 1)/RayPacketSize;
+    const int numThreads = std::min(getNumberOfThreads(),
+                                    ParallelExecutor::getNumSharedThreads());
+    if (numThreads == 1 || numPackets == 1) {
+        for (int start=0; start < numRays; start += RayPacketSize)
+            castRayPacket(&origins[start], &directions[start],
+                          std::min(RayPacketSize, numRays-start),
+                          X_GS, centers, &hits[start]);
+    } else {
+        CastRaysTask task(*this, origins, directions, X_GS, centers, hits);
+        m_executor->execute(task, numPackets);
+    }
+
+    for (ContactTrackerSubsystem::RayHit& hit : hits)
+        if (!hit.isHit())
+            hit.distance = Infinity;
+}
+
 // Call this any time after accelerations are known, to ensure that the
 // predicted contact set has been updated for new velocities and accelerations.
 // We can use three sources of information to compute the update:
@@ -591,6 +1125,10 @@ Array_<Surface,ContactSurfaceIndex>     m_surfaces;
 Array_<Bubble,BubbleIndex>              m_bubbles;
 DiscreteVariableIndex                   m_activeContactsIx;
 DiscreteVariableIndex                   m_predictedContactsIx;
+CacheEntryIndex                         m_broadPhaseIx;
+
+    // NARROW PHASE
+mutable ClonePtr<ParallelExecutor>      m_executor;
 };
 
 } // namespace SimTK
@@ -658,6 +1196,18 @@ void ContactTrackerSubsystem::
 adoptContactTracker(ContactTracker* tracker)
 {   updImpl().adoptContactTracker(tracker); }
 
+void ContactTrackerSubsystem::setNumberOfThreads(unsigned numThreads)
+{   updImpl().setNumberOfThreads(numThreads); }
+
+int ContactTrackerSubsystem::getNumberOfThreads() const
+{   return getImpl().getNumberOfThreads(); }
+
+void ContactTrackerSubsystem::
+castRays(const State& state, const ArrayViewConst_<Vec3>& origins,
+         const ArrayViewConst_<UnitVec3>& directions, Real maxDistance,
+         Array_<RayHit>& hits) const
+{   getImpl().castRays(state, origins, directions, maxDistance, hits); }
+
 bool ContactTrackerSubsystem::
 hasContactTracker(ContactGeometryTypeId surface1, 
                   ContactGeometryTypeId surface2) const
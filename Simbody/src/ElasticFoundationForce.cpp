@@ -27,8 +27,6 @@
 #include "simbody/internal/GeneralContactSubsystem.h"
 #include "simbody/internal/MobilizedBody.h"
 #include "ElasticFoundationForceImpl.h"
-#include <map>
-#include <set>
 
 namespace SimTK {
 
@@ -67,6 +65,8 @@ void ElasticFoundationForceImpl::setBodyParameters
                         == ContactGeometry::TriangleMesh::classTypeId(), 
         "ElasticFoundationForceImpl", "setBodyParameters",
         "Body %d is not a triangle mesh", (int)bodyIndex);
+    if (bodyIndex >= parameters.size())
+        parameters.resize(bodyIndex+1);
     parameters[bodyIndex] = 
         Parameters(stiffness, dissipation, staticFriction, dynamicFriction, 
                    viscousFriction);
@@ -89,6 +89,12 @@ void ElasticFoundationForceImpl::setBodyParameters
     subsystem.invalidateSubsystemTopologyCache();
 }
 
+const ElasticFoundationForceImpl::Parameters* 
+ElasticFoundationForceImpl::findParameters(ContactSurfaceIndex surface) const {
+    return surface < parameters.size() && parameters[surface].isSet()
+           ? &parameters[surface] : nullptr;
+}
+
 void ElasticFoundationForceImpl::calcForce
    (const State& state, Vector_<SpatialVec>& bodyForces, 
     Vector_<Vec3>& particleForces, Vector& mobilityForces) const 
@@ -97,30 +103,30 @@ void ElasticFoundationForceImpl::calcForce
     Real& pe = Value<Real>::updDowncast
                 (subsystem.updCacheEntry(state, energyCacheIndex));
     pe = 0.0;
+    SpringQueries queries;
     for (int i = 0; i < (int) contacts.size(); i++) {
-        std::map<ContactSurfaceIndex, Parameters>::const_iterator iter1 = 
-            parameters.find(contacts[i].getSurface1());
-        std::map<ContactSurfaceIndex, Parameters>::const_iterator iter2 = 
-            parameters.find(contacts[i].getSurface2());
+        const Parameters* param1 = findParameters(contacts[i].getSurface1());
+        const Parameters* param2 = findParameters(contacts[i].getSurface2());
 
         // If there are two meshes, scale each one's contributions by 50%.
-        Real areaScale = (iter1==parameters.end() || iter2==parameters.end())
-                         ? Real(1) : Real(0.5);
+        Real areaScale = (!param1 || !param2) ? Real(1) : Real(0.5);
 
-        if (iter1 != parameters.end()) {
+        if (param1) {
             const TriangleMeshContact& contact = 
                 static_cast<const TriangleMeshContact&>(contacts[i]);
             processContact(state, contact.getSurface1(), 
-                contact.getSurface2(), iter1->second, 
-                contact.getSurface1Faces(), areaScale, bodyForces, pe);
+                contact.getSurface2(), *param1, 
+                contact.getSurface1FaceIndices(), areaScale, queries, 
+                bodyForces, pe);
         }
 
-        if (iter2 != parameters.end()) {
+        if (param2) {
             const TriangleMeshContact& contact = 
                 static_cast<const TriangleMeshContact&>(contacts[i]);
             processContact(state, contact.getSurface2(), 
-                contact.getSurface1(), iter2->second, 
-                contact.getSurface2Faces(), areaScale, bodyForces, pe);
+                contact.getSurface1(), *param2, 
+                contact.getSurface2FaceIndices(), areaScale, queries, 
+                bodyForces, pe);
         }
     }
 }
@@ -128,8 +134,9 @@ void ElasticFoundationForceImpl::calcForce
 void ElasticFoundationForceImpl::processContact
    (const State& state, 
     ContactSurfaceIndex meshIndex, ContactSurfaceIndex otherBodyIndex, 
-    const Parameters& param, const std::set<int>& insideFaces,
-    Real areaScale, Vector_<SpatialVec>& bodyForces, Real& pe) const 
+    const Parameters& param, const Array_<int>& insideFaces,
+    Real areaScale, SpringQueries& queries, 
+    Vector_<SpatialVec>& bodyForces, Real& pe) const 
 {
     const ContactGeometry& otherObject = subsystem.getBodyGeometry(set, otherBodyIndex);
     const MobilizedBody& body1 = subsystem.getBody(set, meshIndex);
@@ -138,20 +145,29 @@ void ElasticFoundationForceImpl::processContact
     const Transform t2g = body2.getBodyTransform(state)*subsystem.getBodyTransform(set, otherBodyIndex); // other object to ground
     const Transform t12 = ~t2g*t1g; // mesh to other object
 
+    // Find where all the springs touch the other object in one batch, since
+    // neighboring springs are likely to touch nearby parts of it.
+
+    const int numSprings = (int) insideFaces.size();
+    queries.positions.resize(numSprings);
+    queries.nearestPoints.resize(numSprings);
+    queries.inside.resize(numSprings);
+    queries.normals.resize(numSprings);
+    for (int i = 0; i < numSprings; i++)
+        queries.positions[i] = t12*param.springPosition[insideFaces[i]];
+    otherObject.findNearestPoints(queries.positions, queries.nearestPoints, 
+                                  queries.inside, queries.normals);
+
     // Loop over all the springs, and evaluate the force from each one.
 
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter) {
-        int face = *iter;
-        UnitVec3 normal;
-        bool inside;
-        Vec3 nearestPoint = otherObject.findNearestPoint(t12*param.springPosition[face], inside, normal);
-        if (!inside)
+    for (int i = 0; i < numSprings; i++) {
+        if (!queries.inside[i])
             continue;
+        const int face = insideFaces[i];
         
         // Find how much the spring is displaced.
         
-        nearestPoint = t2g*nearestPoint;
+        const Vec3 nearestPoint = t2g*queries.nearestPoints[i];
         const Vec3 springPosInGround = t1g*param.springPosition[face];
         const Vec3 displacement = nearestPoint-springPosInGround;
         const Real distance = displacement.norm();
@@ -46,17 +46,28 @@ public:
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
     void realizeTopology(State& state) const override;
+    // Scratch space for the nearest point queries of one contact, reused from
+    // one contact to the next within a single force calculation.
+    struct SpringQueries {
+        Array_<Vec3>        positions, nearestPoints;
+        Array_<bool>        inside;
+        Array_<UnitVec3>    normals;
+    };
     void processContact(const State& state, ContactSurfaceIndex meshIndex, 
                         ContactSurfaceIndex otherBodyIndex, 
                         const Parameters& param, 
-                        const std::set<int>& insideFaces,
-                        Real areaScale,
+                        const Array_<int>& insideFaces,
+                        Real areaScale, SpringQueries& queries,
                         Vector_<SpatialVec>& bodyForces, Real& pe) const;
 private:
     friend class ElasticFoundationForce;
+    // Return the parameters of the given surface, or null if 
+    // setBodyParameters() has not been called for it.
+    const Parameters* findParameters(ContactSurfaceIndex surface) const;
     const GeneralContactSubsystem& subsystem;
     const ContactSetIndex set;
-    std::map<ContactSurfaceIndex, Parameters> parameters;
+    // Indexed by surface; only the meshes with parameters have springs.
+    Array_<Parameters, ContactSurfaceIndex> parameters;
     Real transitionVelocity;
     mutable CacheEntryIndex energyCacheIndex;
 };
@@ -68,6 +79,7 @@ public:
     Parameters(Real stiffness, Real dissipation, Real staticFriction, Real dynamicFriction, Real viscousFriction) :
             stiffness(stiffness), dissipation(dissipation), staticFriction(staticFriction), dynamicFriction(dynamicFriction), viscousFriction(viscousFriction) {
     }
+    bool isSet() const {return !springPosition.empty();}
     Real stiffness, dissipation, staticFriction, dynamicFriction, viscousFriction;
     Array_<Vec3> springPosition;
     Array_<UnitVec3> springNormal;
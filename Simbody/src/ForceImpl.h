@@ -49,8 +49,15 @@ public:
     virtual bool dependsOnlyOnPositions() const {
         return false;
     }
-    virtual bool shouldBeParallelIfPossible() const{
-        return false;
+    // A force whose calcForce() only reads the State (and its own cache
+    // entries) and adds into the given arrays can be calculated concurrently
+    // with other forces. Such a force returns a rough estimate of the cost of
+    // calcForce(), in units of the cost of a TwoPointLinearSpring, which
+    // GeneralForceSubsystem uses to group the forces into parallel chunks of
+    // similar cost. Forces that return zero (the default) are calculated one
+    // after another on a single thread.
+    virtual Real getParallelEvaluationCost() const {
+        return 0;
     }
     ForceIndex getForceIndex() const {return index;}
     const GeneralForceSubsystem& getForceSubsystem() const 
@@ -116,6 +123,7 @@ public:
     TwoPointLinearSpringImpl* clone() const override {
         return new TwoPointLinearSpringImpl(*this);
     }
+    Real getParallelEvaluationCost() const override {return 1;}
     bool dependsOnlyOnPositions() const override {
         return true;
     }
@@ -147,6 +155,7 @@ public:
     TwoPointLinearDamperImpl* clone() const override {
         return new TwoPointLinearDamperImpl(*this);
     }
+    Real getParallelEvaluationCost() const override {return 1;}
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
 private:
@@ -167,6 +176,7 @@ public:
     TwoPointConstantForceImpl* clone() const override {
         return new TwoPointConstantForceImpl(*this);
     }
+    Real getParallelEvaluationCost() const override {return 1;}
     bool dependsOnlyOnPositions() const override {
         return true;
     }
@@ -203,6 +213,7 @@ friend class MobilityLinearSpring;
 
     MobilityLinearSpringImpl* clone() const override
     {   return new MobilityLinearSpringImpl(*this); }
+    Real getParallelEvaluationCost() const override {return 1;}
     bool dependsOnlyOnPositions() const override {return true;}
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, 
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
@@ -253,6 +264,7 @@ friend class MobilityLinearDamper;
 
     MobilityLinearDamperImpl* clone() const override 
     {   return new MobilityLinearDamperImpl(*this); }
+    Real getParallelEvaluationCost() const override {return 1;}
 
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, 
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
@@ -305,6 +317,7 @@ friend class MobilityConstantForce;
 
     MobilityConstantForceImpl* clone() const override 
     {   return new MobilityConstantForceImpl(*this); }
+    Real getParallelEvaluationCost() const override {return 1;}
 
     // Has to wait for Dynamics stage because that's all that gets invalidated
     // if the constant force is changed.
@@ -365,6 +378,7 @@ friend class MobilityLinearStop;
     // Implementation of virtual methods from ForceImpl:
     MobilityLinearStopImpl* clone() const override 
     {   return new MobilityLinearStopImpl(*this); }
+    Real getParallelEvaluationCost() const override {return 1;}
     bool dependsOnlyOnPositions() const override {return false;}
 
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
@@ -440,6 +454,7 @@ public:
 
     MobilityDiscreteForceImpl* clone() const override 
     {   return new MobilityDiscreteForceImpl(*this); }
+    Real getParallelEvaluationCost() const override {return 1;}
 
     // Force this to wait for Dynamics stage before calculating, because that's
     // all that gets invalidated when a new forces is applied.
@@ -515,6 +530,7 @@ public:
     ConstantForceImpl* clone() const override {
         return new ConstantForceImpl(*this);
     }
+    Real getParallelEvaluationCost() const override {return 1;}
     bool dependsOnlyOnPositions() const override {
         return true;
     }
@@ -537,6 +553,7 @@ public:
     ConstantTorqueImpl* clone() const override {
         return new ConstantTorqueImpl(*this);
     }
+    Real getParallelEvaluationCost() const override {return 1;}
     bool dependsOnlyOnPositions() const override {
         return true;
     }
@@ -617,8 +634,9 @@ public:
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) 
                    const override;
     Real calcPotentialEnergy(const State& state) const override;
-    bool shouldBeParallelIfPossible() const override {
-        return implementation->shouldBeParallelIfPossible();
+    Real getParallelEvaluationCost() const override {
+        return implementation->shouldBeParallelIfPossible()
+            ? implementation->getEvaluationCost() : 0;
     }
     ~CustomImpl() {
         delete implementation;
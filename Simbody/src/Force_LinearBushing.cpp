@@ -65,6 +65,9 @@ public:
     LinearBushingImpl* clone() const override {
         return new LinearBushingImpl(*this);
     }
+    // Touches only this bushing's own cache entries, so it can run
+    // concurrently with other forces.
+    Real getParallelEvaluationCost() const override {return 4;}
     bool dependsOnlyOnPositions() const override {
         return false;
     }
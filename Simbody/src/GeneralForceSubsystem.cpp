@@ -40,480 +40,134 @@
 #include "ForceImpl.h"
 
 #include <memory>
+#include <typeinfo>
 
-//Threading constants used by CalcForcesTask
+//Constants used to divide the forces into chunks for parallel evaluation. Costs
+//are in units of the cost of a TwoPointLinearSpring (roughly 50-100ns); see
+//ForceImpl::getParallelEvaluationCost().
 namespace {
 using namespace SimTK;
 
-const int NumNonParallelThreads = 1;
-const int NonParallelForcesIndex = 0;
-
-/* Base class for CalcForcesParallelTask and CalcForcesNonParallelTask - lays 
-out common methods that will be implemented to suit the parallel/non-parallel
-use cases*/
-class CalcForcesTask : public ParallelExecutor::Task {
-public:
-    CalcForcesTask() = default;
-    
-    virtual CalcForcesTask* clone() const = 0;
-    
-    virtual void initializeAll(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces) = 0;
-    virtual void initializeCachedAndNonCached(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces,
-            Vector_<SpatialVec>& rigidBodyForceCache,
-            Vector_<Vec3>& particleForceCache,
-            Vector& mobilityForceCache) = 0;
-    virtual void initializeNonCached(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces) = 0;
-    
+// Below this total cost it is cheaper to calculate the forces serially than
+// to hand them to other threads.
+const Real MinParallelCost = 200;
+// Chunks are made at least this expensive so that the parallel bookkeeping
+// stays small compared to the work in each chunk.
+const Real MinChunkCost = 50;
+
+/* The enabled forces in the order in which they are calculated, divided into
+chunks that are the indices of the parallel reduction. The forces that can't be
+calculated concurrently with other forces come first and always form a single
+chunk of their own; the rest are split into chunks of similar total cost.
+Chunk c is forces[chunkStarts[c]] through forces[chunkStarts[c+1]-1]. The
+order is set when Instance stage is realized; the chunks are (re)computed when
+they are first needed, and whenever the number of threads or the summation
+mode changes.*/
+struct ForceChunks {
+    ForceChunks() : numSerialForces(0), numThreads(0), deterministic(false) {}
+
+    Array_<ForceIndex>  forces;
+    int                 numSerialForces;
+    Array_<Real>        costs;  // parallel evaluation cost of each force
+
+    int                 numThreads; // 0 if chunkStarts is out of date
+    bool                deterministic;
+    Array_<int>         chunkStarts;
+
+    int getNumChunks() const {return (int)chunkStarts.size() - 1;}
 };
-/*Calculates each enabled force's contribution in the MultibodySystem.
-CalcForcesParallelTask allows force calculations to occur in parallel with
-non-parallel forces being calculated on Thread NonParallelForcesIndex and all
-other parallel forces being calculated on separate threads.*/
 
-//Implementation of CalcForcesTask for parallel forces
-class CalcForcesParallelTask : public CalcForcesTask {
-public:
-    //The different categories of force calculations that GeneralForceSubsystem
-    //chooses between
-    enum Mode {
-        All,
-        CachedAndNonCached,
-        NonCached
-    };
-    
-    CalcForcesParallelTask* clone() const override {
-        return new CalcForcesParallelTask();
-    }
-    // Each different force calculation Mode requires different parameters
-    //
-    // Note: Execute MUST be called directly after CalcForceTask is initialized
-    void initializeAll(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces) override
-    {
-        m_forces = &forces;
-        m_state = &s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
-        m_rigidBodyForces = &rigidBodyForces;
-        m_particleForces = &particleForces;
-        m_mobilityForces = &mobilityForces;
-        
-        m_mode = All;
-    }
-    void initializeCachedAndNonCached(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces,
-            Vector_<SpatialVec>& rigidBodyForceCache,
-            Vector_<Vec3>& particleForceCache,
-            Vector& mobilityForceCache) override
-    {
-        m_forces = &forces;
-        m_state = s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
-        m_rigidBodyForces = &rigidBodyForces;
-        m_particleForces = &particleForces;
-        m_mobilityForces = &mobilityForces;
-        m_rigidBodyForceCache = &rigidBodyForceCache;
-        m_particleForceCache = &particleForceCache;
-        m_mobilityForceCache = &mobilityForceCache;
-
-        m_mode = CachedAndNonCached;
-    }
-    void initializeNonCached(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces) override
-    {
-        m_forces = &forces;
-        m_state = s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
-        m_rigidBodyForces = &rigidBodyForces;
-        m_particleForces = &particleForces;
-        m_mobilityForces = &mobilityForces;
+/* The contribution of some subset of the forces. The first three vectors are
+added into the System-global force arrays and the last three into the cache of
+forces that depend only on positions; vectors that aren't needed in the current
+mode are left empty. One of these is accumulated for each block of chunks and
+they are then summed by ParallelExecutor::parallelReduce().*/
+struct ForceAccumulator {
+    Vector_<SpatialVec> rigidBodyForces;
+    Vector_<Vec3>       particleForces;
+    Vector              mobilityForces;
+
+    Vector_<SpatialVec> rigidBodyForceCache;
+    Vector_<Vec3>       particleForceCache;
+    Vector              mobilityForceCache;
+};
 
-        m_mode = NonCached;
-    }
-    
-    // Set all of the local force contribution arrays to 0. This is so that
-    // each local thread can sum up its force contribution to be later
-    // added into the total force array.
-    void initialize() override {
-        m_rigidBodyForcesLocalStatic.resize(m_rigidBodyForces->size());
-        m_rigidBodyForcesLocalStatic.setToZero();
-        m_particleForcesLocalStatic.resize(m_particleForces->size());
-        m_particleForcesLocalStatic.setToZero();
-        m_mobilityForcesLocalStatic.resize(m_mobilityForces->size());
-        m_mobilityForcesLocalStatic.setToZero();
-
-        if (m_mode == CachedAndNonCached) {
-            m_rigidBodyForceCacheLocalStatic.resize(m_rigidBodyForceCache->size());
-            m_rigidBodyForceCacheLocalStatic.setToZero();
-            m_particleForceCacheLocalStatic.resize(m_particleForceCache->size());
-            m_particleForceCacheLocalStatic.setToZero();
-            m_mobilityForceCacheLocalStatic.resize(m_mobilityForceCache->size());
-            m_mobilityForceCacheLocalStatic.setToZero();
-        }
-    }
-    
-    // Calculate all enabled forces (taking into account mode and parallelism)
-    void execute(int threadIndex) override {
-      switch (m_mode) {
-        case All:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto force = m_forces.getRef()[forceIndex];
-                    force->getImpl().calcForce(*m_state, m_rigidBodyForcesLocalStatic, m_particleForcesLocalStatic, m_mobilityForcesLocalStatic);
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from index b/c
-                // we use 0 for the non-parallel forces.
-                const auto& forceIndex =
-                        m_enabledParallelForces->getElt(threadIndex-1);
-                const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                impl.calcForce(*m_state, m_rigidBodyForcesLocalStatic, m_particleForcesLocalStatic, m_mobilityForcesLocalStatic);
+/* Which forces to calculate. All: every enabled force, when nothing is being
+cached. CachedAndNonCached: every enabled force, with the ones that depend only
+on positions going into the cache arrays. NonCached: only the forces that
+don't depend only on positions, since the cache is valid.*/
+enum Mode {All, CachedAndNonCached, NonCached};
 
+/*Calculates the enabled forces' contributions for one chunk, which is one
+index of the parallel reduction. Each calcForce() call is timed in the force's
+TimingCounter if profiling is enabled.*/
+class CalcForcesBody {
+public:
+    CalcForcesBody(Mode mode, const Array_<Force*>& forces, const State& s,
+                   const ForceChunks& chunks,
+                   Array_<TimingCounter>& timingCounters)
+    :   m_mode(mode), m_forces(forces), m_state(s), m_chunks(chunks),
+        m_timingCounters(timingCounters) {}
+
+    void operator()(int chunk, ForceAccumulator& forces) const {
+        calcChunk(chunk, forces.rigidBodyForces, forces.particleForces,
+                  forces.mobilityForces, forces.rigidBodyForceCache,
+                  forces.particleForceCache, forces.mobilityForceCache);
+    }
+
+    // The cache arrays are used only in CachedAndNonCached mode.
+    void calcChunk(int chunk, Vector_<SpatialVec>& rigidBodyForces,
+                   Vector_<Vec3>& particleForces, Vector& mobilityForces,
+                   Vector_<SpatialVec>& rigidBodyForceCache,
+                   Vector_<Vec3>& particleForceCache,
+                   Vector& mobilityForceCache) const {
+        const int end = m_chunks.chunkStarts[chunk+1];
+        for (int i = m_chunks.chunkStarts[chunk]; i < end; ++i) {
+            const ForceIndex fx = m_chunks.forces[i];
+            const ForceImpl& impl = m_forces[fx]->getImpl();
+            bool toCache = false;
+            switch (m_mode) {
+            case All:
+                break;
+            case CachedAndNonCached:
+                toCache = impl.dependsOnlyOnPositions();
+                break;
+            case NonCached:
+                if (impl.dependsOnlyOnPositions())
+                    continue; // already in the cache
+                break;
             }
-            break;
-
-        case CachedAndNonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                    if (impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state, *m_rigidBodyForceCache, *m_particleForceCache, *m_mobilityForceCache);
-                    } else { // ordinary velocity dependent force
-                        impl.calcForce(*m_state, *m_rigidBodyForces, *m_particleForces, *m_mobilityForces);
-                    }
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from threadIndex b/c
-                // we use 0 for the non-parallel forces.
-                const auto& forceIndex =
-                        m_enabledParallelForces->getElt(threadIndex-1);
-                const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                if (impl.dependsOnlyOnPositions()) {
-                    impl.calcForce(*m_state, m_rigidBodyForceCacheLocalStatic, m_particleForceCacheLocalStatic, m_mobilityForceCacheLocalStatic);
-                } else { // ordinary velocity dependent force
-                    impl.calcForce(*m_state, m_rigidBodyForcesLocalStatic, m_particleForcesLocalStatic, m_mobilityForcesLocalStatic);
-                }
-            }
-            break;
-
-        case NonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                    if (!impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state,
-                                *m_rigidBodyForces, *m_particleForces,
-                                *m_mobilityForces);
-                    }
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from index b/c
-                // we use 0 for the non-parallel forces.
-                const auto& forceIndex =
-                        m_enabledParallelForces->getElt(threadIndex-1);
-                const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                if (!impl.dependsOnlyOnPositions()) {
-                    impl.calcForce(*m_state,
-                            m_rigidBodyForcesLocalStatic, m_particleForcesLocalStatic,
-                            m_mobilityForcesLocalStatic);
-                }
+            Profiler::Scope scope(m_timingCounters[fx], "force");
+            if (toCache) {
+                impl.calcForce(m_state, rigidBodyForceCache,
+                               particleForceCache, mobilityForceCache);
+            } else { // ordinary velocity dependent force
+                impl.calcForce(m_state, rigidBodyForces, particleForces,
+                               mobilityForces);
             }
-            break;
-        }
-    }
-    
-    //Once a thread has finished its force calculations, we add in the thread's
-    //contribution into the cached force arrays in the State
-    void finish() override {
-        *m_rigidBodyForces += m_rigidBodyForcesLocalStatic;
-        *m_particleForces += m_particleForcesLocalStatic;
-        *m_mobilityForces += m_mobilityForcesLocalStatic;
-
-        if (m_mode == CachedAndNonCached) {
-            *m_rigidBodyForceCache += m_rigidBodyForceCacheLocalStatic;
-            *m_particleForceCache += m_particleForceCacheLocalStatic;
-            *m_mobilityForceCache += m_mobilityForceCacheLocalStatic;
         }
     }
 private:
-    Mode m_mode;
-
-    ReferencePtr<const Array_<Force*>> m_forces;
-    ReferencePtr<const State> m_state;
-
-    // Constant state-cache variables for the enabled parallel and non-parallel
-    // forces.
-    ReferencePtr<const Array_<ForceIndex>> m_enabledNonParallelForces;
-    ReferencePtr<const Array_<ForceIndex>> m_enabledParallelForces;
-
-    // ReferencePtrs that point to caches in the state; We eventually add our
-    // thread-local result to these vectors.
-    ReferencePtr<Vector_<SpatialVec>> m_rigidBodyForces;
-    ReferencePtr<Vector_<Vec3>> m_particleForces;
-    ReferencePtr<Vector> m_mobilityForces;
-
-    ReferencePtr<Vector_<SpatialVec>> m_rigidBodyForceCache;
-    ReferencePtr<Vector_<Vec3>> m_particleForceCache;
-    ReferencePtr<Vector> m_mobilityForceCache;
-    
-    // These variables are local to a thread. They are set to their default
-    // value when the threads are spawned. We use them to keep track of each
-    // thread's contribution that we will later add in to the final state cache.
-    static thread_local Vector_<SpatialVec> m_rigidBodyForcesLocalStatic;
-    static thread_local Vector_<Vec3> m_particleForcesLocalStatic;
-    static thread_local Vector m_mobilityForcesLocalStatic;
-
-    static thread_local Vector_<SpatialVec> m_rigidBodyForceCacheLocalStatic;
-    static thread_local Vector_<Vec3> m_particleForceCacheLocalStatic;
-    static thread_local Vector m_mobilityForceCacheLocalStatic;
+    const Mode                      m_mode;
+    const Array_<Force*>&           m_forces;
+    const State&                    m_state;
+    const ForceChunks&              m_chunks;
+    Array_<TimingCounter>&          m_timingCounters;
 };
 
-//local declarations of static member variables
-/*static*/ thread_local Vector_<SpatialVec>
-                    CalcForcesParallelTask::m_rigidBodyForcesLocalStatic;
-/*static*/ thread_local Vector_<Vec3>
-                    CalcForcesParallelTask::m_particleForcesLocalStatic;
-/*static*/ thread_local Vector
-                    CalcForcesParallelTask::m_mobilityForcesLocalStatic;
-
-/*static*/ thread_local Vector_<SpatialVec>
-                    CalcForcesParallelTask::m_rigidBodyForceCacheLocalStatic;
-/*static*/ thread_local Vector_<Vec3>
-                    CalcForcesParallelTask::m_particleForceCacheLocalStatic;
-/*static*/ thread_local Vector
-                    CalcForcesParallelTask::m_mobilityForceCacheLocalStatic;
-
-/* Calculates each enabled force's contribution in the MultibodySystem. These
-calculations occur on the main thread, without use of local thread variables.*/
-
-//Implementation of CalcForcesTask for non-parallel forces
-class CalcForcesNonParallelTask : public CalcForcesTask {
+// Adds one block's contribution into another's.
+class AddForces {
 public:
-    //The different categories of force calculations that GeneralForceSubsystem
-    //chooses between
-    enum Mode {
-        All,
-        CachedAndNonCached,
-        NonCached
-    };
-    
-    CalcForcesNonParallelTask* clone() const override {
-        return new CalcForcesNonParallelTask();
-    }
-    
-    // Each different force calculation Mode requires different parameters
-    //
-    // Note: Execute MUST be called directly after CalcForceTask is initialized
-    void initializeAll(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces) override
-    {
-        m_forces = &forces;
-        m_state = &s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
-        m_rigidBodyForces = &rigidBodyForces;
-        m_particleForces = &particleForces;
-        m_mobilityForces = &mobilityForces;
-        
-        m_mode = All;
-    }
-    void initializeCachedAndNonCached(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces,
-            Vector_<SpatialVec>& rigidBodyForceCache,
-            Vector_<Vec3>& particleForceCache,
-            Vector& mobilityForceCache) override
-    {
-        m_forces = &forces;
-        m_state = s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
-        m_rigidBodyForces = &rigidBodyForces;
-        m_particleForces = &particleForces;
-        m_mobilityForces = &mobilityForces;
-        m_rigidBodyForceCache = &rigidBodyForceCache;
-        m_particleForceCache = &particleForceCache;
-        m_mobilityForceCache = &mobilityForceCache;
-
-        m_mode = CachedAndNonCached;
-    }
-    void initializeNonCached(
-            const Array_<Force*>& forces, const State& s,
-            const Array_<ForceIndex>& enabledNonParallelForces,
-            const Array_<ForceIndex>& enabledParallelForces,
-            Vector_<SpatialVec>& rigidBodyForces,
-            Vector_<Vec3>& particleForces,
-            Vector& mobilityForces) override
-    {
-        m_forces = &forces;
-        m_state = s;
-        m_enabledNonParallelForces = &enabledNonParallelForces;
-        m_enabledParallelForces = &enabledParallelForces;
-        m_rigidBodyForces = &rigidBodyForces;
-        m_particleForces = &particleForces;
-        m_mobilityForces = &mobilityForces;
+    void operator()(ForceAccumulator& sum,
+                    const ForceAccumulator& other) const {
+        sum.rigidBodyForces += other.rigidBodyForces;
+        sum.particleForces += other.particleForces;
+        sum.mobilityForces += other.mobilityForces;
 
-        m_mode = NonCached;
-    }
-    
-    // Set all of the local force contribution arrays to 0. This is so that
-    // each local thread can sum up it's force contribution to be later
-    // added into the total force array.
-    void initialize() override {
-        m_rigidBodyForcesLocal.resize(m_rigidBodyForces->size());
-        m_rigidBodyForcesLocal.setToZero();
-        m_particleForcesLocal.resize(m_particleForces->size());
-        m_particleForcesLocal.setToZero();
-        m_mobilityForcesLocal.resize(m_mobilityForces->size());
-        m_mobilityForcesLocal.setToZero();
-
-        if (m_mode == CachedAndNonCached) {
-            m_rigidBodyForceCacheLocal.resize(m_rigidBodyForceCache->size());
-            m_rigidBodyForceCacheLocal.setToZero();
-            m_particleForceCacheLocal.resize(m_particleForceCache->size());
-            m_particleForceCacheLocal.setToZero();
-            m_mobilityForceCacheLocal.resize(m_mobilityForceCache->size());
-            m_mobilityForceCacheLocal.setToZero();
-        }
-    }
-    
-    // Calculate all enabled forces (taking into account mode and parallelism)
-    void execute(int threadIndex) override {
-      switch (m_mode) {
-        case All:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto force = m_forces.getRef()[forceIndex];
-                    force->getImpl().calcForce(*m_state, m_rigidBodyForcesLocal,
-                                  m_particleForcesLocal, m_mobilityForcesLocal);
-                }
-            }
-            break;
-
-        case CachedAndNonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                    if (impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state, *m_rigidBodyForceCache,
-                                  *m_particleForceCache, *m_mobilityForceCache);
-                    } else { // ordinary velocity dependent force
-                        impl.calcForce(*m_state, *m_rigidBodyForces,
-                                          *m_particleForces, *m_mobilityForces);
-                    }
-                }
-            }
-            break;
-
-        case NonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (const auto& forceIndex : *m_enabledNonParallelForces) {
-                    const auto& impl = m_forces.getRef()[forceIndex]->getImpl();
-                    if (!impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state,
-                                *m_rigidBodyForces, *m_particleForces,
-                                *m_mobilityForces);
-                    }
-                }
-            }
-            break;
-        }
+        sum.rigidBodyForceCache += other.rigidBodyForceCache;
+        sum.particleForceCache += other.particleForceCache;
+        sum.mobilityForceCache += other.mobilityForceCache;
     }
-    
-    //Once a thread has finished it's force calculations, we add in the thread's
-    //contribution into the cached force arrays in the State
-    void finish() override {
-        *m_rigidBodyForces += m_rigidBodyForcesLocal;
-        *m_particleForces += m_particleForcesLocal;
-        *m_mobilityForces += m_mobilityForcesLocal;
-
-        if (m_mode == CachedAndNonCached) {
-            *m_rigidBodyForceCache += m_rigidBodyForceCacheLocal;
-            *m_particleForceCache += m_particleForceCacheLocal;
-            *m_mobilityForceCache += m_mobilityForceCacheLocal;
-        }
-    }
-private:
-    Mode m_mode;
-
-    ReferencePtr<const Array_<Force*>> m_forces;
-    ReferencePtr<const State> m_state;
-
-    // Const. state-cache variables for the enabled parallel and non-parallel
-    // forces.
-    ReferencePtr<const Array_<ForceIndex>> m_enabledNonParallelForces;
-    ReferencePtr<const Array_<ForceIndex>> m_enabledParallelForces;
-
-    // ReferencePtrs that point to caches in the state; We eventually add our
-    // thread-local result to these vectors.
-    ReferencePtr<Vector_<SpatialVec>> m_rigidBodyForces;
-    ReferencePtr<Vector_<Vec3>> m_particleForces;
-    ReferencePtr<Vector> m_mobilityForces;
-
-    ReferencePtr<Vector_<SpatialVec>> m_rigidBodyForceCache;
-    ReferencePtr<Vector_<Vec3>> m_particleForceCache;
-    ReferencePtr<Vector> m_mobilityForceCache;
-    
-    // These variables belong to the main thread. We use them to keep track of
-    // each thread's contribution that we will later add in to the final state
-    // cache.
-    Vector_<SpatialVec> m_rigidBodyForcesLocal;
-    Vector_<Vec3> m_particleForcesLocal;
-    Vector m_mobilityForcesLocal;
-
-    Vector_<SpatialVec> m_rigidBodyForceCacheLocal;
-    Vector_<Vec3> m_particleForceCacheLocal;
-    Vector m_mobilityForceCacheLocal;
 };
 } //namespace
 
@@ -527,11 +181,16 @@ namespace SimTK{
 class GeneralForceSubsystemRep : public ForceSubsystem::Guts {
 public:
     GeneralForceSubsystemRep()
-     : ForceSubsystemRep("GeneralForceSubsystem", "0.0.1")
+     : ForceSubsystemRep("GeneralForceSubsystem", "0.0.1"),
+       deterministicForceSummation(false)
     {
         //The default number of threads is the physical number of processors
         //call setNumberOfThreads() if you want to override the thread count
         calcForcesExecutor = new ParallelExecutor();
+        //The cost of individual forces varies widely, so let idle threads
+        //steal work from busy ones.
+        calcForcesExecutor->setScheduling(
+            ParallelExecutor::WorkStealingScheduling);
     }
 
     ~GeneralForceSubsystemRep() {
@@ -591,13 +250,22 @@ public:
     void setNumberOfThreads(unsigned numThreads) {
         SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "GeneralForceSubsystemRep",
                     "setNumberOfThreads", "Number of threads must be positive");
-        calcForcesExecutor = new ParallelExecutor(numThreads);
+        calcForcesExecutor = new ParallelExecutor(numThreads,
+            ParallelExecutor::WorkStealingScheduling);
     }
     
     int getNumberOfThreads() const{
       return calcForcesExecutor->getMaxThreads();
     }
 
+    void setDeterministicForceSummation(bool deterministic) {
+        deterministicForceSummation = deterministic;
+    }
+
+    bool getDeterministicForceSummation() const {
+        return deterministicForceSummation;
+    }
+
     // These override default implementations of virtual methods in the
     // Subsystem::Guts class.
 
@@ -606,8 +274,7 @@ public:
 
     int realizeSubsystemTopologyImpl(State& s) const  override {
         forceEnabledIndex.invalidate();
-        enabledParallelForcesIndex.invalidate();
-        enabledNonParallelForcesIndex.invalidate();
+        forceChunksIndex.invalidate();
         cachedForcesAreValidCacheIndex.invalidate();
         rigidBodyForceCacheIndex.invalidate();
         mobilityForceCacheIndex.invalidate();
@@ -627,57 +294,12 @@ public:
 
         forceEnabledIndex = allocateDiscreteVariable(s, Stage::Instance,
             new Value<Array_<bool> >(forceEnabled));
-        
-        
-        // Track the enabled forces and whether they should be parallelized.
-        Array_<ForceIndex> enabledNonParallelForces;
-        Array_<ForceIndex> enabledParallelForces;
-
-        // Avoid repeatedly allocating memory.
-        enabledNonParallelForces.reserve(forces.size());
-        enabledParallelForces.reserve(forces.size());
 
-        for (int i = 0; i < (int) forces.size(); ++i) {
-            if (forceEnabled[i])
-            {
-                if (forces[i]->getImpl().shouldBeParallelIfPossible())
-                    enabledParallelForces.push_back(ForceIndex(i));
-                else
-                    enabledNonParallelForces.push_back(ForceIndex(i));
-            }
-        }
+        // The enabled forces and their division into chunks are filled in
+        // when Instance stage is realized.
+        forceChunksIndex = allocateCacheEntry(s, Stage::Instance,
+                new Value<ForceChunks>());
 
-        enabledNonParallelForcesIndex = allocateCacheEntry(s, Stage::Instance,
-                new Value<Array_<ForceIndex> >(enabledNonParallelForces));
-        enabledParallelForcesIndex = allocateCacheEntry(s, Stage::Instance,
-                new Value<Array_<ForceIndex> >(enabledParallelForces));
-
-        //Determine whether the subsystem has parallel forces - if so, use the
-        //parallel implementation of CalcForcesTask (even if those parallel
-        //forces are not currently enabled - they could be enabled in the
-        //future)
-        //
-        // *Consider the following example:*
-        // Parallel Forces: A B C
-        // NonParallel Forces: D E
-        //
-        // Enabled Forces at Time 0: D E
-        // Enabled Forces at Time 1: A B C D E
-        
-        bool hasParallelForces = false;
-        for(int x = 0; x < (int)forces.size(); ++x)
-        {
-            if (forces[x]->getImpl().shouldBeParallelIfPossible())
-            {
-                hasParallelForces = true;
-                break;
-            }
-        }
-        if (hasParallelForces)
-            calcForcesTask = new CalcForcesParallelTask();
-        else
-            calcForcesTask = new CalcForcesNonParallelTask();
-        
         // Note that we'll allocate these even if all the needs-caching
         // elements are presently disabled. That way they'll be around when
         // the force gets enabled.
@@ -695,9 +317,34 @@ public:
         // We must realizeTopology() even if the force is disabled by default.
         for (int i = 0; i < (int) forces.size(); ++i)
             forces[i]->getImpl().realizeTopology(s);
+
+        forceTimingCounters.resize(forces.size());
+        for (ForceIndex fx(0); fx < forces.size(); ++fx)
+            forceTimingCounters[fx].setName(getName() + "::Force " 
+                + String(fx) + " (" + getForceTypeName(fx) + ")");
         return 0;
     }
 
+    void appendTimingCountersImpl
+       (Array_<TimingCounter>& counters) const override {
+        for (const TimingCounter& counter : forceTimingCounters)
+            if (counter.getNumCalls() > 0)
+                counters.push_back(counter);
+    }
+
+    void resetTimingCountersImpl() const override {
+        for (TimingCounter& counter : forceTimingCounters)
+            counter.reset();
+    }
+
+    const TimingCounter& getForceTimingCounter(ForceIndex index) const {
+        SimTK_APIARGCHECK_ALWAYS(subsystemTopologyHasBeenRealized(),
+            "GeneralForceSubsystem", "getForceTimingCounter",
+            "The timing counters are created by realizeTopology().");
+        assert(index >= 0 && index < forceTimingCounters.size());
+        return forceTimingCounters[index];
+    }
+
     // Forces must realizeModel() even if they are currently disabled.
     int realizeSubsystemModelImpl(State& s) const override {
         for (int i = 0; i < (int) forces.size(); ++i)
@@ -712,34 +359,26 @@ public:
             (getDiscreteVariable(s, forceEnabledIndex));
         for (int i = 0; i < (int) forces.size(); ++i)
             if (enabled[i]) forces[i]->getImpl().realizeInstance(s);
-            
-        //Update non/parallel enabled force arrays
-        // Track the enabled forces and whether they should be parallelized.
-        const Array_<bool>& forceEnabled = Value< Array_<bool> >::downcast
-                                    (getDiscreteVariable(s, forceEnabledIndex));
-        Array_<ForceIndex>& enabledNonParallelForces =
-                Value< Array_<ForceIndex> >::
-                    updDowncast(updCacheEntry(s,enabledNonParallelForcesIndex));
-        Array_<ForceIndex>& enabledParallelForces =
-                Value< Array_<ForceIndex> >::
-                    updDowncast(updCacheEntry(s,enabledParallelForcesIndex));
-
-        // Avoid repeatedly allocating memory.
-        enabledParallelForces.resize(0);
-        enabledNonParallelForces.resize(0);
-        
-        enabledNonParallelForces.reserve(forces.size());
-        enabledParallelForces.reserve(forces.size());
 
+        // Put the enabled forces in evaluation order, with the ones that must
+        // be calculated serially first.
+        ForceChunks& chunks = Value<ForceChunks>::updDowncast
+                                    (updCacheEntry(s, forceChunksIndex));
+        chunks.forces.clear();
+        chunks.costs.clear();
+        for (int i = 0; i < (int) forces.size(); ++i)
+            if (enabled[i] && forces[i]->getImpl().getParallelEvaluationCost()
+                              <= 0)
+                chunks.forces.push_back(ForceIndex(i));
+        chunks.numSerialForces = (int) chunks.forces.size();
         for (int i = 0; i < (int) forces.size(); ++i) {
-            if (forceEnabled[i])
-            {
-                if (forces[i]->getImpl().shouldBeParallelIfPossible())
-                    enabledParallelForces.push_back(ForceIndex(i));
-                else
-                    enabledNonParallelForces.push_back(ForceIndex(i));
+            const Real cost = forces[i]->getImpl().getParallelEvaluationCost();
+            if (enabled[i] && cost > 0) {
+                chunks.forces.push_back(ForceIndex(i));
+                chunks.costs.push_back(cost);
             }
         }
+        chunks.numThreads = 0; // the chunks must be recomputed
         return 0;
     }
 
@@ -781,12 +420,9 @@ public:
         // force element is enabled.
         const Array_<bool>& forceEnabled = Value< Array_<bool> >::downcast
                                     (getDiscreteVariable(s, forceEnabledIndex));
-        const Array_<ForceIndex>& enabledNonParallelForces =
-                Value<Array_<ForceIndex>>::
-                      downcast(getCacheEntry(s, enabledNonParallelForcesIndex));
-        const Array_<ForceIndex>& enabledParallelForces =
-                Value<Array_<ForceIndex>>::
-                         downcast(getCacheEntry(s, enabledParallelForcesIndex));
+        ForceChunks& chunks = Value<ForceChunks>::updDowncast
+                                    (updCacheEntry(s, forceChunksIndex));
+        updateForceChunks(chunks);
 
         // Get access to System-global force cache arrays.
         Vector_<SpatialVec>&   rigidBodyForces =
@@ -801,11 +437,9 @@ public:
         // exist?), not the contents.
         if (!cachedForcesAreValidCacheIndex.isValid()) {
             // Call calcForce() on all Forces, in parallel.
-            calcForcesTask->initializeAll(forces, s,
-                    enabledNonParallelForces, enabledParallelForces,
-                    rigidBodyForces, particleForces, mobilityForces);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            calcForces(s, All, chunks,
+                       rigidBodyForces, particleForces, mobilityForces,
+                       rigidBodyForces, particleForces, mobilityForces);
 
             // Allow forces to do their own realization, but wait until all
             // forces have executed calcForce(). TODO: not sure if that is
@@ -841,24 +475,19 @@ public:
             mobilityForceCache.resize(matter.getNumMobilities());
             mobilityForceCache = 0;
 
-            // Run through all the forces, accumulating directly into the
-            // force arrays or indirectly into the cache as appropriate.
-            calcForcesTask->initializeCachedAndNonCached(forces, s,
-                                enabledNonParallelForces, enabledParallelForces,
-                                rigidBodyForces, particleForces, mobilityForces,
-                                rigidBodyForceCache, particleForceCache,
-                                mobilityForceCache);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            // Run through all the forces, accumulating into the force
+            // arrays or into the cache as appropriate.
+            calcForces(s, CachedAndNonCached, chunks,
+                       rigidBodyForces, particleForces, mobilityForces,
+                       rigidBodyForceCache, particleForceCache,
+                       mobilityForceCache);
             cachedForcesAreValid = true;
         } else {
             // Cache already valid; just need to do the non-cached ones (the
             // ones for which dependsOnlyOnPositions is false).
-            calcForcesTask->initializeNonCached(forces, s,
-                               enabledNonParallelForces, enabledParallelForces,
-                               rigidBodyForces, particleForces, mobilityForces);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            calcForces(s, NonCached, chunks,
+                       rigidBodyForces, particleForces, mobilityForces,
+                       rigidBodyForces, particleForces, mobilityForces);
         }
 
         // Accumulate the values from the cache into the global arrays.
@@ -915,11 +544,130 @@ public:
     }
 
 private:
+    // Divide the enabled forces into chunks of similar cost for the number of
+    // threads that can actually be used, unless that has already been done.
+    void updateForceChunks(ForceChunks& chunks) const {
+        const int numThreads = std::min(getNumberOfThreads(),
+                                        ParallelExecutor::getNumSharedThreads());
+        if (chunks.numThreads == numThreads
+            && chunks.deterministic == deterministicForceSummation)
+            return;
+        chunks.numThreads = numThreads;
+        chunks.deterministic = deterministicForceSummation;
+
+        const int numForces = (int) chunks.forces.size();
+        Array_<int>& starts = chunks.chunkStarts;
+        starts.clear();
+        starts.push_back(0);
+
+        // We don't know what the serial forces cost; count them as cheap.
+        Real totalCost = chunks.numSerialForces;
+        for (Real cost : chunks.costs)
+            totalCost += cost;
+
+        // Calculating a small set of forces in parallel would only add
+        // overhead. In deterministic mode, though, the chunks must not
+        // depend on the number of threads.
+        if (!chunks.deterministic
+            && (numThreads == 1 || totalCost < MinParallelCost)) {
+            starts.push_back(numForces);
+            return;
+        }
+
+        if (chunks.numSerialForces > 0)
+            starts.push_back(chunks.numSerialForces);
+        const Real targetCost = chunks.deterministic ? MinChunkCost
+            : ParallelExecutor::calcTargetChunkCost(totalCost, numThreads,
+                                                    MinChunkCost);
+        ParallelExecutor::appendChunksByCost(numForces,
+            [&](int i) {return chunks.costs[i - chunks.numSerialForces];},
+            targetCost, starts);
+    }
+
+    // Calculate the enabled forces selected by mode and add them into the
+    // given arrays. A single chunk is calculated directly into the arrays on
+    // this thread; otherwise the chunks are calculated in parallel and their
+    // sum is added in.
+    void calcForces(const State& s, Mode mode, const ForceChunks& chunks,
+                    Vector_<SpatialVec>& rigidBodyForces,
+                    Vector_<Vec3>& particleForces, Vector& mobilityForces,
+                    Vector_<SpatialVec>& rigidBodyForceCache,
+                    Vector_<Vec3>& particleForceCache,
+                    Vector& mobilityForceCache) const {
+        const CalcForcesBody body(mode, forces, s, chunks,
+                                  forceTimingCounters);
+        const bool cached = (mode == CachedAndNonCached);
+        if (chunks.getNumChunks() == 1 && !chunks.deterministic) {
+            body.calcChunk(0, rigidBodyForces, particleForces, mobilityForces,
+                           rigidBodyForceCache, particleForceCache,
+                           mobilityForceCache);
+            return;
+        }
+
+        const SimbodyMatterSubsystem& matter =
+            getMultibodySystem().getMatterSubsystem();
+        calcForcesZero.rigidBodyForces.resize(matter.getNumBodies());
+        calcForcesZero.rigidBodyForces.setToZero();
+        calcForcesZero.particleForces.resize(matter.getNumParticles());
+        calcForcesZero.particleForces.setToZero();
+        calcForcesZero.mobilityForces.resize(matter.getNumMobilities());
+        calcForcesZero.mobilityForces.setToZero();
+        calcForcesZero.rigidBodyForceCache.resize
+           (cached ? matter.getNumBodies() : 0);
+        calcForcesZero.rigidBodyForceCache.setToZero();
+        calcForcesZero.particleForceCache.resize
+           (cached ? matter.getNumParticles() : 0);
+        calcForcesZero.particleForceCache.setToZero();
+        calcForcesZero.mobilityForceCache.resize
+           (cached ? matter.getNumMobilities() : 0);
+        calcForcesZero.mobilityForceCache.setToZero();
+
+        calcForcesExecutor->parallelReduce(chunks.getNumChunks(),
+            calcForcesZero, body, AddForces(), calcForcesPartials,
+            chunks.deterministic);
+
+        const ForceAccumulator& sum = calcForcesPartials[0];
+        rigidBodyForces += sum.rigidBodyForces;
+        particleForces += sum.particleForces;
+        mobilityForces += sum.mobilityForces;
+        if (cached) {
+            rigidBodyForceCache += sum.rigidBodyForceCache;
+            particleForceCache += sum.particleForceCache;
+            mobilityForceCache += sum.mobilityForceCache;
+        }
+    }
+
+    // The name of a force's type for use in reports, without the SimTK
+    // namespace or the Impl suffix of the built-in forces' implementation
+    // classes. For a Force::Custom it is the type of the user's
+    // Implementation.
+    std::string getForceTypeName(ForceIndex index) const {
+        const ForceImpl& impl = forces[index]->getImpl();
+        const Force::CustomImpl* custom = 
+            dynamic_cast<const Force::CustomImpl*>(&impl);
+        std::string name = custom ? demangle(typeid(
+                                        custom->getImplementation()).name())
+                                  : demangle(typeid(impl).name());
+        if (name.compare(0, 7, "SimTK::") == 0)
+            name.erase(0, 7);
+        if (!custom && name.size() > 4 
+            && name.compare(name.size()-4, 4, "Impl") == 0)
+            name.erase(name.size()-4);
+        return name;
+    }
+
     Array_<Force*>                  forces;
 
-    // For parallel calculation of forces.
+    // Timing of each force's calcForce() calls while profiling is enabled,
+    // indexed by ForceIndex. These are created by realizeTopology().
+    mutable Array_<TimingCounter>   forceTimingCounters;
+
+    // For parallel calculation of forces. The partial sums are kept between
+    // evaluations so that they don't have to be reallocated each time.
     mutable ClonePtr<ParallelExecutor>               calcForcesExecutor;
-    mutable ClonePtr<CalcForcesTask>                 calcForcesTask;
+    bool                                             deterministicForceSummation;
+    mutable ForceAccumulator                         calcForcesZero;
+    mutable Array_<ForceAccumulator>                 calcForcesPartials;
     
     // TOPOLOGY "CACHE"
     // These indices must be filled in during realizeTopology and treated
@@ -928,10 +676,9 @@ private:
     // This instance-stage variable holds a bool for each force element.
     mutable DiscreteVariableIndex   forceEnabledIndex;
     
-    //This set of cache entries stores an array of Force* elements for enabled
-    //parallel and non-parallel forces
-    mutable CacheEntryIndex   enabledParallelForcesIndex;
-    mutable CacheEntryIndex   enabledNonParallelForcesIndex;
+    // This instance-stage cache entry holds the enabled forces in evaluation
+    // order and their division into chunks for parallel evaluation.
+    mutable CacheEntryIndex   forceChunksIndex;
 
     // This set of cache entries is allocated only if some force element
     // overrode dependsOnlyOnPositions().
@@ -1007,6 +754,16 @@ void GeneralForceSubsystem::setNumberOfThreads(unsigned numThreads)
 int GeneralForceSubsystem::getNumberOfThreads() const
 {   return getRep().getNumberOfThreads(); }
 
+void GeneralForceSubsystem::setDeterministicForceSummation(bool deterministic)
+{   updRep().setDeterministicForceSummation(deterministic); }
+
+bool GeneralForceSubsystem::getDeterministicForceSummation() const
+{   return getRep().getDeterministicForceSummation(); }
+
+const TimingCounter& GeneralForceSubsystem::
+getForceTimingCounter(ForceIndex index) const
+{   return getRep().getForceTimingCounter(index); }
+
 const MultibodySystem& GeneralForceSubsystem::getMultibodySystem() const
 {   return MultibodySystem::downcast(getSystem()); }
 
@@ -107,6 +107,46 @@ void SimbodyMatterSubsystem::setShowDefaultGeometry(bool show) {
     updRep().setShowDefaultGeometry(show);
 }
 
+void SimbodyMatterSubsystem::setNumberOfThreads(unsigned numThreads) {
+    updRep().setNumberOfThreads(numThreads);
+}
+
+int SimbodyMatterSubsystem::getNumberOfThreads() const {
+    return getRep().getNumberOfThreads();
+}
+
+void SimbodyMatterSubsystem::setUseLevelParallelism(bool useLevelParallelism) {
+    updRep().setUseLevelParallelism(useLevelParallelism);
+}
+
+bool SimbodyMatterSubsystem::getUseLevelParallelism() const {
+    return getRep().getUseLevelParallelism();
+}
+
+void SimbodyMatterSubsystem::setMinParallelLevelWidth(int minWidth) {
+    updRep().setMinParallelLevelWidth(minWidth);
+}
+
+int SimbodyMatterSubsystem::getMinParallelLevelWidth() const {
+    return getRep().getMinParallelLevelWidth();
+}
+
+void SimbodyMatterSubsystem::
+setUseSubtreeParallelism(bool useSubtreeParallelism) {
+    updRep().setUseSubtreeParallelism(useSubtreeParallelism);
+}
+
+bool SimbodyMatterSubsystem::getUseSubtreeParallelism() const {
+    return getRep().getUseSubtreeParallelism();
+}
+
+int SimbodyMatterSubsystem::getNumIndependentSubtrees() const {
+    SimTK_STAGECHECK_TOPOLOGY_REALIZED_ALWAYS(
+        getRep().subsystemTopologyHasBeenRealized(), "SimbodyMatterSubsystem",
+        getName(), "getNumIndependentSubtrees");
+    return getRep().getNumIndependentSubtrees();
+}
+
 
 ConstraintIndex SimbodyMatterSubsystem::
 adoptConstraint(Constraint& child) {return updRep().adoptConstraint(child);}
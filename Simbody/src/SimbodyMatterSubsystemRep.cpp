@@ -97,6 +97,8 @@ void SimbodyMatterSubsystemRep::clearTopologyCache() {
     velocityCoupledConstraints.clear();
     accelerationCoupledConstraints.clear();
     dynamicallyCoupledConstraints.clear();
+    independentSubtreeNodes.clear();
+    independentSubtreeStarts.clear();
 
     // RigidBodyNodes themselves are owned by the MobilizedBodyImpls and will
     // be deleted when the MobilizedBodyImpl objects are.
@@ -327,6 +329,112 @@ void SimbodyMatterSubsystemRep::endConstruction(State& s) {
         }
         */
     }
+
+    // Partition the constraints into dynamically coupled sets. Forces from a
+    // Constraint reach only the grounded subtrees (branches) containing its
+    // constrained bodies and mobilizers, and M^-1 doesn't couple different
+    // branches, so two Constraints are coupled in G*M^-1*~G only if they 
+    // share a branch, directly or through a chain of other Constraints. We
+    // merge the branches of each Constraint, then collect the Constraints
+    // and the nodes of each merged group of branches.
+    const int nb = getNumMobilizedBodies();
+    Array_<MobilizedBodyIndex,MobilizedBodyIndex> baseBody(nb);
+    Array_<MobilizedBodyIndex,MobilizedBodyIndex> mergedInto(nb);
+    for (MobilizedBodyIndex mbx(0); mbx < nb; ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        baseBody[mbx] = node.getLevel() <= 1 
+            ? mbx : baseBody[node.getParent()->getNodeNum()];
+        mergedInto[mbx] = mbx;
+    }
+    // Follow a chain of merged branches to its representative.
+    auto findRoot = [&mergedInto](MobilizedBodyIndex branch) {
+        while (mergedInto[branch] != branch)
+            branch = mergedInto[branch] = mergedInto[mergedInto[branch]];
+        return branch;
+    };
+
+    // A Constraint's first branch, or Ground if it doesn't act on any.
+    Array_<MobilizedBodyIndex,ConstraintIndex> firstBranch(getNumConstraints());
+    for (ConstraintIndex cx(0); cx<getNumConstraints(); ++cx) {
+        const ConstraintImpl& crep = getConstraint(cx).getImpl();
+        Array_<MobilizedBodyIndex> bodies;
+        for (ConstrainedBodyIndex cbx(0); 
+             cbx < crep.getNumConstrainedBodies(); ++cbx)
+            bodies.push_back(crep.getMobilizedBodyIndexOfConstrainedBody(cbx));
+        for (ConstrainedMobilizerIndex cmx(0); 
+             cmx < crep.getNumConstrainedMobilizers(); ++cmx)
+            bodies.push_back
+               (crep.getMobilizedBodyIndexOfConstrainedMobilizer(cmx));
+        firstBranch[cx] = GroundIndex;
+        for (MobilizedBodyIndex mbx : bodies) {
+            const MobilizedBodyIndex branch = baseBody[mbx];
+            if (branch == GroundIndex)
+                continue;
+            if (firstBranch[cx] == GroundIndex)
+                firstBranch[cx] = branch;
+            else
+                mergedInto[findRoot(branch)] = findRoot(firstBranch[cx]);
+        }
+    }
+
+    // Constraints that don't act on any branch go together in one set with
+    // no nodes; their rows of G are zero.
+    dynamicallyCoupledConstraints.clear();
+    Array_<int,MobilizedBodyIndex> setOfBranch(nb);
+    setOfBranch.fill(-1);
+    for (ConstraintIndex cx(0); cx<getNumConstraints(); ++cx) {
+        const MobilizedBodyIndex root = firstBranch[cx] == GroundIndex
+            ? GroundIndex : findRoot(firstBranch[cx]);
+        if (setOfBranch[root] < 0) {
+            setOfBranch[root] = (int)dynamicallyCoupledConstraints.size();
+            dynamicallyCoupledConstraints.push_back(CoupledConstraintSet());
+        }
+        dynamicallyCoupledConstraints[setOfBranch[root]].addConstraint(cx);
+    }
+    for (int i=1; i < (int)rbNodeLevels.size(); ++i)
+        for (int j=0; j < (int)rbNodeLevels[i].size(); ++j) {
+            const RigidBodyNode* node = rbNodeLevels[i][j];
+            const int set = 
+                setOfBranch[findRoot(baseBody[node->getNodeNum()])];
+            if (set >= 0)
+                dynamicallyCoupledConstraints[set].addNode(node);
+        }
+    for (CoupledConstraintSet& cset : dynamicallyCoupledConstraints)
+        cset.realizeTopology(getMySimbodyMatterSubsystemHandle());
+
+    // The same merged groups of branches are the independent subtrees of
+    // Ground used for subtree-parallel tree recursions. Every branch is in 
+    // one, whether or not it has Constraints. Gather each subtree's nodes 
+    // contiguously, keeping them ordered by level.
+    Array_<int,MobilizedBodyIndex> subtreeOfBranch(nb);
+    subtreeOfBranch.fill(-1);
+    Array_<int> subtreeSize;
+    for (int i=1; i < (int)rbNodeLevels.size(); ++i)
+        for (int j=0; j < (int)rbNodeLevels[i].size(); ++j) {
+            const MobilizedBodyIndex root = 
+                findRoot(baseBody[rbNodeLevels[i][j]->getNodeNum()]);
+            if (subtreeOfBranch[root] < 0) {
+                subtreeOfBranch[root] = (int)subtreeSize.size();
+                subtreeSize.push_back(0);
+            }
+            ++subtreeSize[subtreeOfBranch[root]];
+        }
+    const int numSubtrees = (int)subtreeSize.size();
+    independentSubtreeStarts.resize(numSubtrees+1);
+    independentSubtreeStarts[0] = 0;
+    for (int t=0; t < numSubtrees; ++t)
+        independentSubtreeStarts[t+1] = 
+            independentSubtreeStarts[t] + subtreeSize[t];
+    Array_<int> next(independentSubtreeStarts.begin(), 
+                     independentSubtreeStarts.end()-1);
+    independentSubtreeNodes.resize(independentSubtreeStarts.back());
+    for (int i=1; i < (int)rbNodeLevels.size(); ++i)
+        for (int j=0; j < (int)rbNodeLevels[i].size(); ++j) {
+            const RigidBodyNode* node = rbNodeLevels[i][j];
+            const int t = 
+                subtreeOfBranch[findRoot(baseBody[node->getNodeNum()])];
+            independentSubtreeNodes[next[t]++] = node;
+        }
 }
 
 int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
@@ -477,6 +585,13 @@ int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
         allocateLazyCacheEntry(s, Stage::Dynamics,
                                new Value<SBConstrainedAccelerationCache>());
 
+    // The factored constraint-space matrix G*M^-1*~G used for multipliers in
+    // forward dynamics and for impulses. This is calculated only on demand,
+    // after which it can be reused until time or positions change.
+    tc.constraintFactorizationCacheIndex =
+        allocateLazyCacheEntry(s, Stage::Position,
+                               new Value<SBConstraintFactorizationCache>());
+
     tc.valid = true;
 
     // Allocate a cache entry for the topologyCache, and save a copy there.
@@ -1106,6 +1221,144 @@ int SimbodyMatterSubsystemRep::realizeSubsystemPositionImpl(const State& s) cons
 }
 
 
+//==============================================================================
+//                              LEVEL SWEEPS
+//==============================================================================
+namespace {
+// Below this many nodes per chunk the dispatch cost outweighs the work.
+const int MinLevelNodesPerChunk = 8;
+
+// Calls nodeFunc for a contiguous chunk of the nodes at one level of the tree.
+// The chunks don't share any outputs.
+template <class NodeFunc>
+class LevelSweepTask : public ParallelExecutor::Task {
+public:
+    LevelSweepTask(const RBNodePtrList& nodes, int numChunks, 
+                   const NodeFunc& nodeFunc)
+    :   m_nodes(nodes), m_numChunks(numChunks), m_nodeFunc(nodeFunc) {}
+
+    void execute(int chunk) override {
+        const long long width = m_nodes.size();
+        const int begin = (int)(width*chunk/m_numChunks);
+        const int end   = (int)(width*(chunk+1)/m_numChunks);
+        for (int j=begin; j < end; ++j)
+            m_nodeFunc(*m_nodes[j]);
+    }
+private:
+    const RBNodePtrList&    m_nodes;
+    const int               m_numChunks;
+    const NodeFunc&         m_nodeFunc;
+};
+
+// Sweeps a range of whole independent subtrees, either base to tip or tip to
+// base. Chunks are balanced by number of nodes, rounded to subtree 
+// boundaries, so a chunk may hold many small subtrees or part of none.
+template <class NodeFunc>
+class SubtreeSweepTask : public ParallelExecutor::Task {
+public:
+    SubtreeSweepTask(const RBNodePtrList& nodes, const Array_<int>& starts,
+                     int numChunks, bool inward, const NodeFunc& nodeFunc)
+    :   m_nodes(nodes), m_starts(starts), m_numChunks(numChunks), 
+        m_inward(inward), m_nodeFunc(nodeFunc) {}
+
+    void execute(int chunk) override {
+        const int begin = subtreeBoundary(chunk);
+        const int end   = subtreeBoundary(chunk+1);
+        // Each subtree's nodes are ordered by level, so running backwards
+        // through the whole range visits every child before its parent.
+        if (m_inward) {
+            for (int j=end-1; j >= begin; --j)
+                m_nodeFunc(*m_nodes[j]);
+        } else {
+            for (int j=begin; j < end; ++j)
+                m_nodeFunc(*m_nodes[j]);
+        }
+    }
+private:
+    // The first node of the first subtree starting at or after this chunk's
+    // share of the nodes.
+    int subtreeBoundary(int chunk) const {
+        const long long numNodes = m_nodes.size();
+        const int target = (int)(numNodes*chunk/m_numChunks);
+        return *std::lower_bound(m_starts.begin(), m_starts.end(), target);
+    }
+
+    const RBNodePtrList&    m_nodes;
+    const Array_<int>&      m_starts;
+    const int               m_numChunks;
+    const bool              m_inward;
+    const NodeFunc&         m_nodeFunc;
+};
+}
+
+template <class NodeFunc>
+void SimbodyMatterSubsystemRep::
+forEachNodeAtLevel(int level, const NodeFunc& nodeFunc) const {
+    const RBNodePtrList& nodes = rbNodeLevels[level];
+    const int width = (int)nodes.size();
+    if (m_useLevelParallelism && width >= m_minParallelLevelWidth) {
+        const int numThreads = std::min(getNumberOfThreads(),
+                                        ParallelExecutor::getNumSharedThreads());
+        const int numChunks = ParallelExecutor::calcNumChunks(width, 
+            numThreads, MinLevelNodesPerChunk);
+        if (numThreads > 1 && numChunks > 1 
+            && !ParallelExecutor::isWorkerThread()) {
+            LevelSweepTask<NodeFunc> task(nodes, numChunks, nodeFunc);
+            m_executor->execute(task, numChunks);
+            return;
+        }
+    }
+    for (int j=0; j < width; ++j)
+        nodeFunc(*nodes[j]);
+}
+
+template <class NodeFunc>
+bool SimbodyMatterSubsystemRep::
+forEachNodeInSubtrees(const NodeFunc& nodeFunc, bool inward) const {
+    if (!m_useSubtreeParallelism || getNumIndependentSubtrees() < 2)
+        return false;
+    const int numNodes = (int)independentSubtreeNodes.size();
+    const int numThreads = std::min(getNumberOfThreads(),
+                                    ParallelExecutor::getNumSharedThreads());
+    const int numChunks = ParallelExecutor::calcNumChunks(numNodes, 
+        numThreads, MinLevelNodesPerChunk);
+    if (numThreads <= 1 || numChunks <= 1 
+        || ParallelExecutor::isWorkerThread())
+        return false;
+
+    // Only Ground is at level 0; its children read it on the way out and 
+    // it reads them on the way in.
+    if (!inward)
+        forEachNodeAtLevel(0, nodeFunc);
+    SubtreeSweepTask<NodeFunc> task(independentSubtreeNodes, 
+        independentSubtreeStarts, numChunks, inward, nodeFunc);
+    m_executor->execute(task, numChunks);
+    if (inward)
+        forEachNodeAtLevel(0, nodeFunc);
+    return true;
+}
+
+template <class NodeFunc>
+void SimbodyMatterSubsystemRep::
+forEachNodeBaseToTip(const NodeFunc& nodeFunc) const {
+    if (forEachNodeInSubtrees(nodeFunc, false))
+        return;
+    for (int i=0 ; i<(int)rbNodeLevels.size() ; ++i) 
+        forEachNodeAtLevel(i, nodeFunc);
+}
+
+template <class NodeFunc>
+void SimbodyMatterSubsystemRep::
+forEachNodeTipToBase(const NodeFunc& nodeFunc) const {
+    if (forEachNodeInSubtrees(nodeFunc, true))
+        return;
+    for (int i=rbNodeLevels.size()-1 ; i>=0 ; --i) 
+        forEachNodeAtLevel(i, nodeFunc);
+}
+//................................ LEVEL SWEEPS ................................
+
+
+
 //==============================================================================
 //                       REALIZE POSITION KINEMATICS
 //==============================================================================
@@ -1130,9 +1383,8 @@ realizePositionKinematics(const State& state) const {
     // Any body which is using quaternions should calculate the quaternion
     // constraint here and put it in the appropriate slot of qErr.
     // Set generalized coordinates: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
-            rbNodeLevels[i][j]->realizePosition(stateDigest); 
+    forEachNodeBaseToTip([&](const RigidBodyNode& node) 
+    {   node.realizePosition(stateDigest); });
 
     // Ask the constraints to calculate ancestor-relative kinematics (still 
     // goes in TreePositionCache).
@@ -1238,9 +1490,8 @@ realizeArticulatedBodyInertias(const State& state) const {
     SBArticulatedBodyInertiaCache&  abc = updArticulatedBodyInertiaCache(state);
 
     // tip-to-base sweep
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; --i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeArticulatedBodyInertiasInward(ic,tpc,abc);
+    forEachNodeTipToBase([&](const RigidBodyNode& node) 
+    {   node.realizeArticulatedBodyInertiasInward(ic,tpc,abc); });
 
     markCacheValueRealized(state, abx);
 }
@@ -1374,9 +1625,8 @@ realizeVelocityKinematics(const State& state) const {
     // and all global velocities relative to Ground (G). Also computes qdots.
 
     // Set generalized speeds: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; ++i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeVelocity(stateDigest); 
+    forEachNodeBaseToTip([&](const RigidBodyNode& node) 
+    {   node.realizeVelocity(stateDigest); });
 
     // Ask the constraints to calculate ancestor-relative velocity kinematics 
     // (still goes in TreeVelocityCache).
@@ -1452,11 +1702,11 @@ realizeArticulatedBodyVelocity(const State& state) const {
                                 abvc = updArticulatedBodyVelocityCache(state);
 
     // Order doesn't matter for this calculation. Ground's entries are
-    // precalculated so start at level 1.
-    for (int i=1 ; i<(int)rbNodeLevels.size() ; i++) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
-            rbNodeLevels[i][j]->realizeArticulatedBodyVelocityCache
-                                                            (tpc,tvc,abc,abvc);
+    // precalculated so skip it.
+    forEachNodeBaseToTip([&](const RigidBodyNode& node) {
+        if (node.getLevel() > 0)
+            node.realizeArticulatedBodyVelocityCache(tpc,tvc,abc,abvc);
+    });
 
     markCacheValueRealized(state, abvx);
 }
@@ -3509,6 +3759,44 @@ calcPVA(const State&     s,
 // advantage of that in forming the matrix, and (b) some constraints may
 // result in the force transmission matrix != G (this occurs for example for
 // some kinds of "working" constraints like sliding friction).
+namespace {
+// Each block of columns of GMInvGt costs three O(n) sweeps per column, so
+// small problems aren't worth splitting up.
+const int MinParallelGMInvGtColumns  = 16;
+const int MinGMInvGtColumnsPerBlock  = 4;
+}
+
+// Calculates a contiguous block of columns of GMInvGt. Each block has its own
+// scratch vectors and writes only its own columns of the result.
+class SimbodyMatterSubsystemRep::CalcGMInvGtTask 
+:   public ParallelExecutor::Task {
+public:
+    CalcGMInvGtTask(const SimbodyMatterSubsystemRep& matter, const State& s,
+                    const Vector& bias, int blockSize, Matrix& GMInvGt)
+    :   m_matter(matter), m_state(s), m_bias(bias), m_blockSize(blockSize), 
+        m_GMInvGt(GMInvGt) {}
+
+    void execute(int block) override {
+        const int m = m_GMInvGt.ncol();
+        const int begin = std::max(1, block*m_blockSize); // have column 0
+        const int end = std::min(block*m_blockSize + m_blockSize, m);
+        const int nu = m_matter.getNU(m_state);
+        const bool columnsAreContiguous = m_GMInvGt(0).hasContiguousData();
+        Vector GMInvGt_j(columnsAreContiguous ? 0 : m);
+        Vector Gtcol(nu), MInvGtcol(nu);
+        Vector lambda(m, Real(0));
+        for (int j=begin; j < end; ++j)
+            m_matter.calcGMInvGtColumn(m_state, m_bias, j, lambda, Gtcol,
+                                       MInvGtcol, GMInvGt_j, m_GMInvGt);
+    }
+private:
+    const SimbodyMatterSubsystemRep&    m_matter;
+    const State&                        m_state;
+    const Vector&                       m_bias;
+    const int                           m_blockSize;
+    Matrix&                             m_GMInvGt;
+};
+
 void SimbodyMatterSubsystemRep::
 calcGMInvGt(const State&   s,
             Matrix&        GMInvGt) const
@@ -3543,20 +3831,391 @@ calcGMInvGt(const State&   s,
     // element at a time of lambda will be 1, the rest are 0.
     Vector lambda(m, Real(0));
 
-    for (int j=0; j < m; ++j) {
-        lambda[j] = 1;
-        multiplyByPVATranspose(s, true, true, true, lambda, Gtcol);
-        lambda[j] = 0;
-        multiplyByMInv(s, Gtcol, MInvGtcol);
-        if (columnsAreContiguous)
-            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt(j));
-        else {
-            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt_j);
-            GMInvGt(j) = GMInvGt_j;
-        }
+    // The first column is always calculated here. That realizes the
+    // articulated body inertias and any lazily evaluated constraint cache 
+    // entries, after which the remaining columns only read the State.
+    calcGMInvGtColumn(s, bias, 0, lambda, Gtcol, MInvGtcol, GMInvGt_j, 
+                      GMInvGt);
+
+    int numThreads;
+    if (!shouldCalcConstraintColumnsInParallel(s, m, numThreads)) {
+        for (int j=1; j < m; ++j)
+            calcGMInvGtColumn(s, bias, j, lambda, Gtcol, MInvGtcol, 
+                              GMInvGt_j, GMInvGt);
+        return;
     }
+
+    const int numBlocks = ParallelExecutor::calcNumChunks(m, numThreads, 
+        MinGMInvGtColumnsPerBlock);
+    const int blockSize = (m + numBlocks-1)/numBlocks;
+    CalcGMInvGtTask task(*this, s, bias, blockSize, GMInvGt);
+    m_executor->execute(task, (m + blockSize-1)/blockSize);
 } 
 
+// Columns are calculated in parallel only if there are enough of them, we
+// aren't already on a worker thread, and every enabled constraint's error
+// and force methods can be called concurrently.
+bool SimbodyMatterSubsystemRep::
+shouldCalcConstraintColumnsInParallel(const State& s, int numColumns,
+                                      int& numThreads) const
+{
+    numThreads = std::min(getNumberOfThreads(),
+                          ParallelExecutor::getNumSharedThreads());
+    if (numThreads == 1 || numColumns < MinParallelGMInvGtColumns
+        || ParallelExecutor::isWorkerThread())
+        return false;
+    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx)
+        if (!isConstraintDisabled(s,cx) 
+            && !constraints[cx]->getImpl().isThreadSafe())
+            return false;
+    return true;
+}
+
+// Calculate column j of GMInvGt. All the vectors are caller-supplied scratch
+// of the right sizes; lambda must be all zero and is left that way.
+void SimbodyMatterSubsystemRep::
+calcGMInvGtColumn(const State&  s,
+                  const Vector& bias,
+                  int           j,
+                  Vector&       lambda,
+                  Vector&       Gtcol,
+                  Vector&       MInvGtcol,
+                  Vector&       GMInvGt_j,
+                  Matrix&       GMInvGt) const
+{
+    lambda[j] = 1;
+    multiplyByPVATranspose(s, true, true, true, lambda, Gtcol);
+    lambda[j] = 0;
+    multiplyByMInv(s, Gtcol, MInvGtcol);
+    if (GMInvGt(j).hasContiguousData())
+        multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt(j));
+    else {
+        multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt_j);
+        GMInvGt(j) = GMInvGt_j;
+    }
+}
+
+
+
+// =============================================================================
+//                          CALC G M^-1 G^T BLOCKS
+// =============================================================================
+// Scratch space for calculating columns of the diagonal blocks of GMInvGt.
+// The body- and mobility-sized arrays are allocated once and only the entries
+// belonging to one dynamically coupled constraint set are touched for each
+// column; those are always overwritten before they are read, except for the
+// body forces, which are accumulated and so are put back to zero after use.
+class SimbodyMatterSubsystemRep::ConstraintSpaceWorkspace {
+public:
+    ConstraintSpaceWorkspace(int nb, int nu, int nqAlloc)
+    :   F_G(nb, SpatialVec(Vec3(0))), zTmp(nb, SpatialVec(Vec3(0))),
+        z(nb, SpatialVec(Vec3(0))), zPlus(nb, SpatialVec(Vec3(0))),
+        V_GB(nb, SpatialVec(Vec3(0))), A_GB(nb, SpatialVec(Vec3(0))),
+        Gtcol(nu, Real(0)), MInvGtcol(nu, Real(0)), eps(nu, Real(0)), 
+        qlike(nqAlloc, Real(0)) {}
+
+    // Global arrays; Ground's entries of V_GB and A_GB stay zero.
+    Array_<SpatialVec>                      F_G, zTmp, z, zPlus;
+    Array_<SpatialVec,MobilizedBodyIndex>   V_GB, A_GB;
+    Array_<Real>                            Gtcol, MInvGtcol, eps, qlike;
+
+    // One constraint at a time, as in multiplyByPVATranspose() and 
+    // multiplyByPVA().
+    Array_<Real>                            lambda, err;
+    Array_<SpatialVec,ConstrainedBodyIndex> oneF_G, V_AB, A_AB;
+    Array_<Real,ConstrainedUIndex>          onefu, udot;
+    Array_<Real,ConstrainedQIndex>          onefq, qdot;
+};
+
+// Calculates the columns after the first of a contiguous range of blocks, 
+// with one workspace for the whole range.
+class SimbodyMatterSubsystemRep::CalcGMInvGtBlocksTask 
+:   public ParallelExecutor::Task {
+public:
+    CalcGMInvGtBlocksTask(const SimbodyMatterSubsystemRep& matter, 
+                          const State& s, const Vector& bias,
+                          const Array_<int>& setOfBlock,
+                          const Array_<int>& rangeStarts,
+                          Array_<ConstraintSpaceBlock>& blocks)
+    :   m_matter(matter), m_state(s), m_bias(bias), m_setOfBlock(setOfBlock),
+        m_rangeStarts(rangeStarts), m_blocks(blocks) {}
+
+    void execute(int range) override {
+        ConstraintSpaceWorkspace ws(m_matter.getNumBodies(), 
+                                    m_matter.getNU(m_state),
+                                    m_matter.getTotalQAlloc());
+        for (int b=m_rangeStarts[range]; b < m_rangeStarts[range+1]; ++b) {
+            const CoupledConstraintSet& cset = 
+                m_matter.dynamicallyCoupledConstraints[m_setOfBlock[b]];
+            for (int j=1; j < (int)m_blocks[b].equations.size(); ++j)
+                m_matter.calcGMInvGtBlockColumn(m_state, m_bias, cset, j, ws,
+                                                m_blocks[b]);
+        }
+    }
+private:
+    const SimbodyMatterSubsystemRep&    m_matter;
+    const State&                        m_state;
+    const Vector&                       m_bias;
+    const Array_<int>&                  m_setOfBlock;
+    const Array_<int>&                  m_rangeStarts;
+    Array_<ConstraintSpaceBlock>&       m_blocks;
+};
+
+void SimbodyMatterSubsystemRep::
+calcGMInvGtBlocks(const State&                   s,
+                  Array_<ConstraintSpaceBlock>&  blocks) const
+{
+    const SBInstanceCache& ic = getInstanceCache(s);
+
+    const int mHolo    = ic.totalNHolonomicConstraintEquationsInUse;
+    const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
+    const int mAccOnly = ic.totalNAccelerationOnlyConstraintEquationsInUse;
+    const int m        = mHolo+mNonholo+mAccOnly;  
+
+    if (m==0) {blocks.clear(); return;}
+
+    // One block for each set with any equations in use. Within a block each 
+    // constraint's holonomic equations come first, then its nonholonomic and
+    // acceleration-only ones, following the sets' constraint order. Existing
+    // blocks are reused.
+    Array_<int> setOfBlock;
+    for (int set=0; set < (int)dynamicallyCoupledConstraints.size(); ++set) {
+        Array_<int> equations;
+        for (ConstraintIndex cx : 
+             dynamicallyCoupledConstraints[set].getCoupledConstraints()) {
+            if (isConstraintDisabled(s,cx))
+                continue;
+            const SBInstancePerConstraintInfo& 
+                cInfo = ic.getConstraintInstanceInfo(cx);
+            const Segment& holoSeg    = cInfo.holoErrSegment;
+            const Segment& nonholoSeg = cInfo.nonholoErrSegment;
+            const Segment& accOnlySeg = cInfo.accOnlyErrSegment;
+            for (int i=0; i < holoSeg.length; ++i)
+                equations.push_back(holoSeg.offset + i);
+            for (int i=0; i < nonholoSeg.length; ++i)
+                equations.push_back(mHolo + nonholoSeg.offset + i);
+            for (int i=0; i < accOnlySeg.length; ++i)
+                equations.push_back(mHolo + mNonholo + accOnlySeg.offset + i);
+        }
+        if (equations.empty())
+            continue;
+        if (setOfBlock.size() == blocks.size())
+            blocks.push_back(ConstraintSpaceBlock());
+        ConstraintSpaceBlock& block = blocks[setOfBlock.size()];
+        block.equations = equations;
+        block.GMInvGt.resize(equations.size(), equations.size());
+        setOfBlock.push_back(set);
+    }
+    const int numBlocks = (int)setOfBlock.size();
+    blocks.resize(numBlocks);
+
+    Vector bias(m);
+    calcBiasForMultiplyByPVA(s,true,true,true,bias);
+    realizeArticulatedBodyInertias(s); // (may already have been realized)
+
+    // The first column of each block is always calculated here. That 
+    // realizes any lazily evaluated constraint cache entries, after which the
+    // remaining columns only read the State.
+    ConstraintSpaceWorkspace ws(getNumBodies(), getNU(s), getTotalQAlloc());
+    for (int b=0; b < numBlocks; ++b)
+        calcGMInvGtBlockColumn(s, bias, 
+            dynamicallyCoupledConstraints[setOfBlock[b]], 0, ws, blocks[b]);
+
+    int numThreads;
+    if (!shouldCalcConstraintColumnsInParallel(s, m-numBlocks, numThreads)) {
+        for (int b=0; b < numBlocks; ++b) {
+            const CoupledConstraintSet& cset = 
+                dynamicallyCoupledConstraints[setOfBlock[b]];
+            for (int j=1; j < (int)blocks[b].equations.size(); ++j)
+                calcGMInvGtBlockColumn(s, bias, cset, j, ws, blocks[b]);
+        }
+        return;
+    }
+
+    // Group whole blocks into ranges of similar numbers of columns.
+    Array_<int> rangeStarts(1, 0);
+    ParallelExecutor::appendChunksByCost(numBlocks,
+        [&](int b) {return Real(blocks[b].equations.size() - 1);},
+        ParallelExecutor::calcTargetChunkCost(Real(m - numBlocks), numThreads,
+                                              MinGMInvGtColumnsPerBlock),
+        rangeStarts);
+    CalcGMInvGtBlocksTask task(*this, s, bias, setOfBlock, rangeStarts, 
+                               blocks);
+    m_executor->execute(task, (int)rangeStarts.size()-1);
+}
+
+// Calculate column j of one block of GMInvGt: apply a unit multiplier to the
+// block's j'th constraint equation, then map the resulting forces through
+// M^-1 and G using sweeps over only the bodies of the block's constraint set.
+// Complexity is O(n+m) for the set's bodies and constraint equations.
+void SimbodyMatterSubsystemRep::
+calcGMInvGtBlockColumn(const State&                 s,
+                       const Vector&                bias,
+                       const CoupledConstraintSet&  cset,
+                       int                          j,
+                       ConstraintSpaceWorkspace&    ws,
+                       ConstraintSpaceBlock&        block) const
+{
+    const SBInstanceCache&               ic  = getInstanceCache(s);
+    const SBTreePositionCache&           tpc = getTreePositionCache(s);
+    const SBArticulatedBodyInertiaCache& abc = 
+                                        getArticulatedBodyInertiaCache(s);
+
+    const int mHolo    = ic.totalNHolonomicConstraintEquationsInUse;
+    const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
+
+    const RBNodePtrList& nodes = cset.getNodes();
+    const int e = block.equations[j];
+
+    // Find the constraint that generates equation e and apply a unit 
+    // multiplier to it; see multiplyByPVATranspose().
+    for (ConstraintIndex cx : cset.getCoupledConstraints()) {
+        if (isConstraintDisabled(s,cx))
+            continue;
+        const SBInstancePerConstraintInfo& 
+            cInfo = ic.getConstraintInstanceInfo(cx);
+        const Segment& holoSeg    = cInfo.holoErrSegment;
+        const Segment& nonholoSeg = cInfo.nonholoErrSegment;
+        const Segment& accOnlySeg = cInfo.accOnlyErrSegment;
+        const int k = e < mHolo ? e - holoSeg.offset
+            : e < mHolo+mNonholo ? e - mHolo - nonholoSeg.offset
+            : e - mHolo - mNonholo - accOnlySeg.offset;
+        const int length = e < mHolo ? holoSeg.length
+            : e < mHolo+mNonholo ? nonholoSeg.length : accOnlySeg.length;
+        if (k < 0 || k >= length)
+            continue;
+
+        const ConstraintImpl& crep = constraints[cx]->getImpl();
+        const int ncb = crep.getNumConstrainedBodies();
+        const int ncu = cInfo.getNumConstrainedU();
+        ws.oneF_G.resize(ncb);                ws.onefu.resize(ncu);
+        ws.oneF_G.fill(SpatialVec(Vec3(0)));  ws.onefu.fill(Real(0));
+        ws.lambda.resize(length);             ws.lambda.fill(Real(0));
+        ws.lambda[k] = 1;
+        if (e < mHolo) {
+            ws.onefq.resize(cInfo.getNumConstrainedQ());
+            ws.onefq.fill(Real(0));
+            crep.addInPositionConstraintForces(s, ws.lambda, ws.oneF_G, 
+                                               ws.onefq);
+            crep.convertQForcesToUForces(s, ws.onefq, ws.onefu);
+        } else if (e < mHolo+mNonholo)
+            crep.addInVelocityConstraintForces(s, ws.lambda, ws.oneF_G, 
+                                               ws.onefu);
+        else
+            crep.addInAccelerationConstraintForces(s, ws.lambda, ws.oneF_G, 
+                                                   ws.onefu);
+
+        if (crep.isAncestorDifferentFromGround()) {
+            const Rotation& R_GA = 
+                crep.getAncestorMobilizedBody().getBodyRotation(s);
+            for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx)
+                ws.oneF_G[cbx] = R_GA*ws.oneF_G[cbx];
+        }
+        for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx)
+            ws.F_G[crep.getMobilizedBodyIndexOfConstrainedBody(cbx)] 
+                += ws.oneF_G[cbx];
+
+        // Gtcol = ~J*F_G + fu over this set's bodies only.
+        for (int i=(int)nodes.size()-1; i >= 0; --i)
+            nodes[i]->multiplyBySystemJacobianTranspose(tpc, ws.zTmp.begin(),
+                ws.F_G.begin(), ws.Gtcol.begin());
+        for (ConstrainedUIndex cux(0); cux < ncu; ++cux) 
+            ws.Gtcol[cInfo.getUIndexFromConstrainedU(cux)] += ws.onefu[cux];
+
+        for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx)
+            ws.F_G[crep.getMobilizedBodyIndexOfConstrainedBody(cbx)] =
+                SpatialVec(Vec3(0));
+        break;
+    }
+
+    // MInvGtcol = M^-1*Gtcol; see multiplyByMInv().
+    for (int i=(int)nodes.size()-1; i >= 0; --i)
+        nodes[i]->multiplyByMInvPass1Inward(ic, tpc, abc, ws.Gtcol.cbegin(),
+            ws.z.begin(), ws.zPlus.begin(), ws.eps.begin());
+    for (int i=0; i < (int)nodes.size(); ++i)
+        nodes[i]->multiplyByMInvPass2Outward(ic, tpc, abc, ws.eps.cbegin(),
+            ws.A_GB.begin(), ws.MInvGtcol.begin());
+
+    // Finally G*MInvGtcol - bias for the set's equations; see multiplyByPVA().
+    // Here A_GB is J*MInvGtcol to start with, then gets the coriolis terms.
+    for (int i=0; i < (int)nodes.size(); ++i)
+        nodes[i]->multiplyBySystemJacobian(tpc, ws.MInvGtcol.cbegin(), 
+                                           ws.V_GB.begin());
+    if (mHolo) {
+        const SBStateDigest sbState(s, *this, Stage(Stage::Position).next());
+        for (int i=0; i < (int)nodes.size(); ++i) {
+            const RigidBodyNode& rbn = *nodes[i];
+            const int maxNQ = rbn.getMaxNQ();
+            if (maxNQ == 0)
+                continue;
+            ws.qlike[rbn.getQIndex() + maxNQ-1] = 0;
+            rbn.multiplyByN(sbState, false, &ws.MInvGtcol[rbn.getUIndex()],
+                            &ws.qlike[rbn.getQIndex()]);
+        }
+    }
+    if (ic.totalNNonholonomicConstraintEquationsInUse 
+        || ic.totalNAccelerationOnlyConstraintEquationsInUse) {
+        const Array_<SpatialVec>& 
+            allAC_GB = getTreeVelocityCache(s).totalCoriolisAcceleration;
+        for (int i=0; i < (int)nodes.size(); ++i) {
+            const MobilizedBodyIndex mbx = nodes[i]->getNodeNum();
+            ws.A_GB[mbx] = ws.V_GB[mbx] + allAC_GB[mbx];
+        }
+    }
+
+    int row = 0;
+    for (ConstraintIndex cx : cset.getCoupledConstraints()) {
+        if (isConstraintDisabled(s,cx))
+            continue;
+        const SBInstancePerConstraintInfo& 
+            cInfo = ic.getConstraintInstanceInfo(cx);
+        const ConstraintImpl& crep = constraints[cx]->getImpl();
+        const Segment& holoSeg    = cInfo.holoErrSegment;
+        const Segment& nonholoSeg = cInfo.nonholoErrSegment;
+        const Segment& accOnlySeg = cInfo.accOnlyErrSegment;
+        const int mp = holoSeg.length;
+        const int mv = nonholoSeg.length;
+        const int ma = accOnlySeg.length;
+
+        if (mp) {
+            const int ncq = cInfo.getNumConstrainedQ();
+            crep.convertBodyVelocityToConstrainedBodyVelocity(s, ws.V_GB, 
+                                                              ws.V_AB);
+            ws.qdot.resize(ncq);
+            for (ConstrainedQIndex cqx(0); cqx < ncq; ++cqx)
+                ws.qdot[cqx] = ws.qlike[cInfo.getQIndexFromConstrainedQ(cqx)];
+            ws.err.resize(mp);
+            crep.calcPositionDotErrors(s, ws.V_AB, ws.qdot, ws.err);
+            for (int i=0; i < mp; ++i, ++row)
+                block.GMInvGt(row,j) = ws.err[i] - bias[holoSeg.offset+i];
+        }
+
+        if (!(mv || ma))
+            continue;
+
+        const int ncu = cInfo.getNumConstrainedU();
+        crep.convertBodyAccelToConstrainedBodyAccel(s, ws.A_GB, ws.A_AB);
+        ws.udot.resize(ncu);
+        for (ConstrainedUIndex cux(0); cux < ncu; ++cux)
+            ws.udot[cux] = ws.MInvGtcol[cInfo.getUIndexFromConstrainedU(cux)];
+
+        if (mv) {
+            const int start = mHolo + nonholoSeg.offset;
+            ws.err.resize(mv);
+            crep.calcVelocityDotErrors(s, ws.A_AB, ws.udot, ws.err);
+            for (int i=0; i < mv; ++i, ++row)
+                block.GMInvGt(row,j) = ws.err[i] - bias[start+i];
+        }
+        if (ma) {
+            const int start = mHolo + mNonholo + accOnlySeg.offset;
+            ws.err.resize(ma);
+            crep.calcAccelerationErrors(s, ws.A_AB, ws.udot, ws.err);
+            for (int i=0; i < ma; ++i, ++row)
+                block.GMInvGt(row,j) = ws.err[i] - bias[start+i];
+        }
+    }
+}
+
 
 
 // =============================================================================
@@ -3570,14 +4229,162 @@ solveForConstraintImpulses(const State&     state,
                            const Vector&    deltaV,
                            Vector&          impulse) const
 {
-    Matrix GMInvGt;
-    calcGMInvGt(state, GMInvGt);
-    // MUST DUPLICATE SIMBODY'S METHOD HERE:
-    const Real conditioningTol = GMInvGt.nrow() 
-                                    * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-    qtz.solve(deltaV, impulse);
+    // This must be the same method Simbody uses for the multipliers.
+    solveWithConstraintFactorization(state, deltaV, impulse);
+}
+
+
+
+// =============================================================================
+//                     REALIZE CONSTRAINT FACTORIZATION
+// =============================================================================
+void SimbodyMatterSubsystemRep::
+realizeConstraintFactorization(const State& s) const {
+    if (isConstraintFactorizationRealized(s))
+        return; // already realized
+
+    const int mHolo    = getNumHolonomicConstraintEquationsInUse(s);
+    const int mNonholo = getNumNonholonomicConstraintEquationsInUse(s);
+    const int mAccOnly = getNumAccelerationOnlyConstraintEquationsInUse(s);
+    const int m        = mHolo+mNonholo+mAccOnly;
+
+    // Conditioning tolerance. This determines when we'll drop a 
+    // constraint. 
+    // TODO: this is probably too tight; should depend on constraint tolerance
+    // and should be consistent with position and velocity projection ranks.
+    // Tricky here because conditioning depends on mass matrix as well as
+    // constraints.
+    const Real conditioningTol = m 
+        //* SignificantReal;
+        * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
+
+    // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
+    // I know how to do, O(m*n) with O(n) temporary memory, using a series
+    // of O(n) operators. Then we'll factor it here in O(m^3) time. 
+    // If the constraints fall into independent groups, G*M^-1*G^T is block
+    // diagonal (after reordering) and we calculate and factor just the 
+    // blocks instead.
+    SBConstraintFactorizationCache& cfc = updConstraintFactorizationCache(s);
+    if (getNumDynamicallyCoupledConstraintSets() > 1)
+        calcGMInvGtBlocks(s, cfc.blocks);
+    else {
+        cfc.blocks.resize(m==0 ? 0 : 1);
+        if (m) {
+            ConstraintSpaceBlock& block = cfc.blocks.front();
+            block.equations.resize(m);
+            for (int i=0; i < m; ++i)
+                block.equations[i] = i;
+            block.GMInvGt.resize(m,m);
+            calcGMInvGt(s, block.GMInvGt);
+        }
+    }
+
+    // G*M^-1*~G is symmetric only if every enabled constraint applies its
+    // forces through ~G.
+    bool isSymmetric = true;
+    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx)
+        if (!isConstraintDisabled(s,cx) 
+            && !constraints[cx]->getImpl().hasSymmetricForceTransmission())
+            isSymmetric = false;
+
+    for (ConstraintSpaceBlock& block : cfc.blocks)
+        block.factor(isSymmetric, conditioningTol);
+
+    cfc.dependsOnU = (mNonholo+mAccOnly > 0);
+    cfc.uVersion   = s.getUValueVersion();
+    markCacheValueRealized(s, topologyCache.constraintFactorizationCacheIndex);
+}
+
+bool SimbodyMatterSubsystemRep::
+isConstraintFactorizationRealized(const State& s) const {
+    const CacheEntryIndex cfx = topologyCache.constraintFactorizationCacheIndex;
+    if (!isCacheValueRealized(s, cfx))
+        return false;
+    const SBConstraintFactorizationCache& cfc = 
+        getConstraintFactorizationCache(s);
+    return !cfc.dependsOnU || cfc.uVersion == s.getUValueVersion();
+}
+
+void SimbodyMatterSubsystemRep::
+solveWithConstraintFactorization(const State&   s,
+                                 const Vector&  b,
+                                 Vector&        x) const
+{
+    realizeConstraintFactorization(s);
+    const SBConstraintFactorizationCache& cfc = 
+        getConstraintFactorizationCache(s);
+
+    x.resize(b.size());
+    Vector blockB, blockX;
+    for (const ConstraintSpaceBlock& block : cfc.blocks) {
+        const int mb = (int)block.equations.size();
+        blockB.resize(mb);
+        for (int i=0; i < mb; ++i)
+            blockB[i] = b[block.equations[i]];
+        block.solve(blockB, blockX);
+        for (int i=0; i < mb; ++i)
+            x[block.equations[i]] = blockX[i];
+    }
+}
+
+// Factor a copy of GMInvGt as L*D*~L if it is symmetric and the previous 
+// factorization had full rank. This is a right-looking factorization of the
+// lower triangle without pivoting. The pivots of a symmetric positive 
+// semidefinite matrix lie between its extreme eigenvalues, so we accept the
+// factorization only if they are all positive and the smallest is within a 
+// factor of sqrt(conditioningTol) of the largest. That keeps it well clear of
+// the conditioning at which QTZ, which judges the whole matrix with the same
+// tolerance, would find a redundant constraint equation; otherwise GMInvGt
+// is given to QTZ exactly as it was calculated.
+void ConstraintSpaceBlock::factor(bool isSymmetric, Real conditioningTol) {
+    const int m = GMInvGt.nrow();
+    isFactoredLDLt = false;
+    if (isSymmetric && hadFullRank) {
+        LDLt = GMInvGt;
+        Real minPivot = Infinity, maxPivot = 0;
+        int j = 0;
+        for (; j < m; ++j) {
+            const Real d = LDLt(j,j);
+            if (!(d > 0))
+                break;
+            minPivot = std::min(minPivot, d);
+            maxPivot = std::max(maxPivot, d);
+            const Real ood = 1/d;
+            for (int i=j+1; i < m; ++i)
+                LDLt(i,j) *= ood;
+            for (int k=j+1; k < m; ++k) {
+                const Real dLkj = d*LDLt(k,j);
+                for (int i=k; i < m; ++i)
+                    LDLt(i,k) -= LDLt(i,j)*dLkj;
+            }
+        }
+        isFactoredLDLt = 
+            (j == m && minPivot > std::sqrt(conditioningTol)*maxPivot);
+        if (isFactoredLDLt)
+            return;
+    }
+
+    qtz.factor(GMInvGt, conditioningTol);
+    hadFullRank = (qtz.getRank() == m);
+}
+
+void ConstraintSpaceBlock::solve(const Vector& b, Vector& x) const {
+    if (!isFactoredLDLt) {
+        qtz.solve(b, x);
+        return;
+    }
+    const int m = LDLt.nrow();
+    x = b;
+    for (int j=0; j < m; ++j)       // L y = b
+        for (int i=j+1; i < m; ++i)
+            x[i] -= LDLt(i,j)*x[j];
+    for (int j=0; j < m; ++j)       // D z = y
+        x[j] /= LDLt(j,j);
+    for (int j=m-1; j >= 0; --j)    // ~L x = z
+        for (int i=j+1; i < m; ++i)
+            x[j] -= LDLt(i,j)*x[i];
 }
+//...................... REALIZE CONSTRAINT FACTORIZATION ......................
 
 
 
@@ -5107,32 +5914,12 @@ void SimbodyMatterSubsystemRep::calcLoopForwardDynamicsOperator
     if (m==0) return;
     if (nu==0) {multipliers.setToZero(); return;}
 
-    // Conditioning tolerance. This determines when we'll drop a 
-    // constraint. 
-    // TODO: this is probably too tight; should depend on constraint tolerance
-    // and should be consistent with position and velocity projection ranks.
-    // Tricky here because conditioning depends on mass matrix as well as
-    // constraints.
-    const Real conditioningTol = m 
-        //* SignificantReal;
-        * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-
     // Calculate multipliers lambda as
     //     (G M^-1 ~G) lambda = aerr
-    // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
-    // I know how to do, O(m*n) with O(n) temporary memory, using a series
-    // of O(n) operators. Then we'll factor it here in O(m^3) time. 
-    Matrix GMInvGt(m,m);
-    calcGMInvGt(s, GMInvGt);
-    
-    // specify 1/cond at which we declare rank deficiency
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-
-    //printf("fwdDynamics: m=%d condTol=%g rank=%d rcond=%g\n",
-    //    GMInvGt.nrow(), conditioningTol, qtz.getRank(),
-    //    qtz.getRCondEstimate());
-
-    qtz.solve(udotErr, multipliers);
+    // G M^-1 ~G depends only on time and positions (with rare exceptions), 
+    // so its factorization is kept in the State and reused by every call 
+    // at the same positions.
+    solveWithConstraintFactorization(s, udotErr, multipliers);
 
     // We have the multipliers, now turn them into forces.
 
@@ -5324,22 +6111,18 @@ void SimbodyMatterSubsystemRep::calcTreeAccelerations(const State& s,
     for (int i=0; i < (int)ic.zeroUDot.size(); ++i)
         udotPtr[ic.zeroUDot[i]] = 0;
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass1Inward(ic,tpc,abc,abvc,
-                mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
-                hingeForcePtr);
-        }
+    forEachNodeTipToBase([&](const RigidBodyNode& node) {
+        node.calcUDotPass1Inward(ic,tpc,abc,abvc,
+            mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
+            hingeForcePtr);
+    });
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
-                hingeForcePtr, aPtr, udotPtr, tauPtr);
-            node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
-                             &qdotdotPtr[node.getQIndex()]);
-        }
+    forEachNodeBaseToTip([&](const RigidBodyNode& node) {
+        node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
+            hingeForcePtr, aPtr, udotPtr, tauPtr);
+        node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
+                         &qdotdotPtr[node.getQIndex()]);
+    });
 }
 //......................... CALC TREE ACCELERATIONS ............................
 
@@ -5384,19 +6167,15 @@ void SimbodyMatterSubsystemRep::multiplyByMInv(const State& s,
     const Real* fPtr     = &f[0];       
     Real*       MInvfPtr = &MInvf[0];
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass1Inward(ic,tpc,abc,
-                fPtr, z.begin(), zPlus.begin(), eps.begin());
-        }
+    forEachNodeTipToBase([&](const RigidBodyNode& node) {
+        node.multiplyByMInvPass1Inward(ic,tpc,abc,
+            fPtr, z.begin(), zPlus.begin(), eps.begin());
+    });
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass2Outward(ic,tpc,abc, 
-                eps.cbegin(), A_GB.begin(), MInvfPtr);
-        }
+    forEachNodeBaseToTip([&](const RigidBodyNode& node) {
+        node.multiplyByMInvPass2Outward(ic,tpc,abc, 
+            eps.cbegin(), A_GB.begin(), MInvfPtr);
+    });
 }
 //............................. CALC M INVERSE F ...............................
 
@@ -5433,17 +6212,13 @@ void SimbodyMatterSubsystemRep::multiplyByM(const State&    s,
     const Real* aPtr    = &a[0];       
     Real*       MaPtr   = &Ma[0];
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMPass1Outward(tpc, aPtr, A_GB.begin());
-        }
+    forEachNodeBaseToTip([&](const RigidBodyNode& node) {
+        node.multiplyByMPass1Outward(tpc, aPtr, A_GB.begin());
+    });
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMPass2Inward(tpc,A_GB.cbegin(),fTmp.begin(),MaPtr);
-        }
+    forEachNodeTipToBase([&](const RigidBodyNode& node) {
+        node.multiplyByMPass2Inward(tpc,A_GB.cbegin(),fTmp.begin(),MaPtr);
+    });
 }
 
 
@@ -5598,21 +6373,17 @@ void SimbodyMatterSubsystemRep::calcTreeResidualForces(const State& s,
                         ? &residualMobilityForces[0] : NULL;
     SpatialVec* tempPtr = allFTmp.size() ? &allFTmp[0] : NULL;
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcBodyAccelerationsFromUdotOutward
-               (tpc,tvc,knownUdotPtr,aPtr);
-        }
-
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcInverseDynamicsPass2Inward(
-                tpc,tvc,aPtr,
-                mobilityForcePtr,bodyForcePtr,
-                tempPtr,residualPtr);
-        }
+    forEachNodeBaseToTip([&](const RigidBodyNode& node) {
+        node.calcBodyAccelerationsFromUdotOutward
+           (tpc,tvc,knownUdotPtr,aPtr);
+    });
+
+    forEachNodeTipToBase([&](const RigidBodyNode& node) {
+        node.calcInverseDynamicsPass2Inward(
+            tpc,tvc,aPtr,
+            mobilityForcePtr,bodyForcePtr,
+            tempPtr,residualPtr);
+    });
 }
 //........................ CALC TREE RESIDUAL FORCES ...........................
 
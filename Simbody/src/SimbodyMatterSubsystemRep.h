@@ -105,18 +105,25 @@ public:
         return coupledConstraints;
     }
 
+    // The nodes of the mobilized bodies that the included Constraints can
+    // affect, ordered by level (Ground excluded). Only filled in for the
+    // dynamically coupled sets.
+    void addNode(const RigidBodyNode* node) {nodes.push_back(node);}
+    const RBNodePtrList& getNodes() const {return nodes;}
+
 private:
     // TOPOLOGY STATE
     std::set<ConstraintIndex> constraints;
+    RBNodePtrList             nodes;
 
     // TOPOLOGY CACHE
     bool topologyRealized;
 
     // Sorted in nondecreasing order of ancestor MobilizedBodyIndex.
     Array_<ConstraintIndex>    coupledConstraints;
-    SimbodyMatterSubtree coupledSubtree; // with the new ancestor
 };
 
+
     //////////////////////////////////
     // SIMBODY MATTER SUBSYSTEM REP //
     //////////////////////////////////
@@ -144,6 +151,10 @@ public:
       : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1")
     { 
         clearTopologyCache();
+        // The default number of threads is the number of processors; call
+        // setNumberOfThreads() to override it.
+        m_executor = new ParallelExecutor();
+        m_executor->setScheduling(ParallelExecutor::WorkStealingScheduling);
     }
 
     SimbodyMatterSubsystemRep(const SimbodyMatterSubsystemRep&);
@@ -933,9 +944,78 @@ public:
     // Performance is best if the output matrix has columns stored 
     // contiguously in memory, but this method will work anyway, in that case
     // using a contiguous temporary for column calculations and then copying
-    // out into the result.
+    // out into the result. The columns are independent, so blocks of them are
+    // calculated in parallel when there are enough of them and every enabled
+    // constraint is thread safe.
     void calcGMInvGt(const State&   state,
                      Matrix&        GMInvGt) const;
+    void calcGMInvGtColumn(const State& state, const Vector& bias, int j,
+                           Vector& lambda, Vector& Gtcol, Vector& MInvGtcol,
+                           Vector& GMInvGt_j, Matrix& GMInvGt) const;
+    class CalcGMInvGtTask;
+
+    // Call nodeFunc(node) for each node at one level of the tree. Nodes at 
+    // the same level are independent, so if level parallelism is enabled
+    // and the level is wide enough it is split into chunks of nodes that are
+    // processed in parallel. Base-to-tip and tip-to-base recursions call this
+    // for each level in turn.
+    template <class NodeFunc>
+    void forEachNodeAtLevel(int level, const NodeFunc& nodeFunc) const;
+
+    // Call nodeFunc(node) for every node, each after its parent (base to 
+    // tip) or each after its children (tip to base). If subtree parallelism
+    // is enabled and Ground has more than one independent subtree, each 
+    // thread takes a range of whole subtrees and sweeps them without 
+    // waiting for the other threads between levels. Otherwise this goes 
+    // level by level using forEachNodeAtLevel().
+    template <class NodeFunc>
+    void forEachNodeBaseToTip(const NodeFunc& nodeFunc) const;
+    template <class NodeFunc>
+    void forEachNodeTipToBase(const NodeFunc& nodeFunc) const;
+
+    // Helper for the above; returns false without doing anything if the 
+    // subtrees should not be processed in parallel.
+    template <class NodeFunc>
+    bool forEachNodeInSubtrees(const NodeFunc& nodeFunc, bool inward) const;
+
+    // Decide whether numColumns independent columns of a constraint-space
+    // operator should be calculated in parallel, and on how many threads.
+    bool shouldCalcConstraintColumnsInParallel(const State& state, 
+                                               int numColumns, 
+                                               int& numThreads) const;
+
+    // Calculate only the nonzero diagonal blocks of G*M^-1*~G, one for each
+    // dynamically coupled set of constraints with any equations in use. Each
+    // column of a block costs sweeps over just the bodies that set's
+    // constraints can affect, so many small independent loops cost close to
+    // O(m+n) altogether rather than O(m*n). Same stage requirements as
+    // calcGMInvGt().
+    void calcGMInvGtBlocks(const State&                   state,
+                           Array_<ConstraintSpaceBlock>&  blocks) const;
+    class ConstraintSpaceWorkspace;
+    class CalcGMInvGtBlocksTask;
+    void calcGMInvGtBlockColumn(const State& state, const Vector& bias,
+                                const CoupledConstraintSet& cset, int j,
+                                ConstraintSpaceWorkspace& ws,
+                                ConstraintSpaceBlock& block) const;
+
+    int getNumDynamicallyCoupledConstraintSets() const
+    {   return (int)dynamicallyCoupledConstraints.size(); }
+
+    // Calculate and factor G*M^-1*~G, or just its nonzero diagonal blocks if
+    // there is more than one dynamically coupled set of constraints, unless
+    // that has already been done for the current time and positions (and 
+    // velocities, if there are nonholonomic or acceleration-only constraints).
+    // Call at Position stage or later; see SBConstraintFactorizationCache.
+    void realizeConstraintFactorization(const State& state) const;
+    bool isConstraintFactorizationRealized(const State& state) const;
+
+    // Solve (G*M^-1*~G) x = b for x using the factorization above, realizing
+    // it first if necessary. This is how Simbody deals with constraint 
+    // redundancies, for both multipliers and impulses.
+    void solveWithConstraintFactorization(const State&  state,
+                                          const Vector& b,
+                                          Vector&       x) const;
 
     // Use factored GMInvGt to solve GMinvGt*impulse=deltaV. The main benefit
     // of this method is that it promises to use the same method Simbody does
@@ -1076,6 +1156,17 @@ public:
             (updCacheEntry(s,topologyCache.articulatedBodyInertiaCacheIndex));
     }
 
+    const SBConstraintFactorizationCache& 
+    getConstraintFactorizationCache(const State& s) const {
+        return Value<SBConstraintFactorizationCache>::downcast
+            (getCacheEntry(s,topologyCache.constraintFactorizationCacheIndex));
+    }
+    SBConstraintFactorizationCache& 
+    updConstraintFactorizationCache(const State& s) const { //mutable
+        return Value<SBConstraintFactorizationCache>::updDowncast
+            (updCacheEntry(s,topologyCache.constraintFactorizationCacheIndex));
+    }
+
     const SBTreeVelocityCache& getTreeVelocityCache(const State& state) const {
         return Value<SBTreeVelocityCache>::downcast
            (state.getCacheEntry(getMySubsystemIndex(),
@@ -1210,6 +1301,33 @@ public:
     bool getShowDefaultGeometry() const;
     void setShowDefaultGeometry(bool show);
 
+    void setNumberOfThreads(unsigned numThreads) {
+        SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "SimbodyMatterSubsystemRep",
+            "setNumberOfThreads", "Number of threads must be positive");
+        m_executor = new ParallelExecutor(numThreads,
+            ParallelExecutor::WorkStealingScheduling);
+    }
+
+    int getNumberOfThreads() const {return m_executor->getMaxThreads();}
+
+    void setUseLevelParallelism(bool useLevelParallelism) 
+    {   m_useLevelParallelism = useLevelParallelism; }
+    bool getUseLevelParallelism() const {return m_useLevelParallelism;}
+
+    void setMinParallelLevelWidth(int minWidth) {
+        SimTK_APIARGCHECK_ALWAYS(minWidth > 0, "SimbodyMatterSubsystemRep",
+            "setMinParallelLevelWidth", "Minimum level width must be positive");
+        m_minParallelLevelWidth = minWidth;
+    }
+    int getMinParallelLevelWidth() const {return m_minParallelLevelWidth;}
+
+    void setUseSubtreeParallelism(bool useSubtreeParallelism) 
+    {   m_useSubtreeParallelism = useSubtreeParallelism; }
+    bool getUseSubtreeParallelism() const {return m_useSubtreeParallelism;}
+
+    int getNumIndependentSubtrees() const 
+    {   return std::max((int)independentSubtreeStarts.size()-1, 0); }
+
     void calcTreeForwardDynamicsOperator(const State&,
         const Vector&                   mobilityForces,
         const Vector_<Vec3>&            particleForces,
@@ -1398,11 +1516,22 @@ private:
     // These groups correspond to disjoint blocks in M (as
     // well as G, of course), so we can decouple them for the (G M^-1 G^T) 
     // calculation.
+    // These are built by endConstruction() from all the Constraints, enabled
+    // or not; see calcGMInvGtBlocks().
     // TODO: acceleration constraints should instead be dealt with recursively,
     // based on *kinematic* coupling; where the kinematically coupled groups are
     // used to modify the articulated body inertias.
     Array_<CoupledConstraintSet> dynamicallyCoupledConstraints;
 
+    // The non-Ground nodes grouped by independent subtree of Ground: the
+    // branches of each dynamically coupled set above, or a single branch
+    // that no Constraint couples to another. Subtree t occupies 
+    // independentSubtreeNodes[independentSubtreeStarts[t]] up to (but not
+    // including) independentSubtreeStarts[t+1], ordered by level. Built by
+    // endConstruction(); see forEachNodeInSubtrees().
+    RBNodePtrList                independentSubtreeNodes;
+    Array_<int>                  independentSubtreeStarts;
+
 
     // TODO: these state indices and counters should be deferred to realizeModel()
     // so we can have Model stage variables which change the number of state
@@ -1436,6 +1565,15 @@ private:
     
     // Specifies whether default decorative geometry should be shown.
     bool showDefaultGeometry;
+
+    // For calculating independent columns of operators, and the nodes within
+    // each level of the tree, in parallel.
+    mutable ClonePtr<ParallelExecutor> m_executor;
+
+    // Level- and subtree-parallel tree recursions are opt-in.
+    bool m_useLevelParallelism{false};
+    int  m_minParallelLevelWidth{64};
+    bool m_useSubtreeParallelism{false};
 };
 
 std::ostream& operator<<(std::ostream&, const SimbodyMatterSubsystemRep&);
@@ -63,6 +63,7 @@ receive a state evaluated to stage Whatever-1 equipped with values for stage
 Whatever so that it can calculate results and put them in the cache (which is 
 allocated if necessary), and then advance to stage Whatever. */
 
+#include "SimTKmath.h"
 #include "simbody/internal/common.h"
 #include "simbody/internal/Motion.h"
 
@@ -92,6 +93,7 @@ class SBConstrainedVelocityCache;
 class SBDynamicsCache;
 class SBTreeAccelerationCache;
 class SBConstrainedAccelerationCache;
+class SBConstraintFactorizationCache;
 
 class SBModelVars;
 class SBInstanceVars;
@@ -156,7 +158,8 @@ public:
                           articulatedBodyVelocityCacheIndex,
                           dynamicsCacheIndex, 
                           treeAccelerationCacheIndex, 
-                          constrainedAccelerationCacheIndex;
+                          constrainedAccelerationCacheIndex,
+                          constraintFactorizationCacheIndex;
 
 
     // These are instance variables that exist regardless of modeling
@@ -1230,6 +1233,66 @@ public:
 
 
 
+// =============================================================================
+//                       CONSTRAINT FACTORIZATION CACHE
+// =============================================================================
+// One diagonal block of the constraint-space matrix G*M^-1*~G, belonging to
+// one of the dynamically coupled constraint sets, and its factorization. The
+// block's rows and columns correspond to the constraint equations listed in
+// "equations", by their index among all the constraint equations in use. 
+// Entries of G*M^-1*~G coupling two different blocks are zero.
+//
+// G*M^-1*~G is positive semidefinite, and symmetric as long as every
+// constraint applies its forces through ~G. In that case, if the previous 
+// factorization of this block had full rank, we first try an L*D*~L 
+// factorization without pivoting in a copy of GMInvGt. If its pivots show
+// that the block is anywhere near rank deficient, or if the block isn't 
+// known to be symmetric or the rank was deficient last time, we use the 
+// slower rank-revealing QTZ factorization of the untouched GMInvGt instead.
+class ConstraintSpaceBlock {
+public:
+    ConstraintSpaceBlock() : isFactoredLDLt(false), hadFullRank(true) {}
+
+    // Factor GMInvGt, which must have been filled in already.
+    void factor(bool isSymmetric, Real conditioningTol);
+    // Solve GMInvGt*x=b using the factorization.
+    void solve(const Vector& b, Vector& x) const;
+
+    Array_<int> equations;
+    Matrix      GMInvGt;
+
+    bool        isFactoredLDLt;
+    bool        hadFullRank;    // result of the most recent factorization
+    Matrix      LDLt;           // L and D in lower triangle, if isFactoredLDLt
+    FactorQTZ   qtz;            // used if !isFactoredLDLt
+};
+
+// This cache entry holds the factored blocks of G*M^-1*~G for the constraint
+// equations in use, for solving for the constraint multipliers in forward 
+// dynamics. If the constraints are not separated into independent sets there
+// is a single block containing all the equations. G*M^-1*~G depends only on
+// time and positions, except for the rows of nonholonomic and 
+// acceleration-only constraints, which may also depend on velocities. So this
+// is a lazy cache entry with depends-on stage Position, that we also consider 
+// invalid if there are nonholonomic or acceleration-only constraint equations
+// and u has changed since the factorization was done. It is never realized
+// automatically.
+//
+// When this is recalculated the previous contents are reused to decide how to
+// factor each block; see ConstraintSpaceBlock.
+class SBConstraintFactorizationCache {
+public:
+    SBConstraintFactorizationCache() : dependsOnU(false), uVersion(-1) {}
+
+    Array_<ConstraintSpaceBlock> blocks;
+
+    bool         dependsOnU;
+    ValueVersion uVersion;      // u version when factored, if dependsOnU
+};
+//..................... CONSTRAINT FACTORIZATION CACHE .........................
+
+
+
 
 /* 
  * Generalized state variable collection for a SimbodyMatterSubsystem. 
@@ -0,0 +1,376 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKsimbody.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace SimTK;
+
+// A layer of moving spheres packed closely on a floor, so that there are
+// many sphere-sphere and sphere-floor contacts. A generator for those
+// contacts may be given to replace the built-in one.
+class GranularBed {
+public:
+    explicit GranularBed(int numThreads, 
+                         ContactForceGenerator* generator = nullptr)
+    :   matter(system), tracker(system), contactForces(system, tracker) {
+        contactForces.setNumberOfThreads(numThreads);
+        if (generator)
+            contactForces.adoptForceGenerator(generator);
+        const ContactMaterial material(1e6, 0.5, 0.8, 0.6, 0.1);
+        matter.Ground().updBody().addContactSurface(
+            Transform(Rotation(-Pi/2, ZAxis)),
+            ContactSurface(ContactGeometry::HalfSpace(), material)); // y < 0
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(0.1)));
+        body.addContactSurface(ContactSurface(ContactGeometry::Sphere(0.5),
+                                              material));
+        for (int i = 0; i < 20; ++i)
+            for (int j = 0; j < 20; ++j)
+                spheres.push_back(MobilizedBody::Free(matter.updGround(),
+                                    Transform(), body, Transform()));
+        system.realizeTopology();
+        state = system.getDefaultState();
+
+        Random::Uniform random(-0.01, 0.01);
+        random.setSeed(7);
+        for (int i = 0; i < (int)spheres.size(); ++i) {
+            const Vec3 center(0.98*(i % 20) + random.getValue(),
+                              0.49 + random.getValue(),
+                              0.98*(i / 20) + random.getValue());
+            spheres[i].setQToFitTranslation(state, center);
+            spheres[i].setUToFitAngularVelocity(state,
+                100*Vec3(random.getValue(), random.getValue(),
+                         random.getValue()));
+            spheres[i].setUToFitLinearVelocity(state,
+                10*Vec3(random.getValue(), random.getValue(),
+                        random.getValue()));
+        }
+        system.realize(state, Stage::Dynamics);
+    }
+
+    MultibodySystem                 system;
+    SimbodyMatterSubsystem          matter;
+    ContactTrackerSubsystem         tracker;
+    CompliantContactSubsystem       contactForces;
+    Array_<MobilizedBody::Free>     spheres;
+    State                           state;
+};
+
+// The contact forces must not depend on the number of threads.
+void testParallelMatchesSerial() {
+    // Make sure there are enough pool threads to get parallel chunks even on
+    // a single-processor machine.
+    ParallelExecutor::setNumSharedThreads(16);
+    GranularBed serial(1), parallel(8);
+    SimTK_TEST(serial.contactForces.getNumberOfThreads() == 1);
+    SimTK_TEST(parallel.contactForces.getNumberOfThreads() == 8);
+
+    const int numForces = serial.contactForces.getNumContactForces(
+                              serial.state);
+    SimTK_TEST(numForces > 1000);
+    SimTK_TEST(parallel.contactForces.getNumContactForces(parallel.state)
+               == numForces);
+    for (int i = 0; i < numForces; ++i) {
+        const ContactForce& expected =
+            serial.contactForces.getContactForce(serial.state, i);
+        const ContactForce& actual =
+            parallel.contactForces.getContactForce(parallel.state, i);
+        SimTK_TEST(actual.isValid());
+        SimTK_TEST_EQ(actual.getContactPoint(), expected.getContactPoint());
+        SimTK_TEST_EQ(actual.getForceOnSurface2(),
+                      expected.getForceOnSurface2());
+        SimTK_TEST_EQ(actual.getPotentialEnergy(),
+                      expected.getPotentialEnergy());
+        SimTK_TEST_EQ(actual.getPowerDissipation(),
+                      expected.getPowerDissipation());
+    }
+    SimTK_TEST_EQ(
+        parallel.system.getRigidBodyForces(parallel.state, Stage::Dynamics),
+        serial.system.getRigidBodyForces(serial.state, Stage::Dynamics));
+    SimTK_TEST_EQ(parallel.system.calcPotentialEnergy(parallel.state),
+                  serial.system.calcPotentialEnergy(serial.state));
+}
+
+// The patch details use the same surface kinematics as the forces.
+void testPatchDetailsMatchForces() {
+    GranularBed bed(4);
+    const ContactForce& force = bed.contactForces.getContactForce(bed.state, 0);
+    ContactPatch patch;
+    SimTK_TEST(bed.contactForces.calcContactPatchDetailsById(
+                   bed.state, force.getContactId(), patch));
+    SimTK_TEST_EQ(patch.getContactForce().getContactPoint(),
+                  force.getContactPoint());
+    SimTK_TEST_EQ(patch.getContactForce().getForceOnSurface2(),
+                  force.getForceOnSurface2());
+}
+
+// Recalculating the forces reuses the cached array.
+void testForceCacheIsReused() {
+    GranularBed bed(4);
+    const int numForces = bed.contactForces.getNumContactForces(bed.state);
+    const ContactForce* first = &bed.contactForces.getContactForce(bed.state, 0);
+    for (int i = 0; i < 3; ++i) {
+        bed.spheres[0].setUToFitLinearVelocity(bed.state, Vec3(i, 0, 0));
+        bed.system.realize(bed.state, Stage::Dynamics);
+        SimTK_TEST(bed.contactForces.getNumContactForces(bed.state)
+                   == numForces);
+        SimTK_TEST(&bed.contactForces.getContactForce(bed.state, 0) == first);
+    }
+}
+
+// A generator that doesn't allow concurrent calls. It delegates to the
+// built-in Hertz model and records how many calls overlapped.
+class SerialHertzCircular : public ContactForceGenerator {
+public:
+    SerialHertzCircular()
+    :   ContactForceGenerator(CircularPointContact::classTypeId()),
+        numCalls(0), maxConcurrentCalls(0) {}
+
+    void calcContactForce(const State& state, const Contact& overlapping,
+                          const SpatialVec& V_S1S2,
+                          ContactForce& contactForce) const override {
+        const int concurrent = ++numCalls;
+        int seen = maxConcurrentCalls;
+        while (concurrent > seen
+               && !maxConcurrentCalls.compare_exchange_weak(seen, concurrent))
+            ;
+        std::this_thread::yield();
+        getHertz().calcContactForce(state, overlapping, V_S1S2, contactForce);
+        --numCalls;
+    }
+
+    void calcContactPatch(const State& state, const Contact& overlapping,
+                          const SpatialVec& V_S1S2,
+                          ContactPatch& patch) const override {
+        getHertz().calcContactPatch(state, overlapping, V_S1S2, patch);
+    }
+
+    // A built-in generator that uses this one's subsystem.
+    ContactForceGenerator::HertzCircular getHertz() const {
+        ContactForceGenerator::HertzCircular hertz;
+        hertz.setCompliantContactSubsystem(&getCompliantContactSubsystem());
+        return hertz;
+    }
+
+    mutable std::atomic<int>    numCalls;
+    mutable std::atomic<int>    maxConcurrentCalls;
+};
+
+// A generator that doesn't opt in to parallel calculation must never be
+// called concurrently, even if the subsystem is allowed to use several 
+// threads. The forces are still the built-in ones.
+void testSerialGenerator() {
+    ParallelExecutor::setNumSharedThreads(16);
+    SerialHertzCircular* generator = new SerialHertzCircular();
+    GranularBed serial(8, generator), reference(1);
+    for (int i = 0; i < 3; ++i) {
+        serial.spheres[0].setUToFitLinearVelocity(serial.state, Vec3(i,0,0));
+        reference.spheres[0].setUToFitLinearVelocity(reference.state, 
+                                                     Vec3(i,0,0));
+        serial.system.realize(serial.state, Stage::Dynamics);
+        reference.system.realize(reference.state, Stage::Dynamics);
+        SimTK_TEST_EQ(
+            serial.system.getRigidBodyForces(serial.state, Stage::Dynamics),
+            reference.system.getRigidBodyForces(reference.state, 
+                                                Stage::Dynamics));
+    }
+    SimTK_TEST(generator->maxConcurrentCalls == 1);
+}
+
+// A finely meshed ball pressed into the floor, so that a single elastic
+// foundation patch has thousands of springs.
+class MeshOnFloor {
+public:
+    explicit MeshOnFloor(int numThreads)
+    :   matter(system), tracker(system), contactForces(system, tracker) {
+        contactForces.setNumberOfThreads(numThreads);
+        const ContactMaterial material(1e6, 0.5, 0.8, 0.6, 0.1);
+        matter.Ground().updBody().addContactSurface(
+            Transform(Rotation(-Pi/2, ZAxis)),
+            ContactSurface(ContactGeometry::HalfSpace(), material)); // y < 0
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(0.4)));
+        body.addContactSurface(ContactSurface(
+            ContactGeometry::TriangleMesh(PolygonalMesh::createSphereMesh(1, 5)),
+            material, 0.1));
+        ball = MobilizedBody::Free(matter.updGround(), Transform(), body, 
+                                   Transform());
+        system.realizeTopology();
+        state = system.getDefaultState();
+        ball.setQToFitTransform(state, Transform(
+            Rotation(0.3, UnitVec3(1, 1, 0)), Vec3(0, 0.5, 0)));
+        ball.setUToFitAngularVelocity(state, Vec3(1, 2, 3));
+        ball.setUToFitLinearVelocity(state, Vec3(0.5, -1, 0.2));
+        system.realize(state, Stage::Dynamics);
+    }
+
+    MultibodySystem                 system;
+    SimbodyMatterSubsystem          matter;
+    ContactTrackerSubsystem         tracker;
+    CompliantContactSubsystem       contactForces;
+    MobilizedBody::Free             ball;
+    State                           state;
+};
+
+// Splitting a large elastic foundation patch among threads must not change
+// its force.
+void testParallelElasticFoundation() {
+    // Make sure there are enough pool threads to get parallel chunks even on
+    // a single-processor machine.
+    ParallelExecutor::setNumSharedThreads(16);
+    MeshOnFloor serial(1), parallel(4);
+    const ContactForce& expected = 
+        serial.contactForces.getContactForce(serial.state, 0);
+    const ContactForce& actual = 
+        parallel.contactForces.getContactForce(parallel.state, 0);
+    SimTK_TEST(parallel.contactForces.getNumContactForces(parallel.state)
+               == 1);
+    SimTK_TEST_EQ(actual.getContactPoint(), expected.getContactPoint());
+    SimTK_TEST_EQ(actual.getForceOnSurface2(), expected.getForceOnSurface2());
+    SimTK_TEST_EQ(actual.getPotentialEnergy(), expected.getPotentialEnergy());
+    SimTK_TEST_EQ(actual.getPowerDissipation(), 
+                  expected.getPowerDissipation());
+
+    ContactPatch patch;
+    SimTK_TEST(parallel.contactForces.calcContactPatchDetailsById(
+                   parallel.state, actual.getContactId(), patch));
+    SimTK_TEST(patch.getNumDetails() > 1000);
+    SimTK_TEST_EQ(patch.getContactForce().getForceOnSurface2(),
+                  actual.getForceOnSurface2());
+}
+
+// A single body touching the floor, which is either a half space or the top
+// face of a big brick, both at y=0.
+class ShapeOnFloor {
+public:
+    ShapeOnFloor(const ContactGeometry& floor, const Transform& X_GF,
+                 const ContactGeometry& shape,
+                 const Transform& X_GB, const SpatialVec& V_GB)
+    :   matter(system), tracker(system), contactForces(system, tracker) {
+        const ContactMaterial material(1e6, 0.5, 0.8, 0.6, 0.1);
+        matter.Ground().updBody().addContactSurface(X_GF,
+            ContactSurface(floor, material));
+        // A mesh needs a thickness for the elastic foundation model.
+        const Real thickness = 
+            ContactGeometry::TriangleMesh::isInstance(shape) ? 0.1 : 0;
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(0.1)));
+        body.addContactSurface(ContactSurface(shape, material, thickness));
+        mobod = MobilizedBody::Free(matter.updGround(), Transform(), body,
+                                    Transform());
+        system.realizeTopology();
+        state = system.getDefaultState();
+        mobod.setQToFitTransform(state, X_GB);
+        mobod.setUToFitVelocity(state, V_GB);
+        system.realize(state, Stage::Dynamics);
+    }
+
+    MultibodySystem                 system;
+    SimbodyMatterSubsystem          matter;
+    ContactTrackerSubsystem         tracker;
+    CompliantContactSubsystem       contactForces;
+    MobilizedBody::Free             mobod;
+    State                           state;
+};
+
+// The half space is the floor the other floors are compared against; its
+// outward normal is the ground's +y.
+const ContactGeometry::HalfSpace halfSpaceFloor;
+const Transform X_GHalfSpace(Rotation(-Pi/2, ZAxis));
+
+// A brick or sphere resting on a brick floor feels the same force as on a
+// half space floor, now that brick pairs and sphere-brick pairs have their
+// own trackers.
+void testBrickFloorMatchesHalfSpace() {
+    const Transform X_GB(Rotation(0.3, YAxis), Vec3(0.2, 0.29, -0.1));
+    const SpatialVec V_GB(Vec3(0.1, 0.2, 0.3), Vec3(0.5, -0.2, 0.1));
+    const ContactGeometry shapes[] = {ContactGeometry::Brick(Vec3(0.5,0.3,0.4)),
+                                      ContactGeometry::Sphere(0.3)};
+    for (const ContactGeometry& shape : shapes) {
+        ShapeOnFloor halfSpace(halfSpaceFloor, X_GHalfSpace, shape, X_GB, V_GB);
+        ShapeOnFloor brick(ContactGeometry::Brick(Vec3(10, 1, 10)),
+                           Transform(Vec3(0, -1, 0)), shape, X_GB, V_GB);
+        SimTK_TEST(brick.contactForces.getNumContactForces(brick.state) == 1);
+        const ContactForce& expected =
+            halfSpace.contactForces.getContactForce(halfSpace.state, 0);
+        const ContactForce& actual =
+            brick.contactForces.getContactForce(brick.state, 0);
+        SimTK_TEST(actual.isValid());
+        SimTK_TEST_EQ(actual.getPotentialEnergy(),
+                      expected.getPotentialEnergy());
+        SimTK_TEST_EQ(actual.getPowerDissipation(),
+                      expected.getPowerDissipation());
+        // The brick's contact points are found by a different route.
+        SimTK_TEST_EQ_TOL(
+            brick.system.getRigidBodyForces(brick.state, Stage::Dynamics),
+            halfSpace.system.getRigidBodyForces(halfSpace.state, 
+                                                Stage::Dynamics), 1e-9);
+    }
+}
+
+// A sphere, an ellipsoid or a mesh resting on flat terrain feels the same
+// force as on a half space floor.
+void testHeightMapFloorMatchesHalfSpace() {
+    const Transform X_GB(Rotation(0.3, YAxis), Vec3(0.2, 0.27, -0.1));
+    const SpatialVec V_GB(Vec3(0.1, 0.2, 0.3), Vec3(0.5, -0.2, 0.1));
+    // The terrain's z is the ground's y.
+    const ContactGeometry::SmoothHeightMap terrain
+       (BicubicSurface(Vec2(-10), Vec2(1), Matrix(21, 21, Real(0)), 0));
+    const Transform X_GT(Rotation(-Pi/2, XAxis));
+    const ContactGeometry shapes[] = {
+        ContactGeometry::Sphere(0.3),
+        ContactGeometry::Ellipsoid(Vec3(0.4, 0.3, 0.5)),
+        ContactGeometry::TriangleMesh(PolygonalMesh::createSphereMesh(0.3, 2))};
+    for (const ContactGeometry& shape : shapes) {
+        ShapeOnFloor halfSpace(halfSpaceFloor, X_GHalfSpace, shape, X_GB, V_GB);
+        ShapeOnFloor heightMap(terrain, X_GT, shape, X_GB, V_GB);
+        SimTK_TEST(
+            heightMap.contactForces.getNumContactForces(heightMap.state) == 1);
+        const ContactForce& expected =
+            halfSpace.contactForces.getContactForce(halfSpace.state, 0);
+        const ContactForce& actual =
+            heightMap.contactForces.getContactForce(heightMap.state, 0);
+        SimTK_TEST(actual.isValid());
+        SimTK_TEST_EQ_TOL(actual.getPotentialEnergy(),
+                          expected.getPotentialEnergy(), 1e-9);
+        SimTK_TEST_EQ_TOL(actual.getPowerDissipation(),
+                          expected.getPowerDissipation(), 1e-9);
+        SimTK_TEST_EQ_TOL(
+            heightMap.system.getRigidBodyForces(heightMap.state,
+                                                Stage::Dynamics),
+            halfSpace.system.getRigidBodyForces(halfSpace.state,
+                                                Stage::Dynamics), 1e-9);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestCompliantContactSubsystem");
+        SimTK_SUBTEST(testParallelMatchesSerial);
+        SimTK_SUBTEST(testPatchDetailsMatchForces);
+        SimTK_SUBTEST(testForceCacheIsReused);
+        SimTK_SUBTEST(testSerialGenerator);
+        SimTK_SUBTEST(testParallelElasticFoundation);
+        SimTK_SUBTEST(testBrickFloorMatchesHalfSpace);
+        SimTK_SUBTEST(testHeightMapFloorMatchesHalfSpace);
+    SimTK_END_TEST();
+}
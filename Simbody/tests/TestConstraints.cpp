@@ -26,6 +26,8 @@
 
 #include "../src/ConstraintImpl.h"
 
+#include <thread>
+
 using namespace SimTK;
 using namespace std;
 
@@ -582,6 +584,286 @@ void testConstraintMatrices() {
     delete &system;
 }
 
+// The columns of G*M^-1*~G are calculated in parallel when there are enough
+// of them; the result must not depend on the number of threads, nor on
+// whether the output matrix has contiguous columns.
+void testParallelProjectedMInv() {
+    // Make sure there are enough pool threads to get parallel chunks even on
+    // a single-processor machine.
+    ParallelExecutor::setNumSharedThreads(16);
+    State state;
+    MultibodySystem& system = createSystem();
+    SimbodyMatterSubsystem& matter = system.updMatterSubsystem();
+    MobilizedBody& first = matter.updMobilizedBody(MobilizedBodyIndex(1));
+    MobilizedBody& second = matter.updMobilizedBody(MobilizedBodyIndex(2));
+    MobilizedBody& third = matter.updMobilizedBody(MobilizedBodyIndex(3));
+    MobilizedBody& fifth = matter.updMobilizedBody(MobilizedBodyIndex(5));
+    MobilizedBody& seventh = matter.updMobilizedBody(MobilizedBodyIndex(7));
+    MobilizedBody& last = matter.updMobilizedBody(MobilizedBodyIndex(NUM_BODIES));
+
+    MobilizedBody::Free extra(fifth, Transform(),
+        MassProperties(1, Vec3(.01,.02,.03), Inertia(1,1.1,1.2)), Transform());
+    Constraint::Weld weld(extra, fifth);
+    Constraint::Ball ball(first, last);
+    Constraint::Ball ball2(third, seventh);
+    Constraint::Rod rod(second, Vec3(.1,0,0), seventh, Vec3(0,.2,0), 1);
+    Constraint::Rod rod2(first, Vec3(0,.1,0), fifth, Vec3(0,0,.1), 1.5);
+    Constraint::ConstantAcceleration accel2(second, MobilizerUIndex(1), .01);
+    Constraint::ConstantSpeed speed5(fifth, MobilizerUIndex(1), .1);
+    createState(system, state);
+
+    const int m = matter.getNUDotErr(state);
+    SimTK_TEST(m >= 16);
+
+    matter.setNumberOfThreads(1);
+    Matrix serial;
+    matter.calcProjectedMInv(state, serial);
+
+    Matrix G, MInv;
+    matter.calcG(state, G);
+    matter.calcMInv(state, MInv);
+    SimTK_TEST_EQ(serial, G*MInv*~G);
+
+    for (int numThreads : {2, 3, 8}) {
+        matter.setNumberOfThreads(numThreads);
+        SimTK_TEST(matter.getNumberOfThreads() == numThreads);
+        Matrix parallel, transposed(m, m);
+        matter.calcProjectedMInv(state, parallel);
+        matter.calcProjectedMInv(state, ~transposed);
+        SimTK_TEST_EQ_TOL(parallel, serial, 1e-16); // identical
+        SimTK_TEST_EQ_TOL(~transposed, serial, 1e-16);
+    }
+
+    // Two threads may calculate it at once in different States, sharing the
+    // matter subsystem's executor.
+    matter.setNumberOfThreads(4);
+    State other = state;
+    system.realize(other, Stage::Acceleration);
+    for (int i=0; i < 10; ++i) {
+        Matrix mine, theirs;
+        std::thread thread([&] {matter.calcProjectedMInv(other, theirs);});
+        matter.calcProjectedMInv(state, mine);
+        thread.join();
+        SimTK_TEST_EQ_TOL(mine, serial, 1e-16);
+        SimTK_TEST_EQ_TOL(theirs, serial, 1e-16);
+    }
+
+    SimTK_TEST_MUST_THROW(matter.setNumberOfThreads(0));
+
+    delete &system;
+}
+
+// Two closed chains hanging from Ground don't interact through the mass
+// matrix, so forward dynamics solves for their multipliers separately. A
+// disabled constraint linking the chains couples them topologically, which
+// makes forward dynamics treat all the constraints together instead; the 
+// results must be the same either way.
+MultibodySystem& createTwoLoopSystem(bool linkTheLoops) {
+    MultibodySystem* system = new MultibodySystem();
+    SimbodyMatterSubsystem matter(*system);
+    GeneralForceSubsystem forces(*system);
+    const Real mass = 1.23;
+    Body::Rigid body(MassProperties(mass, Vec3(.1,.2,-.03), 
+                     mass*UnitInertia(1.1, 1.2, 1.3, .01, -.02, .07)));
+    MobilizedBodyIndex tips[2];
+    for (int chain=0; chain < 2; ++chain) {
+        tips[chain] = GroundIndex;
+        for (int i=0; i < 4; ++i)
+            tips[chain] = MobilizedBody::Gimbal(
+                matter.updMobilizedBody(tips[chain]), 
+                Transform(Vec3(chain-.5*i, .3, .2)), 
+                body, Transform(Vec3(BOND_LENGTH, 0, 0))).getMobilizedBodyIndex();
+        MobilizedBody& tip = matter.updMobilizedBody(tips[chain]);
+        Constraint::Ball(matter.Ground(), Vec3(chain+1,-1,0), 
+                         tip, Vec3(0,.1,0));
+        Constraint::ConstantSpeed(tip, MobilizerUIndex(1), .1);
+    }
+    if (linkTheLoops) {
+        Constraint::Rod link(matter.updMobilizedBody(tips[0]), 
+                             matter.updMobilizedBody(tips[1]), 1);
+        link.setDisabledByDefault(true);
+    }
+    Force::UniformGravity(forces, system->getMatterSubsystem(), Vec3(0, -9.8, 0));
+    return *system;
+}
+
+void testIndependentConstraintGroups() {
+    MultibodySystem& separate = createTwoLoopSystem(false);
+    MultibodySystem& linked = createTwoLoopSystem(true);
+    separate.realizeTopology();
+    linked.realizeTopology();
+    State sState = separate.getDefaultState();
+    State lState = linked.getDefaultState();
+    SimTK_TEST(sState.getNY() == lState.getNY());
+    Random::Uniform random(-1, 1);
+    random.setSeed(17);
+    for (int i = 0; i < sState.getNY(); ++i)
+        sState.updY()[i] = lState.updY()[i] = random.getValue();
+    separate.realize(sState, Stage::Acceleration);
+    linked.realize(lState, Stage::Acceleration);
+
+    SimTK_TEST(sState.getNMultipliers() == 8);
+    SimTK_TEST_EQ_TOL(sState.getUDotErr(), Vector(8, Real(0)), 1e-10);
+    SimTK_TEST_EQ(sState.getMultipliers(), lState.getMultipliers());
+    SimTK_TEST_EQ(sState.getUDot(), lState.getUDot());
+
+    delete &separate;
+    delete &linked;
+}
+
+// Locks the first q of a mobilizer at zero, counting how many times its
+// constraint forces are applied. Factoring G*M^-1*~G applies them once for
+// each column.
+class CountingCoordinateLock : public Constraint::Custom::Implementation {
+public:
+    CountingCoordinateLock(MobilizedBody& mobod, int& numForceCalls)
+    :   Implementation(mobod.updMatterSubsystem(), 1, 0, 0), 
+        numForceCalls(numForceCalls) 
+    {   mobilizer = addConstrainedMobilizer(mobod); }
+
+    Implementation* clone() const override 
+    {   return new CountingCoordinateLock(*this); }
+
+    void calcPositionErrors
+       (const State& state, const Array_<Transform,ConstrainedBodyIndex>&,
+        const Array_<Real,ConstrainedQIndex>& constrainedQ,
+        Array_<Real>& perr) const override
+    {   perr[0] = getOneQ(state, constrainedQ, mobilizer, MobilizerQIndex(0)); }
+
+    void calcPositionDotErrors
+       (const State& state, const Array_<SpatialVec,ConstrainedBodyIndex>&,
+        const Array_<Real,ConstrainedQIndex>& constrainedQDot,
+        Array_<Real>& pverr) const override
+    {   pverr[0] = getOneQDot(state, constrainedQDot, mobilizer, 
+                              MobilizerQIndex(0)); }
+
+    void calcPositionDotDotErrors
+       (const State& state, const Array_<SpatialVec,ConstrainedBodyIndex>&,
+        const Array_<Real,ConstrainedQIndex>& constrainedQDotDot,
+        Array_<Real>& paerr) const override
+    {   paerr[0] = getOneQDotDot(state, constrainedQDotDot, mobilizer, 
+                                 MobilizerQIndex(0)); }
+
+    void addInPositionConstraintForces
+       (const State& state, const Array_<Real>& multipliers,
+        Array_<SpatialVec,ConstrainedBodyIndex>&,
+        Array_<Real,ConstrainedQIndex>& qForces) const override
+    {   ++numForceCalls;
+        addInOneQForce(state, mobilizer, MobilizerQIndex(0), multipliers[0],
+                       qForces); }
+
+private:
+    int&                        numForceCalls;
+    ConstrainedMobilizerIndex   mobilizer;
+};
+
+// The factorization of G*M^-1*~G is kept in the State and reused until the
+// positions change, as long as all the constraints are holonomic. Check the
+// results against a fresh State, and check that redundant constraints are 
+// still handled by the rank-revealing fallback.
+void testConstraintFactorizationReuse() {
+    MultibodySystem& system = createSystem();
+    SimbodyMatterSubsystem& matter = system.updMatterSubsystem();
+    MobilizedBody& first = matter.updMobilizedBody(MobilizedBodyIndex(1));
+    MobilizedBody& fifth = matter.updMobilizedBody(MobilizedBodyIndex(5));
+    MobilizedBody& last = matter.updMobilizedBody(MobilizedBodyIndex(NUM_BODIES));
+    Constraint::Ball ball(first, last);
+    Constraint::Ball redundant(first, last);
+    redundant.setDisabledByDefault(true);
+    int numForceCalls = 0;
+    Constraint::Custom lock5(new CountingCoordinateLock(fifth, numForceCalls));
+    system.realizeTopology();
+
+    State state = system.getDefaultState();
+    Random::Uniform random(-1, 1);
+    random.setSeed(23);
+    for (int i = 0; i < state.getNY(); ++i)
+        state.updY()[i] = random.getValue();
+    system.realize(state, Stage::Acceleration);
+
+    // Changing only u keeps the factorization, so the lock's forces are 
+    // applied fewer times than after changing q, which refactors.
+    numForceCalls = 0;
+    for (int i = 0; i < state.getNU(); ++i)
+        state.updU()[i] = random.getValue();
+    system.realize(state, Stage::Acceleration);
+    const int numCallsAfterUChange = numForceCalls;
+    State refactored = state;
+    refactored.updQ(); // invalidates the positions
+    numForceCalls = 0;
+    system.realize(refactored, Stage::Acceleration);
+    SimTK_TEST(numCallsAfterUChange < numForceCalls);
+    SimTK_TEST_EQ(refactored.getMultipliers(), state.getMultipliers());
+
+    State fresh = system.getDefaultState();
+    fresh.updQ() = state.getQ();
+    fresh.updU() = state.getU();
+    system.realize(fresh, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getUDotErr(), Vector(4, Real(0)), 1e-10);
+    SimTK_TEST_EQ(state.getMultipliers(), fresh.getMultipliers());
+    SimTK_TEST_EQ(state.getUDot(), fresh.getUDot());
+
+    // With a duplicate Ball G*M^-1*~G is singular; the two Balls share the
+    // load.
+    const Vector multipliers = ball.getMultipliersAsVector(state);
+    redundant.enable(state);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getUDotErr(), Vector(7, Real(0)), 1e-10);
+    SimTK_TEST_EQ_TOL(ball.getMultipliersAsVector(state), multipliers/2, 1e-8);
+    SimTK_TEST_EQ_TOL(redundant.getMultipliersAsVector(state), 
+                      multipliers/2, 1e-8);
+
+    redundant.disable(state);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(ball.getMultipliersAsVector(state), multipliers, 1e-10);
+    state.invalidateAllCacheAtOrAbove(Stage::Position);
+    system.realize(state, Stage::Acceleration); // factored L*D*~L again
+    SimTK_TEST_EQ_TOL(ball.getMultipliersAsVector(state), multipliers, 1e-10);
+
+    delete &system;
+}
+
+// A Ball holding a very heavy body to a light one contributes equations to
+// G*M^-1*~G that are tiny compared to those of the light body's Ball, so the
+// rank-revealing QTZ factorization treats them as redundant, although each
+// L*D*~L pivot is fine relative to its own diagonal element. The cached 
+// factorization must give exactly the multipliers QTZ gives.
+void testBadlyScaledConstraints() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    Body::Rigid light(MassProperties(1, Vec3(0), UnitInertia(1)));
+    Body::Rigid heavy(MassProperties(1e13, Vec3(0), UnitInertia(1)));
+    MobilizedBody::Free first(matter.Ground(), Transform(), 
+                              light, Transform(Vec3(0,.5,0)));
+    MobilizedBody::Free second(first, Transform(Vec3(0,-.5,0)), 
+                               heavy, Transform(Vec3(0,.5,0)));
+    Constraint::Ball(matter.Ground(), Vec3(0), first, Vec3(0,.5,0));
+    Constraint::Ball(first, Vec3(0,-.5,0), second, Vec3(0,.5,0));
+    system.realizeTopology();
+
+    State state = system.getDefaultState();
+    Random::Uniform random(-1, 1);
+    random.setSeed(31);
+    for (int i = 0; i < state.getNY(); ++i)
+        state.updY()[i] = random.getValue();
+    system.realize(state, Stage::Acceleration);
+
+    Matrix GMInvGt;
+    matter.calcProjectedMInv(state, GMInvGt);
+    const int m = GMInvGt.nrow();
+    SimTK_TEST(m == 6);
+    SimTK_TEST_EQ(GMInvGt, ~GMInvGt);
+    const FactorQTZ qtz(GMInvGt, m*SqrtEps*std::sqrt(SqrtEps));
+    SimTK_TEST(qtz.getRank() < m);
+
+    Vector deltaV(m), expected, impulse;
+    for (int i = 0; i < m; ++i)
+        deltaV[i] = random.getValue();
+    qtz.solve(deltaV, expected);
+    matter.solveForConstraintImpulses(state, deltaV, impulse);
+    SimTK_TEST_EQ_TOL(impulse, expected, 1e-16); // identical
+}
+
 // Test the operator SimbodyMatterSubsystem::calcConstraintAccelerationErrors(),
 // which computes pvaerr = G udot - b. For the most part, we just ensure that
 // this operator gives results consistent with other methods.
@@ -737,6 +1019,10 @@ int main() {
         SimTK_SUBTEST(testWeldConstraintWithPreAssembly);
         SimTK_SUBTEST(testConstraintForces);
         SimTK_SUBTEST(testConstraintMatrices);
+        SimTK_SUBTEST(testParallelProjectedMInv);
+        SimTK_SUBTEST(testIndependentConstraintGroups);
+        SimTK_SUBTEST(testConstraintFactorizationReuse);
+        SimTK_SUBTEST(testBadlyScaledConstraints);
         SimTK_SUBTEST(testConstraintAccelerationErrors);
         SimTK_SUBTEST(testDisablingConstraints);
     SimTK_END_TEST();
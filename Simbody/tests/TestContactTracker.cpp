@@ -0,0 +1,443 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKsimbody.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <utility>
+
+using namespace SimTK;
+
+typedef std::set<std::pair<int,int> > PairSet;
+
+// Many free spheres above a floor. The floor is surface 0 and sphere i is
+// surface i+1. Optionally some of the spheres are replaced by ellipsoids of
+// the same size, which are much more expensive to track.
+class SphereCloud {
+public:
+    SphereCloud(int numSpheres, Real boxSize, int everyNthIsEllipsoid = 0)
+    :   matter(system), tracker(system), boxSize(boxSize), random(0, 1) {
+        random.setSeed(42);
+        const ContactMaterial material(1e6, 0, 0, 0, 0);
+        matter.Ground().updBody().addContactSurface(
+            Transform(Rotation(-Pi/2, ZAxis)),
+            ContactSurface(ContactGeometry::HalfSpace(), material)); // y < 0
+        for (int i = 0; i < numSpheres; ++i) {
+            const Real radius = 0.5 + 0.5*random.getValue();
+            Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+            if (everyNthIsEllipsoid && i % everyNthIsEllipsoid == 0)
+                body.addContactSurface(ContactSurface(
+                    ContactGeometry::Ellipsoid(Vec3(radius, 0.8*radius,
+                                                    0.6*radius)), material));
+            else
+                body.addContactSurface(ContactSurface(
+                    ContactGeometry::Sphere(radius), material));
+            spheres.push_back(MobilizedBody::Free(matter.updGround(),
+                                                  Transform(), body,
+                                                  Transform()));
+            radii.push_back(radius);
+        }
+        system.realizeTopology();
+        state = system.getDefaultState();
+        centers.resize(numSpheres);
+        scatter();
+    }
+
+    // Put every sphere at a new random location.
+    void scatter() {
+        for (int i = 0; i < (int)spheres.size(); ++i)
+            moveTo(i, boxSize*Vec3(random.getValue(), random.getValue(),
+                                   random.getValue()));
+    }
+
+    // Move every sphere a little bit.
+    void jiggle(Real distance) {
+        for (int i = 0; i < (int)spheres.size(); ++i)
+            moveTo(i, centers[i] + distance*Vec3(random.getValue()-0.5,
+                                                 random.getValue()-0.5,
+                                                 random.getValue()-0.5));
+    }
+
+    void moveTo(int i, const Vec3& center) {
+        centers[i] = center;
+        spheres[i].setQToFitTranslation(state, center);
+    }
+
+    PairSet findContactsByBruteForce() const {
+        PairSet pairs;
+        for (int i = 0; i < (int)spheres.size(); ++i) {
+            if (centers[i][1] < radii[i])
+                pairs.insert(std::make_pair(0, i+1));
+            for (int j = i+1; j < (int)spheres.size(); ++j)
+                if ((centers[i]-centers[j]).normSqr()
+                        < square(radii[i]+radii[j]))
+                    pairs.insert(std::make_pair(i+1, j+1));
+        }
+        return pairs;
+    }
+
+    // The contacts must come out in increasing order of surface pair.
+    PairSet findContactsWithTracker() {
+        system.realize(state, Stage::Position);
+        const ContactSnapshot& contacts = tracker.getActiveContacts(state);
+        PairSet pairs;
+        std::pair<int,int> previous(-1, -1);
+        for (int i = 0; i < contacts.getNumContacts(); ++i) {
+            const Contact& contact = contacts.getContact(i);
+            const int surf1 = contact.getSurface1();
+            const int surf2 = contact.getSurface2();
+            const std::pair<int,int> pair(std::min(surf1, surf2),
+                                          std::max(surf1, surf2));
+            SimTK_TEST(previous < pair);
+            previous = pair;
+            pairs.insert(pair);
+        }
+        return pairs;
+    }
+
+    MultibodySystem                 system;
+    SimbodyMatterSubsystem          matter;
+    ContactTrackerSubsystem         tracker;
+    Array_<MobilizedBody::Free>     spheres;
+    Array_<Real>                    radii;
+    Array_<Vec3>                    centers;
+    Real                            boxSize;
+    Random::Uniform                 random;
+    State                           state;
+};
+
+// The incremental broad phase must find exactly the contacts that a brute
+// force search does, whether the bodies move a little (so that the sorted
+// lists are nearly in order) or are scattered all over again.
+void testMatchesBruteForce() {
+    SphereCloud cloud(200, 10);
+    int numContacts = 0;
+    for (int i = 0; i < 40; ++i) {
+        if (i % 10 == 9)
+            cloud.scatter();
+        else
+            cloud.jiggle(0.2);
+        const PairSet expected = cloud.findContactsByBruteForce();
+        SimTK_TEST(cloud.findContactsWithTracker() == expected);
+        numContacts += (int)expected.size();
+    }
+    SimTK_TEST(numContacts > 40); // make sure the test means something
+}
+
+// The surface pairs of the active contacts in a State.
+PairSet findActivePairs(const SphereCloud& cloud, const State& state) {
+    cloud.system.realize(state, Stage::Position);
+    const ContactSnapshot& contacts = cloud.tracker.getActiveContacts(state);
+    PairSet pairs;
+    for (int i = 0; i < contacts.getNumContacts(); ++i) {
+        const Contact& contact = contacts.getContact(i);
+        pairs.insert(std::make_pair(
+            std::min(contact.getSurface1(), contact.getSurface2()),
+            std::max(contact.getSurface1(), contact.getSurface2())));
+    }
+    return pairs;
+}
+
+// Each State keeps its own broad phase, so two States of one System that
+// are realized in turn, or at the same time on different threads, don't see
+// each other's bodies.
+void testIndependentStates() {
+    SphereCloud cloud(200, 10);
+    State states[2] = {cloud.state, cloud.state};
+    Array_<Vec3> centers[2] = {cloud.centers, cloud.centers};
+    for (int i = 0; i < 20; ++i) {
+        PairSet expected[2], found[2];
+        for (int k = 0; k < 2; ++k) {
+            // The first State's bodies move a little, the second's jump.
+            for (int j = 0; j < (int)cloud.spheres.size(); ++j) {
+                const Vec3 r(cloud.random.getValue(), cloud.random.getValue(),
+                             cloud.random.getValue());
+                centers[k][j] = k == 0 ? centers[k][j] + 0.2*(r-Vec3(0.5))
+                                       : cloud.boxSize*r;
+                cloud.spheres[j].setQToFitTranslation(states[k], 
+                                                      centers[k][j]);
+            }
+            cloud.centers = centers[k];
+            expected[k] = cloud.findContactsByBruteForce();
+        }
+        std::thread other([&] {found[1] = findActivePairs(cloud, states[1]);});
+        found[0] = findActivePairs(cloud, states[0]);
+        other.join();
+        SimTK_TEST(found[0] == expected[0]);
+        SimTK_TEST(found[1] == expected[1]);
+    }
+}
+
+// All the spheres piled onto one spot and then spread out again, so that
+// every box overlaps every other box along every axis at some point.
+void testPileUp() {
+    SphereCloud cloud(50, 10);
+    for (int i = 0; i < 50; ++i)
+        cloud.moveTo(i, Vec3(5, 0.1*i, 5));
+    SimTK_TEST(cloud.findContactsWithTracker()
+               == cloud.findContactsByBruteForce());
+    cloud.scatter();
+    SimTK_TEST(cloud.findContactsWithTracker()
+               == cloud.findContactsByBruteForce());
+}
+
+// Tracking the pairs in parallel must produce the same contacts, in the same
+// order and with the same ContactIds, as tracking them serially.
+void testParallelNarrowPhase() {
+    // Make sure there are enough pool threads to get parallel chunks even on
+    // a single-processor machine.
+    ParallelExecutor::setNumSharedThreads(16);
+    SphereCloud serial(100, 8, 3), parallel(100, 8, 3);
+    serial.tracker.setNumberOfThreads(1);
+    parallel.tracker.setNumberOfThreads(8);
+    SimTK_TEST(serial.tracker.getNumberOfThreads() == 1);
+    SimTK_TEST(parallel.tracker.getNumberOfThreads() == 8);
+    for (int i = 0; i < 10; ++i) {
+        serial.jiggle(0.2);
+        parallel.jiggle(0.2);
+        serial.system.realize(serial.state, Stage::Position);
+        parallel.system.realize(parallel.state, Stage::Position);
+        const ContactSnapshot& expected =
+            serial.tracker.getActiveContacts(serial.state);
+        const ContactSnapshot& actual =
+            parallel.tracker.getActiveContacts(parallel.state);
+        SimTK_TEST(expected.getNumContacts() > 10);
+        SimTK_TEST(actual.getNumContacts() == expected.getNumContacts());
+        if (actual.getNumContacts() != expected.getNumContacts())
+            continue;
+        // The ids come from a global counter, so compare them relative to
+        // the first one.
+        const int firstExpected = expected.getContact(0).getContactId();
+        const int firstActual = actual.getContact(0).getContactId();
+        for (int c = 0; c < actual.getNumContacts(); ++c) {
+            const Contact& e = expected.getContact(c);
+            const Contact& a = actual.getContact(c);
+            SimTK_TEST(a.getSurface1() == e.getSurface1());
+            SimTK_TEST(a.getSurface2() == e.getSurface2());
+            SimTK_TEST(a.getTypeId() == e.getTypeId());
+            SimTK_TEST(a.getCondition() == e.getCondition());
+            SimTK_TEST(a.getContactId() - firstActual
+                       == e.getContactId() - firstExpected);
+            if (CircularPointContact::isInstance(a))
+                SimTK_TEST_EQ(CircularPointContact::getAs(a).getDepth(),
+                              CircularPointContact::getAs(e).getDepth());
+        }
+    }
+}
+
+// A tracker that doesn't allow concurrent calls. It delegates to the
+// built-in sphere-ellipsoid tracker and records how many calls overlapped.
+class SerialSphereEllipsoid : public ContactTracker {
+public:
+    SerialSphereEllipsoid()
+    :   ContactTracker(ContactGeometry::Sphere::classTypeId(),
+                       ContactGeometry::Ellipsoid::classTypeId()),
+        convex(ContactGeometry::Sphere::classTypeId(),
+               ContactGeometry::Ellipsoid::classTypeId()),
+        numCalls(0), maxConcurrentCalls(0) {}
+
+    bool trackContact(const Contact& priorStatus,
+                      const Transform& X_GS1, const ContactGeometry& surface1,
+                      const Transform& X_GS2, const ContactGeometry& surface2,
+                      Real cutoff, Contact& currentStatus) const override {
+        const int concurrent = ++numCalls;
+        int seen = maxConcurrentCalls;
+        while (concurrent > seen
+               && !maxConcurrentCalls.compare_exchange_weak(seen, concurrent))
+            ;
+        std::this_thread::yield();
+        const bool result = convex.trackContact(priorStatus, X_GS1, surface1,
+                                                X_GS2, surface2, cutoff,
+                                                currentStatus);
+        --numCalls;
+        return result;
+    }
+
+    ContactTracker::ConvexImplicitPair  convex;
+    mutable std::atomic<int>            numCalls;
+    mutable std::atomic<int>            maxConcurrentCalls;
+};
+
+// A tracker that doesn't opt in to parallel tracking must never be called
+// concurrently, even if the subsystem is allowed to use several threads.
+void testSerialTracker() {
+    ParallelExecutor::setNumSharedThreads(16);
+    SphereCloud cloud(100, 8, 3);
+    SerialSphereEllipsoid* serial = new SerialSphereEllipsoid();
+    cloud.tracker.adoptContactTracker(serial);
+    cloud.tracker.setNumberOfThreads(8);
+    for (int i = 0; i < 10; ++i) {
+        cloud.jiggle(0.2);
+        cloud.system.realize(cloud.state, Stage::Position);
+        cloud.tracker.getActiveContacts(cloud.state);
+    }
+    SimTK_TEST(serial->maxConcurrentCalls == 1);
+}
+
+// A scene with one surface of each kind that supports ray casting, plus a
+// torus that must be ignored. Body i is at a random pose.
+class RayScene {
+public:
+    explicit RayScene(int numThreads) : matter(system), tracker(system) {
+        tracker.setNumberOfThreads(numThreads);
+        const ContactMaterial material(1e6, 0, 0, 0, 0);
+        matter.Ground().updBody().addContactSurface(
+            Transform(Rotation(-Pi/2, ZAxis), Vec3(0, -3, 0)),
+            ContactSurface(ContactGeometry::HalfSpace(), material)); // y < -3
+        Matrix f(21, 21);
+        for (int i = 0; i < f.nrow(); ++i)
+            for (int j = 0; j < f.ncol(); ++j)
+                f(i,j) = 0.3*std::sin(0.8*i)*std::cos(0.6*j);
+        // The height map's z axis is Ground's y, a little above the floor.
+        matter.Ground().updBody().addContactSurface(
+            Transform(Rotation(-Pi/2, XAxis), Vec3(-5, -2.5, 5)),
+            ContactSurface(ContactGeometry::SmoothHeightMap(BicubicSurface(
+                Vec2(0), Vec2(0.5), f, 0)), material));
+
+        const ContactGeometry::TriangleMesh mesh
+           (PolygonalMesh::createSphereMesh(0.8, 2));
+        const ContactGeometry shapes[] = {
+            ContactGeometry::Sphere(0.5),
+            ContactGeometry::Brick(Vec3(0.3, 0.6, 0.4)),
+            ContactGeometry::Ellipsoid(Vec3(0.7, 0.4, 0.3)),
+            mesh,
+            ContactGeometry::Torus(0.6, 0.2)};
+        Random::Uniform random(-3, 3);
+        random.setSeed(11);
+        for (int i = 0; i < 30; ++i) {
+            Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+            body.addContactSurface(ContactSurface(shapes[i % 5], material));
+            const Transform X_GB(
+                Rotation(BodyRotationSequence, random.getValue(), XAxis,
+                         random.getValue(), YAxis, random.getValue(), ZAxis),
+                Vec3(random.getValue(), random.getValue(), random.getValue()));
+            MobilizedBody::Weld(matter.updGround(), X_GB, body, Transform());
+        }
+        system.realizeTopology();
+        state = system.getDefaultState();
+        system.realize(state, Stage::Position);
+    }
+
+    // Test every ray against every surface.
+    ContactTrackerSubsystem::RayHit castByBruteForce(const Vec3& origin,
+        const UnitVec3& direction, Real maxDistance) const {
+        ContactTrackerSubsystem::RayHit best;
+        best.distance = maxDistance;
+        for (ContactSurfaceIndex surfx(0); surfx < tracker.getNumSurfaces();
+             ++surfx) {
+            const ContactGeometry& geo =
+                tracker.getContactSurface(surfx).getShape();
+            if (ContactGeometry::Torus::isInstance(geo))
+                continue;
+            const Transform X_GS =
+                tracker.getMobilizedBody(surfx).getBodyTransform(state)
+                * tracker.getContactSurfaceTransform(surfx);
+            Real distance; UnitVec3 normal;
+            if (geo.intersectsRay(~X_GS*origin, ~X_GS.R()*direction,
+                                  distance, normal)
+                && distance <= best.distance) {
+                best.surface = surfx;
+                best.distance = distance;
+                best.normal = X_GS.R()*normal;
+            }
+        }
+        if (!best.isHit())
+            best.distance = Infinity;
+        return best;
+    }
+
+    MultibodySystem                 system;
+    SimbodyMatterSubsystem          matter;
+    ContactTrackerSubsystem         tracker;
+    State                           state;
+};
+
+// Casting rays through the subsystem finds the same hits as trying every
+// surface, and gives the same results with any number of threads.
+void testCastRays() {
+    // Make sure there are enough pool threads to get parallel chunks even on
+    // a single-processor machine.
+    ParallelExecutor::setNumSharedThreads(16);
+    RayScene serial(1), parallel(8);
+    // Rays from all over, in all directions, including a partial packet.
+    Array_<Vec3> origins;
+    Array_<UnitVec3> directions;
+    for (int i = 0; i < 1000; ++i) {
+        origins.push_back(4*Vec3(std::sin(1.7*i), std::sin(0.9*i+1),
+                                 std::sin(0.5*i+2)));
+        directions.push_back(UnitVec3(std::sin(2.3*i), std::cos(1.1*i),
+                                      std::sin(0.7*i+3)));
+    }
+
+    for (Real maxDistance : {Real(Infinity), Real(2)}) {
+        Array_<ContactTrackerSubsystem::RayHit> hits, parallelHits;
+        serial.tracker.castRays(serial.state, origins, directions,
+                                maxDistance, hits);
+        parallel.tracker.castRays(parallel.state, origins, directions,
+                                  maxDistance, parallelHits);
+        SimTK_TEST(hits.size() == origins.size());
+        SimTK_TEST(parallelHits.size() == origins.size());
+        int numHits = 0, numMeshHits = 0;
+        for (int i = 0; i < (int)origins.size(); ++i) {
+            const ContactTrackerSubsystem::RayHit& hit = hits[i];
+            const ContactTrackerSubsystem::RayHit expected =
+                serial.castByBruteForce(origins[i], directions[i],
+                                        maxDistance);
+            SimTK_TEST(hit.surface == expected.surface);
+            SimTK_TEST(hit.distance == parallelHits[i].distance);
+            SimTK_TEST(hit.surface == parallelHits[i].surface);
+            SimTK_TEST(hit.face == parallelHits[i].face);
+            if (!expected.isHit()) {
+                SimTK_TEST(hit.distance == Infinity && hit.face == -1);
+                continue;
+            }
+            ++numHits;
+            SimTK_TEST(hit.distance <= maxDistance);
+            SimTK_TEST_EQ(hit.distance, expected.distance);
+            SimTK_TEST_EQ(hit.normal, expected.normal);
+            const ContactGeometry& geo =
+                serial.tracker.getContactSurface(hit.surface).getShape();
+            if (ContactGeometry::TriangleMesh::isInstance(geo)) {
+                SimTK_TEST(hit.face >= 0);
+                ++numMeshHits;
+            } else {
+                SimTK_TEST(hit.face == -1);
+            }
+        }
+        SimTK_TEST(numHits > 100);
+        SimTK_TEST(numMeshHits > 5);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestContactTracker");
+        SimTK_SUBTEST(testMatchesBruteForce);
+        SimTK_SUBTEST(testPileUp);
+        SimTK_SUBTEST(testIndependentStates);
+        SimTK_SUBTEST(testParallelNarrowPhase);
+        SimTK_SUBTEST(testSerialTracker);
+        SimTK_SUBTEST(testCastRays);
+    SimTK_END_TEST();
+}
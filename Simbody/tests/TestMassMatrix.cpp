@@ -1484,6 +1484,95 @@ void testVelocityKinematics() {
     syscomv = matter.calcSystemMassCenterVelocityInGround(state); // OK
 }
 
+// A wide tree: many chains of bodies on Ground. Two of the chains are joined
+// by a Constraint so they must form one subtree; another is constrained to
+// Ground, which doesn't join it to anything. The tree recursions must give
+// identical results with parallelism on and off, whether it sweeps each
+// level of the tree in parallel or whole subtrees of Ground.
+static void compareSerialAndParallel(bool bySubtree) {
+    // Make sure there are enough pool threads to get parallel chunks even on
+    // a single-processor machine.
+    ParallelExecutor::setNumSharedThreads(16);
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,.3), 
+                                    UnitInertia(1, 1.1, 1.2, .01, .02, .03)));
+    const int NumChains = 40;
+    Array_<MobilizedBody> feet;
+    for (int i=0; i < NumChains; ++i) {
+        MobilizedBody::Free base(matter.Ground(), Transform(Vec3(i,0,0)), 
+                                 body, Transform());
+        MobilizedBody::Pin knee(base, Transform(Vec3(0,-.5,0)), 
+                                body, Transform(Vec3(0,.5,0)));
+        MobilizedBody::Ball ankle(knee, Transform(Vec3(0,-.5,0)), 
+                                  body, Transform(Vec3(0,.5,0)));
+        MobilizedBody::Pin foot(ankle, Transform(Vec3(0,-.5,0)), 
+                                body, Transform(Vec3(0,.5,0)));
+        feet.push_back(foot);
+    }
+    Constraint::Rod(feet[0], feet[1], 1);
+    Constraint::Ball(matter.Ground(), Vec3(2,-2,0), feet[2], Vec3(0));
+    system.realizeTopology();
+    SimTK_TEST(!matter.getUseLevelParallelism());
+    SimTK_TEST(!matter.getUseSubtreeParallelism());
+
+    State serial = system.getDefaultState();
+    serial.updQ() = Test::randVector(serial.getNQ());
+    serial.updU() = Test::randVector(serial.getNU());
+    const Vector v = Test::randVector(serial.getNU());
+    system.realize(serial, Stage::Acceleration);
+    Vector Mv, MInvv, residual;
+    matter.multiplyByM(serial, v, Mv);
+    matter.multiplyByMInv(serial, v, MInvv);
+    matter.calcResidualForceIgnoringConstraints(serial, v, 
+        Vector_<SpatialVec>(), v, residual);
+
+    if (bySubtree) {
+        SimTK_TEST(matter.getNumIndependentSubtrees() == NumChains-1);
+        matter.setUseSubtreeParallelism(true);
+    } else {
+        SimTK_TEST_MUST_THROW(matter.setMinParallelLevelWidth(0));
+        matter.setUseLevelParallelism(true);
+        matter.setMinParallelLevelWidth(8);
+    }
+    for (int numThreads : {1, 2, 4}) {
+        matter.setNumberOfThreads(numThreads);
+        State parallel = system.getDefaultState();
+        parallel.updQ() = serial.getQ();
+        parallel.updU() = serial.getU();
+        system.realize(parallel, Stage::Acceleration);
+        for (const MobilizedBody& foot : feet) {
+            SimTK_TEST_EQ_TOL(foot.getBodyTransform(parallel), 
+                              foot.getBodyTransform(serial), 1e-16);
+            SimTK_TEST_EQ_TOL(foot.getBodyVelocity(parallel), 
+                              foot.getBodyVelocity(serial), 1e-16);
+        }
+        SimTK_TEST_EQ_TOL(parallel.getUDot(), serial.getUDot(), 1e-16);
+        SimTK_TEST_EQ_TOL(parallel.getQDotDot(), serial.getQDotDot(), 1e-16);
+        SimTK_TEST_EQ_TOL(parallel.getMultipliers(), 
+                          serial.getMultipliers(), 1e-16);
+
+        Vector Mv2, MInvv2, residual2;
+        matter.multiplyByM(parallel, v, Mv2);
+        matter.multiplyByMInv(parallel, v, MInvv2);
+        matter.calcResidualForceIgnoringConstraints(parallel, v, 
+            Vector_<SpatialVec>(), v, residual2);
+        SimTK_TEST_EQ_TOL(Mv2, Mv, 1e-16);
+        SimTK_TEST_EQ_TOL(MInvv2, MInvv, 1e-16);
+        SimTK_TEST_EQ_TOL(residual2, residual, 1e-16);
+    }
+}
+
+void testLevelParallelism() {
+    compareSerialAndParallel(false);
+}
+
+void testSubtreeParallelism() {
+    compareSerialAndParallel(true);
+}
+
 int main() {
     SimTK_START_TEST("TestMassMatrix");
         SimTK_SUBTEST(testPositionKinematics);
@@ -1496,6 +1585,8 @@ int main() {
         SimTK_SUBTEST(testUnconstrainedSystem);
         SimTK_SUBTEST(testConstrainedSystem);
         SimTK_SUBTEST(testTaskJacobians);
+        SimTK_SUBTEST(testLevelParallelism);
+        SimTK_SUBTEST(testSubtreeParallelism);
     SimTK_END_TEST();
 }
 
@@ -60,6 +60,160 @@ public:
     }
 };
 
+// Applies a distinct force to one of the bodies and mobilities, so that the
+// sum depends on every force being added in exactly once.
+class BodyForceImpl : public Force::Custom::Implementation {
+public:
+    BodyForceImpl(int k, bool parallel, bool positionOnly, Real cost)
+    :   k(k), parallel(parallel), positionOnly(positionOnly), cost(cost) {}
+    bool shouldBeParallelIfPossible() const override {
+        return parallel;
+    }
+    Real getEvaluationCost() const override {
+        return cost;
+    }
+    bool dependsOnlyOnPositions() const override {
+        return positionOnly;
+    }
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+          Vector_<Vec3>& particleForces, Vector& mobilityForces) const override{
+        bodyForces[1 + k % (bodyForces.size()-1)] +=
+            SpatialVec(Vec3(1.0/(k+1)), Vec3(k, 0, 1));
+        mobilityForces[k % mobilityForces.size()] += 1.0/(k+3);
+    }
+    Real calcPotentialEnergy(const State& state) const override {
+        return 0.0;
+    }
+private:
+    int k;
+    bool parallel, positionOnly;
+    Real cost;
+};
+
+bool bitwiseEqual(const Vector_<SpatialVec>& a, const Vector_<SpatialVec>& b) {
+    if (a.size() != b.size())
+        return false;
+    for (int i = 0; i < a.size(); ++i)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+// The parallel reduction of the force contributions must give the same sums
+// as adding them up one at a time, for any number of threads, with and
+// without cached position-only forces. Most of the forces are cheap, so they
+// are grouped into chunks; a few are expensive enough to get their own.
+void testParallelForceSums()
+{
+    const int numBodies = 10, numForces = 600;
+    for (bool withCachedForces : {false, true}) {
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        GeneralForceSubsystem forces(system);
+        for (int i = 0; i < numBodies; ++i)
+            MobilizedBody::Free(matter.Ground(), Transform(),
+                Body::Rigid(MassProperties(1, Vec3(0), Inertia(1))),
+                Transform());
+        Array_<BodyForceImpl*> impls;
+        for (int k = 0; k < numForces; ++k) {
+            impls.push_back(new BodyForceImpl(k, k % 5 != 0,
+                                              withCachedForces && k % 3 == 0,
+                                              k % 97 == 0 ? 1000 : 1));
+            Force::Custom custom(forces, impls.back());
+        }
+        system.realizeTopology();
+        State state = system.getDefaultState();
+        system.realize(state, Stage::Velocity);
+
+        Vector_<SpatialVec> expectedBodyForces(matter.getNumBodies(),
+                                               SpatialVec(Vec3(0), Vec3(0)));
+        Vector_<Vec3> particleForces;
+        Vector expectedMobilityForces(state.getNU(), 0.);
+        for (int k = 0; k < numForces; ++k)
+            impls[k]->calcForce(state, expectedBodyForces, particleForces,
+                                expectedMobilityForces);
+
+        Vector_<SpatialVec> deterministicBodyForces;
+        for (bool deterministic : {false, true}) {
+            forces.setDeterministicForceSummation(deterministic);
+            SimTK_TEST(forces.getDeterministicForceSummation()
+                       == deterministic);
+            for (int numThreads : {1, 2, 3, 8}) {
+                forces.setNumberOfThreads(numThreads);
+                // Twice, so that the second time the cached forces are used.
+                for (int repeat = 0; repeat < 2; ++repeat) {
+                    state.invalidateAllCacheAtOrAbove(
+                        repeat == 0 ? Stage::Position : Stage::Velocity);
+                    system.realize(state, Stage::Dynamics);
+                    const Vector_<SpatialVec>& bodyForces =
+                        system.getRigidBodyForces(state, Stage::Dynamics);
+                    SimTK_TEST_EQ(bodyForces, expectedBodyForces);
+                    SimTK_TEST_EQ(system.getMobilityForces(state,
+                                  Stage::Dynamics), expectedMobilityForces);
+                    if (deterministic) {
+                        if (deterministicBodyForces.size() == 0)
+                            deterministicBodyForces = bodyForces;
+                        SimTK_TEST(bitwiseEqual(bodyForces,
+                                                deterministicBodyForces));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Many small built-in forces are calculated in parallel chunks and must give
+// the same results as a serial calculation.
+void testManySmallForces()
+{
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+    MobilizedBodyIndex parent = GroundIndex;
+    for (int i = 0; i < 50; ++i) {
+        MobilizedBody::Pin pin(matter.updMobilizedBody(parent),
+                               Transform(Vec3(0, -1, 0)), body, Transform());
+        parent = pin.getMobilizedBodyIndex();
+    }
+    for (MobilizedBodyIndex i(1); i < matter.getNumBodies(); ++i) {
+        const MobilizedBody& mobod = matter.getMobilizedBody(i);
+        for (int j = 0; j < 5; ++j) {
+            Force::TwoPointLinearSpring(forces, matter.Ground(),
+                Vec3(j, 0, 0), mobod, Vec3(0, 0.1*j, 0), 10+j, 0.5);
+            Force::MobilityLinearDamper(forces, mobod, MobilizerUIndex(0),
+                                        0.1*(j+1));
+        }
+        Force::LinearBushing(forces, matter.Ground(), Transform(), mobod,
+            Transform(), Vec6(1, 2, 3, 4, 5, 6), Vec6(.1, .2, .3, .4, .5, .6));
+    }
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    for (int i = 0; i < state.getNQ(); ++i) {
+        state.updQ()[i] = 0.01*i;
+        state.updU()[i] = 0.1*std::sin(Real(i));
+    }
+
+    forces.setNumberOfThreads(1);
+    system.realize(state, Stage::Dynamics);
+    const Vector_<SpatialVec> serialBodyForces =
+        system.getRigidBodyForces(state, Stage::Dynamics);
+    const Vector serialMobilityForces =
+        system.getMobilityForces(state, Stage::Dynamics);
+    // Make sure there are enough pool threads to get parallel chunks even on
+    // a single-processor machine.
+    ParallelExecutor::setNumSharedThreads(16);
+    for (int numThreads : {2, 4, 16}) {
+        forces.setNumberOfThreads(numThreads);
+        state.invalidateAllCacheAtOrAbove(Stage::Position);
+        system.realize(state, Stage::Dynamics);
+        SimTK_TEST_EQ(system.getRigidBodyForces(state, Stage::Dynamics),
+                      serialBodyForces);
+        SimTK_TEST_EQ(system.getMobilityForces(state, Stage::Dynamics),
+                      serialMobilityForces);
+    }
+}
+
 void testParallelForce()
 {
     MultibodySystem system;
@@ -91,6 +245,9 @@ void testNonParallelForce()
 int main()
 {
     SimTK_START_TEST("TestParallelForces");
+        SimTK_SUBTEST(testParallelForceSums);
+        SimTK_SUBTEST(testManySmallForces);
+
         //Simply pass the test if only one thread is supported on this machine
         unsigned concurrentThreadsSupported = std::thread::hardware_concurrency();
         if(concurrentThreadsSupported <= 1)
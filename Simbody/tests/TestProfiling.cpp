@@ -0,0 +1,206 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKsimbody.h"
+
+#include <sstream>
+#include <string>
+
+using namespace SimTK;
+
+class SpinningForceImpl : public Force::Custom::Implementation {
+public:
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+                   Vector_<Vec3>& particleForces,
+                   Vector& mobilityForces) const override {
+        const long long start = realTimeInNs();
+        while (realTimeInNs() - start < 100000) {} // 0.1ms
+    }
+    Real calcPotentialEnergy(const State& state) const override {return 0;}
+};
+
+// A pendulum with a spring, a damper and a custom force. The damper is
+// disabled.
+class ProfiledModel {
+public:
+    ProfiledModel() : matter(system), forces(system) {
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+        MobilizedBody::Pin pendulum(matter.Ground(), Transform(),
+                                    body, Transform(Vec3(0, 1, 0)));
+        Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+        spring = Force::TwoPointLinearSpring(forces, matter.Ground(), Vec3(0),
+                     pendulum, Vec3(0), 10, 0.5).getForceIndex();
+        damper = Force::MobilityLinearDamper(forces, pendulum, 0, 1)
+                     .getForceIndex();
+        custom = Force::Custom(forces, new SpinningForceImpl())
+                     .getForceIndex();
+        system.realizeTopology();
+        state = system.getDefaultState();
+        forces.setForceIsDisabled(state, damper, true);
+        pendulum.setAngle(state, 0.5);
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+    ForceIndex              spring, damper, custom;
+    State                   state;
+};
+
+static void realizeDynamics(ProfiledModel& model, int times) {
+    for (int i = 0; i < times; ++i) {
+        model.state.invalidateAllCacheAtOrAbove(Stage::Position);
+        model.system.realize(model.state, Stage::Dynamics);
+    }
+}
+
+static const TimingCounter* findCounter(const Array_<TimingCounter>& counters,
+                                        const std::string& name) {
+    for (const TimingCounter& counter : counters)
+        if (counter.getName() == name)
+            return &counter;
+    return nullptr;
+}
+
+void testDisabledByDefault() {
+    SimTK_TEST(!Profiler::isEnabled());
+    ProfiledModel model;
+    realizeDynamics(model, 3);
+    Array_<TimingCounter> counters;
+    model.system.getTimingCounters(counters);
+    SimTK_TEST(counters.empty());
+    SimTK_TEST(model.forces.getForceTimingCounter(model.spring)
+                   .getNumCalls() == 0);
+    SimTK_TEST(model.forces.getRealizeTimingCounter(Stage::Dynamics)
+                   .getNumCalls() == 0);
+}
+
+void testForceAndRealizeCounters() {
+    ProfiledModel model;
+    Profiler::setEnabled(true);
+    realizeDynamics(model, 3);
+    Profiler::setEnabled(false);
+    realizeDynamics(model, 2); // not counted
+
+    const TimingCounter& spring =
+        model.forces.getForceTimingCounter(model.spring);
+    SimTK_TEST(spring.getName() ==
+        "GeneralForceSubsystem::Force 1 (Force::TwoPointLinearSpring)");
+    SimTK_TEST(spring.getNumCalls() == 3);
+    SimTK_TEST(model.forces.getForceTimingCounter(model.damper)
+                   .getNumCalls() == 0);
+
+    // The custom force spins for 0.1ms per call, and is named after the
+    // user's Implementation class.
+    const TimingCounter& custom =
+        model.forces.getForceTimingCounter(model.custom);
+    SimTK_TEST(custom.getName().find("SpinningForceImpl")
+               != std::string::npos);
+    SimTK_TEST(custom.getNumCalls() == 3);
+    SimTK_TEST(custom.getRealTimeInNs() >= 3*100000);
+    SimTK_TEST(custom.getCpuTimeInNs() >= 0);
+
+    // The subsystem's realizeDynamics() includes its forces.
+    const TimingCounter& dynamics =
+        model.forces.getRealizeTimingCounter(Stage::Dynamics);
+    SimTK_TEST(dynamics.getName() ==
+               "GeneralForceSubsystem::realizeDynamics");
+    SimTK_TEST(dynamics.getNumCalls() == 3);
+    SimTK_TEST(dynamics.getRealTimeInNs() >= custom.getRealTimeInNs());
+
+    Array_<TimingCounter> counters;
+    model.system.getTimingCounters(counters);
+    SimTK_TEST(findCounter(counters, spring.getName()) != nullptr);
+    SimTK_TEST(findCounter(counters, custom.getName()) != nullptr);
+    SimTK_TEST(findCounter(counters, dynamics.getName()) != nullptr);
+    SimTK_TEST(findCounter(counters,
+        "SimbodyMatterSubsystem::realizePosition") != nullptr);
+    SimTK_TEST(findCounter(counters, model.forces.getForceTimingCounter(
+        model.damper).getName()) == nullptr);
+    for (const TimingCounter& counter : counters)
+        SimTK_TEST(counter.getNumCalls() > 0);
+
+    model.system.resetTimingCounters();
+    SimTK_TEST(spring.getNumCalls() == 0);
+    SimTK_TEST(dynamics.getRealTimeInNs() == 0);
+    model.system.getTimingCounters(counters);
+    SimTK_TEST(counters.empty());
+}
+
+void testIntegratorCounter() {
+    ProfiledModel model;
+    RungeKuttaMersonIntegrator integ(model.system);
+    integ.initialize(model.state);
+    SimTK_TEST(integ.getStepTimingCounter().getName() ==
+               "RungeKuttaMerson::step");
+    Profiler::setEnabled(true);
+    while (integ.getTime() < 0.01) // the first call only reports the start
+        integ.stepTo(0.01);
+    Profiler::setEnabled(false);
+    SimTK_TEST(integ.getNumStepsTaken() > 0);
+    SimTK_TEST(integ.getStepTimingCounter().getNumCalls() ==
+               integ.getNumStepsTaken());
+    integ.resetAllStatistics();
+    SimTK_TEST(integ.getStepTimingCounter().getNumCalls() == 0);
+}
+
+void testChromeTrace() {
+    ProfiledModel model;
+    Profiler::setEnabled(true);
+    Profiler::setTracing(true);
+    Profiler::clearTrace();
+    realizeDynamics(model, 2);
+    Profiler::setTracing(false);
+    Profiler::setEnabled(false);
+
+    // Each of the 3 enabled forces and each subsystem's realization of
+    // Position, Velocity and Dynamics.
+    const int numEvents = Profiler::getNumTraceEvents();
+    SimTK_TEST(numEvents >= 2*(3 + 3*2));
+
+    std::ostringstream out;
+    Profiler::writeChromeTrace(out);
+    const std::string json = out.str();
+    SimTK_TEST(json.compare(0, 16, "{\"traceEvents\":[") == 0);
+    int numComplete = 0;
+    for (std::string::size_type pos = json.find("\"ph\":\"X\"");
+         pos != std::string::npos; pos = json.find("\"ph\":\"X\"", pos+1))
+        ++numComplete;
+    SimTK_TEST(numComplete == numEvents);
+    SimTK_TEST(json.find("\"name\":\"GeneralForceSubsystem::Force 1 "
+                         "(Force::TwoPointLinearSpring)\",\"cat\":\"force\"")
+               != std::string::npos);
+    SimTK_TEST(json.find("\"cat\":\"realize\"") != std::string::npos);
+
+    Profiler::clearTrace();
+    SimTK_TEST(Profiler::getNumTraceEvents() == 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestProfiling");
+        SimTK_SUBTEST(testDisabledByDefault);
+        SimTK_SUBTEST(testForceAndRealizeCounters);
+        SimTK_SUBTEST(testIntegratorCounter);
+        SimTK_SUBTEST(testChromeTrace);
+    SimTK_END_TEST();
+}
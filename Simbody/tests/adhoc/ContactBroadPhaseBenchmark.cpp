@@ -0,0 +1,95 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program measures how long ContactTrackerSubsystem takes to find the
+active contacts among a pile of spheres resting on a floor, as the number of
+spheres grows from 10 to 10000. The spheres move a little between
+evaluations, as they would from one time step to the next. Usage:
+
+    ContactBroadPhaseBenchmark [maxBodies]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+int main(int argc, char** argv) {
+    const int maxBodies = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+    std::printf("%8s %10s %14s\n", "bodies", "contacts", "tracking(us)");
+    for (int numBodies = 10; numBodies <= maxBodies; numBodies *= 10) {
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        ContactTrackerSubsystem tracker(system);
+        const ContactMaterial material(1e6, 0, 0, 0, 0);
+        matter.Ground().updBody().addContactSurface(
+            Transform(Rotation(-Pi/2, ZAxis)),
+            ContactSurface(ContactGeometry::HalfSpace(), material)); // y < 0
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+        body.addContactSurface(ContactSurface(ContactGeometry::Sphere(0.5),
+                                              material));
+        Array_<MobilizedBody::Free> spheres;
+        for (int i = 0; i < numBodies; ++i)
+            spheres.push_back(MobilizedBody::Free(matter.updGround(),
+                                                  Transform(), body,
+                                                  Transform()));
+        system.realizeTopology();
+        State state = system.getDefaultState();
+
+        // A pile that is wide in x and z and a few layers deep in y, with
+        // most neighbors slightly interpenetrating.
+        const int perSide = std::max(1, (int)std::sqrt(numBodies/4.));
+        Random::Uniform random(-0.005, 0.005);
+        Random::Uniform offset(-0.05, 0.05);
+        Array_<Vec3> centers(numBodies);
+        for (int i = 0; i < numBodies; ++i)
+            centers[i] = Vec3(0.95*(i % perSide) + offset.getValue(),
+                              0.45 + 0.95*(i / (perSide*perSide)),
+                              0.95*((i / perSide) % perSide)
+                                  + offset.getValue());
+
+        const int repeats = std::max(5, 100000/numBodies);
+        long long elapsed = 0;
+        int numContacts = 0;
+        for (int r = 0; r <= repeats; ++r) {
+            for (int i = 0; i < numBodies; ++i)
+                spheres[i].setQToFitTranslation(state, centers[i]
+                    + Vec3(random.getValue(), random.getValue(),
+                           random.getValue()));
+            system.realize(state, Stage::Position);
+            const long long start = realTimeInNs();
+            numContacts = tracker.getActiveContacts(state).getNumContacts();
+            if (r > 0) // the first one is warm up
+                elapsed += realTimeInNs() - start;
+        }
+        std::printf("%8d %10d %14.2f\n", numBodies, numContacts,
+                    1e-3*elapsed/repeats);
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program measures how long GeneralForceSubsystem takes to calculate a
+large number of small built-in forces (springs, dampers and bushings, as in a
+musculoskeletal model) with different numbers of threads. Usage:
+
+    ManySmallForcesBenchmark [numForces [maxThreads]]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+int main(int argc, char** argv) {
+    const int numForces = argc > 1 ? std::atoi(argv[1]) : 600;
+    const int maxThreads = argc > 2 ? std::atoi(argv[2])
+                                    : ParallelExecutor::getNumProcessors();
+    const int numBodies = 30;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+    MobilizedBodyIndex parent = GroundIndex;
+    for (int i = 0; i < numBodies; ++i) {
+        MobilizedBody::Ball ball(matter.updMobilizedBody(parent),
+                                 Transform(Vec3(0, -1, 0)), body, Transform());
+        parent = ball.getMobilizedBodyIndex();
+    }
+    for (int i = 0; i < numForces; ++i) {
+        const MobilizedBody& b1 =
+            matter.getMobilizedBody(MobilizedBodyIndex(i % (numBodies+1)));
+        const MobilizedBody& b2 =
+            matter.getMobilizedBody(MobilizedBodyIndex(1 + (7*i) % numBodies));
+        switch (i % 3) {
+        case 0:
+            Force::TwoPointLinearSpring(forces, b1, Vec3(0.1, 0, 0),
+                                        b2, Vec3(0, 0.1, 0), 100, 0.5);
+            break;
+        case 1:
+            Force::TwoPointLinearDamper(forces, b1, Vec3(0, 0, 0.1),
+                                        b2, Vec3(0.1, 0, 0), 2);
+            break;
+        case 2:
+            Force::LinearBushing(forces, b1, b2, Vec6(10), Vec6(1));
+            break;
+        }
+    }
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    for (int i = 0; i < state.getNQ(); ++i)
+        state.updQ()[i] = 0.01*i;
+    for (int i = 0; i < state.getNU(); ++i)
+        state.updU()[i] = 0.1*i;
+
+    std::printf("# %d forces on %d bodies\n", numForces, numBodies);
+    std::printf("%8s %14s\n", "threads", "dynamics(us)");
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        forces.setNumberOfThreads(numThreads);
+        state.invalidateAllCacheAtOrAbove(Stage::Position);
+        system.realize(state, Stage::Dynamics); // warm up
+        const int repeats = 2000;
+        const long long start = realTimeInNs();
+        for (int i = 0; i < repeats; ++i) {
+            state.invalidateAllCacheAtOrAbove(Stage::Velocity);
+            system.realize(state, Stage::Dynamics);
+        }
+        std::printf("%8d %14.2f\n", numThreads,
+                    1e-3*(realTimeInNs() - start)/repeats);
+    }
+    return 0;
+}
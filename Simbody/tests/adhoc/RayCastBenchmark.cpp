@@ -0,0 +1,153 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*
+This program measures how long ContactTrackerSubsystem::castRays() takes to
+cast a simulated LiDAR scan into a scene of mesh and sphere obstacles over a
+floor, using one thread and then the default number of threads. For
+comparison it also times the obvious loop that tests every ray against every
+surface with ContactGeometry::intersectsRay(). Usage:
+
+    RayCastBenchmark [numObstacles] [numRays]
+*/
+
+#include "SimTKsimbody.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+namespace {
+
+// Milliseconds per scan, casting the same scan the given number of times.
+double timeCastRays(const ContactTrackerSubsystem& tracker, const State& state,
+                    const Array_<Vec3>& origins,
+                    const Array_<UnitVec3>& directions, int repeats,
+                    int& numHits) {
+    Array_<ContactTrackerSubsystem::RayHit> hits;
+    const long long start = realTimeInNs();
+    for (int r = 0; r < repeats; ++r)
+        tracker.castRays(state, origins, directions, Infinity, hits);
+    const double ms = 1e-6*(realTimeInNs() - start)/repeats;
+    numHits = 0;
+    for (const ContactTrackerSubsystem::RayHit& hit : hits)
+        if (hit.isHit())
+            ++numHits;
+    return ms;
+}
+
+double timeBruteForce(const ContactTrackerSubsystem& tracker,
+                      const State& state, const Array_<Vec3>& origins,
+                      const Array_<UnitVec3>& directions, int& numHits) {
+    const long long start = realTimeInNs();
+    numHits = 0;
+    for (int i = 0; i < (int)origins.size(); ++i) {
+        Real nearest = Infinity;
+        for (ContactSurfaceIndex surfx(0); surfx < tracker.getNumSurfaces();
+             ++surfx) {
+            const Transform X_GS =
+                tracker.getMobilizedBody(surfx).getBodyTransform(state)
+                * tracker.getContactSurfaceTransform(surfx);
+            Real distance; UnitVec3 normal;
+            if (tracker.getContactSurface(surfx).getShape().intersectsRay(
+                    ~X_GS*origins[i], ~X_GS.R()*directions[i], distance,
+                    normal))
+                nearest = std::min(nearest, distance);
+        }
+        if (nearest < Infinity)
+            ++numHits;
+    }
+    return 1e-6*(realTimeInNs() - start);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int numObstacles = argc > 1 ? std::atoi(argv[1]) : 200;
+    const int numRays      = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    ContactTrackerSubsystem tracker(system);
+    const ContactMaterial material(1e6, 0, 0, 0, 0);
+    matter.Ground().updBody().addContactSurface(
+        Transform(Rotation(-Pi/2, ZAxis)),
+        ContactSurface(ContactGeometry::HalfSpace(), material)); // y < 0
+    const ContactGeometry::TriangleMesh mesh
+       (PolygonalMesh::createSphereMesh(0.5, 4));
+    Random::Uniform random(0, 1);
+    random.setSeed(3);
+    for (int i = 0; i < numObstacles; ++i) {
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+        if (i % 4 == 0)
+            body.addContactSurface(ContactSurface(
+                ContactGeometry::Sphere(0.5), material));
+        else
+            body.addContactSurface(ContactSurface(mesh, material));
+        // Scatter the obstacles on the floor around the sensor.
+        const Real angle = 2*Pi*random.getValue();
+        const Real range = 2 + 18*random.getValue();
+        MobilizedBody::Weld(matter.updGround(),
+            Transform(Vec3(range*std::cos(angle), 0.5, range*std::sin(angle))),
+            body, Transform());
+    }
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    system.realize(state, Stage::Position);
+
+    // A spinning scanner 1m above the floor with 16 beams fanned from 15
+    // degrees down to 15 degrees up.
+    Array_<Vec3> origins(numRays, Vec3(0, 1, 0));
+    Array_<UnitVec3> directions(numRays);
+    const int numBeams = 16;
+    for (int i = 0; i < numRays; ++i) {
+        const Real elevation = (-15 + 30.*(i % numBeams)/(numBeams-1))*Pi/180;
+        const Real azimuth = 2*Pi*(i / numBeams)*numBeams/numRays;
+        directions[i] = UnitVec3(std::cos(elevation)*std::cos(azimuth),
+                                 std::sin(elevation),
+                                 std::cos(elevation)*std::sin(azimuth));
+    }
+
+    std::printf("%d obstacles (%d mesh faces each), %d rays\n", numObstacles,
+                mesh.getNumFaces(), numRays);
+    int numHits;
+    const double bruteMs = timeBruteForce(tracker, state, origins,
+                                          directions, numHits);
+    std::printf("%-22s %10.2f ms %8d hits\n", "every surface", bruteMs,
+                numHits);
+    const int numThreads = tracker.getNumberOfThreads();
+    tracker.setNumberOfThreads(1);
+    const double serialMs = timeCastRays(tracker, state, origins, directions,
+                                         10, numHits);
+    std::printf("%-22s %10.2f ms %8d hits\n", "castRays, 1 thread",
+                serialMs, numHits);
+    tracker.setNumberOfThreads(numThreads);
+    const double parallelMs = timeCastRays(tracker, state, origins,
+                                           directions, 10, numHits);
+    char label[40];
+    std::snprintf(label, sizeof(label), "castRays, %d threads", numThreads);
+    std::printf("%-22s %10.2f ms %8d hits\n", label, parallelMs, numHits);
+    return 0;
+}